@@ -11,15 +11,12 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "placa.h" //Pinagem da placa: LED_R, LED_G, LED_B e BUTTON.
 
 /* Definições e Constantes */
 #define TRUE          	1 
 #define FALSE		  	0
 #define DEBUG         	TRUE
-#define LED_R			GPIO_NUM_15 
-#define LED_G			GPIO_NUM_12
-#define LED_B 			GPIO_NUM_14
-#define BUTTON			GPIO_NUM_16 
 
 /* Protótipos de Funções */
 void app_main( void );
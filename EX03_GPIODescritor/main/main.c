@@ -12,110 +12,187 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "benchmark.h"
+#include "dlog.h"
+#include "perfil.h"
+#include "gpio_input.h"
+#include "gpio_mask.h"
+#include "tarefas.h"
+#include "agenda.h"
+#include "placa.h" //Pinagem da placa: LED_R, LED_G, LED_B e BUTTON.
 
 /* Definições e Constantes */
 #define TRUE          	1 
 #define FALSE		  	0
 #define DEBUG         	TRUE
-#define LED_R			GPIO_NUM_15 
-#define LED_G			GPIO_NUM_12
-#define LED_B 			GPIO_NUM_14
-#define BUTTON			GPIO_NUM_16 
-#define GPIO_OUTPUT_PIN_SEL  	((1ULL<<LED_G) | (1ULL<<LED_B))
-#define GPIO_INPUT_PIN_SEL  	(1ULL<<BUTTON)
+#ifndef BENCHMARK //O build para Linux define o modo pela linha de comando (host/CMakeLists.txt).
+#define BENCHMARK      	FALSE //Injeta bordas no BUTTON e mede latência botão->LED e ciclos por loop.
+#endif
+#define MODO_POLLING   	FALSE //TRUE: lê o BUTTON a cada 10ms. FALSE: task acordada pela interrupção do BUTTON.
+#define DEBOUNCE_US    	5000  //Janela de debounce do BUTTON no modo por interrupção (0 desabilita).
+#define NUCLEO_GPIO    	TAREFAS_NUCLEO_GPIO //Núcleo das tasks e da ISR de GPIO (tskNO_AFFINITY: escolhido pelo escalonador).
+#define PERIODO_BLINK_US	2000000 //Período do blink do LED_R, sem deriva (agenda).
 
 /* Protótipos de Funções */
 void app_main( void );
-void task_GPIO_Blink( void *pvParameter );
+static void GPIO_Blink( void *arg );
+static void relatorio_agenda( void *arg );
 void task_GPIO_Control( void *pvParameter );
+static void atualiza_leds( int nivel );
 
 /* Variáveis Globais */
 static const char * TAG = "main: ";
 const char * msg[2] = {"Desligado","Ligado"};
+static bench_stats_t bench_latencia; //Latência (us) entre a borda no BUTTON e a escrita nos LEDs.
+static bench_stats_t bench_cpu;      //Ciclos de CPU gastos por iteração do loop de controle.
+
+static agenda_item_t s_blink;           //Blink do LED_R, executado pela task da agenda.
+static agenda_item_t s_relatorio_agenda; //Atraso e deriva dos itens da agenda (modo BENCHMARK).
+
+/* Tasks da aplicação: função, nome, pilha, prioridade e núcleo. */
+static const tarefas_t s_tarefas[] = {
+	{ task_GPIO_Control, "task_GPIO_Control", 2048, 1, NUCLEO_GPIO },
+};
  
-void task_GPIO_Blink( void *pvParameter )
+/*
+	Inverte o LED_R a cada PERIODO_BLINK_US. Chamada pela agenda, que conta cada prazo a partir do
+	anterior: o período não soma o tempo do log e da escrita no pino, e não deriva ao longo das horas.
+*/
+static void GPIO_Blink( void *arg )
 {
-	 /*  Parâmetros de controle da GPIO da função "gpio_set_direction"
-		GPIO_MODE_OUTPUT       			//Saída
-		GPIO_MODE_INPUT        			//Entrada
-		GPIO_MODE_INPUT_OUTPUT 			//Dreno Aberto
-    */
-	gpio_pad_select_gpio( LED_R ); 	
-	gpio_set_direction( LED_R, GPIO_MODE_OUTPUT );	
-	bool estado = 0; 
-	
-    while ( TRUE ) 
-    {		
-		estado = !estado;
-        if( DEBUG )
-            ESP_LOGI(TAG, "Led Red: %s", msg[estado] );
-        gpio_set_level( LED_R, estado ); 				
-		
-        vTaskDelay( 2000 / portTICK_RATE_MS ); //Delay de 2000ms liberando scheduler;
-	}
-}	
+	static bool estado = 0;
+
+	estado = !estado;
+	DLOGI(TAG, "Led Red: %s", msg[estado] );
+	gpio_set_level( LED_R, estado );
+}
+
+/* Imprime o atraso e a deriva de cada item da agenda. */
+static void relatorio_agenda( void *arg )
+{
+	agenda_relatorio();
+}
 
 void task_GPIO_Control( void *pvParameter )
 {
-	 /*  Parâmetros de controle da GPIO da função "gpio_set_direction"
-		GPIO_MODE_OUTPUT       			//Saída
-		GPIO_MODE_INPUT        			//Entrada
-		GPIO_MODE_INPUT_OUTPUT 			//Dreno Aberto
-    */
-	
-	gpio_config_t io_conf;  //Declaração da variável descritora. 
-    io_conf.intr_type = GPIO_PIN_INTR_DISABLE; //Desabilita interrupção externa.
-    io_conf.mode = GPIO_MODE_OUTPUT; //Configura GPIO como saídas.
-    io_conf.pin_bit_mask = GPIO_OUTPUT_PIN_SEL; //Carrega GPIO configuradas.
-    gpio_config( &io_conf );  //Configura GPIO conforme descritor.
-  
-  
-	/*	Parâmetros de controle da resistência interna na função "gpio_set_pull_mode"
-		GPIO_PULLUP_ONLY,               // Pad pull up            
-		GPIO_PULLDOWN_ONLY,             // Pad pull down          
-		GPIO_PULLUP_PULLDOWN,           // Pad pull up + pull down
-		GPIO_FLOATING,                  // Pad floating  
-	*/
-	io_conf.intr_type = GPIO_PIN_INTR_DISABLE;  //Desabilita interrupção externa.
-    io_conf.mode = GPIO_MODE_INPUT; //Configura GPIO como entradas.
-    io_conf.pin_bit_mask = GPIO_INPUT_PIN_SEL; //Carrega GPIO configuradas.
-    io_conf.pull_down_en = GPIO_PULLDOWN_DISABLE; //Desabilita Pull-down das GPIO's.
-    io_conf.pull_up_en = GPIO_PULLUP_ENABLE; //Habilita Pull-up das GPIO's.
-    gpio_config(&io_conf);    //Configura GPIO conforme descritor.
-    
+	if( BENCHMARK )
+	{
+		bench_stats_init( &bench_latencia, "latencia botao->LED" );
+		bench_stats_init( &bench_cpu, "ciclos por loop" );
+		bench_injetor_iniciar( BUTTON, 20, 200, &bench_latencia, 100 );
+
+		//Custo por atualização de 1 e 2 saídas: gpio_set_level pino a pino x gpio_write_mask. O LED_R
+		//fica de fora porque pertence ao blink da agenda, que roda ao mesmo tempo.
+		const gpio_num_t saidas[] = { LED_G, LED_B };
+		for( size_t n = 1; n <= sizeof(saidas)/sizeof(saidas[0]); n++ )
+			gpio_mask_benchmark( saidas, n, 10000 );
+	}
+
+	/*	No modo por interrupção a ISR do BUTTON envia a borda (pino, nível e instante) para esta task,
+		que fica bloqueada sem consumir CPU enquanto o botão não muda de estado. */
+	bool polling = MODO_POLLING;
+	if( !polling && gpio_input_iniciar( PLACA_MASCARA_ENTRADAS, 16 ) != ESP_OK )
+	{
+		ESP_LOGE( TAG, "Interrupcao do BUTTON indisponivel, lendo a cada 10ms" );
+		polling = TRUE;
+	}
+	if( !polling )
+	{
+		if( DEBOUNCE_US )
+		{
+			gpio_input_debounce_t debounce = {
+				.janela_us = DEBOUNCE_US,
+				.pulso_min_us = DEBOUNCE_US,
+				.borda = GPIO_INTR_ANYEDGE, //Os LEDs acompanham o botão nas duas bordas.
+			};
+			gpio_input_debounce( BUTTON, &debounce );
+		}
+	}
+
+	int nivel_anterior = gpio_get_level(BUTTON);
+	atualiza_leds( nivel_anterior );
+	uint32_t acordadas = 0;
+	int64_t ultimo_relatorio = esp_timer_get_time();
 
     while ( TRUE ) 
     {
-		if (!gpio_get_level(BUTTON))
-		{			
-			gpio_set_level(LED_G,1);
-			gpio_set_level(LED_B,0);			
+		int nivel;
+		if( polling )
+		{
+			vTaskDelay( 10 / portTICK_RATE_MS ); //Delay de 10ms liberando scheduler;
+			nivel = ( gpio_read_all() >> BUTTON ) & 1;
 		}
 		else
 		{
-			gpio_set_level(LED_G,0);
-			gpio_set_level(LED_B,1);			
+			gpio_input_evento_t evento;
+			if( !gpio_input_ler( &evento, portMAX_DELAY ) ) //Aguarda a próxima borda no BUTTON.
+				continue;
+			nivel = evento.nivel;
+		}
+		acordadas++;
+
+		uint32_t inicio = bench_ciclos();
+		atualiza_leds( nivel );
+		if( BENCHMARK )
+		{
+			bench_stats_add( &bench_cpu, bench_ciclos() - inicio );
+			//Só registra a latência quando os LEDs de fato mudaram em resposta a uma borda.
+			if( nivel != nivel_anterior )
+				bench_latencia_marcar( &bench_latencia );
+
+			int64_t agora = esp_timer_get_time();
+			if( agora - ultimo_relatorio >= 10000000 )
+			{
+				ESP_LOGI( TAG, "%s: %u despertares em %u ms", polling ? "polling" : "interrupcao",
+						  acordadas, (uint32_t)( ( agora - ultimo_relatorio ) / 1000 ) );
+				bench_stats_report( &bench_cpu, "ciclos" );
+				acordadas = 0;
+				ultimo_relatorio = agora;
+			}
 		}
-		vTaskDelay( 10 / portTICK_RATE_MS ); //Delay de 10ms liberando scheduler;
+		nivel_anterior = nivel;
 	}
 }	
 
+/*	Acende o LED_G e apaga o LED_B com o botão pressionado (nível baixo) e o inverso com o botão solto.
+	Cada máscara é escrita de uma só vez nos registradores W1TS/W1TC (sem uma chamada por pino). */
+static void atualiza_leds( int nivel )
+{
+	if (!nivel)
+		gpio_write_mask( 1ULL<<LED_G, 1ULL<<LED_B );
+	else
+		gpio_write_mask( 1ULL<<LED_B, 1ULL<<LED_G );
+}
+
 /* Aplicação Principal (Inicia após bootloader) */
 void app_main( void )
 {	
-	// Cria a task responsável pelo blink LED. 
-	if( (xTaskCreate( task_GPIO_Blink, "task_GPIO_Blink", 2048, NULL, 1, NULL )) != pdTRUE )
-    {
-      if( DEBUG )
-        ESP_LOGI( TAG, "error - Nao foi possivel alocar task_GPIO_Blink.\r\n" );  
-      return;   
-    } 
-	
-	// Cria a task responsável pelo blink controle dos LEDs através do botão. 
-	if( (xTaskCreate( task_GPIO_Control, "task_GPIO_Control", 2048, NULL, 1, NULL )) != pdTRUE )
+	//Os logs das tasks (DLOGx) são formatados e enviados à UART por esta task de baixa prioridade.
+	dlog_iniciar( DLOG_SAIDA_TEXTO, 50, 1 );
+
+	/*	Os descritores gpio_config_t são montados a partir da tabela de pinos (placa.h): pinos com a
+		mesma configuração são agrupados em uma única chamada de gpio_config. */
+	placa_configurar();
+
+	//A ISR do BUTTON é alocada no mesmo núcleo das tasks que a consomem.
+	tarefas_isr_gpio( NUCLEO_GPIO, 0 );
+
+	// Cria as tasks da tabela: controle dos LEDs através do botão (o blink do LED_R roda na agenda).
+	if( tarefas_criar( s_tarefas, sizeof(s_tarefas)/sizeof(s_tarefas[0]) ) != ESP_OK )
     {
       if( DEBUG )
-        ESP_LOGI( TAG, "error - Nao foi possivel alocar task_GPIO_Control.\r\n" );  
+        ESP_LOGI( TAG, "error - Nao foi possivel alocar as tasks.\r\n" );  
       return;   
-    } 
-}
\ No newline at end of file
+    }
+
+	//O blink roda na task da agenda, no mesmo núcleo das demais tasks de GPIO (sem task própria).
+	agenda_iniciar( 1, NUCLEO_GPIO, 2048 );
+	agenda_adicionar( &s_blink, "blink LED_R", PERIODO_BLINK_US, 0, GPIO_Blink, NULL );
+	if( BENCHMARK )
+		agenda_adicionar( &s_relatorio_agenda, "relatorio da agenda", 10000000, 10000000, relatorio_agenda, NULL );
+
+	//Relatório periódico (JSON) do uso de CPU e de pilha de cada task e da duração das ISRs.
+	if( BENCHMARK )
+		perfil_iniciar( 10000 );
+}
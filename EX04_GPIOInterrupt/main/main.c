@@ -12,110 +12,313 @@
 #include "freertos/task.h"
 #include "driver/gpio.h"
 #include "esp_log.h"
+#include "benchmark.h"
+#include "dlog.h"
+#include "perfil.h"
+#include "gpio_input.h"
+#include "tarefas.h"
+#include "agenda.h"
+#include "captura.h"
+#include "contagem.h"
+#include "gpio_bin.h"
+#include "esp_timer.h"
+#include "placa.h" //Pinagem da placa: LED_R, LED_G, LED_B e BUTTON.
 
 /* Definições e Constantes */
 #define TRUE          	1 
 #define FALSE		  	0
 #define DEBUG         	TRUE
-#define LED_R			GPIO_NUM_15 
-#define LED_G			GPIO_NUM_12
-#define LED_B 			GPIO_NUM_14
-#define BUTTON			GPIO_NUM_16 
-#define GPIO_OUTPUT_PIN_SEL  	((1ULL<<LED_G) | (1ULL<<LED_B))
-#define GPIO_INPUT_PIN_SEL  	(1ULL<<BUTTON)
+#ifndef BENCHMARK //O build para Linux define o modo pela linha de comando (host/CMakeLists.txt).
+#define BENCHMARK      	FALSE //Injeta bordas com rebote no BUTTON e mede latência e ISRs por borda aceita.
+#endif
+#define TAMANHO_RING		64    //Capacidade do ring de eventos (potência de 2).
+#define TAMANHO_LOTE		16    //Eventos retirados do ring por vez.
+#define DEBOUNCE_US			20000 //Janela de debounce do BUTTON (0 desabilita o filtro).
+#define PULSO_MIN_US		30000 //Tempo mínimo que o botão precisa ficar pressionado.
+#define ENTRADA_ISR			0     //Uma ISR por borda, consumida pela task_GPIO_Eventos.
+#define ENTRADA_RMT			1     //Pulsos medidos pelo RMT (task_captura).
+#define ENTRADA_PCNT		2     //Bordas contadas pelo PCNT (task_contagem).
+#define MODO_ENTRADA		ENTRADA_ISR //Como o BUTTON é lido.
+#define LIMIAR_CONTAGEM		10    //No modo PCNT, a task_contagem é acordada a cada LIMIAR_CONTAGEM bordas.
+#define SAIDA_BINARIA		FALSE //Bordas do BUTTON na UART como linhas "GPIOBIN:<hex>" (tools/gpio_bin_decode.py) em vez do log em texto.
+#define NUCLEO_GPIO			TAREFAS_NUCLEO_GPIO //Núcleo das tasks e da ISR de GPIO (tskNO_AFFINITY: escolhido pelo escalonador).
+#define PERIODO_BLINK_US		2000000 //Período do blink do LED_R, sem deriva (agenda).
 
 /* Protótipos de Funções */
 void app_main( void );
-void task_GPIO_Blink( void *pvParameter );
-static void IRAM_ATTR gpio_isr_handler( void *arg );
+static void GPIO_Blink( void *arg );
+static void relatorio_agenda( void *arg );
+void task_GPIO_Eventos( void *pvParameter );
+void task_captura( void *pvParameter );
+void task_contagem( void *pvParameter );
 
 /* Variáveis Globais */
 static const char * TAG = "main: ";
 const char * msg[2] = {"Desligado","Ligado"};
-volatile int contador=0; 
+uint32_t contador=0; //Bordas recebidas, atualizado somente pela task de entrada do modo escolhido.
+static bench_stats_t bench_latencia; //Latência (us) entre a borda no BUTTON e a escrita no LED_G.
+
+static agenda_item_t s_blink;           //Blink do LED_R, executado pela task da agenda.
+static agenda_item_t s_relatorio_agenda; //Atraso e deriva dos itens da agenda (modo BENCHMARK).
+
+/* Tasks da aplicação: função, nome, pilha, prioridade e núcleo. */
+static const tarefas_t s_tarefas[] = {
+	{ task_GPIO_Eventos, "task_GPIO_Eventos", 4096, 2, NUCLEO_GPIO },
+};
+static const tarefas_t s_tarefas_captura[] = {
+	{ task_captura,      "task_captura",      3072, 2, NUCLEO_GPIO },
+};
+static const tarefas_t s_tarefas_contagem[] = {
+	{ task_contagem,     "task_contagem",     2048, 2, NUCLEO_GPIO },
+};
  
-void task_GPIO_Blink( void *pvParameter )
+/*
+	Inverte o LED_R a cada PERIODO_BLINK_US. Chamada pela agenda, que conta cada prazo a partir do
+	anterior: o período não soma o tempo do log e da escrita no pino, e não deriva ao longo das horas.
+*/
+static void GPIO_Blink( void *arg )
 {
-	 /*  Parâmetros de controle da GPIO da função "gpio_set_direction"
-		GPIO_MODE_OUTPUT       			//Saída
-		GPIO_MODE_INPUT        			//Entrada
-		GPIO_MODE_INPUT_OUTPUT 			//Dreno Aberto
-    */
-	gpio_pad_select_gpio( LED_R ); 	
-	gpio_set_direction( LED_R, GPIO_MODE_OUTPUT );	
-	bool estado = 0; 
-	
+	static bool estado = 0;
+
+	estado = !estado;
+	DLOGI(TAG, "Led Red: %s", msg[estado] );
+	gpio_set_level( LED_R, estado );
+	if( BENCHMARK )
+	{
+		gpio_input_stats_t stats;
+		gpio_input_estatisticas( &stats );
+		ESP_LOGI( TAG, "ISRs: %u, aceitos: %u, rejeitados: %u, descartados: %u",
+				  stats.interrupcoes, stats.aceitos, stats.rejeitados, stats.descartados );
+	}
+}
+
+/* Imprime o atraso e a deriva de cada item da agenda. */
+static void relatorio_agenda( void *arg )
+{
+	agenda_relatorio();
+}
+
+/*
+	Consome em lote as bordas do BUTTON. A ISR do componente gpio_input registra cada borda em um ring
+	sem travas e, com o debounce ativo, desabilita a interrupção do pino durante a janela: os rebotes
+	não geram novas ISRs e somente a borda de descida confirmada chega a esta task. Com SAIDA_BINARIA,
+	cada lote vira uma linha "GPIOBIN:<hex>" no formato do componente gpio_bin (~3 bytes por borda).
+*/
+void task_GPIO_Eventos( void *pvParameter )
+{
+	gpio_input_evento_t lote[TAMANHO_LOTE];
+	uint8_t bloco[( TAMANHO_LOTE + 1 ) * GPIO_BIN_MAX_REGISTRO]; //Sincronismo e uma borda por evento do lote.
+	gpio_bin_codificador_t cod;
+	uint32_t ciclos_anterior = 0;
+	uint32_t estado_led = 0;
+	uint16_t seq_esperado[2] = { 0, 0 }; //Próxima sequência dos eventos sem e com debounce.
+	uint32_t perdidos = 0;
+
+	if( BENCHMARK )
+		gpio_bin_benchmark( 10000 );
+
+	if( gpio_input_iniciar( PLACA_MASCARA_ENTRADAS, TAMANHO_RING ) != ESP_OK )
+	{
+		ESP_LOGE( TAG, "Nao foi possivel iniciar a interrupcao do GPIO %d", BUTTON );
+		vTaskDelete( NULL );
+	}
+	if( DEBOUNCE_US )
+	{
+		gpio_input_debounce_t debounce = {
+			.janela_us = DEBOUNCE_US,
+			.pulso_min_us = PULSO_MIN_US,
+			.borda = GPIO_INTR_NEGEDGE, //Mesma borda configurada no descritor do BUTTON.
+		};
+		gpio_input_debounce( BUTTON, &debounce );
+	}
+
     while ( TRUE ) 
-    {		
-		estado = !estado;
-        if( DEBUG )
-            ESP_LOGI(TAG, "Led Red: %s", msg[estado] );
-        gpio_set_level( LED_R, estado ); 				
-		
-        vTaskDelay( 2000 / portTICK_RATE_MS ); //Delay de 2000ms liberando scheduler;
+    {
+		size_t n = gpio_input_drenar( lote, TAMANHO_LOTE, portMAX_DELAY ); //Bloqueia até chegarem novas bordas.
+
+		/*	Os eventos trazem o contador de ciclos da CPU, convertido para o relógio do esp_timer pela
+			distância até agora. Com NUCLEO_GPIO fixo, a ISR e esta task leem o contador do mesmo núcleo
+			(com tskNO_AFFINITY o instante pode ter o erro da diferença entre os dois contadores).
+		*/
+		int64_t agora_us = esp_timer_get_time();
+		uint32_t agora_ciclos = bench_ciclos();
+		size_t pos = 0, sincronismo = 0;
+		if( SAIDA_BINARIA )
+		{
+			gpio_bin_codificador_init( &cod );
+			sincronismo = pos = gpio_bin_sincronismo( &cod, bloco, sizeof( bloco ),
+				agora_us - ( agora_ciclos - lote[0].ciclos ) / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ );
+		}
+
+		for( size_t i = 0; i < n; i++ )
+		{
+			//Uma lacuna na sequência são bordas descartadas com o ring cheio.
+			uint16_t *esperado = &seq_esperado[ DEBOUNCE_US && lote[i].pino == BUTTON ];
+			if( lote[i].seq != *esperado )
+			{
+				uint16_t lacuna = lote[i].seq - *esperado;
+				perdidos += lacuna;
+				DLOGW( TAG, "%u bordas perdidas antes do GPIO %u, %u no total", lacuna, lote[i].pino, perdidos );
+			}
+			*esperado = lote[i].seq + 1;
+
+			//Sem debounce o pino é monitorado nas duas bordas; conta apenas as de descida.
+			if( lote[i].pino != BUTTON || lote[i].nivel )
+				continue;
+			estado_led = !estado_led;
+			gpio_set_level(LED_G,estado_led);
+			if( BENCHMARK )
+				bench_latencia_marcar( &bench_latencia );
+			contador++;
+			if( SAIDA_BINARIA )
+				pos += gpio_bin_codificar( &cod, bloco + pos, sizeof( bloco ) - pos,
+					agora_us - ( agora_ciclos - lote[i].ciclos ) / CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+					lote[i].pino, lote[i].nivel );
+			else
+				DLOGI( TAG, "Borda %u no GPIO %u, %u ciclos apos a anterior",
+					   contador, lote[i].pino, lote[i].ciclos - ciclos_anterior );
+			ciclos_anterior = lote[i].ciclos;
+		}
+
+		if( pos > sincronismo )
+		{
+			printf( "GPIOBIN:" );
+			for( size_t i = 0; i < pos; i++ )
+				printf( "%02x", bloco[i] );
+			printf( "\n" );
+		}
 	}
-}	
+}
 
-/* ISR (função de callback) esta função de IRQ será chamada sempre que acontecer uma interrupção. */
-static void IRAM_ATTR gpio_isr_handler( void* arg )
-{	
-	//Verifica qual botão ativou a interrupção.
-	if( BUTTON == (uint32_t) arg )
-	{			
-		gpio_set_level(LED_G,contador%2);				
+/*
+	Modo captura: o receptor do RMT mede cada nível do BUTTON em hardware e entrega um quadro quando a
+	linha fica parada por 1ms, sem uma ISR por borda. Cada pulso em nível baixo começa com uma borda de
+	descida, contada em "contador". No modo BENCHMARK o RMT_CHANNEL_0 gera rajadas no próprio pino
+	para medir a maior taxa de bordas capturada sem perdas.
+*/
+void task_captura( void *pvParameter )
+{
+	captura_pulso_t lote[TAMANHO_LOTE];
+	const captura_config_t config = {
+		.pino = BUTTON,
+		.canal = RMT_CHANNEL_4,
+		.blocos_memoria = 4,                  //Até 255 pulsos por quadro.
+		.divisor = 8,                         //Resolução de 100ns.
+		.filtro_apb = BENCHMARK ? 0 : 100,    //Ignora pulsos menores que 1,25us (desligado para medir a vazão).
+		.ocioso_ticks = 10000,                //1ms parado encerra o quadro.
+		.tamanho_buffer = 4096,
+	};
+
+	if( captura_iniciar( &config ) != ESP_OK )
+	{
+		ESP_LOGE( TAG, "Nao foi possivel iniciar a captura no GPIO %d", BUTTON );
+		vTaskDelete( NULL );
+	}
+	if( BENCHMARK )
+		captura_benchmark( RMT_CHANNEL_0, 200 );
+
+    while ( TRUE ) 
+    {
+		size_t n = captura_ler( lote, TAMANHO_LOTE, portMAX_DELAY ); //Bloqueia até chegar um quadro.
+		for( size_t i = 0; i < n; i++ )
+			if( !lote[i].nivel )
+				contador++;
+		DLOGI( TAG, "%u pulsos no lote, %u bordas de descida no total", n, contador );
+	}
+}
+
+/*
+	Modo contagem: o PCNT conta as bordas de descida do BUTTON em hardware, com o filtro de glitch, e a
+	CPU só é interrompida no limiar e no estouro do contador de 16 bits. "contador" passa a ser apenas
+	uma cópia do total de 64 bits mantido pelo componente. No modo BENCHMARK, compara antes a carga da
+	CPU de uma ISR por borda e do PCNT com ondas de 1 kHz, 10 kHz e 100 kHz geradas no próprio pino.
+*/
+void task_contagem( void *pvParameter )
+{
+	const contagem_config_t config = {
+		.pino = BUTTON,
+		.unidade = PCNT_UNIT_0,
+		.subida = PCNT_COUNT_DIS,
+		.descida = PCNT_COUNT_INC,
+		.filtro_apb = 1000,                   //Ignora pulsos menores que 12,5us.
+		.limite = LIMIAR_CONTAGEM,            //Volta a zero a cada limiar: uma interrupção por LIMIAR_CONTAGEM bordas.
+		.notificar = xTaskGetCurrentTaskHandle(),
+	};
+
+	if( BENCHMARK )
+		contagem_benchmark( BUTTON, PCNT_UNIT_0, 2000 );
+	if( contagem_iniciar( &config ) != ESP_OK )
+	{
+		ESP_LOGE( TAG, "Nao foi possivel iniciar a contagem no GPIO %d", BUTTON );
+		vTaskDelete( NULL );
+	}
+
+    while ( TRUE ) 
+    {
+		//Acorda no limiar ou a cada 1s para atualizar as bordas que ainda não chegaram a ele.
+		ulTaskNotifyTake( pdTRUE, 1000 / portTICK_PERIOD_MS );
+		uint32_t total = (uint32_t) contagem_total();
+		if( total != contador )
+		{
+			contador = total;
+			DLOGI( TAG, "%u bordas de descida no total", contador );
+		}
 	}
-	contador++;	
 }
 
 /* Aplicação Principal (Inicia após bootloader) */
 void app_main( void )
 {	
-	/*  Parâmetros de controle da GPIO da função "gpio_set_direction"
-		GPIO_MODE_OUTPUT       			//Saída
-		GPIO_MODE_INPUT        			//Entrada
-		GPIO_MODE_INPUT_OUTPUT 			//Dreno Aberto
-    */	
-	gpio_config_t output_conf = {
-		.intr_type = GPIO_PIN_INTR_DISABLE, //Desabilita interrupção externa.
-		.mode = GPIO_MODE_OUTPUT, //Configura GPIO como saídas.
-		.pin_bit_mask = GPIO_OUTPUT_PIN_SEL //Carrega GPIO configuradas.
-	};
-    gpio_config( &output_conf );  //Configura GPIO conforme descritor.
-    
-	/*	Parâmetros de controle da resistência interna na função "gpio_set_pull_mode"
-		GPIO_PULLUP_ONLY,               // Pad pull up            
-		GPIO_PULLDOWN_ONLY,             // Pad pull down          
-		GPIO_PULLUP_PULLDOWN,           // Pad pull up + pull down
-		GPIO_FLOATING,                  // Pad floating  
-	*/
-	/*
-		GPIO_INTR_DISABLE = 0,     		// Desabilita interrupção da GPIO                            
-		GPIO_INTR_POSEDGE = 1,     		// Habilita interrupção na borda de subida                  
-		GPIO_INTR_NEGEDGE = 2,     		// Habilita interrupção na borda de descida               
-		GPIO_INTR_ANYEDGE = 3,     		// Habilita interrupção em ambas as borda 
+	//Os logs das tasks (DLOGx) são formatados e enviados à UART por esta task de baixa prioridade.
+	dlog_iniciar( DLOG_SAIDA_TEXTO, 50, 1 );
+
+	/*	Os descritores gpio_config_t são montados a partir da tabela de pinos (placa.h): pinos com a
+		mesma configuração são agrupados em uma única chamada de gpio_config. A interrupção do BUTTON
+		é habilitada depois, pelo gpio_input.
 	*/
-	gpio_config_t input_conf = {
-		.intr_type = GPIO_INTR_NEGEDGE,  //Habilita interrupção na borda de descida 
-		.mode = GPIO_MODE_INPUT, //Configura GPIO como entradas.
-		.pin_bit_mask = GPIO_INPUT_PIN_SEL, //Carrega GPIO configuradas.
-		.pull_down_en = GPIO_PULLDOWN_DISABLE, //Desabilita Pull-down das GPIO's.
-		.pull_up_en = GPIO_PULLUP_ENABLE //Habilita Pull-up das GPIO's.
-    };
-	gpio_config(&input_conf);    //Configura GPIO conforme descritor.
+	placa_configurar();
+
+	if( BENCHMARK && MODO_ENTRADA == ENTRADA_ISR )
+	{
+		bench_stats_init( &bench_latencia, "latencia borda->LED" );
+		bench_injetor_rebotes( 5, 300 ); //5 rebotes de 300us a cada aperto simulado.
+		bench_injetor_iniciar( BUTTON, 50, 200, &bench_latencia, 100 );
+	}
 
 	//Habilita a interrupção externa da(s) GPIO's. 
 	//Ao utilizar a função gpio_install_isr_service todas as interrupções de GPIO do descritor vão chamar a mesma 
-	//interrupção. A função de callback que será chamada para cada interrupção é definida em gpio_isr_handler_add. 
-	gpio_install_isr_service(0);
+	//interrupção. A função de callback de cada pino é registrada pelo gpio_input (gpio_isr_handler_add). 
+	//O serviço é instalado no mesmo núcleo da task_GPIO_Eventos, que consome as bordas.
+	tarefas_isr_gpio( NUCLEO_GPIO, 0 );
 
-	//Registra a interrupção externa do BUTTON
-    gpio_isr_handler_add( BUTTON, gpio_isr_handler, (void*) BUTTON ); 	
-
-	// Cria a task responsável pelo blink LED. 
-	if( (xTaskCreate( task_GPIO_Blink, "task_GPIO_Blink", 2048, NULL, 1, NULL )) != pdTRUE )
+	// Cria as tasks da tabela do modo de entrada: interrupções do BUTTON, capturas do RMT ou contagem do PCNT.
+	esp_err_t ret;
+	switch( MODO_ENTRADA )
+	{
+		case ENTRADA_RMT:
+			ret = tarefas_criar( s_tarefas_captura, sizeof(s_tarefas_captura)/sizeof(s_tarefas_captura[0]) );
+			break;
+		case ENTRADA_PCNT:
+			ret = tarefas_criar( s_tarefas_contagem, sizeof(s_tarefas_contagem)/sizeof(s_tarefas_contagem[0]) );
+			break;
+		default:
+			ret = tarefas_criar( s_tarefas, sizeof(s_tarefas)/sizeof(s_tarefas[0]) );
+			break;
+	}
+	if( ret != ESP_OK )
     {
       if( DEBUG )
-        ESP_LOGI( TAG, "error - Nao foi possivel alocar task_GPIO_Blink.\r\n" );  
+        ESP_LOGI( TAG, "error - Nao foi possivel alocar as tasks.\r\n" );  
       return;   
-    }	
-}
\ No newline at end of file
+    }
+
+	//O blink roda na task da agenda, no mesmo núcleo das demais tasks de GPIO (sem task própria).
+	agenda_iniciar( 1, NUCLEO_GPIO, 2048 );
+	agenda_adicionar( &s_blink, "blink LED_R", PERIODO_BLINK_US, 0, GPIO_Blink, NULL );
+	if( BENCHMARK )
+		agenda_adicionar( &s_relatorio_agenda, "relatorio da agenda", 10000000, 10000000, relatorio_agenda, NULL );
+
+	//Relatório periódico (JSON) do uso de CPU e de pilha de cada task e da duração das ISRs.
+	if( BENCHMARK )
+		perfil_iniciar( 10000 );
+}
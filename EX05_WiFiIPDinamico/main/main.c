@@ -1,7 +1,7 @@
 /*
 	Autor: Prof. Vagner Rodrigues
 	Objetivo: Configurando rede WiFi com o ESP32 em modo cliente (Station)
-			  Configuração com IP dinâmico
+			  Configuração com IP dinâmico; o EX06 compila este mesmo main com o IP estático
 	Disciplina: IoT Aplicada
 	Curso: Engenharia da Computação
 */
@@ -14,10 +14,13 @@
 */
 
 /* Inclusão das Bibliotecas */
+#include <inttypes.h>
+#include <stdlib.h>
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
 #include "esp_system.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
@@ -25,17 +28,48 @@
 #include "nvs_flash.h"
 #include "lwip/err.h"
 #include "lwip/sys.h"
+#include "lwip/sockets.h"
+#include "esp_timer.h"
+#include "benchmark.h"
+#include "dlog.h"
+#include "perfil.h"
+#include "wifi_cache.h"
+#include "wifi_reconexao.h"
+#include "wifi_roaming.h"
+#include "rede_ip.h"
+#include "ip_eventos.h"
+#include "tarefas.h"
+#include "led_rgb.h"
+#include "energia.h"
+#include "telemetria.h"
+#include "parametros.h"
+#include "http_local.h"
+#include "contagem.h"
+#include "soc/gpio_reg.h"
+#include "placa.h" //Pinagem da placa: LED_R, LED_G, LED_B e BUTTON.
 
 /* Definições e Constantes */
 #define TRUE          	1 
 #define FALSE		  	0
 #define DEBUG         	TRUE
-#define LED_R			GPIO_NUM_15 
-#define LED_G			GPIO_NUM_12
-#define LED_B 			GPIO_NUM_14
-#define BUTTON			GPIO_NUM_16 
-#define GPIO_OUTPUT_PIN_SEL  	((1ULL<<LED_G) | (1ULL<<LED_B))
-#define GPIO_INPUT_PIN_SEL  	(1ULL<<BUTTON)
+#define BENCHMARK      	FALSE //Mede os ciclos do event_handler e o jitter do blink com o WiFi sob carga.
+#define FIXAR_NUCLEOS  	TRUE  //FALSE: todas as tasks sem afinidade, para comparar o jitter no modo BENCHMARK.
+#define NUCLEO_WIFI    	( FIXAR_NUCLEOS ? TAREFAS_NUCLEO_WIFI : tskNO_AFFINITY )
+#define NUCLEO_GPIO    	( FIXAR_NUCLEOS ? TAREFAS_NUCLEO_GPIO : tskNO_AFFINITY )
+#define PERIODO_BLINK_MS	10   //Período do task_GPIO_Blink no modo BENCHMARK.
+#define RELATORIO_BLINK		1000 //Períodos entre os relatórios de jitter.
+#define TAMANHO_CARGA		1024 //Bytes de cada datagrama UDP gerado pela task_carga_wifi.
+#define CARGA_POR_TICK		8    //Datagramas enviados a cada tick.
+#define LED_STATUS     	!BENCHMARK //LED RGB mostra o estado do WiFi (no BENCHMARK o LED_R é do blink de medição).
+#define ECONOMIA       	FALSE //Light sleep automático com DFS, BUTTON desperta a CPU e WiFi em modem sleep.
+#define RELATORIO_ENERGIA_MS	60000 //Período do relatório de tempo e corrente por modo de energia (0 desabilita).
+#define TELEMETRIA     	FALSE //Envia as leituras do BUTTON em lotes ao coletor (Example Configuration).
+#define PERIODO_AMOSTRA_MS	1000 //Período de leitura do BUTTON pela task_amostras.
+#define AMOSTRAS_POR_TICK	10   //Modo BENCHMARK: amostras sintéticas geradas a cada tick.
+#define RELATORIO_TELEMETRIA	10000 //Modo BENCHMARK: período (ms) do relatório da telemetria.
+#define ROAMING        	FALSE //Perfis de SSID e troca de AP por RSSI com histerese (Example Configuration).
+#define SERVIDOR_HTTP  	FALSE //Estado dos LEDs, do BUTTON, das tasks e da rede por HTTP; escrita dos LEDs (HTTP port).
+#define CONTADOR       	FALSE //O PCNT conta as bordas de descida do BUTTON (contador do EX04), exibido no /estado.
 /* The examples use WiFi configuration that you can set via project configuration menu
 
    If you'd rather not, just change the below entries to strings with
@@ -44,25 +78,109 @@
 #define EXAMPLE_ESP_WIFI_SSID      CONFIG_ESP_WIFI_SSID
 #define EXAMPLE_ESP_WIFI_PASS      CONFIG_ESP_WIFI_PASSWORD
 #define EXAMPLE_ESP_MAXIMUM_RETRY  CONFIG_ESP_MAXIMUM_RETRY
+#define EXAMPLE_RECONEXAO_BASE_MS  CONFIG_ESP_RECONEXAO_BASE_MS
+#define EXAMPLE_RECONEXAO_TETO_MS  CONFIG_ESP_RECONEXAO_TETO_MS
+#define EXAMPLE_INTERVALO_ESCUTA   CONFIG_ESP_INTERVALO_ESCUTA
+#define EXAMPLE_ROAMING_RSSI       CONFIG_ESP_ROAMING_RSSI
+#define EXAMPLE_ROAMING_HISTERESE  CONFIG_ESP_ROAMING_HISTERESE
+#define EXAMPLE_ROAMING_VARREDURA_S CONFIG_ESP_ROAMING_VARREDURA_S
+#define EXAMPLE_ROAMING_VARREDURA_FRACA_S CONFIG_ESP_ROAMING_VARREDURA_FRACA_S
+#define EXAMPLE_IP_FIXO            CONFIG_ESP_IP_FIXO
+#define EXAMPLE_IP_MASCARA         CONFIG_ESP_IP_MASCARA
+#define EXAMPLE_IP_GATEWAY         CONFIG_ESP_IP_GATEWAY
+#define EXAMPLE_IP_DNS             CONFIG_ESP_IP_DNS
+#define EXAMPLE_IP_TIMEOUT_DHCP_MS CONFIG_ESP_IP_TIMEOUT_DHCP_MS
+#define EXAMPLE_HTTP_PORTA         CONFIG_ESP_HTTP_PORTA
+#if defined(CONFIG_ESP_IP_MODO_ESTATICO)
+#define EXAMPLE_IP_MODO            REDE_IP_ESTATICO
+#elif defined(CONFIG_ESP_IP_MODO_DHCP)
+#define EXAMPLE_IP_MODO            REDE_IP_DHCP
+#else
+#define EXAMPLE_IP_MODO            REDE_IP_HIBRIDO
+#endif
+#define EXAMPLE_TELEMETRIA_DESTINO CONFIG_ESP_TELEMETRIA_DESTINO
+#define EXAMPLE_TELEMETRIA_PORTA   CONFIG_ESP_TELEMETRIA_PORTA
+#define EXAMPLE_TELEMETRIA_LOTE    CONFIG_ESP_TELEMETRIA_LOTE
+#define EXAMPLE_TELEMETRIA_IDADE_MS CONFIG_ESP_TELEMETRIA_IDADE_MS
+#ifdef CONFIG_ESP_TELEMETRIA_TCP
+#define EXAMPLE_TELEMETRIA_TCP     true
+#else
+#define EXAMPLE_TELEMETRIA_TCP     false
+#endif
 
 /* FreeRTOS event group to signal when we are connected*/
 static EventGroupHandle_t s_wifi_event_group; //Cria o objeto do grupo de eventos
 
 /* The event group allows multiple bits for each event, but we only care about two events:
  * - we are connected to the AP with an IP
- * - we failed to connect after the maximum amount of retries */
+ * - we failed to connect after the maximum amount of retries (the station keeps retrying with backoff) */
 #define WIFI_CONNECTED_BIT BIT0
 #define WIFI_FAIL_BIT      BIT1
+#define TAMANHO_FILA_IP    4 //Eventos de IP/enlace aguardando a task_ip.
 
 /* Protótipos de Funções */
 void app_main( void );
 static void event_handler(void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data);
 void task_ip( void *pvParameter );
-void wifi_init_sta( void );
+void task_GPIO_Blink( void *pvParameter );
+void task_carga_wifi( void *pvParameter );
+void task_amostras( void *pvParameter );
+EventGroupHandle_t wifi_init_sta( void );
 
 /* Variáveis Globais */
 static const char *TAG = "wifi station";
-static int s_retry_num = 0;
+static bench_stats_t bench_eventos; //Ciclos de CPU gastos por chamada do event_handler.
+static wifi_config_t s_wifi_config; //Mantida para voltar à varredura completa se o AP salvo falhar; somente a task do event loop a altera.
+ESP_EVENT_DEFINE_BASE(PARAMETROS_EVENT); //Parâmetro alterado em campo (id do parâmetro), tratado no event_handler.
+static QueueHandle_t s_fila_ip; //Mudanças de IP e de enlace entregues pelo ip_eventos à task_ip.
+
+/*
+	Parâmetros ajustáveis em campo (componente parametros, na NVS): o menuconfig fornece somente os
+	valores padrão, e um valor alterado vale para o dispositivo sem regravar o firmware.
+*/
+enum {
+	PARAM_SSID = 0,
+	PARAM_SENHA,
+	PARAM_TENTATIVAS,
+	PARAM_IP_FIXO,
+	PARAM_IP_MASCARA,
+	PARAM_IP_GATEWAY,
+	PARAM_IP_DNS,
+	NUM_PARAMETROS,
+};
+#define VERSAO_PARAMETROS  1 //Incrementar ao mudar o tipo ou o significado de uma chave.
+
+static const parametros_def_t s_parametros[NUM_PARAMETROS] = {
+	[PARAM_SSID]       = { "ssid",       PARAMETROS_TEXTO, .padrao_texto = EXAMPLE_ESP_WIFI_SSID, .maximo = 32 },
+	[PARAM_SENHA]      = { "senha",      PARAMETROS_TEXTO, .padrao_texto = EXAMPLE_ESP_WIFI_PASS, .maximo = 64, .secreto = true },
+	[PARAM_TENTATIVAS] = { "tentativas", PARAMETROS_INT,   .padrao = EXAMPLE_ESP_MAXIMUM_RETRY, .minimo = 0, .maximo = 1000 },
+	[PARAM_IP_FIXO]    = { "ip_fixo",    PARAMETROS_IP4,   .padrao_texto = EXAMPLE_IP_FIXO },
+	[PARAM_IP_MASCARA] = { "ip_mascara", PARAMETROS_IP4,   .padrao_texto = EXAMPLE_IP_MASCARA },
+	[PARAM_IP_GATEWAY] = { "ip_gateway", PARAMETROS_IP4,   .padrao_texto = EXAMPLE_IP_GATEWAY },
+	[PARAM_IP_DNS]     = { "ip_dns",     PARAMETROS_IP4,   .padrao_texto = EXAMPLE_IP_DNS },
+};
+
+/* Redes conhecidas pelo roaming; o segundo SSID é opcional (vazio no menuconfig). Outras podem ser salvas na NVS. */
+static wifi_roaming_perfil_t s_perfis_wifi[] = {
+	{ "", "" }, //PARAM_SSID e PARAM_SENHA, copiados em wifi_init_sta.
+	{ CONFIG_ESP_WIFI_SSID_2, CONFIG_ESP_WIFI_PASSWORD_2 },
+};
+
+/* Tasks da aplicação: função, nome, pilha, prioridade e núcleo. */
+static const tarefas_t s_tarefas[] = {
+	{ task_ip, "task_ip", 2048, 5, NUCLEO_WIFI },
+};
+
+/* Medição do jitter: blink no núcleo da GPIO e tráfego UDP no núcleo da pilha WiFi. */
+static const tarefas_t s_tarefas_benchmark[] = {
+	{ task_GPIO_Blink, "task_GPIO_Blink", 2048, 1, NUCLEO_GPIO },
+	{ task_carga_wifi, "task_carga_wifi", 2048, 5, NUCLEO_WIFI },
+};
+
+/* Leituras enviadas pela telemetria. */
+static const tarefas_t s_tarefas_telemetria[] = {
+	{ task_amostras, "task_amostras", 2048, 3, NUCLEO_GPIO },
+};
 
 /*
   Função de callback responsável em receber as notificações durante as etapas de conexão do WiFi.
@@ -73,6 +191,7 @@ static int s_retry_num = 0;
 static void event_handler(void* arg, esp_event_base_t event_base,
                                 int32_t event_id, void* event_data)
 {
+	uint32_t inicio = bench_ciclos();
     if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
 		if( DEBUG )
 		    ESP_LOGI(TAG, "Tentando conectar ao WiFi...\r\n");
@@ -80,58 +199,148 @@ static void event_handler(void* arg, esp_event_base_t event_base,
 			O WiFi do ESP32 foi configurado com sucesso. 
 			Agora precisamos conectar a rede WiFi local. Portanto, foi chamado a função esp_wifi_connect();
 		*/
+        bench_marco("WiFi iniciado (STA_START)");
         esp_wifi_connect();
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED) {
+        bench_marco("associado ao AP");
     } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        if (s_retry_num < EXAMPLE_ESP_MAXIMUM_RETRY) {
+        if ((ROAMING && wifi_roaming_desconectado(&s_wifi_config) == ESP_OK) || wifi_cache_fallback(&s_wifi_config) == ESP_OK) {
 			/*
-			Se chegou aqui foi devido a falha de conexão com a rede WiFi.
-			Por esse motivo, haverá uma nova tentativa de conexão WiFi pelo ESP32.
+				O roaming escolheu o próximo AP: o destino de uma troca pedida por ele, o melhor AP do
+				cache da varredura ou o próximo perfil. Sem escolha do roaming, se a conexão direta no
+				BSSID/canal salvos falhou (AP trocou de canal ou foi substituído), a próxima tentativa
+				usa a varredura completa.
 			*/
-            esp_wifi_connect();
-            s_retry_num++;
-            ESP_LOGI(TAG, "Tentando reconectar ao WiFi...");
-        } else {
-			/*
-				É necessário apagar o bit para avisar as demais Tasks que a 
-				conexão WiFi está offline no momento. 
-			*/
-            xEventGroupSetBits(s_wifi_event_group, WIFI_FAIL_BIT);
+            esp_wifi_set_config(ESP_IF_WIFI_STA, &s_wifi_config);
         }
+		/*
+			Se chegou aqui foi devido a falha de conexão com a rede WiFi. A nova tentativa é agendada
+			com backoff exponencial; o WIFI_CONNECTED_BIT é apagado para avisar as demais Tasks que
+			a conexão está offline e o WIFI_FAIL_BIT é setado após PARAM_TENTATIVAS falhas.
+		*/
+        wifi_reconexao_desconectado();
         ESP_LOGI(TAG,"Falha ao conectar ao WiFi");
+        if( LED_STATUS )
+            led_rgb_padrao( xEventGroupGetBits(s_wifi_event_group) & WIFI_FAIL_BIT ? LED_RGB_FALHA : LED_RGB_CONECTANDO );
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
 		/*
 			Conexão efetuada com sucesso. Busca e imprime o IP atribuido. 
 		*/
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
         ESP_LOGI(TAG, "Conectado! O IP atribuido é:" IPSTR, IP2STR(&event->ip_info.ip));
-        s_retry_num = 0;
+		/*
+			Salva o AP (BSSID e canal) para que o próximo boot conecte sem varrer todos os canais.
+			O tempo é contado a partir da inicialização do esp_timer, logo após o bootloader.
+		*/
+        wifi_cache_salvar();
+        static bool primeiro_ip = true; //Os handlers seguem registrados: mede somente o IP do boot.
+        if( primeiro_ip )
+        {
+            bench_marco("IP recebido");
+            if( DEBUG )
+            {
+                ESP_LOGI(TAG, "Tempo do boot ate o IP: %u ms (%s)", (uint32_t)(esp_timer_get_time() / 1000),
+                         wifi_cache_em_uso() ? "AP salvo" : "varredura completa");
+                bench_marcos_report();
+            }
+            primeiro_ip = false;
+        }
 		/*
 				Seta o bit indicativo para avisar as demais Tasks que o WiFi foi conectado. 
 		*/
-        xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        wifi_reconexao_conectado();
+        if( ROAMING )
+            wifi_roaming_conectado();
+        if( LED_STATUS )
+            led_rgb_padrao( LED_RGB_CONECTADO );
+    } else if (event_base == PARAMETROS_EVENT && (event_id == PARAM_SSID || event_id == PARAM_SENHA)) {
+		/*
+			SSID ou senha alterados em campo (postado pelo parametro_alterado): a s_wifi_config é
+			atualizada aqui, na mesma task do roaming e do wifi_cache. A station desconecta e o
+			wifi_reconexao reconecta com as credenciais novas.
+		*/
+        char texto[PARAMETROS_MAX_TEXTO + 1];
+        parametros_texto(PARAM_SSID, texto, sizeof(texto));
+        strncpy((char*) s_wifi_config.sta.ssid, texto, sizeof(s_wifi_config.sta.ssid));
+        parametros_texto(PARAM_SENHA, texto, sizeof(texto));
+        strncpy((char*) s_wifi_config.sta.password, texto, sizeof(s_wifi_config.sta.password));
+        s_wifi_config.sta.bssid_set = false; //O AP salvo é da rede anterior.
+        esp_wifi_set_config(ESP_IF_WIFI_STA, &s_wifi_config);
+        esp_wifi_disconnect();
+        ESP_LOGI(TAG, "Credenciais do WiFi alteradas, reconectando");
     }
+	if( BENCHMARK )
+	{
+		bench_stats_add( &bench_eventos, bench_ciclos() - inicio );
+		if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP)
+		{
+			bench_stats_report( &bench_eventos, "ciclos" );
+			wifi_reconexao_relatorio();
+			rede_ip_relatorio();
+			if( ROAMING )
+				wifi_roaming_relatorio();
+		}
+	}
 }
 
- /* Inicializa o WiFi em modo cliente (Station) */
-void wifi_init_sta(void)
+ /*
+	Inicializa o WiFi em modo cliente (Station) sem aguardar a conexão: a associação e o DHCP
+	acontecem em paralelo com o restante do boot. O grupo de eventos retornado é o indicador de
+	conclusão (WIFI_CONNECTED_BIT ou WIFI_FAIL_BIT); os handlers ficam registrados durante toda a
+	execução, tratando também as quedas e reconexões.
+*/
+EventGroupHandle_t wifi_init_sta(void)
 {
-    s_wifi_event_group = xEventGroupCreate(); //Cria o grupo de eventos
+    s_wifi_event_group = tarefas_grupo("app"); //Cria o grupo de eventos (estático com CONFIG_TAREFAS_ESTATICO)
+	if( BENCHMARK )
+		bench_stats_init( &bench_eventos, "ciclos por event_handler" );
 
     ESP_ERROR_CHECK(esp_netif_init());
 
     ESP_ERROR_CHECK(esp_event_loop_create_default());
-    esp_netif_create_default_wifi_sta();
+    esp_netif_t *netif = esp_netif_create_default_wifi_sta();
+
+    /* A task_ip é acordada somente quando o IP ou o enlace mudam (sem consulta periódica). */
+    ESP_ERROR_CHECK(ip_eventos_iniciar());
+    s_fila_ip = tarefas_fila("app", TAMANHO_FILA_IP, sizeof(ip_eventos_t));
+    ESP_ERROR_CHECK(ip_eventos_assinar_fila(IP_EVENTOS_TODOS, s_fila_ip));
 
     wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
     ESP_ERROR_CHECK(esp_wifi_init(&cfg));
 
+    wifi_reconexao_config_t reconexao = {
+        .grupo = s_wifi_event_group,
+        .bit_conectado = WIFI_CONNECTED_BIT,
+        .bit_falha = WIFI_FAIL_BIT,
+        .tentativas_falha = parametros_int(PARAM_TENTATIVAS),
+        .atraso_base_ms = EXAMPLE_RECONEXAO_BASE_MS,
+        .atraso_teto_ms = EXAMPLE_RECONEXAO_TETO_MS,
+    };
+    ESP_ERROR_CHECK(wifi_reconexao_iniciar(&reconexao));
+
     ESP_ERROR_CHECK(esp_event_handler_register(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL));
     ESP_ERROR_CHECK(esp_event_handler_register(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler, NULL));
+    ESP_ERROR_CHECK(esp_event_handler_register(PARAMETROS_EVENT, ESP_EVENT_ANY_ID, &event_handler, NULL));
+
+    /*	IP da station: DHCP, IP fixo ou híbrido (DHCP e, sem resposta em EXAMPLE_IP_TIMEOUT_DHCP_MS após a
+		associação, o IP fixo). O modo vem do menuconfig e pode ser trocado em campo com rede_ip_salvar_modo();
+		o IP fixo, a máscara, o gateway e o DNS são parâmetros.
+		No DHCP o endereço anterior é pedido direto ao servidor (INIT-REBOOT, CONFIG_LWIP_DHCP_RESTORE_LAST_IP),
+		sem a troca DISCOVER/OFFER. */
+    const rede_ip_config_t rede = {
+        .modo = rede_ip_modo_salvo(EXAMPLE_IP_MODO),
+        .estatico = {
+            .ip.addr = parametros_ip4(PARAM_IP_FIXO),
+            .netmask.addr = parametros_ip4(PARAM_IP_MASCARA),
+            .gw.addr = parametros_ip4(PARAM_IP_GATEWAY),
+        },
+        .dns.addr = parametros_ip4(PARAM_IP_DNS),
+        .timeout_dhcp_ms = EXAMPLE_IP_TIMEOUT_DHCP_MS,
+    };
+    ESP_ERROR_CHECK(rede_ip_iniciar(netif, &rede));
 
-    wifi_config_t wifi_config = {
+    s_wifi_config = (wifi_config_t) {
         .sta = {
-            .ssid = EXAMPLE_ESP_WIFI_SSID,
-            .password = EXAMPLE_ESP_WIFI_PASS,
             /* Setting a password implies station will connect to all security modes including WEP/WPA.
              * However these modes are deprecated and not advisable to be used. Incase your Access point
              * doesn't support WPA2, these mode can be enabled by commenting below line */
@@ -143,59 +352,308 @@ void wifi_init_sta(void)
             },
         },
     };
+    /* SSID e senha dos parâmetros (o SSID de 32 caracteres não tem terminador na wifi_config_t). */
+    parametros_texto(PARAM_SSID, s_perfis_wifi[0].ssid, sizeof(s_perfis_wifi[0].ssid));
+    parametros_texto(PARAM_SENHA, s_perfis_wifi[0].senha, sizeof(s_perfis_wifi[0].senha));
+    strncpy((char*) s_wifi_config.sta.ssid, s_perfis_wifi[0].ssid, sizeof(s_wifi_config.sta.ssid));
+    strncpy((char*) s_wifi_config.sta.password, s_perfis_wifi[0].senha, sizeof(s_wifi_config.sta.password));
+    /*	Roaming: o SSID e a senha vêm do primeiro perfil. Com a conexão forte o AP é varrido a cada
+		EXAMPLE_ROAMING_VARREDURA_S; abaixo do limiar, a cada EXAMPLE_ROAMING_VARREDURA_FRACA_S, e a troca
+		acontece quando outro AP supera o atual pela histerese. */
+    if( ROAMING )
+    {
+        const wifi_roaming_config_t roaming = {
+            .perfis = s_perfis_wifi,
+            .n_perfis = sizeof(s_perfis_wifi)/sizeof(s_perfis_wifi[0]),
+            .rssi_limiar = EXAMPLE_ROAMING_RSSI,
+            .histerese_db = EXAMPLE_ROAMING_HISTERESE,
+            .varredura_forte_ms = EXAMPLE_ROAMING_VARREDURA_S * 1000,
+            .varredura_fraca_ms = EXAMPLE_ROAMING_VARREDURA_FRACA_S * 1000,
+            .validade_cache_ms = 3 * EXAMPLE_ROAMING_VARREDURA_FRACA_S * 1000,
+            .falhas_por_perfil = parametros_int(PARAM_TENTATIVAS),
+        };
+        ESP_ERROR_CHECK(wifi_roaming_iniciar(&roaming, &s_wifi_config));
+    }
+    /* Conexão rápida: usa o BSSID e o canal do último AP, se houver. A PMK já fica salva pelo driver na NVS. */
+    wifi_cache_aplicar(&s_wifi_config);
+    /* Modem sleep: o rádio só liga para os beacons escutados (a cada EXAMPLE_INTERVALO_ESCUTA, 0 = todo DTIM) e para transmitir. */
+    if( ECONOMIA )
+        ESP_ERROR_CHECK(energia_wifi(&s_wifi_config, EXAMPLE_INTERVALO_ESCUTA));
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA) );
-    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &wifi_config) );
+    ESP_ERROR_CHECK(esp_wifi_set_config(ESP_IF_WIFI_STA, &s_wifi_config) );
     ESP_ERROR_CHECK(esp_wifi_start() );
 
     ESP_LOGI(TAG, "wifi_init_sta finished.");
+    return s_wifi_event_group;
+}
 
-    /* Waiting until either the connection is established (WIFI_CONNECTED_BIT) or connection failed for the maximum
-     * number of re-tries (WIFI_FAIL_BIT). The bits are set by event_handler() (see above) */
-    EventBits_t bits = xEventGroupWaitBits(s_wifi_event_group,
-            WIFI_CONNECTED_BIT | WIFI_FAIL_BIT,
-            pdFALSE,
-            pdFALSE,
-            portMAX_DELAY);
-
-    /* xEventGroupWaitBits() returns the bits before the call returned, hence we can test which event actually
-     * happened. */
-    if (bits & WIFI_CONNECTED_BIT) {
-        ESP_LOGI(TAG, "Conectado ao AP SSID:%s password:%s",
-                 EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else if (bits & WIFI_FAIL_BIT) {
-        ESP_LOGI(TAG, "Falha ao conectar ao AP SSID:%s, password:%s",
-                 EXAMPLE_ESP_WIFI_SSID, EXAMPLE_ESP_WIFI_PASS);
-    } else {
-        ESP_LOGE(TAG, "EVENTO INESPERADO");
-    }
+/*
+	Alteração de um parâmetro em campo (executada na task de quem alterou). Sem o roaming, SSID e senha
+	novos valem na próxima conexão: o evento é postado ao event loop, que altera a s_wifi_config (ver
+	event_handler). Com o roaming (perfis copiados na inicialização), e para o IP e as tentativas, valem
+	no próximo boot.
+*/
+static void parametro_alterado( int id, void *arg )
+{
+	if( !ROAMING && ( id == PARAM_SSID || id == PARAM_SENHA ) )
+	{
+		if( esp_event_post( PARAMETROS_EVENT, id, NULL, 0, portMAX_DELAY ) != ESP_OK )
+			ESP_LOGE( TAG, "Credenciais do WiFi alteradas, mas o evento nao foi postado" );
+	}
+	else
+		ESP_LOGI( TAG, "Parametro %s alterado; vale a partir do proximo boot", parametros_definicao( id )->chave );
+}
+
+/*
+	Rotas do servidor HTTP local, executadas na task do http_local. Cada resposta é formatada direto
+	no buffer do servidor; a lista de tasks passa do tamanho dele e segue em blocos (chunked).
+*/
+static uint8_t nivel_saida( gpio_num_t pino )
+{
+	//Saída comum (sem o LEDC): o nível vem do registrador de saída, já que a entrada está desabilitada.
+	if( pino >= 32 )
+		return REG_READ( GPIO_OUT1_REG ) >> ( pino - 32 ) & 1 ? 255 : 0;
+	return REG_READ( GPIO_OUT_REG ) >> pino & 1 ? 255 : 0;
+}
+
+static void rota_estado( const http_local_req_t *req, void *arg )
+{
+	uint8_t cor[3] = { nivel_saida( LED_R ), nivel_saida( LED_G ), nivel_saida( LED_B ) };
+	if( LED_STATUS )
+		led_rgb_atual( cor );
+	http_local_printf( "{\"led_r\":%u,\"led_g\":%u,\"led_b\":%u,\"button\":%d,\"contador\":%" PRIu64 "}",
+					   cor[0], cor[1], cor[2], gpio_get_level( BUTTON ), CONTADOR ? contagem_total() : (uint64_t) 0 );
+}
+
+/*
+	Valor decimal de um parâmetro, inteiro e sem sobras ("12x" e "" são recusados). O parâmetro que
+	ocupa o buffer todo pode ter sido truncado por http_local_parametro e também é recusado.
+*/
+static bool numero( const char *texto, size_t tamanho, long *valor )
+{
+	char *fim;
+	if( strlen( texto ) >= tamanho - 1 )
+		return false;
+	*valor = strtol( texto, &fim, 10 );
+	return fim != texto && *fim == '\0';
+}
+
+/*
+	POST/PUT /saida?r=0..255&g=0..255&b=0..255[&fade=ms]: canais omitidos mantêm o valor atual e um
+	valor que não é número responde 400. Com o LED_STATUS a cor é um fade do led_rgb, mantido até a
+	próxima mudança de estado do WiFi; sem ele, cada LED é ligado com valor diferente de zero.
+*/
+static void rota_saida( const http_local_req_t *req, void *arg )
+{
+	static const char * const nomes[3] = { "r", "g", "b" };
+	static const gpio_num_t pinos[3] = { LED_R, LED_G, LED_B };
+	uint8_t cor[3] = { nivel_saida( LED_R ), nivel_saida( LED_G ), nivel_saida( LED_B ) };
+	char valor[12];
+	long v, fade = 0;
+
+	if( LED_STATUS )
+		led_rgb_atual( cor );
+	for( int i = 0; i < 3; i++ )
+	{
+		if( !http_local_parametro( req, nomes[i], valor, sizeof( valor ) ) )
+			continue;
+		if( !numero( valor, sizeof( valor ), &v ) || v < 0 || v > 255 )
+		{
+			http_local_status( 400, "text/plain" );
+			http_local_printf( "%s deve ser um numero de 0 a 255\n", nomes[i] );
+			return;
+		}
+		cor[i] = v;
+	}
+	if( http_local_parametro( req, "fade", valor, sizeof( valor ) ) && !numero( valor, sizeof( valor ), &fade ) )
+	{
+		http_local_status( 400, "text/plain" );
+		http_local_printf( "fade nao numerico\n" );
+		return;
+	}
+	fade = fade < 0 ? 0 : fade > 10000 ? 10000 : fade;
 
-    ESP_ERROR_CHECK(esp_event_handler_unregister(IP_EVENT, IP_EVENT_STA_GOT_IP, &event_handler));
-    ESP_ERROR_CHECK(esp_event_handler_unregister(WIFI_EVENT, ESP_EVENT_ANY_ID, &event_handler));
-    //vEventGroupDelete(s_wifi_event_group);
+	if( LED_STATUS )
+		led_rgb_cor( cor[0], cor[1], cor[2], fade );
+	else
+		for( int i = 0; i < 3; i++ )
+			gpio_set_level( pinos[i], cor[i] != 0 );
+	http_local_printf( "{\"led_r\":%u,\"led_g\":%u,\"led_b\":%u,\"fade\":%ld}", cor[0], cor[1], cor[2], fade );
+}
+
+static void rota_rede( const http_local_req_t *req, void *arg )
+{
+	esp_netif_ip_info_t ip = { 0 }; //Zerado sem IP.
+	wifi_ap_record_t ap;
+
+	ip_eventos_ip_atual( &ip );
+	http_local_printf( "{\"ip\":\"" IPSTR "\",\"mascara\":\"" IPSTR "\",\"gateway\":\"" IPSTR "\",\"origem\":\"%s\"",
+					   IP2STR( &ip.ip ), IP2STR( &ip.netmask ), IP2STR( &ip.gw ), rede_ip_nome_origem( rede_ip_origem() ) );
+	if( esp_wifi_sta_get_ap_info( &ap ) == ESP_OK )
+	{
+		http_local_printf( ",\"ssid\":" );
+		http_local_json_texto( (const char*) ap.ssid );
+		http_local_printf( ",\"bssid\":\"" MACSTR "\",\"canal\":%u,\"rssi\":%d", MAC2STR( ap.bssid ), ap.primary, ap.rssi );
+	}
+	http_local_printf( "}" );
+}
+
+/* Mesmos campos de cada task do relatório do perfil, sem o uso de CPU. */
+static void rota_tarefas( const http_local_req_t *req, void *arg )
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+	static TaskStatus_t tasks[PERFIL_MAX_TASKS];
+	UBaseType_t n = uxTaskGetSystemState( tasks, PERFIL_MAX_TASKS, NULL );
+	http_local_printf( "{\"heap_livre\":%u,\"heap_minimo\":%u,\"apos_selar\":%u,\"tasks\":[",
+					   esp_get_free_heap_size(), esp_get_minimum_free_heap_size(), tarefas_apos_selar() );
+	for( UBaseType_t i = 0; i < n; i++ )
+	{
+		const TaskStatus_t *t = &tasks[i];
+		http_local_printf( "%s{\"nome\":\"%s\",\"estado\":%d,\"pilha\":%u,\"prio\":%u,\"nucleo\":%d}",
+						   i ? "," : "", t->pcTaskName, t->eCurrentState, (uint32_t) t->usStackHighWaterMark,
+						   (uint32_t) t->uxCurrentPriority, t->xCoreID < portNUM_PROCESSORS ? (int) t->xCoreID : -1 );
+	}
+	http_local_printf( "]}" );
+#else
+	http_local_status( 501, "text/plain" );
+	http_local_printf( "habilite CONFIG_FREERTOS_USE_TRACE_FACILITY\n" );
+#endif
+}
+
+static void rota_http( const http_local_req_t *req, void *arg )
+{
+	http_local_json_estatisticas();
 }
 
 void task_ip( void *pvParameter )
 {
-    
+    ip_eventos_t evento;
+
     if( DEBUG )
       ESP_LOGI( TAG, "Inicializada task_ip...\r\n" );
 	
     while (TRUE) 
     {    
-		/* o EventGroup bloqueia a task enquanto a rede WiFi não for configurada */
-		xEventGroupWaitBits(s_wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdFALSE, portMAX_DELAY);	
-    
-		/* Após configurada a rede WiFi recebemos e imprimimos a informação do IP atribuido */
-		tcpip_adapter_ip_info_t ip_info;
-	    ESP_ERROR_CHECK(tcpip_adapter_get_ip_info(TCPIP_ADAPTER_IF_STA, &ip_info));  
-		
-		/* Imprime o IP, bloqueia a task e repete a a impressão a cada 5 segundos */
-    	if( DEBUG )
-      		ESP_LOGI( TAG, "IP atribuido:  %s\n", ip4addr_ntoa(&ip_info.ip) );
-		vTaskDelay( 5000/portTICK_PERIOD_MS );
+		/* A fila bloqueia a task até o ip_eventos publicar uma mudança de IP ou de enlace */
+		xQueueReceive(s_fila_ip, &evento, portMAX_DELAY);
+
+		switch( evento.tipo )
+		{
+			case IP_EVENTOS_GOT_IP:
+				if( evento.ip_mudou )
+					DLOGI( TAG, "IP atribuido: " IPSTR " (anterior: " IPSTR ")",
+							  IP2STR(&evento.atual.ip), IP2STR(&evento.anterior.ip) );
+				else
+					DLOGI( TAG, "IP mantido: " IPSTR, IP2STR(&evento.atual.ip) );
+				break;
+			case IP_EVENTOS_LOST_IP:
+				DLOGI( TAG, "IP perdido: " IPSTR, IP2STR(&evento.anterior.ip) );
+				break;
+			case IP_EVENTOS_LINK_UP:
+				DLOGI( TAG, "Enlace WiFi ativo" );
+				break;
+			case IP_EVENTOS_LINK_DOWN:
+				DLOGI( TAG, "Enlace WiFi perdido" );
+				break;
+		}
     }
 }
 
+/*
+	Modo BENCHMARK: inverte o LED_R a cada PERIODO_BLINK_MS e mede o desvio de cada período em relação
+	ao nominal enquanto a task_carga_wifi mantém a pilha WiFi/lwIP ocupada. Compare os relatórios com
+	FIXAR_NUCLEOS TRUE (blink e pilha WiFi em núcleos diferentes) e FALSE (escolha do escalonador).
+*/
+void task_GPIO_Blink( void *pvParameter )
+{
+	bool estado = 0;
+	bench_periodo_t periodo;
+	TickType_t ultimo = xTaskGetTickCount();
+
+	//Medição na frequência máxima da CPU: sem DFS nem light sleep entre os períodos.
+	energia_manter( ESP_PM_CPU_FREQ_MAX, "blink" );
+	bench_periodo_init( &periodo, FIXAR_NUCLEOS ? "blink (nucleos fixos)" : "blink (sem afinidade)",
+						PERIODO_BLINK_MS * 1000 );
+    while ( TRUE ) 
+    {
+		bench_periodo_marcar( &periodo );
+		estado = !estado;
+		gpio_set_level( LED_R, estado );
+		if( periodo.desvio.amostras && periodo.desvio.amostras % RELATORIO_BLINK == 0 )
+			bench_periodo_report( &periodo );
+
+		//Prazo contado a partir do anterior: o relatório e o log não atrasam os períodos seguintes.
+		vTaskDelayUntil( &ultimo, PERIODO_BLINK_MS / portTICK_RATE_MS );
+	}
+}
+
+/* Envia datagramas UDP ao gateway (porta 9, discard) sem parar, gerando carga na pilha WiFi/lwIP. */
+void task_carga_wifi( void *pvParameter )
+{
+	static uint8_t pacote[TAMANHO_CARGA];
+	esp_netif_ip_info_t ip_info;
+
+	xEventGroupWaitBits( s_wifi_event_group, WIFI_CONNECTED_BIT, pdFALSE, pdTRUE, portMAX_DELAY );
+	ip_eventos_ip_atual( &ip_info );
+	//A carga não deixa a CPU dormir: o lock torna isso explícito e aparece no relatório de energia.
+	energia_manter( ESP_PM_CPU_FREQ_MAX, "carga_wifi" );
+	int sock = socket( AF_INET, SOCK_DGRAM, IPPROTO_IP );
+	if( sock < 0 )
+	{
+		ESP_LOGE( TAG, "Nao foi possivel criar o socket da carga" );
+		vTaskDelete( NULL );
+	}
+	struct sockaddr_in destino = {
+		.sin_family = AF_INET,
+		.sin_port = htons( 9 ),
+		.sin_addr.s_addr = ip_info.gw.addr,
+	};
+	ESP_LOGI( TAG, "Carga WiFi: %u datagramas de %u bytes por tick para " IPSTR,
+			  CARGA_POR_TICK, TAMANHO_CARGA, IP2STR( &ip_info.gw ) );
+
+	while( TRUE )
+	{
+		//Sem conexão o envio falha imediatamente; a carga volta quando o WiFi reconectar.
+		for( int i = 0; i < CARGA_POR_TICK; i++ )
+			sendto( sock, pacote, sizeof( pacote ), 0, (struct sockaddr*) &destino, sizeof( destino ) );
+		vTaskDelay( 1 );
+	}
+}
+
+/*
+	Registra na telemetria o nível do BUTTON a cada PERIODO_AMOSTRA_MS (canal 0). A task não espera o
+	WiFi: sem conexão as amostras ficam nos lotes da telemetria. No modo BENCHMARK gera também
+	AMOSTRAS_POR_TICK amostras sintéticas (canal 1) por tick e imprime a vazão, os despertares do rádio
+	por hora e a latência a cada RELATORIO_TELEMETRIA ms.
+*/
+void task_amostras( void *pvParameter )
+{
+	TickType_t ultimo = xTaskGetTickCount();
+	TickType_t ultima_amostra = ultimo;
+	TickType_t ultimo_relatorio = ultimo;
+	int32_t sintetica = 0;
+
+	while( TRUE )
+	{
+		if( BENCHMARK )
+		{
+			for( int i = 0; i < AMOSTRAS_POR_TICK; i++ )
+				telemetria_registrar( 1, sintetica++ );
+			if( xTaskGetTickCount() - ultimo_relatorio >= RELATORIO_TELEMETRIA / portTICK_PERIOD_MS )
+			{
+				telemetria_relatorio();
+				ultimo_relatorio = xTaskGetTickCount();
+			}
+		}
+		if( xTaskGetTickCount() - ultima_amostra >= PERIODO_AMOSTRA_MS / portTICK_PERIOD_MS )
+		{
+			telemetria_registrar( 0, gpio_get_level( BUTTON ) );
+			ultima_amostra += PERIODO_AMOSTRA_MS / portTICK_PERIOD_MS;
+		}
+		vTaskDelayUntil( &ultimo, BENCHMARK ? 1 : PERIODO_AMOSTRA_MS / portTICK_PERIOD_MS );
+	}
+}
+
 /* Aplicação Principal (Inicia após bootloader) */
 void app_main(void)
 {
@@ -203,22 +661,149 @@ void app_main(void)
 	    Este espaço de memória reservado armazena dados necessários para a calibração do PHY.	
 		Devido ao fato de o ESP não possuir EEPROM é necessário separar um pedaço da memória de programa para armazenar
 		dados não voláteis*/
+    bench_marco("app_main");
+	//Os logs das tasks (DLOGx) são formatados e enviados à UART por esta task de baixa prioridade.
+    dlog_iniciar(DLOG_SAIDA_TEXTO, 50, 1);
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
       ESP_ERROR_CHECK(nvs_flash_erase());
       ret = nvs_flash_init();
     }
     ESP_ERROR_CHECK(ret);
+    bench_marco("NVS pronta");
+
+	/*	Parâmetros ajustáveis em campo: carregados uma vez para a RAM, antes do WiFi. As alterações
+		feitas dentro de 2 s viram uma única gravação, no máximo uma a cada 10 s. */
+    const parametros_config_t parametros = {
+        .tabela = s_parametros,
+        .n = NUM_PARAMETROS,
+        .versao = VERSAO_PARAMETROS,
+        .atraso_ms = 2000,
+        .intervalo_min_ms = 10000,
+    };
+    ESP_ERROR_CHECK(parametros_iniciar(&parametros));
+    ESP_ERROR_CHECK(parametros_assinar(PARAMETROS_TODOS, parametro_alterado, NULL));
+    if( DEBUG )
+        parametros_relatorio();
 
     ESP_LOGI(TAG, "ESP_WIFI_MODE_STA");
-	//Configura e inicializa o WiFi.
-	
+	//Configura e inicia o WiFi. A função retorna sem aguardar a conexão.
     wifi_init_sta();
-	// Cria a task responsável por imprimir o IP recebido do roteador.
-    if(xTaskCreate( task_ip, "task_ip", 2048, NULL, 5, NULL )!= pdTRUE )
+    bench_marco("wifi_init_sta retornou");
+
+	/*	Os demais subsistemas são iniciados enquanto o WiFi associa e obtém o IP. A primeira leitura
+		do BUTTON representa a primeira amostra da aplicação na linha do tempo do boot. */
+    placa_configurar();
+	/*	Sem locks ativos a CPU cai para o clock do cristal e, com todas as tasks bloqueadas, entra em
+		light sleep até o próximo timer, beacon do WiFi ou o BUTTON pressionado (nível baixo). */
+    if( ECONOMIA )
+    {
+        const energia_config_t energia = {
+            .freq_max_mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ,
+            .freq_min_mhz = 40, //Cristal de 40 MHz.
+            .light_sleep = true,
+            .pino_despertar = BUTTON,
+            .nivel_despertar = 0,
+        };
+        energia_iniciar( &energia );
+        if( RELATORIO_ENERGIA_MS )
+            energia_relatorio_iniciar( RELATORIO_ENERGIA_MS );
+    }
+	/*	Os LEDs passam para o PWM (LEDC): as animações de status são fades do hardware e a task do
+		led_rgb só acorda entre os quadros. */
+    if( LED_STATUS )
+    {
+        led_rgb_iniciar( LEDC_TIMER_13_BIT, 5000, 1 );
+        led_rgb_padrao( xEventGroupGetBits(s_wifi_event_group) & WIFI_CONNECTED_BIT ? LED_RGB_CONECTADO : LED_RGB_CONECTANDO );
+    }
+	/*	Contador do EX04: o PCNT conta as bordas de descida do BUTTON em hardware e só interrompe a CPU
+		no estouro do contador de 16 bits. O PCNT para no light sleep, então com ECONOMIA a borda que
+		desperta a CPU pode não ser contada. */
+    if( CONTADOR )
+    {
+        const contagem_config_t contagem = {
+            .pino = BUTTON,
+            .unidade = PCNT_UNIT_0,
+            .subida = PCNT_COUNT_DIS,
+            .descida = PCNT_COUNT_INC,
+            .filtro_apb = 1000, //Ignora pulsos menores que 12,5us.
+            .limite = 32767,
+        };
+        if( contagem_iniciar( &contagem ) != ESP_OK )
+            ESP_LOGE( TAG, "Nao foi possivel iniciar a contagem no GPIO %d", BUTTON );
+    }
+    bench_marco("placa configurada");
+    int amostra = gpio_get_level(BUTTON);
+    bench_marco("primeira amostra");
+    if( DEBUG )
+        ESP_LOGI(TAG, "Primeira amostra: BUTTON = %d", amostra);
+
+	// Cria as tasks da tabela: a task_ip imprime o IP recebido do roteador.
+    if( tarefas_criar( s_tarefas, sizeof(s_tarefas)/sizeof(s_tarefas[0]) ) != ESP_OK )
 	{
 		if( DEBUG )
-			ESP_LOGI( TAG, "error - nao foi possivel alocar Task_IP.\n" );	
+			ESP_LOGI( TAG, "error - nao foi possivel alocar as tasks.\n" );	
 		return;		
 	}
+	if( BENCHMARK )
+		tarefas_criar( s_tarefas_benchmark, sizeof(s_tarefas_benchmark)/sizeof(s_tarefas_benchmark[0]) );
+
+	/*	Telemetria: as amostras são agrupadas em lotes e cada lote é um único envio (um despertar do
+		rádio), por tamanho ou idade. Sem conexão os lotes aguardam na fila e, quando ela enche, na NVS. */
+    if( TELEMETRIA )
+    {
+        const telemetria_config_t telemetria = {
+            .grupo = s_wifi_event_group,
+            .bit_conectado = WIFI_CONNECTED_BIT,
+            .destino = EXAMPLE_TELEMETRIA_DESTINO,
+            .porta = EXAMPLE_TELEMETRIA_PORTA,
+            .tcp = EXAMPLE_TELEMETRIA_TCP,
+            .amostras_por_lote = EXAMPLE_TELEMETRIA_LOTE,
+            .idade_max_ms = EXAMPLE_TELEMETRIA_IDADE_MS,
+            .lotes_fila = 8,
+            .lotes_nvs = 32,
+            .prioridade = 4,
+            .nucleo = NUCLEO_WIFI,
+        };
+        if( telemetria_iniciar( &telemetria ) == ESP_OK )
+            tarefas_criar( s_tarefas_telemetria, sizeof(s_tarefas_telemetria)/sizeof(s_tarefas_telemetria[0]) );
+        else
+            ESP_LOGE( TAG, "Nao foi possivel iniciar a telemetria" );
+    }
+
+	/*	Servidor HTTP local. As conexões persistentes (keep-alive) e os buffers de pedido e de resposta
+		são alocados aqui, antes do fim da inicialização; o socket escuta antes mesmo do IP. A carga
+		é medida por python tools/http_carga.py <ip>, que lê o tempo de atendimento em /http. */
+    if( SERVIDOR_HTTP )
+    {
+        const http_local_config_t http = {
+            .porta = EXAMPLE_HTTP_PORTA,
+            .max_conexoes = 4,
+            .tamanho_pedido = 1024,
+            .tamanho_resposta = 1024,
+            .ocioso_ms = 30000,
+            .prioridade = 4,
+            .nucleo = NUCLEO_WIFI,
+        };
+        http_local_rota( HTTP_LOCAL_GET, "/estado", rota_estado, NULL );
+        http_local_rota( HTTP_LOCAL_POST | HTTP_LOCAL_PUT, "/saida", rota_saida, NULL );
+        http_local_rota( HTTP_LOCAL_GET, "/rede", rota_rede, NULL );
+        http_local_rota( HTTP_LOCAL_GET, "/tarefas", rota_tarefas, NULL );
+        http_local_rota( HTTP_LOCAL_GET, "/http", rota_http, NULL );
+        if( http_local_iniciar( &http ) != ESP_OK )
+            ESP_LOGE( TAG, "Nao foi possivel iniciar o servidor HTTP" );
+    }
+
+	//Relatório periódico (JSON) do uso de CPU e de pilha de cada task e da duração das ISRs.
+	if( BENCHMARK )
+		perfil_iniciar( 10000 );
+	//Leitura dos parâmetros na RAM contra a NVS e entradas da flash gastas por uma rajada de 100 alterações.
+	if( BENCHMARK )
+		parametros_benchmark( PARAM_TENTATIVAS, PARAM_SSID, 100 );
+
+	/*	Fim da inicialização: tasks, filas e buffers já foram criados (com CONFIG_TAREFAS_ESTATICO, na
+		área estática). Daqui em diante nenhuma criação é esperada; o relatório mostra a memória de
+		cada subsistema e o heap que sobra para o WiFi e o lwIP. */
+    tarefas_selar();
+    tarefas_relatorio();
 }
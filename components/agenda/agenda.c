@@ -0,0 +1,197 @@
+/*
+	Objetivo: Agenda de tarefas periódicas sem deriva - vários callbacks executados por uma única task,
+			  acordada por um único esp_timer no próximo prazo (resolução de microssegundos)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "tarefas.h"
+#include "agenda.h"
+
+/* Variáveis Globais */
+static const char * TAG = "agenda";
+static agenda_item_t *s_itens;			//Lista encadeada, protegida por s_mutex.
+static SemaphoreHandle_t s_mutex;		//Recursivo: os callbacks podem adicionar e remover itens.
+static TaskHandle_t s_task;
+static esp_timer_handle_t s_timer;		//Disparo único, rearmado para o prazo mais próximo.
+
+static void agenda_timer( void *arg )
+{
+	xTaskNotifyGive( s_task );
+}
+
+/* Executa o item e avança o prazo pela grade, pulando os prazos que ficaram a mais de um período. */
+static void executa( agenda_item_t *item )
+{
+	int64_t chamada = esp_timer_get_time();
+	if( item->chamadas == 0 )
+		item->primeira = chamada;
+	bench_stats_add( &item->atraso, (uint32_t)( chamada - item->prazo ) );
+	item->deriva_us = chamada - item->primeira
+					  - (int64_t)( item->chamadas + item->perdidos ) * item->periodo_us;
+	item->chamadas++;
+
+	item->callback( item->arg );
+
+	item->prazo += item->periodo_us;
+	int64_t atraso = esp_timer_get_time() - item->prazo;
+	if( atraso >= (int64_t) item->periodo_us )
+	{
+		uint32_t pulados = (uint32_t)( atraso / item->periodo_us );
+		item->perdidos += pulados;
+		item->prazo += (int64_t) pulados * item->periodo_us;
+	}
+}
+
+/* Retira da lista os itens removidos durante os callbacks. */
+static void remove_inativos( void )
+{
+	agenda_item_t **ref = &s_itens;
+	while( *ref )
+	{
+		if( !(*ref)->ativo )
+			*ref = (*ref)->proximo_item;
+		else
+			ref = &(*ref)->proximo_item;
+	}
+}
+
+/* Arma o timer para o prazo mais próximo; com um prazo já vencido a task é notificada direto. */
+static void rearma( void )
+{
+	esp_timer_stop( s_timer );
+	if( s_itens == NULL )
+		return;
+
+	int64_t proximo = INT64_MAX;
+	for( agenda_item_t *item = s_itens; item; item = item->proximo_item )
+		if( item->prazo < proximo )
+			proximo = item->prazo;
+
+	int64_t espera = proximo - esp_timer_get_time();
+	if( espera <= 0 )
+		xTaskNotifyGive( s_task );
+	else
+		esp_timer_start_once( s_timer, (uint64_t) espera );
+}
+
+static void task_agenda( void *pvParameter )
+{
+	while( 1 )
+	{
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+		xSemaphoreTakeRecursive( s_mutex, portMAX_DELAY );
+		int64_t agora = esp_timer_get_time();
+		for( agenda_item_t *item = s_itens; item; item = item->proximo_item )
+			if( item->ativo && item->prazo <= agora )
+				executa( item );
+		remove_inativos();
+		rearma();
+		xSemaphoreGiveRecursive( s_mutex );
+	}
+}
+
+esp_err_t agenda_iniciar( UBaseType_t prioridade, BaseType_t nucleo, uint32_t pilha )
+{
+	if( s_task != NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	s_mutex = tarefas_mutex_recursivo( "agenda" );
+	if( s_mutex == NULL )
+		return ESP_ERR_NO_MEM;
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = agenda_timer,
+		.name = "agenda",
+	};
+	esp_err_t ret = esp_timer_create( &timer_args, &s_timer );
+	if( ret != ESP_OK )
+		return ret;
+
+	s_task = tarefas_task( "agenda", task_agenda, "task_agenda", pilha, NULL, prioridade, nucleo );
+	if( s_task == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+}
+
+esp_err_t agenda_adicionar( agenda_item_t *item, const char *nome, uint32_t periodo_us, uint32_t fase_us,
+							agenda_cb_t callback, void *arg )
+{
+	if( item == NULL || callback == NULL || periodo_us == 0 )
+		return ESP_ERR_INVALID_ARG;
+	if( s_task == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	xSemaphoreTakeRecursive( s_mutex, portMAX_DELAY );
+	for( agenda_item_t *i = s_itens; i; i = i->proximo_item )
+	{
+		if( i == item )
+		{
+			xSemaphoreGiveRecursive( s_mutex );
+			return ESP_ERR_INVALID_STATE;
+		}
+	}
+	item->nome = nome;
+	item->callback = callback;
+	item->arg = arg;
+	item->periodo_us = periodo_us;
+	item->ativo = true;
+	item->prazo = esp_timer_get_time() + fase_us;
+	item->primeira = 0;
+	item->chamadas = 0;
+	item->perdidos = 0;
+	item->deriva_us = 0;
+	bench_stats_init( &item->atraso, nome );
+	item->proximo_item = s_itens;
+	s_itens = item;
+	xSemaphoreGiveRecursive( s_mutex );
+
+	//A task recalcula o próximo prazo (o novo item pode ser o mais próximo).
+	xTaskNotifyGive( s_task );
+	return ESP_OK;
+}
+
+esp_err_t agenda_remover( agenda_item_t *item )
+{
+	if( s_task == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	xSemaphoreTakeRecursive( s_mutex, portMAX_DELAY );
+	esp_err_t ret = ESP_ERR_NOT_FOUND;
+	for( agenda_item_t *i = s_itens; i; i = i->proximo_item )
+	{
+		if( i == item && item->ativo )
+		{
+			item->ativo = false;
+			ret = ESP_OK;
+			break;
+		}
+	}
+	//Dentro de um callback a lista está sendo percorrida: o item sai no fim da rodada.
+	if( ret == ESP_OK && xTaskGetCurrentTaskHandle() != s_task )
+		remove_inativos();
+	xSemaphoreGiveRecursive( s_mutex );
+	return ret;
+}
+
+void agenda_relatorio( void )
+{
+	if( s_task == NULL )
+		return;
+
+	xSemaphoreTakeRecursive( s_mutex, portMAX_DELAY );
+	for( agenda_item_t *item = s_itens; item; item = item->proximo_item )
+	{
+		ESP_LOGI( TAG, "%s: periodo %u us, %u chamadas, %u perdidas, deriva %d us", item->nome,
+				  item->periodo_us, item->chamadas, item->perdidos, (int32_t) item->deriva_us );
+		bench_stats_report( &item->atraso, "us de atraso" );
+	}
+	xSemaphoreGiveRecursive( s_mutex );
+}
@@ -0,0 +1,4 @@
+#
+# Agenda de tarefas periódicas sem deriva executadas por uma única task e um único esp_timer.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,68 @@
+/*
+	Objetivo: Agenda de tarefas periódicas sem deriva - vários callbacks executados por uma única task,
+			  acordada por um único esp_timer no próximo prazo (resolução de microssegundos)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+#include "benchmark.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef void (*agenda_cb_t)( void *arg );
+
+/*
+	Item da agenda, alocado por quem o registra (normalmente estático) e mantido enquanto estiver
+	registrado. Os campos são de uso interno; leia as estatísticas com agenda_relatorio().
+*/
+typedef struct agenda_item {
+	const char *nome;
+	agenda_cb_t callback;
+	void *arg;
+	uint32_t periodo_us;
+	bool ativo;
+	int64_t prazo;				//Próxima chamada: prazo anterior + periodo_us, sem acumular o tempo de execução.
+	int64_t primeira;			//Instante da primeira chamada.
+	uint32_t chamadas;
+	uint32_t perdidos;			//Prazos pulados porque a chamada anterior atrasou mais de um período.
+	int64_t deriva_us;			//Tempo real menos o nominal entre a primeira e a última chamada.
+	bench_stats_t atraso;		//Atraso (us) entre o prazo e a chamada.
+	struct agenda_item *proximo_item;
+} agenda_item_t;
+
+/*
+	Cria a task que executa os callbacks e o esp_timer que a acorda. Os callbacks rodam nessa task,
+	com a prioridade e o núcleo informados (tskNO_AFFINITY deixa a escolha com o escalonador), e
+	compartilham a sua pilha: não devem bloquear por muito tempo.
+*/
+esp_err_t agenda_iniciar( UBaseType_t prioridade, BaseType_t nucleo, uint32_t pilha );
+
+/*
+	Registra "item" para chamar callback(arg) a cada "periodo_us", com a primeira chamada após
+	"fase_us". Como no vTaskDelayUntil, o prazo seguinte é contado a partir do prazo anterior: o tempo
+	de execução e o atraso de uma chamada não se acumulam. Uma chamada atrasada menos de um período
+	é feita assim que possível; atrasos maiores pulam os prazos perdidos, mantendo a grade.
+*/
+esp_err_t agenda_adicionar( agenda_item_t *item, const char *nome, uint32_t periodo_us, uint32_t fase_us,
+							agenda_cb_t callback, void *arg );
+
+/*
+	Retira o item da agenda. Chamada de outra task, o item pode ser reutilizado no retorno; chamada
+	de um callback da agenda, somente após o fim desse callback.
+*/
+esp_err_t agenda_remover( agenda_item_t *item );
+
+/* Imprime, para cada item, chamadas, prazos perdidos, deriva e a distribuição do atraso (us). */
+void agenda_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,250 @@
+/*
+	Objetivo: Medição de latência e tempo de CPU dos exemplos (benchmark)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <math.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "tarefas.h"
+#include "benchmark.h"
+
+/* Variáveis Globais */
+static const char * TAG = "benchmark";
+
+static gpio_num_t s_pino_injetor;
+static uint32_t s_intervalo_min_ms;
+static uint32_t s_intervalo_max_ms;
+static uint32_t s_relatorio;
+static uint32_t s_rebotes;
+static uint32_t s_intervalo_rebote_us;
+static bench_stats_t *s_latencia;
+static volatile int64_t s_t_borda;      //Instante (us) da última borda injetada.
+static volatile bool s_borda_pendente;  //Borda ainda não consumida pela aplicação.
+
+static struct {
+	const char *nome;
+	int64_t instante;
+} s_marcos[BENCH_MAX_MARCOS];
+static uint32_t s_num_marcos;
+static portMUX_TYPE s_lock_marcos = portMUX_INITIALIZER_UNLOCKED;
+
+/* Converte um valor no índice da faixa do histograma. */
+static inline uint32_t IRAM_ATTR faixa_de( uint32_t valor )
+{
+	if( valor < BENCH_SUBFAIXAS )
+		return valor;
+	uint32_t msb = 31 - __builtin_clz( valor );
+	uint32_t sub = ( valor >> ( msb - 2 ) ) & ( BENCH_SUBFAIXAS - 1 );
+	return ( msb - 1 ) * BENCH_SUBFAIXAS + sub;
+}
+
+/* Limite superior (inclusivo) da faixa. */
+static uint32_t limite_da_faixa( uint32_t faixa )
+{
+	if( faixa < BENCH_SUBFAIXAS )
+		return faixa;
+	uint32_t msb = faixa / BENCH_SUBFAIXAS + 1;
+	uint32_t sub = faixa % BENCH_SUBFAIXAS;
+	uint64_t inicio = (uint64_t)( BENCH_SUBFAIXAS + sub ) << ( msb - 2 );
+	uint64_t fim = inicio + ( 1ULL << ( msb - 2 ) ) - 1;
+	return fim > UINT32_MAX ? UINT32_MAX : (uint32_t) fim;
+}
+
+void bench_stats_init( bench_stats_t *st, const char *nome )
+{
+	memset( st, 0, sizeof( *st ) );
+	st->nome = nome;
+	st->minimo = UINT32_MAX;
+}
+
+void IRAM_ATTR bench_stats_add( bench_stats_t *st, uint32_t valor )
+{
+	st->amostras++;
+	st->soma += valor;
+	if( valor < st->minimo )
+		st->minimo = valor;
+	if( valor > st->maximo )
+		st->maximo = valor;
+	st->faixas[ faixa_de( valor ) ]++;
+}
+
+uint32_t bench_stats_percentil( const bench_stats_t *st, uint32_t percentil )
+{
+	if( st->amostras == 0 )
+		return 0;
+
+	/* Posição (arredondada para cima) da amostra que corresponde ao percentil. */
+	uint64_t alvo = ( (uint64_t) st->amostras * percentil + 99 ) / 100;
+	if( alvo == 0 )
+		alvo = 1;
+
+	uint64_t acumulado = 0;
+	for( uint32_t i = 0; i < BENCH_NUM_FAIXAS; i++ )
+	{
+		acumulado += st->faixas[i];
+		if( acumulado >= alvo )
+		{
+			uint32_t limite = limite_da_faixa( i );
+			return limite > st->maximo ? st->maximo : limite;
+		}
+	}
+	return st->maximo;
+}
+
+void bench_stats_report( const bench_stats_t *st, const char *unidade )
+{
+	if( st->amostras == 0 )
+	{
+		ESP_LOGI( TAG, "%s: sem amostras", st->nome );
+		return;
+	}
+	ESP_LOGI( TAG, "%s: n=%u min=%u med=%u p50=%u p90=%u p99=%u max=%u %s",
+			  st->nome, st->amostras, st->minimo, (uint32_t)( st->soma / st->amostras ),
+			  bench_stats_percentil( st, 50 ), bench_stats_percentil( st, 90 ),
+			  bench_stats_percentil( st, 99 ), st->maximo, unidade );
+}
+
+void bench_periodo_init( bench_periodo_t *p, const char *nome, uint32_t nominal_us )
+{
+	bench_stats_init( &p->desvio, nome );
+	p->nominal_us = nominal_us;
+	p->anterior = 0;
+	p->soma = 0;
+	p->soma_quadrados = 0;
+}
+
+void bench_periodo_marcar( bench_periodo_t *p )
+{
+	int64_t agora = esp_timer_get_time();
+	if( p->anterior != 0 )
+	{
+		int64_t desvio = agora - p->anterior - p->nominal_us;
+		p->soma += desvio;
+		p->soma_quadrados += (uint64_t)( desvio * desvio );
+		bench_stats_add( &p->desvio, (uint32_t)( desvio < 0 ? -desvio : desvio ) );
+	}
+	p->anterior = agora;
+}
+
+void bench_periodo_report( const bench_periodo_t *p )
+{
+	uint32_t n = p->desvio.amostras;
+	if( n == 0 )
+	{
+		bench_stats_report( &p->desvio, "us" );
+		return;
+	}
+	double media = (double) p->soma / n;
+	double variancia = (double) p->soma_quadrados / n - media * media;
+	ESP_LOGI( TAG, "%s: periodo medio %d us (nominal %u us), desvio padrao %u us", p->desvio.nome,
+			  (int)( p->nominal_us + media ), p->nominal_us, (uint32_t) sqrt( variancia > 0 ? variancia : 0 ) );
+	bench_stats_report( &p->desvio, "us de desvio" );
+}
+
+void IRAM_ATTR bench_latencia_marcar( bench_stats_t *st )
+{
+	if( !s_borda_pendente )
+		return;
+	s_borda_pendente = false;
+	bench_stats_add( st, (uint32_t)( esp_timer_get_time() - s_t_borda ) );
+}
+
+/* Espera ativa com resolução de microssegundos, usada apenas para simular rebotes. */
+static void espera_us( uint32_t us )
+{
+	int64_t fim = esp_timer_get_time() + us;
+	while( esp_timer_get_time() < fim )
+		;
+}
+
+/* Task que gera as bordas no pino monitorado pela aplicação. */
+static void task_bench_injetor( void *pvParameter )
+{
+	uint32_t nivel = 1;  //Botão solto (pull-up).
+	uint32_t bordas = 0;
+
+	while( 1 )
+	{
+		uint32_t faixa = s_intervalo_max_ms - s_intervalo_min_ms + 1;
+		vTaskDelay( ( s_intervalo_min_ms + esp_random() % faixa ) / portTICK_PERIOD_MS );
+
+		nivel = !nivel;
+		s_t_borda = esp_timer_get_time();
+		s_borda_pendente = true;
+		for( uint32_t i = 0; i < s_rebotes; i++ )
+		{
+			gpio_set_level( s_pino_injetor, nivel );
+			espera_us( s_intervalo_rebote_us );
+			gpio_set_level( s_pino_injetor, !nivel );
+			espera_us( s_intervalo_rebote_us );
+		}
+		gpio_set_level( s_pino_injetor, nivel );
+
+		if( s_relatorio && ++bordas % s_relatorio == 0 )
+			bench_stats_report( s_latencia, "us" );
+	}
+}
+
+void bench_injetor_rebotes( uint32_t rebotes, uint32_t intervalo_us )
+{
+	s_rebotes = rebotes;
+	s_intervalo_rebote_us = intervalo_us;
+}
+
+esp_err_t bench_injetor_iniciar( gpio_num_t pino, uint32_t intervalo_min_ms, uint32_t intervalo_max_ms,
+								 bench_stats_t *latencia, uint32_t relatorio )
+{
+	if( intervalo_max_ms < intervalo_min_ms || latencia == NULL )
+		return ESP_ERR_INVALID_ARG;
+
+	s_pino_injetor = pino;
+	s_intervalo_min_ms = intervalo_min_ms;
+	s_intervalo_max_ms = intervalo_max_ms;
+	s_latencia = latencia;
+	s_relatorio = relatorio;
+
+	/* Com GPIO_MODE_INPUT_OUTPUT o nível escrito é lido de volta pela entrada do próprio pino. */
+	gpio_set_level( pino, 1 );
+	esp_err_t ret = gpio_set_direction( pino, GPIO_MODE_INPUT_OUTPUT );
+	if( ret != ESP_OK )
+		return ret;
+
+	if( tarefas_task( "benchmark", task_bench_injetor, "task_bench_injetor", 2048, NULL, 2, tskNO_AFFINITY ) == NULL )
+		return ESP_ERR_NO_MEM;
+
+	ESP_LOGI( TAG, "Injetor de bordas iniciado no GPIO %d (%u a %u ms)", pino, intervalo_min_ms, intervalo_max_ms );
+	return ESP_OK;
+}
+
+void bench_marco( const char *nome )
+{
+	int64_t agora = esp_timer_get_time();
+	portENTER_CRITICAL( &s_lock_marcos );
+	if( s_num_marcos < BENCH_MAX_MARCOS )
+	{
+		s_marcos[s_num_marcos].nome = nome;
+		s_marcos[s_num_marcos].instante = agora;
+		s_num_marcos++;
+	}
+	portEXIT_CRITICAL( &s_lock_marcos );
+}
+
+void bench_marcos_report( void )
+{
+	int64_t anterior = 0;
+	ESP_LOGI( TAG, "linha do tempo do boot (%u marcos):", s_num_marcos );
+	for( uint32_t i = 0; i < s_num_marcos; i++ )
+	{
+		ESP_LOGI( TAG, "  %6u ms (+%5u ms) %s", (uint32_t)( s_marcos[i].instante / 1000 ),
+				  (uint32_t)( ( s_marcos[i].instante - anterior ) / 1000 ), s_marcos[i].nome );
+		anterior = s_marcos[i].instante;
+	}
+}
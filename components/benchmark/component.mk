@@ -0,0 +1,4 @@
+#
+# Componente de benchmark compartilhado entre os exemplos.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,102 @@
+/*
+	Objetivo: Medição de latência e tempo de CPU dos exemplos (benchmark)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "xtensa/hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	As amostras são acumuladas em um histograma logarítmico: cada potência de 2 é dividida em
+	BENCH_SUBFAIXAS faixas, o que garante erro máximo de 25% nos percentis sem guardar as amostras.
+*/
+#define BENCH_SUBFAIXAS 		4
+#define BENCH_NUM_FAIXAS 		(32 * BENCH_SUBFAIXAS)
+#define BENCH_MAX_MARCOS		16 //Marcos da linha do tempo do boot.
+
+typedef struct {
+	const char *nome;
+	uint32_t amostras;
+	uint32_t minimo;
+	uint32_t maximo;
+	uint64_t soma;
+	uint32_t faixas[BENCH_NUM_FAIXAS];
+} bench_stats_t;
+
+/* Jitter de uma tarefa periódica: período medido a cada chamada de bench_periodo_marcar(). */
+typedef struct {
+	bench_stats_t desvio;       //|período - nominal| em us.
+	uint32_t nominal_us;
+	int64_t anterior;           //Instante da chamada anterior (0 antes da primeira).
+	int64_t soma;               //Soma de (período - nominal), para a média e a variância.
+	uint64_t soma_quadrados;
+} bench_periodo_t;
+
+/* Leitura do contador de ciclos da CPU (resolução de 1 ciclo). */
+static inline uint32_t bench_ciclos( void )
+{
+	return xthal_get_ccount();
+}
+
+/* Zera as estatísticas. O nome é usado apenas no relatório. */
+void bench_stats_init( bench_stats_t *st, const char *nome );
+
+/* Acrescenta uma amostra. Deve existir apenas um escritor por estrutura (task ou ISR). */
+void bench_stats_add( bench_stats_t *st, uint32_t valor );
+
+/* Retorna o limite superior da faixa que contém o percentil pedido (0 a 100). */
+uint32_t bench_stats_percentil( const bench_stats_t *st, uint32_t percentil );
+
+/* Imprime amostras, mínimo, média, p50, p90, p99 e máximo na unidade informada. */
+void bench_stats_report( const bench_stats_t *st, const char *unidade );
+
+/* Zera as estatísticas de período. "nominal_us" é o período esperado da tarefa. */
+void bench_periodo_init( bench_periodo_t *p, const char *nome, uint32_t nominal_us );
+
+/* Chamar uma vez por ciclo da tarefa, no mesmo ponto do laço. A primeira chamada apenas marca o início. */
+void bench_periodo_marcar( bench_periodo_t *p );
+
+/* Imprime o período médio, o desvio padrão e a distribuição do desvio absoluto em relação ao nominal. */
+void bench_periodo_report( const bench_periodo_t *p );
+
+/*
+	Injetor de bordas: configura o pino como entrada/saída (mantendo o pull-up) e alterna o nível
+	em intervalos aleatórios entre intervalo_min_ms e intervalo_max_ms, simulando o aperto do botão
+	sem necessidade de fiação externa. A latência é registrada por quem consome a borda através de
+	bench_latencia_marcar(), e o relatório é impresso a cada "relatorio" bordas.
+*/
+esp_err_t bench_injetor_iniciar( gpio_num_t pino, uint32_t intervalo_min_ms, uint32_t intervalo_max_ms,
+								 bench_stats_t *latencia, uint32_t relatorio );
+
+/*
+	Simula o rebote mecânico: antes de cada borda definitiva o injetor gera "rebotes" pulsos de
+	"intervalo_us" no nível oposto. A latência continua contada a partir da primeira transição.
+*/
+void bench_injetor_rebotes( uint32_t rebotes, uint32_t intervalo_us );
+
+/* Registra em "st" o tempo (us) desde a última borda injetada. Cada borda é contada uma única vez. */
+void bench_latencia_marcar( bench_stats_t *st );
+
+/*
+	Linha do tempo do boot: registra o instante (us desde a inicialização do esp_timer) de um marco.
+	Pode ser chamada de qualquer task; os marcos além de BENCH_MAX_MARCOS são ignorados.
+	O nome deve ser uma string constante.
+*/
+void bench_marco( const char *nome );
+
+/* Imprime os marcos em ordem de registro com o tempo absoluto e o intervalo desde o anterior. */
+void bench_marcos_report( void );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,281 @@
+/*
+	Objetivo: Captura de trens de pulsos (medidores de vazão, encoders) pelo receptor do RMT: as bordas
+			  são medidas em hardware e entregues à task em lotes de durações
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/ringbuf.h"
+#include "driver/gpio.h"
+#include "soc/gpio_sig_map.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "captura.h"
+
+/* Definições e Constantes */
+#define CLOCK_RMT_HZ		80000000
+#define RAJADAS_BENCHMARK	20
+#define TOLERANCIA_TICKS	2	//Diferença aceita entre a duração gerada e a medida.
+
+/* Variáveis Globais */
+static const char * TAG = "captura";
+static captura_config_t s_config;
+static RingbufHandle_t s_ring;
+static captura_stats_t s_stats;
+/*	Quadro em decodificação (somente a task consumidora). */
+static rmt_item32_t *s_quadro;
+static size_t s_duracoes;			//Durações no quadro (2 por item).
+static size_t s_pos;				//Próxima duração a decodificar.
+
+static inline uint32_t ticks_para_ns( uint32_t ticks )
+{
+	return ticks * s_config.divisor * 25 / 2;
+}
+
+/* Duração "i" do quadro: cada item do RMT guarda duas durações com os respectivos níveis. */
+static inline void duracao( const rmt_item32_t *itens, size_t i, uint32_t *ticks, uint32_t *nivel )
+{
+	const rmt_item32_t *item = &itens[i / 2];
+	*ticks = ( i & 1 ) ? item->duration1 : item->duration0;
+	*nivel = ( i & 1 ) ? item->level1 : item->level0;
+}
+
+/*
+	Decodificação comum às capturas e às reproduções. Uma duração zero marca o fim do quadro (o
+	receptor encerra com a linha ociosa).
+*/
+static size_t decodifica( captura_pulso_t *pulsos, size_t max, bool *fim )
+{
+	size_t n = 0;
+	*fim = false;
+	while( s_pos < s_duracoes )
+	{
+		uint32_t ticks, nivel;
+		duracao( s_quadro, s_pos, &ticks, &nivel );
+		if( ticks == 0 )
+		{
+			s_pos = s_duracoes;
+			break;
+		}
+		//O lote cheio só para antes de uma duração válida: o último pulso ainda vê o fim do quadro.
+		if( n == max )
+			break;
+		s_pos++;
+		pulsos[n].duracao_ns = ticks_para_ns( ticks );
+		pulsos[n].nivel = nivel;
+		pulsos[n].fim_quadro = false;
+		n++;
+	}
+	if( s_pos >= s_duracoes )
+	{
+		*fim = true;
+		if( n )
+			pulsos[n - 1].fim_quadro = true;
+	}
+	return n;
+}
+
+esp_err_t captura_iniciar( const captura_config_t *config )
+{
+	if( config->blocos_memoria == 0 || config->blocos_memoria > 8 || config->divisor == 0
+		|| config->ocioso_ticks == 0 || config->tamanho_buffer == 0 )
+		return ESP_ERR_INVALID_ARG;
+	if( s_ring != NULL )
+		return ESP_ERR_INVALID_STATE;
+	s_config = *config;
+
+	if( config->reproducao )
+	{
+		s_ring = xRingbufferCreate( config->tamanho_buffer, RINGBUF_TYPE_NOSPLIT );
+		return s_ring ? ESP_OK : ESP_ERR_NO_MEM;
+	}
+
+	rmt_config_t rx = {
+		.rmt_mode = RMT_MODE_RX,
+		.channel = config->canal,
+		.gpio_num = config->pino,
+		.clk_div = config->divisor,
+		.mem_block_num = config->blocos_memoria,
+		.rx_config = {
+			.filter_en = config->filtro_apb != 0,
+			.filter_ticks_thresh = config->filtro_apb,
+			.idle_threshold = config->ocioso_ticks,
+		},
+	};
+	esp_err_t ret = rmt_config( &rx );
+	if( ret != ESP_OK )
+		return ret;
+	ret = rmt_driver_install( config->canal, config->tamanho_buffer, 0 );
+	if( ret != ESP_OK )
+		return ret;
+	//O driver já cria o ringbuffer: as reproduções usam o mesmo caminho até captura_ler().
+	ret = rmt_get_ringbuf_handle( config->canal, &s_ring );
+	if( ret != ESP_OK )
+		return ret;
+
+	ESP_LOGI( TAG, "RMT canal %d no GPIO %d: resolucao %u ns, filtro %u ns, fim de quadro %u us",
+			  config->canal, config->pino, ticks_para_ns( 1 ), config->filtro_apb * 25 / 2,
+			  ticks_para_ns( config->ocioso_ticks ) / 1000 );
+	return rmt_rx_start( config->canal, true );
+}
+
+size_t captura_ler( captura_pulso_t *pulsos, size_t max, TickType_t espera )
+{
+	size_t n = 0;
+	while( n < max )
+	{
+		if( s_quadro == NULL )
+		{
+			size_t bytes = 0;
+			//Só bloqueia enquanto o lote estiver vazio.
+			s_quadro = xRingbufferReceive( s_ring, &bytes, n ? 0 : espera );
+			if( s_quadro == NULL )
+				break;
+			s_duracoes = 2 * ( bytes / sizeof( rmt_item32_t ) );
+			s_pos = 0;
+			s_stats.quadros++;
+		}
+
+		bool fim;
+		n += decodifica( pulsos + n, max - n, &fim );
+		if( fim )
+		{
+			vRingbufferReturnItem( s_ring, s_quadro );
+			s_quadro = NULL;
+		}
+	}
+	s_stats.pulsos += n;
+	return n;
+}
+
+esp_err_t captura_reproduzir( const rmt_item32_t *itens, size_t n, TickType_t espera )
+{
+	if( s_ring == NULL )
+		return ESP_ERR_INVALID_STATE;
+	if( xRingbufferSend( s_ring, itens, n * sizeof( rmt_item32_t ), espera ) != pdTRUE )
+	{
+		s_stats.descartados++;
+		return ESP_ERR_TIMEOUT;
+	}
+	return ESP_OK;
+}
+
+void captura_estatisticas( captura_stats_t *stats )
+{
+	*stats = s_stats;
+}
+
+/* Lê a rajada gerada e confere o número de pulsos e as durações. Retorna true sem perdas. */
+static bool confere_rajada( uint32_t pulsos_por_rajada, uint32_t meio_ns, captura_pulso_t *lote, size_t max )
+{
+	//Baixo, alto, ..., baixo: o último nível alto se junta ao repouso e encerra o quadro.
+	uint32_t esperado = 2 * pulsos_por_rajada - 1;
+	uint32_t recebidos = 0;
+	bool ok = true;
+	uint32_t tolerancia_ns = ticks_para_ns( TOLERANCIA_TICKS ) + 25;
+
+	while( 1 )
+	{
+		size_t n = captura_ler( lote, max, 100 / portTICK_PERIOD_MS );
+		if( n == 0 )
+			return false;
+		for( size_t i = 0; i < n; i++ )
+		{
+			uint32_t d = lote[i].duracao_ns;
+			if( d + tolerancia_ns < meio_ns || d > meio_ns + tolerancia_ns )
+				ok = false;
+		}
+		recebidos += n;
+		if( lote[n - 1].fim_quadro )
+			break;
+	}
+	return ok && recebidos == esperado;
+}
+
+esp_err_t captura_benchmark( rmt_channel_t canal_tx, uint32_t pulsos_por_rajada )
+{
+	static const uint32_t frequencias[] = { 10000, 50000, 100000, 250000, 500000, 1000000, 2000000 };
+	const size_t max_lote = 64;
+
+	if( s_config.reproducao || s_ring == NULL )
+		return ESP_ERR_INVALID_STATE;
+	if( pulsos_por_rajada < 2 || pulsos_por_rajada >= s_config.blocos_memoria * CAPTURA_ITENS_POR_BLOCO )
+		return ESP_ERR_INVALID_ARG;
+
+	rmt_config_t tx = {
+		.rmt_mode = RMT_MODE_TX,
+		.channel = canal_tx,
+		.gpio_num = s_config.pino,
+		.clk_div = 1,
+		.mem_block_num = ( pulsos_por_rajada + CAPTURA_ITENS_POR_BLOCO ) / CAPTURA_ITENS_POR_BLOCO,
+		.tx_config = {
+			.idle_level = RMT_IDLE_LEVEL_HIGH,	//Repouso do BUTTON (pull-up).
+			.idle_output_en = true,
+		},
+	};
+	//Registrador do GPIO no nível de repouso: as trocas de direção do pino não geram bordas no receptor.
+	gpio_set_level( s_config.pino, 1 );
+	esp_err_t ret = rmt_config( &tx );
+	if( ret == ESP_OK )
+		ret = rmt_driver_install( canal_tx, 0, 0 );
+	if( ret != ESP_OK )
+		return ret;
+	//Saída do transmissor e entrada do receptor no mesmo pino, sem fiação externa. O gpio_set_direction
+	//devolve a saída ao registrador do GPIO: o sinal do transmissor é roteado de novo pela matriz.
+	gpio_set_direction( s_config.pino, GPIO_MODE_INPUT_OUTPUT );
+	gpio_matrix_out( s_config.pino, RMT_SIG_OUT0_IDX + canal_tx, false, false );
+
+	rmt_item32_t *itens = calloc( pulsos_por_rajada + 1, sizeof( rmt_item32_t ) );
+	captura_pulso_t *lote = malloc( max_lote * sizeof( captura_pulso_t ) );
+	if( itens == NULL || lote == NULL )
+	{
+		free( itens );
+		free( lote );
+		rmt_driver_uninstall( canal_tx );
+		return ESP_ERR_NO_MEM;
+	}
+
+	uint32_t maxima = 0;
+	for( size_t f = 0; f < sizeof( frequencias ) / sizeof( frequencias[0] ); f++ )
+	{
+		uint32_t meio_ticks = CLOCK_RMT_HZ / frequencias[f] / 2;  //TX com divisor 1 (12,5 ns).
+		uint32_t meio_ns = meio_ticks * 25 / 2;
+		//O meio período precisa caber no item (15 bits) e ser menor que o tempo de fim de quadro.
+		if( meio_ticks > 0x7FFF || meio_ns >= ticks_para_ns( s_config.ocioso_ticks ) )
+			continue;
+		for( uint32_t i = 0; i < pulsos_por_rajada; i++ )
+		{
+			itens[i].duration0 = meio_ticks;
+			itens[i].level0 = 0;
+			itens[i].duration1 = meio_ticks;
+			itens[i].level1 = 1;
+		}
+
+		uint32_t ok = 0;
+		int64_t inicio = esp_timer_get_time();
+		for( int r = 0; r < RAJADAS_BENCHMARK; r++ )
+		{
+			rmt_write_items( canal_tx, itens, pulsos_por_rajada + 1, true );
+			if( confere_rajada( pulsos_por_rajada, meio_ns, lote, max_lote ) )
+				ok++;
+		}
+		uint32_t decorrido_us = (uint32_t)( esp_timer_get_time() - inicio );
+		ESP_LOGI( TAG, "%7u Hz (%7u bordas/s na rajada): %u/%u rajadas sem perda, %u pulsos/s em media",
+				  frequencias[f], 2 * frequencias[f], ok, RAJADAS_BENCHMARK,
+				  (uint32_t)( (uint64_t) pulsos_por_rajada * RAJADAS_BENCHMARK * 1000000 / decorrido_us ) );
+		if( ok == RAJADAS_BENCHMARK )
+			maxima = frequencias[f];
+	}
+	ESP_LOGI( TAG, "Maior taxa sem perdas: %u bordas/s", 2 * maxima );
+
+	free( itens );
+	free( lote );
+	rmt_driver_uninstall( canal_tx );
+	gpio_matrix_out( s_config.pino, SIG_GPIO_OUT_IDX, false, false );
+	gpio_set_direction( s_config.pino, GPIO_MODE_INPUT );
+	return ESP_OK;
+}
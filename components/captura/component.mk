@@ -0,0 +1,4 @@
+#
+# Captura de trens de pulsos pelo receptor do RMT, com as durações medidas em hardware.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,79 @@
+/*
+	Objetivo: Captura de trens de pulsos (medidores de vazão, encoders) pelo receptor do RMT: as bordas
+			  são medidas em hardware e entregues à task em lotes de durações
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/rmt.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CAPTURA_ITENS_POR_BLOCO		64	//Itens (2 durações cada) por bloco de memória do RMT.
+
+/*
+	O RMT do ESP32 grava as durações na sua memória sem interromper a CPU e entrega um "quadro" quando
+	a linha fica parada por "ocioso_ticks". Um quadro cabe em blocos_memoria * 64 itens; pulsos
+	contínuos sem intervalo ocioso precisam ser cortados em rajadas menores que isso.
+*/
+typedef struct {
+	gpio_num_t pino;
+	rmt_channel_t canal;		//Canal RX; os blocos de memória dos canais seguintes também são usados.
+	uint8_t blocos_memoria;		//1 a 8.
+	uint8_t divisor;			//Clock do RMT = 80 MHz / divisor; resolução = divisor * 12,5 ns.
+	uint8_t filtro_apb;			//Pulsos menores que este número de ciclos do APB (80 MHz) são ignorados (0 desabilita).
+	uint16_t ocioso_ticks;		//Tempo parado (ticks do RMT) que encerra o quadro.
+	size_t tamanho_buffer;		//Bytes do ringbuffer entre o RMT e a task consumidora.
+	bool reproducao;			//Sem RMT: os quadros chegam somente por captura_reproduzir().
+} captura_config_t;
+
+/* Pulso decodificado: nível da linha e por quanto tempo ele durou. */
+typedef struct {
+	uint32_t duracao_ns;
+	uint8_t nivel;
+	bool fim_quadro;			//Último pulso antes de a linha ficar ociosa.
+} captura_pulso_t;
+
+typedef struct {
+	uint32_t quadros;			//Quadros lidos do ringbuffer.
+	uint32_t pulsos;			//Pulsos entregues à task.
+	uint32_t descartados;		//Quadros de captura_reproduzir() sem espaço no ringbuffer.
+} captura_stats_t;
+
+/* Configura o receptor e inicia a captura (ou apenas cria o ringbuffer no modo de reprodução). */
+esp_err_t captura_iniciar( const captura_config_t *config );
+
+/*
+	Bloqueia a task até chegar um quadro ou esgotar "espera" e decodifica até "max" pulsos. Um quadro
+	maior que "max" continua na chamada seguinte. Retorna quantos pulsos foram escritos.
+*/
+size_t captura_ler( captura_pulso_t *pulsos, size_t max, TickType_t espera );
+
+/*
+	Coloca no ringbuffer um quadro gravado (itens no formato do RMT, com a resolução configurada) para
+	ser lido por captura_ler() pelo mesmo caminho de decodificação das capturas reais.
+*/
+esp_err_t captura_reproduzir( const rmt_item32_t *itens, size_t n, TickType_t espera );
+
+/* Cópia dos contadores. */
+void captura_estatisticas( captura_stats_t *stats );
+
+/*
+	Vazão máxima sem perdas: usa o canal TX informado para gerar, no próprio pino, rajadas de
+	"pulsos_por_rajada" pulsos em frequências crescentes e confere se todas as durações chegaram com
+	o tempo correto. Chamar da task consumidora, antes de começar a ler; o pino volta a ser entrada.
+*/
+esp_err_t captura_benchmark( rmt_channel_t canal_tx, uint32_t pulsos_por_rajada );
+
+#ifdef __cplusplus
+}
+#endif
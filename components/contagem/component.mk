@@ -0,0 +1,4 @@
+#
+# Contagem de bordas pelo PCNT com total de 64 bits e interrupção somente no limiar.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
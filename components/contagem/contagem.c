@@ -0,0 +1,269 @@
+/*
+	Objetivo: Contagem de bordas pelo periférico PCNT, com filtro de glitch em hardware, total de
+			  64 bits e interrupção somente no limiar ou no estouro do contador de 16 bits
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "driver/ledc.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "soc/gpio_sig_map.h"
+#include "soc/pcnt_struct.h"
+#include "xtensa/hal.h"
+#include "perfil.h"
+#include "contagem.h"
+
+/* Definições e Constantes */
+#define LEDC_MODO		LEDC_LOW_SPEED_MODE	//O led_rgb usa o modo de alta velocidade.
+#define LEDC_TIMER		LEDC_TIMER_1
+#define LEDC_CANAL		LEDC_CHANNEL_0
+
+/* Variáveis Globais */
+static const char * TAG = "contagem";
+static contagem_config_t s_config;
+static bool s_iniciado;
+static uint64_t s_acumulado;			//Bordas somadas nos estouros (protegido por s_lock).
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static perfil_isr_t s_perfil_isr = { .nome = "contagem_isr" };
+/*	Usados somente por contagem_benchmark. */
+static perfil_isr_t s_perfil_gpio = { .nome = "borda_gpio" };
+static volatile uint32_t s_bordas_gpio;
+
+/* Estouro sinalizado pelo hardware e ainda não tratado pela ISR. */
+static inline bool estouro_pendente( void )
+{
+	return ( PCNT.int_raw.val & BIT( s_config.unidade ) )
+		&& ( PCNT.status_unit[s_config.unidade].val & PCNT_STATUS_H_LIM_M );
+}
+
+static void IRAM_ATTR contagem_isr( void *arg )
+{
+	uint32_t ciclos = xthal_get_ccount();
+	uint32_t status = PCNT.status_unit[s_config.unidade].val;
+
+	if( status & PCNT_STATUS_H_LIM_M )
+	{
+		//Limpa junto com a soma: contagem_total() não pode ver o estouro somado e ainda pendente.
+		portENTER_CRITICAL_ISR( &s_lock );
+		s_acumulado += s_config.limite;
+		PCNT.int_clr.val = BIT( s_config.unidade );
+		portEXIT_CRITICAL_ISR( &s_lock );
+	}
+	if( s_config.notificar && ( status & ( PCNT_STATUS_H_LIM_M | PCNT_STATUS_THRES0_M ) ) )
+	{
+		BaseType_t acordou = pdFALSE;
+		vTaskNotifyGiveFromISR( s_config.notificar, &acordou );
+		if( acordou )
+			portYIELD_FROM_ISR();
+	}
+	perfil_isr_saida( &s_perfil_isr, ciclos );
+}
+
+static esp_err_t configura( const contagem_config_t *config )
+{
+	pcnt_config_t pcnt = {
+		.pulse_gpio_num = config->pino,
+		.ctrl_gpio_num = PCNT_PIN_NOT_USED,
+		.lctrl_mode = PCNT_MODE_KEEP,
+		.hctrl_mode = PCNT_MODE_KEEP,
+		.pos_mode = config->subida,
+		.neg_mode = config->descida,
+		.counter_h_lim = config->limite,
+		.counter_l_lim = 0,
+		.unit = config->unidade,
+		.channel = PCNT_CHANNEL_0,
+	};
+	esp_err_t ret = pcnt_unit_config( &pcnt );
+	if( ret != ESP_OK )
+		return ret;
+
+	if( config->filtro_apb )
+	{
+		pcnt_set_filter_value( config->unidade, config->filtro_apb );
+		pcnt_filter_enable( config->unidade );
+	}
+	else
+		pcnt_filter_disable( config->unidade );
+
+	pcnt_event_enable( config->unidade, PCNT_EVT_H_LIM );
+	if( config->limiar )
+	{
+		pcnt_set_event_value( config->unidade, PCNT_EVT_THRES_0, config->limiar );
+		pcnt_event_enable( config->unidade, PCNT_EVT_THRES_0 );
+	}
+
+	//O serviço pode já ter sido instalado por outro módulo.
+	ret = pcnt_isr_service_install( 0 );
+	if( ret != ESP_OK && ret != ESP_ERR_INVALID_STATE )
+		return ret;
+	ret = pcnt_isr_handler_add( config->unidade, contagem_isr, NULL );
+	if( ret != ESP_OK )
+		return ret;
+
+	pcnt_counter_pause( config->unidade );
+	pcnt_counter_clear( config->unidade );
+	pcnt_intr_enable( config->unidade );
+	return pcnt_counter_resume( config->unidade );
+}
+
+static void desliga( void )
+{
+	pcnt_counter_pause( s_config.unidade );
+	pcnt_intr_disable( s_config.unidade );
+	pcnt_isr_handler_remove( s_config.unidade );
+}
+
+esp_err_t contagem_iniciar( const contagem_config_t *config )
+{
+	if( config->limite <= 0 || config->limiar < 0 || config->limiar >= config->limite || config->filtro_apb > 1023 )
+		return ESP_ERR_INVALID_ARG;
+	if( s_iniciado )
+		return ESP_ERR_INVALID_STATE;
+
+	s_config = *config;
+	s_acumulado = 0;
+	esp_err_t ret = configura( config );
+	if( ret != ESP_OK )
+		return ret;
+	s_iniciado = true;
+	perfil_registrar_isr( &s_perfil_isr );
+
+	ESP_LOGI( TAG, "PCNT unidade %d no GPIO %d: interrupcao a cada %d bordas, filtro %u ns",
+			  config->unidade, config->pino, config->limite, config->filtro_apb * 25 / 2 );
+	return ESP_OK;
+}
+
+uint64_t contagem_total( void )
+{
+	uint64_t total;
+	bool antes, depois;
+	int16_t valor;
+
+	portENTER_CRITICAL( &s_lock );
+	//Repete se o contador estourar entre as leituras: o valor lido pode ser de antes ou de depois da volta.
+	do
+	{
+		antes = estouro_pendente();
+		pcnt_get_counter_value( s_config.unidade, &valor );
+		depois = estouro_pendente();
+	} while( antes != depois );
+	total = s_acumulado + valor + ( depois ? s_config.limite : 0 );
+	portEXIT_CRITICAL( &s_lock );
+	return total;
+}
+
+static void IRAM_ATTR borda_gpio_isr( void *arg )
+{
+	uint32_t ciclos = xthal_get_ccount();
+	s_bordas_gpio++;
+	perfil_isr_saida( &s_perfil_gpio, ciclos );
+}
+
+/* Mede as bordas e a carga da CPU em um intervalo; "isr" é o contador do handler avaliado. */
+static void mede( const char *modo, uint32_t frequencia, uint32_t duracao_ms, const perfil_isr_t *isr,
+				  uint64_t bordas )
+{
+	//Ciclos decorridos no intervalo, no mesmo clock usado pelos handlers.
+	uint64_t janela = (uint64_t) duracao_ms * ( CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ * 1000 );
+	ESP_LOGI( TAG, "%6u Hz %-4s: %8u bordas (%u esperadas), %7u interrupcoes, CPU %u.%02u%% (%u ciclos/ISR)",
+			  frequencia, modo, (uint32_t) bordas, frequencia * duracao_ms / 1000, isr->entradas,
+			  (uint32_t)( isr->ciclos_total * 100 / janela ), (uint32_t)( isr->ciclos_total * 10000 / janela % 100 ),
+			  isr->entradas ? (uint32_t)( isr->ciclos_total / isr->entradas ) : 0 );
+}
+
+/*
+	Onda do LEDC no próprio pino, lida de volta pela entrada. O gpio_set_direction devolve a saída ao
+	registrador do GPIO: o sinal do canal é roteado de novo pela matriz.
+*/
+static void loopback( gpio_num_t pino )
+{
+	gpio_set_direction( pino, GPIO_MODE_INPUT_OUTPUT );
+	gpio_matrix_out( pino, LEDC_LS_SIG_OUT0_IDX + LEDC_CANAL, false, false );
+}
+
+esp_err_t contagem_benchmark( gpio_num_t pino, pcnt_unit_t unidade, uint32_t duracao_ms )
+{
+	static const uint32_t frequencias[] = { 1000, 10000, 100000 };
+
+	if( s_iniciado )
+		return ESP_ERR_INVALID_STATE;
+
+	esp_err_t ret = gpio_install_isr_service( 0 );
+	if( ret != ESP_OK && ret != ESP_ERR_INVALID_STATE )
+		return ret;
+
+	for( size_t f = 0; f < sizeof( frequencias ) / sizeof( frequencias[0] ); f++ )
+	{
+		//Onda quadrada no próprio pino.
+		ledc_timer_config_t timer = {
+			.speed_mode = LEDC_MODO,
+			.duty_resolution = LEDC_TIMER_8_BIT,
+			.timer_num = LEDC_TIMER,
+			.freq_hz = frequencias[f],
+		};
+		ledc_channel_config_t canal = {
+			.gpio_num = pino,
+			.speed_mode = LEDC_MODO,
+			.channel = LEDC_CANAL,
+			.intr_type = LEDC_INTR_DISABLE,
+			.timer_sel = LEDC_TIMER,
+			.duty = 128,
+			.hpoint = 0,
+		};
+		ret = ledc_timer_config( &timer );
+		if( ret == ESP_OK )
+			ret = ledc_channel_config( &canal );
+		if( ret != ESP_OK )
+			return ret;
+		loopback( pino );
+
+		//Uma ISR por borda de descida, como a contagem por software do EX04.
+		s_bordas_gpio = 0;
+		s_perfil_gpio.entradas = 0;
+		s_perfil_gpio.ciclos_total = 0;
+		s_perfil_gpio.ciclos_max = 0;
+		gpio_set_intr_type( pino, GPIO_INTR_NEGEDGE );
+		gpio_isr_handler_add( pino, borda_gpio_isr, NULL );
+		gpio_intr_enable( pino );
+		vTaskDelay( duracao_ms / portTICK_PERIOD_MS );
+		gpio_intr_disable( pino );
+		gpio_isr_handler_remove( pino );
+		gpio_set_intr_type( pino, GPIO_INTR_DISABLE );
+		mede( "ISR", frequencias[f], duracao_ms, &s_perfil_gpio, s_bordas_gpio );
+
+		//PCNT: interrupção somente a cada 10000 bordas.
+		const contagem_config_t config = {
+			.pino = pino,
+			.unidade = unidade,
+			.subida = PCNT_COUNT_DIS,
+			.descida = PCNT_COUNT_INC,
+			.limite = 10000,
+		};
+		s_config = config;
+		s_acumulado = 0;
+		s_perfil_isr.entradas = 0;
+		s_perfil_isr.ciclos_total = 0;
+		s_perfil_isr.ciclos_max = 0;
+		ret = configura( &config );
+		if( ret != ESP_OK )
+			return ret;
+		loopback( pino );		//O pcnt_unit_config deixa o pino somente como entrada.
+		vTaskDelay( duracao_ms / portTICK_PERIOD_MS );
+		uint64_t bordas = contagem_total();
+		desliga();
+		mede( "PCNT", frequencias[f], duracao_ms, &s_perfil_isr, bordas );
+	}
+
+	ledc_stop( LEDC_MODO, LEDC_CANAL, 1 );
+	gpio_matrix_out( pino, SIG_GPIO_OUT_IDX, false, false );
+	gpio_set_direction( pino, GPIO_MODE_INPUT );
+	s_perfil_isr.entradas = 0;
+	s_perfil_isr.ciclos_total = 0;
+	s_perfil_isr.ciclos_max = 0;
+	return ESP_OK;
+}
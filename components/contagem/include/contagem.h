@@ -0,0 +1,49 @@
+/*
+	Objetivo: Contagem de bordas pelo periférico PCNT, com filtro de glitch em hardware, total de
+			  64 bits e interrupção somente no limiar ou no estouro do contador de 16 bits
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/pcnt.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	gpio_num_t pino;
+	pcnt_unit_t unidade;
+	pcnt_count_mode_t subida;	//PCNT_COUNT_INC, PCNT_COUNT_DEC ou PCNT_COUNT_DIS para a borda de subida.
+	pcnt_count_mode_t descida;	//Idem para a borda de descida.
+	uint16_t filtro_apb;		//Pulsos menores que este número de ciclos do APB (80 MHz) são ignorados (0 a 1023, 0 desabilita).
+	int16_t limite;				//O contador volta a zero a cada "limite" bordas (1 a 32767), somadas ao total na interrupção.
+	int16_t limiar;				//Interrupção adicional quando o contador passa por este valor (0 desabilita).
+	TaskHandle_t notificar;		//Task notificada (xTaskNotifyGive) no limite e no limiar; NULL para nenhuma.
+} contagem_config_t;
+
+/* Configura a unidade e inicia a contagem. A CPU só é interrompida no limite e no limiar. */
+esp_err_t contagem_iniciar( const contagem_config_t *config );
+
+/*
+	Total de bordas desde contagem_iniciar (64 bits): o acumulado pelas interrupções mais o valor atual
+	do contador. Um estouro ainda não tratado pela ISR é considerado, então o total nunca volta atrás.
+*/
+uint64_t contagem_total( void );
+
+/*
+	CPU gasta para contar as mesmas bordas com uma ISR por borda (GPIO) e com o PCNT: gera no pino,
+	com o LEDC, ondas quadradas de 1 kHz, 10 kHz e 100 kHz por "duracao_ms" e imprime as bordas
+	contadas, as interrupções e a carga da CPU nos handlers. Chamar antes de contagem_iniciar.
+*/
+esp_err_t contagem_benchmark( gpio_num_t pino, pcnt_unit_t unidade, uint32_t duracao_ms );
+
+#ifdef __cplusplus
+}
+#endif
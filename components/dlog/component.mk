@@ -0,0 +1,4 @@
+#
+# Log diferido: registro binário em buffer circular por núcleo e formatação por uma task.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
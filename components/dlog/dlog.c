@@ -0,0 +1,216 @@
+/*
+	Objetivo: Log diferido - registro binário em buffer circular por núcleo, formatado e enviado
+			  à UART por uma task de baixa prioridade
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "benchmark.h"
+#include "tarefas.h"
+#include "dlog.h"
+
+_Static_assert( ( DLOG_TAMANHO_RING & ( DLOG_TAMANHO_RING - 1 ) ) == 0, "DLOG_TAMANHO_RING deve ser potencia de 2" );
+#if !CONFIG_IDF_TARGET_LINUX
+_Static_assert( sizeof( dlog_registro_t ) == 16 + 4 * DLOG_MAX_ARGS, "layout usado pelo tools/dlog_decode.py" );
+#endif
+
+/*
+	Um buffer por núcleo: o único escritor é o núcleo dono (com as interrupções mascaradas durante a
+	cópia) e o único leitor é a task de saída. Não há trava entre os núcleos.
+*/
+typedef struct {
+	uint32_t escrita;
+	uint32_t leitura;
+	uint32_t descartados;
+	dlog_registro_t registros[DLOG_TAMANHO_RING];
+} dlog_ring_t;
+
+/* Variáveis Globais */
+static const char * TAG = "dlog";
+static dlog_ring_t s_rings[portNUM_PROCESSORS];
+static dlog_saida_t s_saida;
+static uint32_t s_periodo_ms;
+
+void dlog_registrar( uint8_t nivel, const char *tag, const char *fmt, uint32_t nargs, ... )
+{
+	dlog_registro_t registro = {
+		.fmt = fmt,
+		.tag = tag,
+		.instante_ms = esp_log_timestamp(),
+		.nivel = nivel,
+		.nargs = nargs,
+	};
+	va_list ap;
+	va_start( ap, nargs );
+	for( uint32_t i = 0; i < nargs; i++ )
+		registro.args[i] = va_arg( ap, dlog_arg_t );
+	va_end( ap );
+
+	//Com as interrupções mascaradas a task não troca de núcleo nem é interrompida por outro escritor.
+	UBaseType_t estado = portSET_INTERRUPT_MASK_FROM_ISR();
+	dlog_ring_t *ring = &s_rings[xPortGetCoreID()];
+	registro.nucleo = xPortGetCoreID();
+	uint32_t escrita = ring->escrita;
+	if( escrita - __atomic_load_n( &ring->leitura, __ATOMIC_ACQUIRE ) >= DLOG_TAMANHO_RING )
+		ring->descartados++;
+	else
+	{
+		ring->registros[escrita & ( DLOG_TAMANHO_RING - 1 )] = registro;
+		__atomic_store_n( &ring->escrita, escrita + 1, __ATOMIC_RELEASE );
+	}
+	portCLEAR_INTERRUPT_MASK_FROM_ISR( estado );
+}
+
+/*
+	Formata uma conversão por vez, passando cada argumento com o tipo que ela espera: os inteiros
+	foram gravados com até 32 bits e os modificadores de largura l, ll, j, z e t são removidos (no
+	build para Linux long e size_t têm 64 bits). Conversões sem argumento ou de ponto flutuante
+	saem como estão no formato.
+*/
+static void imprime_formato( const char *fmt, const dlog_arg_t *a, uint32_t nargs )
+{
+	uint32_t n = 0;
+	while( *fmt )
+	{
+		if( *fmt != '%' )
+		{
+			putchar( *fmt++ );
+			continue;
+		}
+		if( fmt[1] == '%' )
+		{
+			putchar( '%' );
+			fmt += 2;
+			continue;
+		}
+
+		//Copia flags, largura e precisão; descarta os modificadores de 64 bits.
+		char conversao[16] = "%";
+		size_t tamanho = 1;
+		const char *inicio = fmt++;
+		while( *fmt && strchr( "-+ #0123456789.hljzt", *fmt ) )
+		{
+			if( !strchr( "ljzt", *fmt ) && tamanho < sizeof( conversao ) - 2 )
+				conversao[tamanho++] = *fmt;
+			fmt++;
+		}
+		if( *fmt == '\0' )
+		{
+			fputs( inicio, stdout );
+			break;
+		}
+		char tipo = *fmt++;
+		if( n >= nargs || !strchr( "diouxXcsp", tipo ) )
+		{
+			fwrite( inicio, 1, fmt - inicio, stdout );
+			continue;
+		}
+		conversao[tamanho++] = tipo;
+		conversao[tamanho] = '\0';
+
+		dlog_arg_t arg = a[n++];
+		if( tipo == 's' )
+			printf( conversao, (const char*) arg );
+		else if( tipo == 'p' )
+			printf( conversao, (void*) arg );
+		else if( tipo == 'd' || tipo == 'i' || tipo == 'c' )
+			printf( conversao, (int)(int32_t) arg );
+		else
+			printf( conversao, (unsigned)(uint32_t) arg );
+	}
+}
+
+static void imprime( const dlog_registro_t *r )
+{
+	if( s_saida == DLOG_SAIDA_BINARIA )
+	{
+		const uint8_t *bytes = (const uint8_t*) r;
+		printf( "DLOG:" );
+		for( size_t i = 0; i < sizeof( *r ); i++ )
+			printf( "%02x", bytes[i] );
+		printf( "\n" );
+		return;
+	}
+	printf( "%c (%u) %s: ", "NEWID"[r->nivel], (unsigned) r->instante_ms, r->tag );
+	imprime_formato( r->fmt, r->args, r->nargs );
+	printf( "\n" );
+}
+
+static void task_dlog( void *pvParameter )
+{
+	uint32_t descartados_anterior = 0;
+
+	while( 1 )
+	{
+		for( int nucleo = 0; nucleo < portNUM_PROCESSORS; nucleo++ )
+		{
+			dlog_ring_t *ring = &s_rings[nucleo];
+			uint32_t leitura = ring->leitura;
+			uint32_t escrita = __atomic_load_n( &ring->escrita, __ATOMIC_ACQUIRE );
+			for( ; leitura != escrita; leitura++ )
+			{
+				imprime( &ring->registros[leitura & ( DLOG_TAMANHO_RING - 1 )] );
+				//Libera o registro para o escritor somente depois de lido.
+				__atomic_store_n( &ring->leitura, leitura + 1, __ATOMIC_RELEASE );
+			}
+		}
+
+		uint32_t descartados = dlog_descartados();
+		if( descartados != descartados_anterior )
+		{
+			ESP_LOGW( TAG, "%u registros descartados (buffer cheio)", descartados - descartados_anterior );
+			descartados_anterior = descartados;
+		}
+		vTaskDelay( s_periodo_ms / portTICK_PERIOD_MS );
+	}
+}
+
+esp_err_t dlog_iniciar( dlog_saida_t saida, uint32_t periodo_ms, UBaseType_t prioridade )
+{
+	if( periodo_ms < portTICK_PERIOD_MS )
+		return ESP_ERR_INVALID_ARG;
+	s_saida = saida;
+	s_periodo_ms = periodo_ms;
+	if( tarefas_task( "dlog", task_dlog, "task_dlog", 3072, NULL, prioridade, tskNO_AFFINITY ) == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+}
+
+uint32_t dlog_descartados( void )
+{
+	uint32_t total = 0;
+	for( int nucleo = 0; nucleo < portNUM_PROCESSORS; nucleo++ )
+		total += __atomic_load_n( &s_rings[nucleo].descartados, __ATOMIC_RELAXED );
+	return total;
+}
+
+void dlog_benchmark( uint32_t repeticoes )
+{
+	bench_stats_t esp_log, dlog;
+	const char *msg = "Ligado";
+
+	bench_stats_init( &esp_log, "ciclos por ESP_LOGI" );
+	bench_stats_init( &dlog, "ciclos por DLOGI" );
+	for( uint32_t i = 0; i < repeticoes; i++ )
+	{
+		uint32_t inicio = bench_ciclos();
+		ESP_LOGI( TAG, "Led Red: %s (%u)", msg, i );
+		bench_stats_add( &esp_log, bench_ciclos() - inicio );
+
+		inicio = bench_ciclos();
+		DLOGI( TAG, "Led Red: %s (%u)", msg, i );
+		bench_stats_add( &dlog, bench_ciclos() - inicio );
+
+		//Dá tempo à task de saída para esvaziar o buffer e não medir descartes.
+		vTaskDelay( 2 * s_periodo_ms / portTICK_PERIOD_MS + 1 );
+	}
+	bench_stats_report( &esp_log, "ciclos" );
+	bench_stats_report( &dlog, "ciclos" );
+}
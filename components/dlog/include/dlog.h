@@ -0,0 +1,111 @@
+/*
+	Objetivo: Log diferido - registro binário em buffer circular por núcleo, formatado e enviado
+			  à UART por uma task de baixa prioridade
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DLOG_NIVEL_NENHUM	0
+#define DLOG_NIVEL_ERRO		1
+#define DLOG_NIVEL_AVISO	2
+#define DLOG_NIVEL_INFO		3
+#define DLOG_NIVEL_DEBUG	4
+
+/*	Nível de compilação (menuconfig, ou DLOG_NIVEL definido antes de incluir este arquivo). As chamadas
+	acima do nível são eliminadas pelo compilador (a condição é constante), sem custo em tempo de execução. */
+#ifndef DLOG_NIVEL
+#define DLOG_NIVEL			CONFIG_DLOG_NIVEL
+#endif
+
+#define DLOG_MAX_ARGS		8
+#define DLOG_TAMANHO_RING	32	//Registros por núcleo (potência de 2).
+
+/* Argumento gravado: 32 bits no ESP32; no build para Linux precisa comportar um ponteiro de 64 bits. */
+#if CONFIG_IDF_TARGET_LINUX
+typedef uintptr_t dlog_arg_t;
+#else
+typedef uint32_t dlog_arg_t;
+#endif
+
+/*
+	Registro gravado no buffer (48 bytes, little-endian). O formato e a tag são guardados como
+	ponteiros: devem ser strings constantes, assim como os argumentos %s. Somente argumentos de
+	até 32 bits (inteiros, char e ponteiros); 64 bits e ponto flutuante não são suportados. As
+	macros DLOGx convertem cada argumento para dlog_arg_t, a largura lida pelo dlog_registrar().
+*/
+typedef struct {
+	const char *fmt;
+	const char *tag;
+	uint32_t instante_ms;
+	uint8_t nivel;
+	uint8_t nargs;
+	uint8_t nucleo;
+	uint8_t reservado;
+	dlog_arg_t args[DLOG_MAX_ARGS];
+} dlog_registro_t;
+
+typedef enum {
+	DLOG_SAIDA_TEXTO,	//Formata como o ESP_LOG ("I (1234) tag: mensagem").
+	DLOG_SAIDA_BINARIA,	//Linhas "DLOG:<registro em hexadecimal>" para o tools/dlog_decode.py.
+} dlog_saida_t;
+
+/* Conta os argumentos (0 a DLOG_MAX_ARGS); mais argumentos geram erro de compilação. */
+#define DLOG_NARGS( ... ) \
+	DLOG_NARGS_( 0, ##__VA_ARGS__, DLOG_ARGUMENTOS_DEMAIS, 8, 7, 6, 5, 4, 3, 2, 1, 0 )
+#define DLOG_NARGS_( _0, _1, _2, _3, _4, _5, _6, _7, _8, _9, N, ... ) N
+
+/* Lista de argumentos convertidos para dlog_arg_t, cada um precedido de vírgula. */
+#define DLOG_ARG( x )		( (dlog_arg_t)( x ) )
+#define DLOG_ARGS( n, ... )	DLOG_ARGS_( n, ##__VA_ARGS__ )
+#define DLOG_ARGS_( n, ... )	DLOG_ARGS_##n( __VA_ARGS__ )
+#define DLOG_ARGS_0()
+#define DLOG_ARGS_1( a )		, DLOG_ARG( a )
+#define DLOG_ARGS_2( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_1( __VA_ARGS__ )
+#define DLOG_ARGS_3( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_2( __VA_ARGS__ )
+#define DLOG_ARGS_4( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_3( __VA_ARGS__ )
+#define DLOG_ARGS_5( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_4( __VA_ARGS__ )
+#define DLOG_ARGS_6( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_5( __VA_ARGS__ )
+#define DLOG_ARGS_7( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_6( __VA_ARGS__ )
+#define DLOG_ARGS_8( a, ... )	, DLOG_ARG( a ) DLOG_ARGS_7( __VA_ARGS__ )
+
+#define DLOG_REGISTRA( nivel, tag, fmt, ... ) do { \
+		if( ( nivel ) <= DLOG_NIVEL ) \
+			dlog_registrar( ( nivel ), ( tag ), ( fmt ), DLOG_NARGS( __VA_ARGS__ ) \
+							DLOG_ARGS( DLOG_NARGS( __VA_ARGS__ ), ##__VA_ARGS__ ) ); \
+	} while( 0 )
+
+#define DLOGE( tag, fmt, ... )	DLOG_REGISTRA( DLOG_NIVEL_ERRO, tag, fmt, ##__VA_ARGS__ )
+#define DLOGW( tag, fmt, ... )	DLOG_REGISTRA( DLOG_NIVEL_AVISO, tag, fmt, ##__VA_ARGS__ )
+#define DLOGI( tag, fmt, ... )	DLOG_REGISTRA( DLOG_NIVEL_INFO, tag, fmt, ##__VA_ARGS__ )
+#define DLOGD( tag, fmt, ... )	DLOG_REGISTRA( DLOG_NIVEL_DEBUG, tag, fmt, ##__VA_ARGS__ )
+
+/*
+	Copia o registro para o buffer do núcleo atual, sem formatar. Pode ser chamada de tasks e ISRs.
+	Com o buffer cheio o registro é descartado e contado. Os "nargs" argumentos variáveis devem ser
+	dlog_arg_t: use as macros DLOGx.
+*/
+void dlog_registrar( uint8_t nivel, const char *tag, const char *fmt, uint32_t nargs, ... );
+
+/* Cria a task que esvazia os buffers a cada "periodo_ms". Registros anteriores ficam guardados. */
+esp_err_t dlog_iniciar( dlog_saida_t saida, uint32_t periodo_ms, UBaseType_t prioridade );
+
+/* Registros descartados por buffer cheio (soma dos núcleos). */
+uint32_t dlog_descartados( void );
+
+/* Compara os ciclos gastos por quem chama ESP_LOGI e DLOGI com a mesma mensagem. */
+void dlog_benchmark( uint32_t repeticoes );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#
+# Economia de energia: light sleep automático com DFS, despertar pelo GPIO e modem sleep do WiFi.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
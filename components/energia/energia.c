@@ -0,0 +1,186 @@
+/*
+	Objetivo: Economia de energia - light sleep automático com DFS, despertar pelo GPIO, modem sleep
+			  do WiFi e relatório do tempo e da corrente estimada em cada modo
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_sleep.h"
+#include "esp32/pm.h"
+#include "tarefas.h"
+#include "energia.h"
+
+/* Definições e Constantes */
+#define MAX_MODOS		4		//SLEEP, APB_MIN, APB_MAX e CPU_MAX.
+#define TAMANHO_DUMP	2048	//Saída de esp_pm_dump_locks: os locks e, por último, os modos.
+#define TAMANHO_JSON	512
+
+/* Variáveis Globais */
+static const char * TAG = "energia";
+#if CONFIG_PM_PROFILING
+static uint32_t s_periodo_ms;
+/*	Usados somente por energia_relatorio (uma chamada por vez). */
+static int64_t s_anterior[MAX_MODOS];	//Tempo acumulado (us) de cada modo no relatório anterior.
+static char s_dump[TAMANHO_DUMP];
+static char s_json[TAMANHO_JSON];
+#endif
+
+esp_err_t energia_iniciar( const energia_config_t *config )
+{
+	esp_pm_config_esp32_t pm = {
+		.max_freq_mhz = config->freq_max_mhz,
+		.min_freq_mhz = config->freq_min_mhz,
+		.light_sleep_enable = config->light_sleep,
+	};
+	esp_err_t ret = esp_pm_configure( &pm );
+	if( ret != ESP_OK )
+	{
+		ESP_LOGE( TAG, "esp_pm_configure: %s (habilite CONFIG_PM_ENABLE)", esp_err_to_name( ret ) );
+		return ret;
+	}
+
+	if( config->pino_despertar >= 0 )
+	{
+		//No light sleep somente o nível do pino acorda a CPU; bordas não são detectadas.
+		ret = gpio_wakeup_enable( config->pino_despertar,
+								  config->nivel_despertar ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL );
+		if( ret == ESP_OK )
+			ret = esp_sleep_enable_gpio_wakeup();
+		if( ret != ESP_OK )
+			return ret;
+	}
+
+	ESP_LOGI( TAG, "CPU de %d a %d MHz, light sleep %s, despertar pelo GPIO %d",
+			  config->freq_min_mhz, config->freq_max_mhz, config->light_sleep ? "ligado" : "desligado",
+			  config->pino_despertar );
+	return ESP_OK;
+}
+
+esp_err_t energia_wifi( wifi_config_t *wifi_config, uint8_t intervalo_escuta )
+{
+	wifi_config->sta.listen_interval = intervalo_escuta;
+	return esp_wifi_set_ps( intervalo_escuta ? WIFI_PS_MAX_MODEM : WIFI_PS_MIN_MODEM );
+}
+
+esp_pm_lock_handle_t energia_manter( esp_pm_lock_type_t tipo, const char *nome )
+{
+	esp_pm_lock_handle_t lock = NULL;
+	if( esp_pm_lock_create( tipo, 0, nome, &lock ) != ESP_OK )
+		return NULL;
+	esp_pm_lock_acquire( lock );
+	return lock;
+}
+
+#if CONFIG_PM_PROFILING
+/* Corrente estimada de um modo a partir da frequência da CPU nele. */
+static uint32_t corrente_ua( const char *modo, int mhz )
+{
+	if( strcmp( modo, "SLEEP" ) == 0 )
+		return ENERGIA_UA_LIGHT_SLEEP;
+	if( mhz >= 240 )
+		return ENERGIA_UA_240MHZ;
+	if( mhz >= 160 )
+		return ENERGIA_UA_160MHZ;
+	if( mhz >= 80 )
+		return ENERGIA_UA_80MHZ;
+	return ENERGIA_UA_XTAL;
+}
+#endif
+
+void energia_relatorio( void )
+{
+#if CONFIG_PM_PROFILING
+	//O driver só expõe os tempos por modo em texto: a saída é capturada em memória e lida de volta.
+	memset( s_dump, 0, sizeof( s_dump ) );
+	FILE *f = fmemopen( s_dump, sizeof( s_dump ) - 1, "w" );
+	if( f == NULL )
+		return;
+	esp_pm_dump_locks( f );
+	fclose( f );
+
+	char *linha = strstr( s_dump, "Mode stats:" );
+	if( linha == NULL )
+	{
+		ESP_LOGW( TAG, "sem estatisticas dos modos (CONFIG_PM_ENABLE desligado?)" );
+		return;
+	}
+
+	char nomes[MAX_MODOS][12];
+	int mhz[MAX_MODOS];
+	int64_t atual[MAX_MODOS];
+	int64_t decorrido = 0;
+	int n = 0;
+	char *salvo;
+	strtok_r( linha, "\n", &salvo );	//Cabeçalho "Mode stats:".
+	while( n < MAX_MODOS && ( linha = strtok_r( NULL, "\n", &salvo ) ) != NULL )
+	{
+		//"<modo>  <frequência>  <tempo us>  <%>"; a frequência é "XTAL" ou começa pelos MHz.
+		char freq[12];
+		long long us;
+		if( sscanf( linha, "%11s %11s %lld", nomes[n], freq, &us ) != 3 )
+			break;
+		mhz[n] = isdigit( (unsigned char) freq[0] ) ? atoi( freq ) : 40;
+		atual[n] = us;
+		decorrido += us - s_anterior[n];
+		n++;
+	}
+	if( decorrido <= 0 )
+		return;
+
+	//"pct" em décimos de %, como o uso de CPU no relatório do perfil.
+	uint64_t carga = 0;	//uA * us no intervalo.
+	size_t pos = snprintf( s_json, TAMANHO_JSON, "{\"modos\":[" );
+	for( int i = 0; i < n && pos < TAMANHO_JSON; i++ )
+	{
+		int64_t us = atual[i] - s_anterior[i];
+		uint32_t ua = corrente_ua( nomes[i], mhz[i] );
+		carga += (uint64_t) ua * us;
+		pos += snprintf( s_json + pos, TAMANHO_JSON - pos, "%s{\"modo\":\"%s\",\"mhz\":%d,\"ms\":%u,\"pct\":%u,\"ua\":%u}",
+						 i ? "," : "", nomes[i], mhz[i], (uint32_t)( us / 1000 ),
+						 (uint32_t)( us * 1000 / decorrido ), ua );
+		s_anterior[i] = atual[i];
+	}
+	if( pos < TAMANHO_JSON )
+		snprintf( s_json + pos, TAMANHO_JSON - pos, "],\"ua_media\":%u}", (uint32_t)( carga / decorrido ) );
+	if( pos >= TAMANHO_JSON )
+		ESP_LOGW( TAG, "relatorio truncado, aumente TAMANHO_JSON" );
+	ESP_LOGI( TAG, "%s", s_json );
+#else
+	ESP_LOGW( TAG, "habilite CONFIG_PM_PROFILING" );
+#endif
+}
+
+#if CONFIG_PM_PROFILING
+static void task_energia( void *pvParameter )
+{
+	while( 1 )
+	{
+		vTaskDelay( s_periodo_ms / portTICK_PERIOD_MS );
+		energia_relatorio();
+	}
+}
+#endif
+
+esp_err_t energia_relatorio_iniciar( uint32_t periodo_ms )
+{
+#if CONFIG_PM_PROFILING
+	if( periodo_ms < portTICK_PERIOD_MS )
+		return ESP_ERR_INVALID_ARG;
+	s_periodo_ms = periodo_ms;
+	//Relatório inicial com o tempo desde o boot; os seguintes mostram cada período.
+	energia_relatorio();
+	if( tarefas_task( "energia", task_energia, "task_energia", 3072, NULL, 1, tskNO_AFFINITY ) == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+#else
+	return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
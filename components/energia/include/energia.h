@@ -0,0 +1,71 @@
+/*
+	Objetivo: Economia de energia - light sleep automático com DFS, despertar pelo GPIO, modem sleep
+			  do WiFi e relatório do tempo e da corrente estimada em cada modo
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_pm.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	Corrente típica (uA) do ESP32 com o rádio desligado, por frequência da CPU, e em light sleep
+	(datasheet). Usadas na estimativa do relatório; o tempo com o rádio ligado não está incluído.
+*/
+#define ENERGIA_UA_240MHZ		50000
+#define ENERGIA_UA_160MHZ		40000
+#define ENERGIA_UA_80MHZ		25000
+#define ENERGIA_UA_XTAL			15000
+#define ENERGIA_UA_LIGHT_SLEEP	800
+
+typedef struct {
+	int freq_max_mhz;			//240, 160 ou 80.
+	int freq_min_mhz;			//Frequência sem locks: 80, 40 (XTAL) ou 2.
+	bool light_sleep;			//Light sleep automático quando todas as tasks estão bloqueadas.
+	int pino_despertar;			//GPIO que acorda do light sleep (-1: nenhum).
+	int nivel_despertar;		//Nível do pino que acorda (0 ou 1).
+} energia_config_t;
+
+/*
+	Configura o gerenciamento de energia (esp_pm_configure) e o despertar pelo GPIO. Requer no
+	sdkconfig CONFIG_PM_ENABLE e, para o light sleep, CONFIG_FREERTOS_USE_TICKLESS_IDLE.
+*/
+esp_err_t energia_iniciar( const energia_config_t *config );
+
+/*
+	Modem sleep do WiFi: o rádio desliga entre os beacons. Com "intervalo_escuta" 0 a station acorda
+	em todo DTIM (WIFI_PS_MIN_MODEM); com N > 0 acorda a cada N beacons (WIFI_PS_MAX_MODEM), trocando
+	latência de recepção por consumo. Chamar após esp_wifi_init e antes de esp_wifi_set_config.
+*/
+esp_err_t energia_wifi( wifi_config_t *wifi_config, uint8_t intervalo_escuta );
+
+/*
+	Cria e adquire um lock de energia mantido pela task que o chama: CPU na frequência máxima
+	(ESP_PM_CPU_FREQ_MAX), APB a 80 MHz (ESP_PM_APB_FREQ_MAX) ou sem light sleep (ESP_PM_NO_LIGHT_SLEEP).
+	Retorna NULL sem CONFIG_PM_ENABLE; libere com esp_pm_lock_release.
+*/
+esp_pm_lock_handle_t energia_manter( esp_pm_lock_type_t tipo, const char *nome );
+
+/*
+	Imprime uma linha "energia: {...}" com o tempo em cada modo (light sleep, APB mínimo, APB máximo e
+	CPU máxima) desde o relatório anterior, a frequência da CPU em cada um e a corrente média estimada.
+	Requer CONFIG_PM_PROFILING. tools/energia_simulacao.py lê essas linhas e estima a autonomia.
+*/
+void energia_relatorio( void );
+
+/* Cria a task que imprime o relatório a cada "periodo_ms". */
+esp_err_t energia_relatorio_iniciar( uint32_t periodo_ms );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#
+# Formato binário compacto das bordas de GPIO (delta de tempo em varint, pino e nível).
+#
+COMPONENT_ADD_INCLUDEDIRS := include
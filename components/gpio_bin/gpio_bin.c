@@ -0,0 +1,120 @@
+/*
+	Objetivo: Formato binário compacto para fluxos de bordas de GPIO - delta de tempo em varint, pino
+			  e nível - com codificador sem alocação e decodificador incremental
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "gpio_bin.h"
+
+/* Bytes do varint de "valor". */
+static inline size_t tamanho_varint( uint64_t valor )
+{
+	size_t n = 1;
+	while( valor >= 0x80 )
+	{
+		valor >>= 7;
+		n++;
+	}
+	return n;
+}
+
+static inline size_t escreve_varint( uint8_t *buf, uint64_t valor )
+{
+	size_t n = 0;
+	while( valor >= 0x80 )
+	{
+		buf[n++] = (uint8_t)( valor | 0x80 );
+		valor >>= 7;
+	}
+	buf[n++] = (uint8_t) valor;
+	return n;
+}
+
+size_t gpio_bin_sincronismo( gpio_bin_codificador_t *c, uint8_t *buf, size_t tamanho, uint64_t instante_us )
+{
+	if( 1 + tamanho_varint( instante_us ) > tamanho )
+		return 0;
+	buf[0] = GPIO_BIN_SINCRONISMO;
+	c->anterior = instante_us;
+	return 1 + escreve_varint( buf + 1, instante_us );
+}
+
+size_t gpio_bin_codificar( gpio_bin_codificador_t *c, uint8_t *buf, size_t tamanho, uint64_t instante_us,
+						   uint8_t pino, uint8_t nivel )
+{
+	if( pino > GPIO_BIN_MAX_PINO )
+		return 0;
+	uint64_t delta = instante_us > c->anterior ? instante_us - c->anterior : 0;
+	if( 1 + tamanho_varint( delta ) > tamanho )
+		return 0;
+	buf[0] = (uint8_t)( pino << 1 | ( nivel ? 1 : 0 ) );
+	c->anterior += delta;
+	return 1 + escreve_varint( buf + 1, delta );
+}
+
+void gpio_bin_decodificador_init( gpio_bin_decodificador_t *d )
+{
+	d->instante = 0;
+	d->valor = 0;
+	d->deslocamento = 0;
+	d->cabecalho = 0;
+	d->em_registro = false;
+	d->sincronizado = false;
+	d->erros = 0;
+}
+
+size_t gpio_bin_decodificar( gpio_bin_decodificador_t *d, const uint8_t *dados, size_t n,
+							 gpio_bin_evento_t *eventos, size_t max, size_t *consumidos )
+{
+	size_t i = 0, saida = 0;
+
+	while( i < n && saida < max )
+	{
+		uint8_t byte = dados[i++];
+		if( !d->em_registro )
+		{
+			d->cabecalho = byte;
+			d->valor = 0;
+			d->deslocamento = 0;
+			d->em_registro = true;
+			continue;
+		}
+
+		if( d->deslocamento >= 64 )
+		{
+			//Mais de 10 bytes de varint: o fluxo está corrompido. Espera o próximo sincronismo.
+			d->erros++;
+			d->em_registro = false;
+			d->sincronizado = false;
+			continue;
+		}
+		d->valor |= (uint64_t)( byte & 0x7F ) << d->deslocamento;
+		d->deslocamento += 7;
+		if( byte & 0x80 )
+			continue;
+
+		d->em_registro = false;
+		if( d->cabecalho == GPIO_BIN_SINCRONISMO )
+		{
+			d->instante = d->valor;
+			d->sincronizado = true;
+			continue;
+		}
+		if( !d->sincronizado )
+		{
+			d->erros++;
+			continue;
+		}
+		d->instante += d->valor;
+		eventos[saida].instante_us = d->instante;
+		eventos[saida].pino = d->cabecalho >> 1;
+		eventos[saida].nivel = d->cabecalho & 1;
+		saida++;
+	}
+
+	if( consumidos )
+		*consumidos = i;
+	return saida;
+}
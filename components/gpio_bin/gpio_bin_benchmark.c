@@ -0,0 +1,95 @@
+/*
+	Objetivo: Benchmark do formato binário das bordas de GPIO (somente no ESP32)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include "esp_log.h"
+#include "esp_system.h"
+#include "benchmark.h"
+#include "gpio_bin.h"
+
+/* Definições e Constantes */
+#define TAMANHO_BLOCO	240		//Bytes por bloco (uma linha "GPIOBIN:" ou um datagrama pequeno).
+#define LOTE_DECODIFICADO	32
+
+/* Variáveis Globais */
+static const char * TAG = "gpio_bin";
+
+void gpio_bin_benchmark( uint32_t eventos )
+{
+	uint8_t bloco[TAMANHO_BLOCO];
+	gpio_bin_evento_t decodificados[LOTE_DECODIFICADO];
+	gpio_bin_codificador_t cod;
+	gpio_bin_decodificador_t dec;
+	char texto[96];
+	uint64_t instante = 1000000;
+	uint64_t bytes = 0, bytes_texto = 0;
+	uint64_t ciclos_codificar = 0, ciclos_decodificar = 0;
+	uint32_t blocos = 0, conferidos = 0, divergentes = 0;
+	uint32_t esperado_pino = 0, esperado_nivel = 0;
+	uint64_t esperado_instante = 0;
+
+	for( uint32_t e = 0; e < eventos; )
+	{
+		//Um bloco: sincronismo seguido de bordas até encher.
+		gpio_bin_codificador_init( &cod );
+		size_t pos = gpio_bin_sincronismo( &cod, bloco, sizeof( bloco ), instante );
+		uint64_t inicio_bloco = instante;
+		uint32_t primeira = e;
+		uint32_t inicio = bench_ciclos();
+		for( ; e < eventos; e++ )
+		{
+			//Intervalos de 100 us a 100 ms, BUTTON alternando e outro pino ocasional.
+			uint64_t proximo = instante + 100 + esp_random() % 100000;
+			size_t n = gpio_bin_codificar( &cod, bloco + pos, sizeof( bloco ) - pos, proximo, e % 7 ? 0 : 4, e & 1 );
+			if( n == 0 )
+				break;
+			pos += n;
+			instante = proximo;
+		}
+		ciclos_codificar += bench_ciclos() - inicio;
+		bytes += pos;
+		blocos++;
+
+		//Mesmo texto que a task_GPIO_Eventos registraria para cada borda.
+		for( uint32_t i = primeira; i < e; i++ )
+			bytes_texto += snprintf( texto, sizeof( texto ), "I (%u) main: Borda %u no GPIO %u, %u ciclos apos a anterior\n",
+									 (uint32_t)( instante / 1000 ), i, 0, 24000000 );
+
+		//Round-trip: decodifica o bloco e confere pino, nível e instante de cada borda.
+		gpio_bin_decodificador_init( &dec );
+		esperado_instante = inicio_bloco;
+		size_t consumido = 0;
+		inicio = bench_ciclos();
+		while( consumido < pos )
+		{
+			size_t lidos;
+			size_t n = gpio_bin_decodificar( &dec, bloco + consumido, pos - consumido, decodificados,
+											 LOTE_DECODIFICADO, &lidos );
+			consumido += lidos;
+			for( size_t i = 0; i < n; i++, conferidos++ )
+			{
+				esperado_pino = ( primeira + conferidos ) % 7 ? 0 : 4;
+				esperado_nivel = ( primeira + conferidos ) & 1;
+				if( decodificados[i].pino != esperado_pino || decodificados[i].nivel != esperado_nivel
+					|| decodificados[i].instante_us <= esperado_instante )
+					divergentes++;
+				esperado_instante = decodificados[i].instante_us;
+			}
+		}
+		ciclos_decodificar += bench_ciclos() - inicio;
+		if( esperado_instante != instante )
+			divergentes++;
+		conferidos = 0;
+	}
+
+	uint32_t mhz = CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ;
+	ESP_LOGI( TAG, "%u bordas em %u blocos: %u.%02u bytes/borda (texto: %u bytes/borda)", eventos, blocos,
+			  (uint32_t)( bytes / eventos ), (uint32_t)( bytes * 100 / eventos % 100 ), (uint32_t)( bytes_texto / eventos ) );
+	ESP_LOGI( TAG, "Codificacao: %u ciclos/borda (%u bordas/s); decodificacao: %u ciclos/borda; %u divergencias",
+			  (uint32_t)( ciclos_codificar / eventos ), (uint32_t)( (uint64_t) eventos * mhz * 1000000 / ciclos_codificar ),
+			  (uint32_t)( ciclos_decodificar / eventos ), divergentes );
+}
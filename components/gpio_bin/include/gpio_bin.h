@@ -0,0 +1,88 @@
+/*
+	Objetivo: Formato binário compacto para fluxos de bordas de GPIO - delta de tempo em varint, pino
+			  e nível - com codificador sem alocação e decodificador incremental
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	Cada borda é um byte (pino << 1 | nível) seguido do tempo desde a borda anterior, em us, como
+	varint (7 bits por byte, o bit 7 indica continuação): uma borda a cada 10 ms ocupa 3 bytes.
+	O byte 0xFF marca um sincronismo, seguido do instante absoluto (us) em varint. Cada bloco (linha
+	do log ou datagrama) começa com um sincronismo e pode ser decodificado isoladamente, a partir de
+	um decodificador reiniciado. Este arquivo e o gpio_bin.c usam somente C padrão e compilam também
+	nos coletores Linux.
+*/
+#define GPIO_BIN_SINCRONISMO	0xFF
+#define GPIO_BIN_MAX_PINO		126		//Pino 127 com nível 1 seria o sincronismo.
+#define GPIO_BIN_MAX_REGISTRO	11		//1 byte de cabeçalho + varint de 64 bits.
+
+typedef struct {
+	uint64_t anterior;			//Instante (us) do último registro escrito.
+} gpio_bin_codificador_t;
+
+typedef struct {
+	uint64_t instante_us;
+	uint8_t pino;
+	uint8_t nivel;
+} gpio_bin_evento_t;
+
+/* Estado entre chamadas: um registro pode chegar dividido em vários pedaços. */
+typedef struct {
+	uint64_t instante;			//Instante da última borda decodificada.
+	uint64_t valor;				//Varint em montagem.
+	uint8_t deslocamento;		//Bits já acumulados em "valor".
+	uint8_t cabecalho;			//Byte do registro em montagem.
+	bool em_registro;
+	bool sincronizado;			//Bordas antes do primeiro sincronismo são descartadas.
+	uint32_t erros;				//Varints longos demais ou bordas sem sincronismo.
+} gpio_bin_decodificador_t;
+
+static inline void gpio_bin_codificador_init( gpio_bin_codificador_t *c )
+{
+	c->anterior = 0;
+}
+
+/*
+	Escreve em "buf" um sincronismo com o instante absoluto. Retorna os bytes escritos, ou 0 (sem
+	alterar o estado) se não couber em "tamanho".
+*/
+size_t gpio_bin_sincronismo( gpio_bin_codificador_t *c, uint8_t *buf, size_t tamanho, uint64_t instante_us );
+
+/*
+	Escreve uma borda. Instantes anteriores ao último registro são gravados com delta 0. Retorna os
+	bytes escritos (no máximo GPIO_BIN_MAX_REGISTRO), ou 0 se não couber ou se o pino passar de
+	GPIO_BIN_MAX_PINO. Não aloca memória nem usa variáveis globais.
+*/
+size_t gpio_bin_codificar( gpio_bin_codificador_t *c, uint8_t *buf, size_t tamanho, uint64_t instante_us,
+						   uint8_t pino, uint8_t nivel );
+
+void gpio_bin_decodificador_init( gpio_bin_decodificador_t *d );
+
+/*
+	Consome bytes de um fluxo, em pedaços de qualquer tamanho, e escreve até "max" bordas em "eventos".
+	"consumidos" recebe quantos bytes foram usados: com "eventos" cheio, chame de novo com o restante.
+	Retorna o número de bordas escritas.
+*/
+size_t gpio_bin_decodificar( gpio_bin_decodificador_t *d, const uint8_t *dados, size_t n,
+							 gpio_bin_evento_t *eventos, size_t max, size_t *consumidos );
+
+/*
+	Benchmark no ESP32: codifica "eventos" bordas sintéticas (intervalos de 100 us a 100 ms) e imprime
+	bordas por segundo, bytes por borda e a comparação com a mesma borda em texto no log.
+*/
+void gpio_bin_benchmark( uint32_t eventos );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#
+# Componente de entradas digitais por interrupção compartilhado entre os exemplos.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,305 @@
+/*
+	Objetivo: Leitura de entradas digitais por interrupção (sem polling)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/gpio_struct.h"
+#include "xtensa/hal.h"
+#include "perfil.h"
+#include "tarefas.h"
+#include "gpio_input.h"
+
+/* Bits do campo int_ena de cada pino: a interrupção é entregue somente ao núcleo habilitado. */
+#define INTR_ENA_APP_CPU	BIT(0)
+#define INTR_ENA_PRO_CPU	BIT(2)
+
+/* Estado do debounce de cada pino. */
+typedef struct {
+	bool ativo;
+	uint8_t estavel;        //Último nível aceito.
+	uint32_t ciclos;        //Ciclos de CPU da borda que iniciou a janela.
+	int64_t inicio_us;      //Instante da borda que iniciou a janela.
+	gpio_input_debounce_t config;
+} debounce_pino_t;
+
+/* Variáveis Globais */
+static const char * TAG = "gpio_input";
+static gpio_ring_t s_ring;           //Produtor: ISR (pinos sem debounce).
+static gpio_ring_t s_ring_filtrado;  //Produtor: esp_timer (pinos com debounce).
+static TaskHandle_t s_consumidor;
+static debounce_pino_t s_pinos[GPIO_NUM_MAX];
+static esp_timer_handle_t s_timer;
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static uint64_t s_pendentes;         //Pinos aguardando o fim da janela (protegido por s_lock).
+static bool s_timer_ativo;           //Protegido por s_lock.
+static gpio_input_stats_t s_stats;         //interrupcoes e aceitos escritos somente pela ISR.
+static uint32_t s_aceitos_filtrados;       //Escritos somente pelo esp_timer.
+static uint32_t s_rejeitados;              //Escritos somente pelo esp_timer.
+static perfil_isr_t s_perfil_isr = { .nome = "gpio_input_isr" }; //Entradas e ciclos da ISR.
+static int s_nucleo_isr;                   //Núcleo em que o serviço de ISR de GPIO foi instalado.
+static gpio_input_evento_t *s_buffer;      //Memória dos dois rings (mantida após uma falha).
+static size_t s_capacidade;                //Eventos por ring que cabem em s_buffer.
+
+/*
+	O gpio_intr_enable entrega a interrupção ao núcleo de quem chama, mas o fim do debounce roda na
+	task do esp_timer (núcleo 0). A interrupção é sempre roteada para o núcleo onde a ISR foi alocada.
+*/
+static void habilita_intr( uint32_t pino )
+{
+	GPIO.pin[pino].int_ena = s_nucleo_isr == APP_CPU_NUM ? INTR_ENA_APP_CPU : INTR_ENA_PRO_CPU;
+}
+
+/* Marca o pino como pendente e liga o timer compartilhado se ele estiver parado. */
+static void IRAM_ATTR agenda_debounce( uint32_t pino, uint32_t ciclos )
+{
+	s_pinos[pino].ciclos = ciclos;
+	s_pinos[pino].inicio_us = esp_timer_get_time();
+
+	portENTER_CRITICAL_SAFE( &s_lock );
+	s_pendentes |= 1ULL << pino;
+	if( !s_timer_ativo )
+	{
+		s_timer_ativo = true;
+		esp_timer_start_periodic( s_timer, GPIO_INPUT_TICK_US );
+	}
+	portEXIT_CRITICAL_SAFE( &s_lock );
+}
+
+/*
+	ISR compartilhada por todos os pinos monitorados. Pinos sem debounce gravam a borda no ring (sem
+	travas, a ISR é o único produtor) e notificam diretamente a task consumidora. Pinos com debounce
+	têm a interrupção desabilitada até o fim da janela, de modo que os rebotes não geram novas ISRs.
+*/
+static inline void IRAM_ATTR trata_borda( uint32_t pino, uint32_t ciclos )
+{
+	s_stats.interrupcoes++;
+
+	if( s_pinos[pino].ativo )
+	{
+		gpio_intr_disable( pino );
+		agenda_debounce( pino, ciclos );
+		return;
+	}
+
+	if( !gpio_ring_push( &s_ring, pino, gpio_get_level( pino ), ciclos ) )
+		return;
+	s_stats.aceitos++;
+
+	BaseType_t acordou = pdFALSE;
+	vTaskNotifyGiveFromISR( s_consumidor, &acordou );
+	if( acordou )
+		portYIELD_FROM_ISR();
+}
+
+/* Contabiliza entradas e ciclos de cada chamada para o relatório do perfil. */
+static void IRAM_ATTR gpio_input_isr( void *arg )
+{
+	uint32_t ciclos = xthal_get_ccount();
+	trata_borda( (uintptr_t) arg, ciclos );
+	perfil_isr_saida( &s_perfil_isr, ciclos );
+}
+
+static bool borda_aceita( gpio_int_type_t borda, uint32_t nivel )
+{
+	return borda == GPIO_INTR_ANYEDGE
+		|| ( borda == GPIO_INTR_POSEDGE && nivel )
+		|| ( borda == GPIO_INTR_NEGEDGE && !nivel );
+}
+
+/* Avalia um pino pendente. Retorna true quando o debounce do pino terminou. */
+static bool avalia_pino( uint32_t pino, int64_t agora )
+{
+	debounce_pino_t *p = &s_pinos[pino];
+	int64_t decorrido = agora - p->inicio_us;
+	if( decorrido < p->config.janela_us )
+		return false;
+
+	uint32_t nivel = gpio_get_level( pino );
+	if( nivel == p->estavel )
+	{
+		//Voltou ao nível anterior: rebote ou pulso espúrio.
+		s_rejeitados++;
+		return true;
+	}
+	if( decorrido < p->config.pulso_min_us )
+		return false;   //Continua amostrando a cada tick até completar o pulso mínimo.
+
+	p->estavel = nivel;
+	if( borda_aceita( p->config.borda, nivel ) )
+	{
+		if( gpio_ring_push( &s_ring_filtrado, pino, nivel, p->ciclos ) )
+		{
+			s_aceitos_filtrados++;
+			xTaskNotifyGive( s_consumidor );
+		}
+	}
+	return true;
+}
+
+/* Callback do timer compartilhado: custo proporcional apenas aos pinos pendentes. */
+static void gpio_input_tick( void *arg )
+{
+	int64_t agora = esp_timer_get_time();
+
+	portENTER_CRITICAL( &s_lock );
+	uint64_t pendentes = s_pendentes;
+	portEXIT_CRITICAL( &s_lock );
+
+	uint64_t concluidos = 0;
+	for( uint64_t resto = pendentes; resto; resto &= resto - 1 )
+	{
+		uint32_t pino = __builtin_ctzll( resto );
+		if( avalia_pino( pino, agora ) )
+			concluidos |= 1ULL << pino;
+	}
+
+	portENTER_CRITICAL( &s_lock );
+	s_pendentes &= ~concluidos;
+	if( s_pendentes == 0 && s_timer_ativo )
+	{
+		s_timer_ativo = false;
+		esp_timer_stop( s_timer );
+	}
+	portEXIT_CRITICAL( &s_lock );
+
+	for( uint64_t resto = concluidos; resto; resto &= resto - 1 )
+	{
+		uint32_t pino = __builtin_ctzll( resto );
+		habilita_intr( pino );
+		//Uma borda ocorrida com a interrupção desabilitada é tratada como nova borda.
+		if( (uint32_t) gpio_get_level( pino ) != s_pinos[pino].estavel )
+		{
+			gpio_intr_disable( pino );
+			agenda_debounce( pino, xthal_get_ccount() );
+		}
+	}
+}
+
+/* Desfaz uma inicialização incompleta: remove os handlers já registrados e apaga o timer. */
+static void desfaz_iniciar( uint64_t registrados, bool servico_instalado )
+{
+	for( uint64_t resto = registrados; resto; resto &= resto - 1 )
+	{
+		uint32_t pino = __builtin_ctzll( resto );
+		gpio_intr_disable( pino );
+		gpio_isr_handler_remove( pino );
+	}
+	if( servico_instalado )
+		gpio_uninstall_isr_service();
+	esp_timer_delete( s_timer );
+	s_timer = NULL;
+}
+
+esp_err_t gpio_input_iniciar( uint64_t pin_bit_mask, size_t max_eventos )
+{
+	if( s_consumidor != NULL )
+		return ESP_ERR_INVALID_STATE;
+	if( max_eventos == 0 || ( max_eventos & ( max_eventos - 1 ) ) != 0 )
+		return ESP_ERR_INVALID_ARG;
+
+	//Os rings são acessados pela ISR, portanto precisam estar na RAM interna. O tarefas_memoria não
+	//libera, então o buffer de uma tentativa que falhou é reaproveitado na seguinte.
+	if( s_buffer == NULL || s_capacidade < max_eventos )
+	{
+		gpio_input_evento_t *buffer = tarefas_memoria( "gpio_input", 2 * max_eventos * sizeof( gpio_input_evento_t ) );
+		if( buffer == NULL )
+			return ESP_ERR_NO_MEM;
+		s_buffer = buffer;
+		s_capacidade = max_eventos;
+	}
+	gpio_ring_init( &s_ring, s_buffer, max_eventos );
+	gpio_ring_init( &s_ring_filtrado, s_buffer + max_eventos, max_eventos );
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = gpio_input_tick,
+		.name = "gpio_input_tick",
+	};
+	esp_err_t ret = esp_timer_create( &timer_args, &s_timer );
+	if( ret != ESP_OK )
+		return ret;
+
+	//O serviço pode já ter sido instalado por outro módulo (ex.: tarefas_isr_gpio em um núcleo escolhido).
+	ret = gpio_install_isr_service( 0 );
+	bool servico_instalado = ret == ESP_OK;
+	if( ret == ESP_OK )
+		s_nucleo_isr = xPortGetCoreID();
+	else if( ret == ESP_ERR_INVALID_STATE )
+		s_nucleo_isr = tarefas_nucleo_isr_gpio() >= 0 ? tarefas_nucleo_isr_gpio() : xPortGetCoreID();
+	else
+	{
+		desfaz_iniciar( 0, false );
+		return ret;
+	}
+
+	//A ISR só notifica depois do registro do consumidor, por isso as interrupções ficam desabilitadas até o fim.
+	uint64_t registrados = 0;
+	for( uint32_t pino = 0; pino < GPIO_NUM_MAX; pino++ )
+	{
+		if( !( pin_bit_mask & ( 1ULL << pino ) ) )
+			continue;
+		gpio_set_intr_type( pino, GPIO_INTR_ANYEDGE );
+		ret = gpio_isr_handler_add( pino, gpio_input_isr, (void*)(uintptr_t) pino );
+		if( ret != ESP_OK )
+		{
+			ESP_LOGE( TAG, "Falha ao registrar a interrupcao do GPIO %u", pino );
+			desfaz_iniciar( registrados, servico_instalado );
+			return ret;
+		}
+		gpio_intr_disable( pino );
+		registrados |= 1ULL << pino;
+	}
+
+	s_consumidor = xTaskGetCurrentTaskHandle();
+	perfil_registrar_isr( &s_perfil_isr );
+	for( uint64_t resto = registrados; resto; resto &= resto - 1 )
+		habilita_intr( __builtin_ctzll( resto ) );
+	return ESP_OK;
+}
+
+esp_err_t gpio_input_debounce( gpio_num_t pino, const gpio_input_debounce_t *config )
+{
+	if( !GPIO_IS_VALID_GPIO( pino ) || config == NULL || config->janela_us == 0 )
+		return ESP_ERR_INVALID_ARG;
+	if( s_timer == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	gpio_intr_disable( pino );
+	s_pinos[pino].config = *config;
+	s_pinos[pino].estavel = gpio_get_level( pino );
+	s_pinos[pino].ativo = true;
+	habilita_intr( pino );
+	return ESP_OK;
+}
+
+size_t gpio_input_drenar( gpio_input_evento_t *eventos, size_t max, TickType_t espera )
+{
+	size_t n;
+	do
+	{
+		n = gpio_ring_drenar( &s_ring_filtrado, eventos, max );
+		n += gpio_ring_drenar( &s_ring, eventos + n, max - n );
+		//Uma notificação pode se referir a eventos já drenados no lote anterior; nesse caso volta a esperar.
+	} while( n == 0 && ulTaskNotifyTake( pdTRUE, espera ) );
+	return n;
+}
+
+bool gpio_input_ler( gpio_input_evento_t *evento, TickType_t espera )
+{
+	return gpio_input_drenar( evento, 1, espera ) == 1;
+}
+
+void gpio_input_estatisticas( gpio_input_stats_t *stats )
+{
+	*stats = s_stats;
+	stats->aceitos += s_aceitos_filtrados;
+	stats->rejeitados = s_rejeitados;
+	stats->descartados = gpio_ring_descartados( &s_ring ) + gpio_ring_descartados( &s_ring_filtrado );
+}
@@ -0,0 +1,71 @@
+/*
+	Objetivo: Leitura de entradas digitais por interrupção (sem polling)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "gpio_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Período do timer compartilhado que conclui o debounce dos pinos pendentes. */
+#define GPIO_INPUT_TICK_US		1000
+
+/* Evento gerado a cada borda em um pino monitorado (ver gpio_ring.h). */
+typedef gpio_ring_evento_t gpio_input_evento_t;
+
+/* Configuração do debounce de um pino. */
+typedef struct {
+	uint32_t janela_us;     //Após uma borda a interrupção do pino fica desabilitada por este tempo (rebotes ignorados).
+	uint32_t pulso_min_us;  //O novo nível precisa se manter por este tempo (contado da borda) para ser aceito.
+	gpio_int_type_t borda;  //Bordas entregues: GPIO_INTR_POSEDGE, GPIO_INTR_NEGEDGE ou GPIO_INTR_ANYEDGE.
+} gpio_input_debounce_t;
+
+typedef struct {
+	uint32_t interrupcoes;  //Entradas na ISR.
+	uint32_t aceitos;       //Eventos entregues à task consumidora.
+	uint32_t rejeitados;    //Pulsos mais curtos que a janela ou que o pulso mínimo.
+	uint32_t descartados;   //Eventos perdidos por falta de espaço no ring.
+} gpio_input_stats_t;
+
+/*
+	Habilita a interrupção em ambas as bordas para os pinos da máscara (já configurados como entrada)
+	e cria o ring que transporta até "max_eventos" (potência de 2) eventos da ISR para a task
+	consumidora. A task que chama esta função passa a ser a única consumidora. Se o serviço de ISR
+	de GPIO ainda não existir ele é instalado no núcleo desta task; para escolher o núcleo da ISR,
+	chame antes tarefas_isr_gpio().
+*/
+esp_err_t gpio_input_iniciar( uint64_t pin_bit_mask, size_t max_eventos );
+
+/*
+	Ativa o debounce em um pino já monitorado. Todos os pinos compartilham um único esp_timer, que só
+	fica ativo enquanto houver pino aguardando o fim da janela; o custo por borda é O(1). Os eventos
+	filtrados trazem os ciclos de CPU da primeira borda e podem chegar fora de ordem em relação aos
+	pinos sem debounce.
+*/
+esp_err_t gpio_input_debounce( gpio_num_t pino, const gpio_input_debounce_t *config );
+
+/* Bloqueia a task (sem consumir CPU) até chegar um evento ou esgotar "espera". */
+bool gpio_input_ler( gpio_input_evento_t *evento, TickType_t espera );
+
+/*
+	Igual a gpio_input_ler, mas retira em lote até "max" eventos. Retorna quantos foram lidos. Os pinos
+	com debounce e os demais têm sequências (seq) separadas, cada uma começando em 0.
+*/
+size_t gpio_input_drenar( gpio_input_evento_t *eventos, size_t max, TickType_t espera );
+
+/* Contadores de interrupções e eventos desde gpio_input_iniciar. */
+void gpio_input_estatisticas( gpio_input_stats_t *stats );
+
+#ifdef __cplusplus
+}
+#endif
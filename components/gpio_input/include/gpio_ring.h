@@ -0,0 +1,97 @@
+/*
+	Objetivo: Buffer circular sem travas (lock-free) para eventos de GPIO da ISR para a task
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_attr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Registro de uma borda (8 bytes, escrito e lido como um bloco). */
+typedef struct {
+	uint8_t pino;
+	uint8_t nivel;
+	uint16_t seq;       //Número de sequência do produtor, conta também os descartes: uma lacuna é um evento perdido.
+	uint32_t ciclos;    //Contador de ciclos da CPU no instante da borda.
+} gpio_ring_evento_t;
+
+/*
+	Um único produtor (a ISR) e um único consumidor (uma task). Os índices crescem livremente e
+	são mascarados no acesso, portanto a capacidade precisa ser potência de 2. Apenas o produtor
+	altera "escrita" e "descartados" e apenas o consumidor altera "leitura", por isso nenhuma seção
+	crítica é necessária: a ordem de memória é garantida pelas barreiras acquire/release.
+	Para vários consumidores, crie um ring por consumidor.
+*/
+typedef struct {
+	uint32_t escrita;
+	uint32_t leitura;
+	uint32_t descartados;   //Eventos perdidos por falta de espaço.
+	uint32_t mascara;
+	gpio_ring_evento_t *eventos;
+} gpio_ring_t;
+
+/* O buffer deve estar em DRAM (DRAM_ATTR) para ser acessível pela ISR com a cache desabilitada. */
+static inline void gpio_ring_init( gpio_ring_t *ring, gpio_ring_evento_t *buffer, uint32_t capacidade )
+{
+	ring->escrita = 0;
+	ring->leitura = 0;
+	ring->descartados = 0;
+	ring->mascara = capacidade - 1;
+	ring->eventos = buffer;
+}
+
+/* Chamado somente pelo produtor. Retorna false (e conta o descarte) se o ring estiver cheio. */
+FORCE_INLINE_ATTR bool gpio_ring_push( gpio_ring_t *ring, uint8_t pino, uint8_t nivel, uint32_t ciclos )
+{
+	uint32_t escrita = ring->escrita;
+	uint32_t leitura = __atomic_load_n( &ring->leitura, __ATOMIC_ACQUIRE );
+	if( escrita - leitura > ring->mascara )
+	{
+		ring->descartados++;
+		return false;
+	}
+	gpio_ring_evento_t *evento = &ring->eventos[ escrita & ring->mascara ];
+	evento->pino = pino;
+	evento->nivel = nivel;
+	evento->seq = (uint16_t)( escrita + ring->descartados );
+	evento->ciclos = ciclos;
+	//Publica o evento somente depois de totalmente escrito.
+	__atomic_store_n( &ring->escrita, escrita + 1, __ATOMIC_RELEASE );
+	return true;
+}
+
+/* Quantidade de eventos aguardando o consumidor. */
+static inline uint32_t gpio_ring_pendentes( const gpio_ring_t *ring )
+{
+	return __atomic_load_n( &ring->escrita, __ATOMIC_ACQUIRE ) - ring->leitura;
+}
+
+/* Chamado somente pelo consumidor. Copia até "max" eventos em lote e retorna quantos foram lidos. */
+static inline size_t gpio_ring_drenar( gpio_ring_t *ring, gpio_ring_evento_t *destino, size_t max )
+{
+	uint32_t leitura = ring->leitura;
+	uint32_t disponiveis = __atomic_load_n( &ring->escrita, __ATOMIC_ACQUIRE ) - leitura;
+	size_t n = disponiveis < max ? disponiveis : max;
+	for( size_t i = 0; i < n; i++ )
+		destino[i] = ring->eventos[ ( leitura + i ) & ring->mascara ];
+	//Libera as posições para o produtor somente depois de copiadas.
+	__atomic_store_n( &ring->leitura, leitura + n, __ATOMIC_RELEASE );
+	return n;
+}
+
+static inline uint32_t gpio_ring_descartados( const gpio_ring_t *ring )
+{
+	return __atomic_load_n( &ring->descartados, __ATOMIC_RELAXED );
+}
+
+#ifdef __cplusplus
+}
+#endif
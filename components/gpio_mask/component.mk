@@ -0,0 +1,4 @@
+#
+# Componente de escrita/leitura de várias GPIOs por registrador compartilhado entre os exemplos.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,49 @@
+/*
+	Objetivo: Escrita e leitura de várias GPIOs com um único acesso a registrador
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "benchmark.h"
+#include "gpio_mask.h"
+
+/* Variáveis Globais */
+static const char * TAG = "gpio_mask";
+
+void gpio_mask_benchmark( const gpio_num_t *pinos, size_t n, uint32_t repeticoes )
+{
+	uint64_t mascara = 0;
+	for( size_t i = 0; i < n; i++ )
+		mascara |= 1ULL << pinos[i];
+
+	//Executa sem trocas de contexto para que a medição contenha apenas o acesso às GPIOs.
+	vTaskSuspendAll();
+
+	uint32_t inicio = bench_ciclos();
+	for( uint32_t r = 0; r < repeticoes; r++ )
+	{
+		uint32_t nivel = r & 1;
+		for( size_t i = 0; i < n; i++ )
+			gpio_set_level( pinos[i], nivel );
+	}
+	uint32_t ciclos_set_level = bench_ciclos() - inicio;
+
+	inicio = bench_ciclos();
+	for( uint32_t r = 0; r < repeticoes; r++ )
+	{
+		if( r & 1 )
+			gpio_write_mask( mascara, 0 );
+		else
+			gpio_write_mask( 0, mascara );
+	}
+	uint32_t ciclos_mascara = bench_ciclos() - inicio;
+
+	xTaskResumeAll();
+
+	ESP_LOGI( TAG, "%u pinos: gpio_set_level %u ciclos/atualizacao, gpio_write_mask %u ciclos/atualizacao",
+			  (uint32_t) n, ciclos_set_level / repeticoes, ciclos_mascara / repeticoes );
+}
@@ -0,0 +1,51 @@
+/*
+	Objetivo: Escrita e leitura de várias GPIOs com um único acesso a registrador
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "driver/gpio.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	Liga os pinos de "set_mask" e desliga os de "clear_mask" (mesmo formato do pin_bit_mask do
+	gpio_config_t). Cada máscara é aplicada com uma única escrita nos registradores W1TS/W1TC, então
+	todos os pinos de uma mesma máscara mudam no mesmo instante; o "set" é aplicado antes do "clear".
+	Os pinos precisam estar configurados como saída. Pode ser chamada de ISR.
+*/
+static inline void gpio_write_mask( uint64_t set_mask, uint64_t clear_mask )
+{
+	if( (uint32_t) set_mask )
+		REG_WRITE( GPIO_OUT_W1TS_REG, (uint32_t) set_mask );
+	if( set_mask >> 32 )
+		REG_WRITE( GPIO_OUT1_W1TS_REG, (uint32_t)( set_mask >> 32 ) );
+	if( (uint32_t) clear_mask )
+		REG_WRITE( GPIO_OUT_W1TC_REG, (uint32_t) clear_mask );
+	if( clear_mask >> 32 )
+		REG_WRITE( GPIO_OUT1_W1TC_REG, (uint32_t)( clear_mask >> 32 ) );
+}
+
+/* Retorna o nível de todas as GPIOs (bit n = GPIO n) lido em dois acessos a registrador. */
+static inline uint64_t gpio_read_all( void )
+{
+	return ( (uint64_t) REG_READ( GPIO_IN1_REG ) << 32 ) | REG_READ( GPIO_IN_REG );
+}
+
+/*
+	Microbenchmark: mede a média de ciclos para atualizar os "n" pinos informados usando gpio_set_level
+	pino a pino e usando gpio_write_mask, repetindo "repeticoes" vezes. Os pinos devem ser saídas livres.
+*/
+void gpio_mask_benchmark( const gpio_num_t *pinos, size_t n, uint32_t repeticoes );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,4 @@
+#
+# Servidor HTTP/1.1 local: conexões persistentes, buffers pré-alocados e respostas em blocos.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
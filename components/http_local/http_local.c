@@ -0,0 +1,619 @@
+/*
+	Objetivo: Servidor HTTP/1.1 local para estado e controle - conexões persistentes, buffers
+			  pré-alocados, respostas montadas no lugar e envio em blocos (chunked)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "benchmark.h"
+#include "tarefas.h"
+#include "http_local.h"
+
+/* Definições e Constantes */
+#define RESERVA_CABECALHO	192		//Antes do corpo: linha de status, cabeçalhos e tamanho do bloco.
+#define RESERVA_FIM			8		//Depois do corpo: "\r\n" do bloco e o bloco final "0\r\n\r\n".
+#define PILHA_TASK			4096	//As rotas formatam com printf na pilha do servidor.
+#define TIMEOUT_ENVIO_MS	2000
+#define FILA_ACCEPT			2
+
+/* Conexão persistente: o buffer guarda os bytes recebidos até formarem um pedido completo. */
+typedef struct {
+	int sock;					//-1: livre.
+	uint16_t recebidos;
+	int64_t ultimo;				//Instante do último recebimento (us).
+	char *buf;					//tamanho_pedido + 1 bytes (terminador).
+} conexao_t;
+
+/* Resposta em montagem. Uma única task atende todas as conexões, então há um único buffer. */
+typedef struct {
+	int sock;
+	int status;
+	const char *tipo;
+	bool manter;				//Keep-alive: a conexão continua aberta após a resposta.
+	bool blocos;				//Cabeçalhos já enviados com Transfer-Encoding: chunked.
+	bool falha;					//Envio falhou: o restante é descartado e a conexão fechada.
+	size_t usado;
+} resposta_t;
+
+typedef struct {
+	uint32_t metodos;
+	const char *caminho;
+	http_local_cb_t cb;
+	void *arg;
+} rota_t;
+
+/* Variáveis Globais */
+static const char * TAG = "http_local";
+static http_local_config_t s_config;
+static rota_t s_rotas[HTTP_LOCAL_MAX_ROTAS];
+static size_t s_num_rotas;
+static conexao_t s_conexoes[HTTP_LOCAL_MAX_CONEXOES];
+static char *s_buffer;					//RESERVA_CABECALHO + tamanho_resposta + RESERVA_FIM bytes.
+static char *s_corpo;					//s_buffer + RESERVA_CABECALHO.
+static resposta_t s_resposta;
+static http_local_stats_t s_stats;		//Escrito somente pela task; a leitura não é atômica.
+static bench_stats_t s_atendimento;		//us entre o pedido completo e o fim da resposta.
+
+static const char *texto_status( int status )
+{
+	switch( status )
+	{
+		case 200: return "OK";
+		case 400: return "Bad Request";
+		case 404: return "Not Found";
+		case 405: return "Method Not Allowed";
+		case 413: return "Payload Too Large";
+		case 500: return "Internal Server Error";
+		case 501: return "Not Implemented";
+		case 503: return "Service Unavailable";
+		default: return "";
+	}
+}
+
+static void inicia_resposta( int sock, bool manter )
+{
+	s_resposta = (resposta_t) {
+		.sock = sock,
+		.status = 200,
+		.tipo = "application/json",
+		.manter = manter,
+	};
+}
+
+static bool envia( const void *dados, size_t tamanho, int flags )
+{
+	const char *p = dados;
+	while( tamanho && !s_resposta.falha )
+	{
+		int n = send( s_resposta.sock, p, tamanho, flags );
+		if( n <= 0 )
+		{
+			s_resposta.falha = true;
+			s_stats.erros++;
+			break;
+		}
+		p += n;
+		tamanho -= n;
+		s_stats.bytes_enviados += n;
+	}
+	return !s_resposta.falha;
+}
+
+/* Linha de status e cabeçalhos; "comprimento" negativo para o envio em blocos. */
+static int cabecalho( char *destino, size_t tamanho, int comprimento )
+{
+	int n = snprintf( destino, tamanho, "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nConnection: %s\r\n",
+					  s_resposta.status, texto_status( s_resposta.status ), s_resposta.tipo,
+					  s_resposta.manter ? "keep-alive" : "close" );
+	if( comprimento < 0 )
+		n += snprintf( destino + n, tamanho - n, "Transfer-Encoding: chunked\r\n\r\n" );
+	else
+		n += snprintf( destino + n, tamanho - n, "Content-Length: %d\r\n\r\n", comprimento );
+	return n < (int) tamanho ? n : (int) tamanho - 1;
+}
+
+/*
+	Envia o conteúdo do buffer. Os cabeçalhos e o tamanho do bloco são copiados para a reserva logo
+	antes do corpo, então cada resposta (ou bloco) sai em um único send, direto do buffer onde o
+	corpo foi formatado. Uma resposta que coube inteira no buffer sai com Content-Length.
+*/
+static void envia_bloco( bool final )
+{
+	char prefixo[RESERVA_CABECALHO];
+	size_t usado = s_resposta.usado;
+	char *fim = s_corpo + usado;
+	int n = 0;
+
+	s_resposta.usado = 0;
+	if( !s_resposta.blocos )
+	{
+		if( final )
+		{
+			n = cabecalho( prefixo, sizeof( prefixo ), usado );
+			memcpy( s_corpo - n, prefixo, n );
+			envia( s_corpo - n, n + usado, 0 );
+			return;
+		}
+		n = cabecalho( prefixo, sizeof( prefixo ) - 8, -1 ); //8: tamanho do bloco em hexadecimal.
+		s_resposta.blocos = true;
+		s_stats.respostas_blocos++;
+	}
+	if( usado )
+	{
+		n += sprintf( prefixo + n, "%x\r\n", (unsigned) usado );
+		memcpy( fim, "\r\n", 2 );
+		fim += 2;
+	}
+	if( final )
+	{
+		memcpy( fim, "0\r\n\r\n", 5 );
+		fim += 5;
+	}
+	memcpy( s_corpo - n, prefixo, n );
+	envia( s_corpo - n, fim - ( s_corpo - n ), 0 );
+}
+
+void http_local_status( int status, const char *tipo )
+{
+	if( s_resposta.blocos )
+		return;
+	s_resposta.status = status;
+	s_resposta.tipo = tipo;
+}
+
+void http_local_printf( const char *formato, ... )
+{
+	va_list args;
+	for( int tentativa = 0; tentativa < 2; tentativa++ )
+	{
+		size_t livre = s_config.tamanho_resposta - s_resposta.usado;
+		va_start( args, formato );
+		//O terminador cai na reserva do fim e é sobrescrito no envio.
+		int n = vsnprintf( s_corpo + s_resposta.usado, livre + 1, formato, args );
+		va_end( args );
+		if( n < 0 )
+			return;
+		if( (size_t) n <= livre )
+		{
+			s_resposta.usado += n;
+			return;
+		}
+		if( s_resposta.usado == 0 )
+			break;
+		envia_bloco( false );
+	}
+	ESP_LOGW( TAG, "Texto maior que a resposta (%u bytes) truncado", s_config.tamanho_resposta );
+	s_resposta.usado = s_config.tamanho_resposta;
+}
+
+void http_local_escrever( const void *dados, size_t tamanho )
+{
+	if( tamanho <= s_config.tamanho_resposta - s_resposta.usado )
+	{
+		memcpy( s_corpo + s_resposta.usado, dados, tamanho );
+		s_resposta.usado += tamanho;
+		return;
+	}
+	//O que está no buffer segue antes; os dados vão em um bloco próprio, da memória do chamador.
+	char tamanho_bloco[12];
+	envia_bloco( false );
+	envia( tamanho_bloco, sprintf( tamanho_bloco, "%x\r\n", (unsigned) tamanho ), MSG_MORE );
+	envia( dados, tamanho, MSG_MORE );
+	envia( "\r\n", 2, 0 );
+}
+
+void http_local_json_texto( const char *texto )
+{
+	http_local_escrever( "\"", 1 );
+	for( const char *p = texto; *p; p++ )
+	{
+		if( *p == '"' || *p == '\\' )
+		{
+			const char escape[2] = { '\\', *p };
+			http_local_escrever( escape, 2 );
+		}
+		else if( (unsigned char) *p < 0x20 )
+			http_local_printf( "\\u%04x", *p );
+		else
+			http_local_escrever( p, 1 );
+	}
+	http_local_escrever( "\"", 1 );
+}
+
+static void erro( int status )
+{
+	if( status < 500 )
+		s_stats.erros++;
+	http_local_status( status, "text/plain" );
+	http_local_printf( "%d %s\n", status, texto_status( status ) );
+}
+
+static int valor_hex( char c )
+{
+	if( c >= '0' && c <= '9' )
+		return c - '0';
+	if( c >= 'a' && c <= 'f' )
+		return c - 'a' + 10;
+	if( c >= 'A' && c <= 'F' )
+		return c - 'A' + 10;
+	return -1;
+}
+
+static void decodifica( const char *inicio, const char *fim, char *valor, size_t tamanho )
+{
+	size_t n = 0;
+	while( inicio < fim && n + 1 < tamanho )
+	{
+		if( *inicio == '%' && fim - inicio >= 3 && valor_hex( inicio[1] ) >= 0 && valor_hex( inicio[2] ) >= 0 )
+		{
+			valor[n++] = valor_hex( inicio[1] ) << 4 | valor_hex( inicio[2] );
+			inicio += 3;
+		}
+		else
+		{
+			valor[n++] = *inicio == '+' ? ' ' : *inicio;
+			inicio++;
+		}
+	}
+	valor[n] = '\0';
+}
+
+static bool procura( const char *texto, const char *nome, char *valor, size_t tamanho )
+{
+	size_t n = strlen( nome );
+	const char *p = texto;
+	while( p != NULL && *p )
+	{
+		const char *fim = strchr( p, '&' );
+		if( fim == NULL )
+			fim = p + strlen( p );
+		if( strncmp( p, nome, n ) == 0 && ( p[n] == '=' || p + n == fim ) )
+		{
+			decodifica( p + n < fim ? p + n + 1 : fim, fim, valor, tamanho );
+			return true;
+		}
+		p = *fim ? fim + 1 : NULL;
+	}
+	return false;
+}
+
+bool http_local_parametro( const http_local_req_t *req, const char *nome, char *valor, size_t tamanho )
+{
+	if( tamanho == 0 )
+		return false;
+	return procura( req->consulta, nome, valor, tamanho )
+		|| ( req->metodo != HTTP_LOCAL_GET && procura( req->corpo, nome, valor, tamanho ) );
+}
+
+/* Valor de um cabeçalho do pedido (até o fim da linha), sem alterar o buffer. */
+static const char *valor_cabecalho( const char *inicio, const char *fim, const char *nome )
+{
+	size_t n = strlen( nome );
+	for( const char *linha = strstr( inicio, "\r\n" ); linha != NULL && linha < fim; linha = strstr( linha + 2, "\r\n" ) )
+	{
+		const char *p = linha + 2;
+		if( strncasecmp( p, nome, n ) == 0 && p[n] == ':' )
+		{
+			for( p += n + 1; *p == ' ' || *p == '\t'; p++ )
+				;
+			return p;
+		}
+	}
+	return NULL;
+}
+
+static void despacha( http_local_req_t *req )
+{
+	bool caminho_existe = false;
+	for( size_t i = 0; i < s_num_rotas; i++ )
+	{
+		if( strcmp( s_rotas[i].caminho, req->caminho ) != 0 )
+			continue;
+		caminho_existe = true;
+		if( s_rotas[i].metodos & req->metodo )
+		{
+			s_rotas[i].cb( req, s_rotas[i].arg );
+			return;
+		}
+	}
+	if( req->metodo == 0 )
+		erro( 501 );
+	else
+		erro( caminho_existe ? 405 : 404 );
+}
+
+/*
+	Atende os pedidos completos do buffer da conexão (vários, se o cliente enviou em sequência).
+	Os cabeçalhos são lidos no lugar: o pedido só é alterado depois de completo, para que a recepção
+	continue no mesmo buffer. Retorna false se a conexão deve ser fechada.
+*/
+static bool atende( conexao_t *c )
+{
+	while( 1 )
+	{
+		c->buf[c->recebidos] = '\0';
+		char *fim_cabecalho = strstr( c->buf, "\r\n\r\n" );
+		if( fim_cabecalho == NULL )
+		{
+			if( c->recebidos < s_config.tamanho_pedido )
+				return true; //Aguarda o restante.
+			inicia_resposta( c->sock, false );
+			erro( 413 );
+			envia_bloco( true );
+			return false;
+		}
+
+		const char *comprimento = valor_cabecalho( c->buf, fim_cabecalho, "Content-Length" );
+		size_t tamanho_corpo = comprimento ? strtoul( comprimento, NULL, 10 ) : 0;
+		size_t total = ( fim_cabecalho + 4 - c->buf ) + tamanho_corpo;
+		if( tamanho_corpo > s_config.tamanho_pedido || total > s_config.tamanho_pedido )
+		{
+			inicia_resposta( c->sock, false );
+			erro( 413 );
+			envia_bloco( true );
+			return false;
+		}
+		if( total > c->recebidos )
+			return true;
+
+		int64_t inicio = esp_timer_get_time();
+		const char *conexao = valor_cabecalho( c->buf, fim_cabecalho, "Connection" );
+		char *versao = NULL;
+		char salvo = c->buf[total]; //Primeiro byte do próximo pedido.
+		c->buf[total] = '\0';
+		*fim_cabecalho = '\0';
+
+		//Linha do pedido: "METODO /caminho?consulta HTTP/1.1".
+		http_local_req_t req = { .consulta = "", .corpo = fim_cabecalho + 4, .tamanho_corpo = tamanho_corpo };
+		char *linha_fim = strstr( c->buf, "\r\n" );
+		if( linha_fim != NULL )
+			*linha_fim = '\0';
+		char *alvo = strchr( c->buf, ' ' );
+		if( alvo != NULL )
+		{
+			*alvo++ = '\0';
+			versao = strchr( alvo, ' ' );
+		}
+		if( versao != NULL )
+		{
+			*versao++ = '\0';
+			char *consulta = strchr( alvo, '?' );
+			if( consulta != NULL )
+			{
+				*consulta++ = '\0';
+				req.consulta = consulta;
+			}
+			req.caminho = alvo;
+			if( strcmp( c->buf, "GET" ) == 0 )
+				req.metodo = HTTP_LOCAL_GET;
+			else if( strcmp( c->buf, "POST" ) == 0 )
+				req.metodo = HTTP_LOCAL_POST;
+			else if( strcmp( c->buf, "PUT" ) == 0 )
+				req.metodo = HTTP_LOCAL_PUT;
+		}
+
+		//HTTP/1.1 mantém a conexão por padrão; HTTP/1.0 somente com "Connection: keep-alive".
+		bool manter = versao != NULL && strcmp( versao, "HTTP/1.1" ) == 0;
+		if( conexao != NULL )
+			manter = strncasecmp( conexao, "close", 5 ) != 0
+				&& ( manter || strncasecmp( conexao, "keep-alive", 10 ) == 0 );
+		inicia_resposta( c->sock, manter );
+		if( versao == NULL )
+		{
+			s_resposta.manter = false;
+			erro( 400 );
+		}
+		else
+			despacha( &req );
+		//Contado antes do último bloco, que libera o cliente.
+		s_stats.pedidos++;
+		envia_bloco( true );
+		bench_stats_add( &s_atendimento, esp_timer_get_time() - inicio );
+
+		c->buf[total] = salvo;
+		c->recebidos -= total;
+		memmove( c->buf, c->buf + total, c->recebidos );
+		if( s_resposta.falha || !s_resposta.manter )
+			return false;
+	}
+}
+
+static void fecha( conexao_t *c )
+{
+	close( c->sock );
+	c->sock = -1;
+	c->recebidos = 0;
+}
+
+static void recebe( conexao_t *c )
+{
+	int n = recv( c->sock, c->buf + c->recebidos, s_config.tamanho_pedido - c->recebidos, 0 );
+	if( n <= 0 )
+	{
+		fecha( c ); //Fechada pelo cliente.
+		return;
+	}
+	c->recebidos += n;
+	c->ultimo = esp_timer_get_time();
+	if( !atende( c ) )
+		fecha( c );
+}
+
+static void aceita( int escuta )
+{
+	int sock = accept( escuta, NULL, NULL );
+	if( sock < 0 )
+		return;
+	//Respostas pequenas e blocos seguidos saem sem esperar o ACK do anterior (Nagle).
+	int um = 1;
+	struct timeval timeout = { .tv_sec = TIMEOUT_ENVIO_MS / 1000, .tv_usec = ( TIMEOUT_ENVIO_MS % 1000 ) * 1000 };
+	setsockopt( sock, IPPROTO_TCP, TCP_NODELAY, &um, sizeof( um ) );
+	setsockopt( sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+	for( int i = 0; i < s_config.max_conexoes; i++ )
+	{
+		if( s_conexoes[i].sock < 0 )
+		{
+			s_conexoes[i].sock = sock;
+			s_conexoes[i].recebidos = 0;
+			s_conexoes[i].ultimo = esp_timer_get_time();
+			s_stats.conexoes++;
+			return;
+		}
+	}
+	inicia_resposta( sock, false );
+	erro( 503 );
+	envia_bloco( true );
+	close( sock );
+	s_stats.recusadas++;
+}
+
+/*
+	Uma única task atende todas as conexões: select() espera por novos pedidos em qualquer uma delas
+	e só acorda antes disso para fechar a conexão ociosa mais antiga. Sem conexões abertas a espera
+	não tem prazo, então o servidor não impede o light sleep.
+*/
+static void task_http_local( void *pvParameter )
+{
+	struct sockaddr_in endereco = {
+		.sin_family = AF_INET,
+		.sin_port = htons( s_config.porta ),
+		.sin_addr.s_addr = htonl( INADDR_ANY ),
+	};
+	int um = 1;
+	int escuta = socket( AF_INET, SOCK_STREAM, IPPROTO_IP );
+	if( escuta >= 0 )
+		setsockopt( escuta, SOL_SOCKET, SO_REUSEADDR, &um, sizeof( um ) );
+	if( escuta < 0 || bind( escuta, (struct sockaddr*) &endereco, sizeof( endereco ) ) != 0
+		|| listen( escuta, FILA_ACCEPT ) != 0 )
+	{
+		ESP_LOGE( TAG, "Nao foi possivel escutar na porta %u", s_config.porta );
+		if( escuta >= 0 )
+			close( escuta );
+		vTaskDelete( NULL );
+	}
+	ESP_LOGI( TAG, "Servidor na porta %u (%u conexoes)", s_config.porta, s_config.max_conexoes );
+
+	while( 1 )
+	{
+		fd_set leitura;
+		int maior = escuta;
+		int64_t prazo = INT64_MAX;
+		FD_ZERO( &leitura );
+		FD_SET( escuta, &leitura );
+		for( int i = 0; i < s_config.max_conexoes; i++ )
+		{
+			conexao_t *c = &s_conexoes[i];
+			if( c->sock < 0 )
+				continue;
+			FD_SET( c->sock, &leitura );
+			if( c->sock > maior )
+				maior = c->sock;
+			if( c->ultimo + s_config.ocioso_ms * 1000LL < prazo )
+				prazo = c->ultimo + s_config.ocioso_ms * 1000LL;
+		}
+
+		struct timeval espera;
+		if( prazo != INT64_MAX )
+		{
+			int64_t falta = prazo - esp_timer_get_time();
+			if( falta < 0 )
+				falta = 0;
+			espera.tv_sec = falta / 1000000;
+			espera.tv_usec = falta % 1000000;
+		}
+		if( select( maior + 1, &leitura, NULL, NULL, prazo != INT64_MAX ? &espera : NULL ) < 0 )
+		{
+			vTaskDelay( 10 / portTICK_PERIOD_MS );
+			continue;
+		}
+
+		int64_t agora = esp_timer_get_time();
+		for( int i = 0; i < s_config.max_conexoes; i++ )
+		{
+			conexao_t *c = &s_conexoes[i];
+			if( c->sock < 0 )
+				continue;
+			if( FD_ISSET( c->sock, &leitura ) )
+				recebe( c );
+			else if( agora - c->ultimo >= s_config.ocioso_ms * 1000LL )
+			{
+				//Contada antes de fechar, que libera o cliente.
+				s_stats.ociosas++;
+				fecha( c );
+			}
+		}
+		//Depois das conexões abertas: uma que acabou de fechar libera a vaga para a nova.
+		if( FD_ISSET( escuta, &leitura ) )
+			aceita( escuta );
+	}
+}
+
+esp_err_t http_local_rota( uint32_t metodos, const char *caminho, http_local_cb_t cb, void *arg )
+{
+	if( metodos == 0 || caminho == NULL || cb == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( s_num_rotas >= HTTP_LOCAL_MAX_ROTAS )
+		return ESP_ERR_NO_MEM;
+	s_rotas[s_num_rotas++] = (rota_t) { metodos, caminho, cb, arg };
+	return ESP_OK;
+}
+
+esp_err_t http_local_iniciar( const http_local_config_t *config )
+{
+	if( config == NULL || config->max_conexoes == 0 || config->max_conexoes > HTTP_LOCAL_MAX_CONEXOES
+		|| config->tamanho_pedido < 128 || config->tamanho_resposta < 128 || config->ocioso_ms == 0 )
+		return ESP_ERR_INVALID_ARG;
+	s_config = *config;
+
+	char *pedidos = tarefas_memoria( "http_local", (size_t) config->max_conexoes * ( config->tamanho_pedido + 1 ) );
+	s_buffer = tarefas_memoria( "http_local", RESERVA_CABECALHO + config->tamanho_resposta + RESERVA_FIM );
+	if( pedidos == NULL || s_buffer == NULL )
+		return ESP_ERR_NO_MEM;
+	s_corpo = s_buffer + RESERVA_CABECALHO;
+	for( int i = 0; i < HTTP_LOCAL_MAX_CONEXOES; i++ )
+	{
+		s_conexoes[i].sock = -1;
+		s_conexoes[i].buf = i < config->max_conexoes ? pedidos + i * ( config->tamanho_pedido + 1 ) : NULL;
+	}
+	bench_stats_init( &s_atendimento, "atendimento HTTP" );
+
+	if( tarefas_task( "http_local", task_http_local, "task_http_local", PILHA_TASK, NULL, config->prioridade,
+					  config->nucleo ) == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+}
+
+void http_local_estatisticas( http_local_stats_t *stats )
+{
+	*stats = s_stats;
+}
+
+void http_local_relatorio( void )
+{
+	http_local_stats_t st;
+	http_local_estatisticas( &st );
+	ESP_LOGI( TAG, "%u pedidos em %u conexoes (%u recusadas, %u fechadas por ociosidade), %u em blocos, %u erros, %u bytes",
+			  st.pedidos, st.conexoes, st.recusadas, st.ociosas, st.respostas_blocos, st.erros, st.bytes_enviados );
+	bench_stats_report( &s_atendimento, "us" );
+}
+
+void http_local_json_estatisticas( void )
+{
+	http_local_printf( "{\"conexoes\":%u,\"recusadas\":%u,\"ociosas\":%u,\"pedidos\":%u,\"blocos\":%u,\"erros\":%u,"
+					   "\"bytes\":%u,\"atendimento_us\":{\"p50\":%u,\"p90\":%u,\"p99\":%u,\"max\":%u}}",
+					   s_stats.conexoes, s_stats.recusadas, s_stats.ociosas, s_stats.pedidos, s_stats.respostas_blocos,
+					   s_stats.erros, s_stats.bytes_enviados, bench_stats_percentil( &s_atendimento, 50 ),
+					   bench_stats_percentil( &s_atendimento, 90 ), bench_stats_percentil( &s_atendimento, 99 ),
+					   s_atendimento.maximo );
+}
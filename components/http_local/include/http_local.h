@@ -0,0 +1,112 @@
+/*
+	Objetivo: Servidor HTTP/1.1 local para estado e controle - conexões persistentes, buffers
+			  pré-alocados, respostas montadas no lugar e envio em blocos (chunked)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HTTP_LOCAL_MAX_CONEXOES	8
+#define HTTP_LOCAL_MAX_ROTAS	16
+
+/* Métodos aceitos (máscara em http_local_rota). */
+typedef enum {
+	HTTP_LOCAL_GET	= 1 << 0,
+	HTTP_LOCAL_POST	= 1 << 1,
+	HTTP_LOCAL_PUT	= 1 << 2,
+} http_local_metodo_t;
+
+typedef struct {
+	uint16_t porta;
+	uint8_t max_conexoes;		//Conexões persistentes simultâneas (até HTTP_LOCAL_MAX_CONEXOES); a seguinte recebe 503.
+	uint16_t tamanho_pedido;	//Buffer de recepção de cada conexão: linha do pedido, cabeçalhos e corpo.
+	uint16_t tamanho_resposta;	//Corpo montado antes do envio; respostas maiores seguem em blocos deste tamanho.
+	uint32_t ocioso_ms;			//Conexão sem pedidos por este tempo é fechada.
+	UBaseType_t prioridade;
+	BaseType_t nucleo;
+} http_local_config_t;
+
+/*
+	Pedido entregue à rota. As strings apontam para o buffer de recepção da conexão (sem cópia) e
+	valem somente durante a chamada.
+*/
+typedef struct {
+	http_local_metodo_t metodo;
+	const char *caminho;		//Sem a consulta.
+	const char *consulta;		//Texto após o '?' ("" sem consulta).
+	const char *corpo;			//"" sem corpo; terminado em '\0'.
+	size_t tamanho_corpo;
+} http_local_req_t;
+
+/*
+	Rota: escreve a resposta com http_local_status (opcional, padrão 200 application/json),
+	http_local_printf e http_local_escrever, que só podem ser chamadas dentro de uma rota (task do
+	servidor). O servidor termina a resposta no retorno.
+*/
+typedef void (*http_local_cb_t)( const http_local_req_t *req, void *arg );
+
+typedef struct {
+	uint32_t conexoes;			//Aceitas.
+	uint32_t recusadas;			//503 por falta de conexão livre.
+	uint32_t ociosas;			//Fechadas por "ocioso_ms".
+	uint32_t pedidos;
+	uint32_t respostas_blocos;	//Respostas maiores que "tamanho_resposta" (chunked).
+	uint32_t erros;				//Pedidos inválidos (4xx) e falhas de envio.
+	uint32_t bytes_enviados;
+} http_local_stats_t;
+
+/* Registra uma rota para os métodos da máscara. Chamar antes de http_local_iniciar. */
+esp_err_t http_local_rota( uint32_t metodos, const char *caminho, http_local_cb_t cb, void *arg );
+
+/*
+	Aloca os buffers das conexões e da resposta (todos aqui, uma única vez) e cria a task do
+	servidor, que atende todas as conexões com select(). Pode ser chamada antes do IP: o socket
+	escuta em todos os endereços.
+*/
+esp_err_t http_local_iniciar( const http_local_config_t *config );
+
+/* Código e Content-Type da resposta; sem efeito depois que o primeiro bloco foi enviado. */
+void http_local_status( int status, const char *tipo );
+
+/*
+	Formata direto no buffer da resposta. Se não couber, o que já foi escrito segue como o primeiro
+	bloco (chunked) e a formatação é refeita no buffer vazio. Um único texto maior que o buffer é
+	truncado.
+*/
+void http_local_printf( const char *formato, ... ) __attribute__( ( format( printf, 1, 2 ) ) );
+
+/* Acrescenta bytes à resposta; um bloco maior que o espaço livre é enviado da memória do chamador, sem cópia. */
+void http_local_escrever( const void *dados, size_t tamanho );
+
+/* Escreve "texto" entre aspas, com aspas, barras e caracteres de controle escapados (JSON). */
+void http_local_json_texto( const char *texto );
+
+/*
+	Valor de "nome" na consulta ou, em POST/PUT, no corpo (application/x-www-form-urlencoded),
+	decodificado (%XX e '+') em "valor". Retorna false se o nome não existir.
+*/
+bool http_local_parametro( const http_local_req_t *req, const char *nome, char *valor, size_t tamanho );
+
+/* Cópia dos contadores. */
+void http_local_estatisticas( http_local_stats_t *stats );
+
+/* Imprime os contadores e o histograma do tempo de atendimento de cada pedido (us). */
+void http_local_relatorio( void );
+
+/* Escreve na resposta os contadores e os percentis do tempo de atendimento em JSON (rota de diagnóstico). */
+void http_local_json_estatisticas( void );
+
+#ifdef __cplusplus
+}
+#endif
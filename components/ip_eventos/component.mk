@@ -0,0 +1,4 @@
+#
+# Notificação de mudanças de IP e de enlace do WiFi por assinatura.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
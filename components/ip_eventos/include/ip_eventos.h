@@ -0,0 +1,61 @@
+/*
+	Objetivo: Notificação de mudanças de IP e de enlace do WiFi (station) por callback ou fila
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_err.h"
+#include "esp_netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IP_EVENTOS_MAX_ASSINANTES	8
+
+typedef enum {
+	IP_EVENTOS_GOT_IP		= 1 << 0,	//IP_EVENT_STA_GOT_IP
+	IP_EVENTOS_LOST_IP		= 1 << 1,	//IP_EVENT_STA_LOST_IP
+	IP_EVENTOS_LINK_UP		= 1 << 2,	//WIFI_EVENT_STA_CONNECTED
+	IP_EVENTOS_LINK_DOWN	= 1 << 3,	//WIFI_EVENT_STA_DISCONNECTED (somente com o enlace ativo)
+} ip_eventos_tipo_t;
+
+#define IP_EVENTOS_TODOS	( IP_EVENTOS_GOT_IP | IP_EVENTOS_LOST_IP | IP_EVENTOS_LINK_UP | IP_EVENTOS_LINK_DOWN )
+
+typedef struct {
+	ip_eventos_tipo_t tipo;
+	bool ip_mudou;					//Endereço, máscara ou gateway diferente do anterior.
+	esp_netif_ip_info_t anterior;	//Último IP conhecido (zerado se nunca houve).
+	esp_netif_ip_info_t atual;		//IP após o evento (zerado em LOST_IP).
+} ip_eventos_t;
+
+/* Executado na task do event loop: não deve bloquear nem assinar/cancelar assinaturas. */
+typedef void (*ip_eventos_cb_t)( const ip_eventos_t *evento, void *arg );
+
+/* Registra os handlers no event loop padrão (chamar após esp_event_loop_create_default()). */
+esp_err_t ip_eventos_iniciar( void );
+
+/* Assina os eventos da máscara (ip_eventos_tipo_t) com um callback. */
+esp_err_t ip_eventos_assinar( uint32_t mascara, ip_eventos_cb_t callback, void *arg );
+
+/*
+	Assina os eventos da máscara com uma fila de ip_eventos_t. O envio não bloqueia: com a fila
+	cheia o evento é descartado para essa fila.
+*/
+esp_err_t ip_eventos_assinar_fila( uint32_t mascara, QueueHandle_t fila );
+
+/* Remove a assinatura (callback ou fila) registrada anteriormente. */
+esp_err_t ip_eventos_cancelar( ip_eventos_cb_t callback, QueueHandle_t fila );
+
+/* IP atual; retorna false sem IP válido. */
+bool ip_eventos_ip_atual( esp_netif_ip_info_t *ip_info );
+
+#ifdef __cplusplus
+}
+#endif
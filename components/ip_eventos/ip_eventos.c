@@ -0,0 +1,181 @@
+/*
+	Objetivo: Notificação de mudanças de IP e de enlace do WiFi (station) por callback ou fila
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_wifi.h"
+#include "tarefas.h"
+#include "ip_eventos.h"
+
+/* Assinatura: callback ou fila (exclusivos) */
+typedef struct {
+	uint32_t mascara;
+	ip_eventos_cb_t callback;
+	void *arg;
+	QueueHandle_t fila;
+} assinante_t;
+
+/* Variáveis Globais */
+static const char * TAG = "ip_eventos";
+
+static SemaphoreHandle_t s_mutex;
+static assinante_t s_assinantes[IP_EVENTOS_MAX_ASSINANTES];
+/*	Estado alterado somente pela task do event loop; s_ip e s_tem_ip também são lidos por
+	ip_eventos_ip_atual() de outras tasks, sob s_lock (os callbacks rodam com s_mutex tomado). */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_netif_ip_info_t s_ip;
+static bool s_tem_ip;
+static bool s_enlace;
+
+static void publica( ip_eventos_t *evento )
+{
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	for( size_t i = 0; i < IP_EVENTOS_MAX_ASSINANTES; i++ )
+	{
+		assinante_t *a = &s_assinantes[i];
+		if( !( a->mascara & evento->tipo ) )
+			continue;
+		if( a->callback )
+			a->callback( evento, a->arg );
+		else if( xQueueSend( a->fila, evento, 0 ) != pdTRUE )
+			ESP_LOGW( TAG, "Fila cheia, evento %d descartado", evento->tipo );
+	}
+	xSemaphoreGive( s_mutex );
+}
+
+static void ip_eventos_handler( void *arg, esp_event_base_t base, int32_t id, void *dados )
+{
+	ip_eventos_t evento = { .anterior = s_ip };
+
+	if( base == WIFI_EVENT && id == WIFI_EVENT_STA_CONNECTED )
+	{
+		s_enlace = true;
+		evento.tipo = IP_EVENTOS_LINK_UP;
+		evento.atual = s_ip;
+	}
+	else if( base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED )
+	{
+		//Cada tentativa de conexão sem sucesso também gera este evento: só publica a queda do enlace.
+		if( !s_enlace )
+			return;
+		s_enlace = false;
+		evento.tipo = IP_EVENTOS_LINK_DOWN;
+		evento.atual = s_ip;
+	}
+	else if( base == IP_EVENT && id == IP_EVENT_STA_GOT_IP )
+	{
+		const ip_event_got_ip_t *got_ip = (const ip_event_got_ip_t*) dados;
+		evento.tipo = IP_EVENTOS_GOT_IP;
+		evento.atual = got_ip->ip_info;
+		evento.ip_mudou = memcmp( &s_ip, &got_ip->ip_info, sizeof( s_ip ) ) != 0;
+		portENTER_CRITICAL( &s_lock );
+		s_ip = got_ip->ip_info;
+		s_tem_ip = true;
+		portEXIT_CRITICAL( &s_lock );
+	}
+	else if( base == IP_EVENT && id == IP_EVENT_STA_LOST_IP )
+	{
+		evento.tipo = IP_EVENTOS_LOST_IP;
+		evento.ip_mudou = true;
+		portENTER_CRITICAL( &s_lock );
+		memset( &s_ip, 0, sizeof( s_ip ) );
+		s_tem_ip = false;
+		portEXIT_CRITICAL( &s_lock );
+	}
+	else
+		return;
+
+	publica( &evento );
+}
+
+esp_err_t ip_eventos_iniciar( void )
+{
+	if( s_mutex != NULL )
+		return ESP_ERR_INVALID_STATE;
+	s_mutex = tarefas_mutex( "ip_eventos" );
+	if( s_mutex == NULL )
+		return ESP_ERR_NO_MEM;
+
+	esp_err_t ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &ip_eventos_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &ip_eventos_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( IP_EVENT, IP_EVENT_STA_GOT_IP, &ip_eventos_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( IP_EVENT, IP_EVENT_STA_LOST_IP, &ip_eventos_handler, NULL );
+	return ret;
+}
+
+static esp_err_t adiciona( const assinante_t *novo )
+{
+	if( s_mutex == NULL )
+		return ESP_ERR_INVALID_STATE;
+	if( novo->mascara == 0 )
+		return ESP_ERR_INVALID_ARG;
+
+	esp_err_t ret = ESP_ERR_NO_MEM;
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	for( size_t i = 0; i < IP_EVENTOS_MAX_ASSINANTES; i++ )
+	{
+		if( s_assinantes[i].mascara == 0 )
+		{
+			s_assinantes[i] = *novo;
+			ret = ESP_OK;
+			break;
+		}
+	}
+	xSemaphoreGive( s_mutex );
+	return ret;
+}
+
+esp_err_t ip_eventos_assinar( uint32_t mascara, ip_eventos_cb_t callback, void *arg )
+{
+	if( callback == NULL )
+		return ESP_ERR_INVALID_ARG;
+	assinante_t novo = { .mascara = mascara, .callback = callback, .arg = arg };
+	return adiciona( &novo );
+}
+
+esp_err_t ip_eventos_assinar_fila( uint32_t mascara, QueueHandle_t fila )
+{
+	if( fila == NULL )
+		return ESP_ERR_INVALID_ARG;
+	assinante_t novo = { .mascara = mascara, .fila = fila };
+	return adiciona( &novo );
+}
+
+esp_err_t ip_eventos_cancelar( ip_eventos_cb_t callback, QueueHandle_t fila )
+{
+	if( s_mutex == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	esp_err_t ret = ESP_ERR_NOT_FOUND;
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	for( size_t i = 0; i < IP_EVENTOS_MAX_ASSINANTES; i++ )
+	{
+		assinante_t *a = &s_assinantes[i];
+		if( a->mascara && ( ( callback && a->callback == callback ) || ( fila && a->fila == fila ) ) )
+		{
+			memset( a, 0, sizeof( *a ) );
+			ret = ESP_OK;
+		}
+	}
+	xSemaphoreGive( s_mutex );
+	return ret;
+}
+
+bool ip_eventos_ip_atual( esp_netif_ip_info_t *ip_info )
+{
+	portENTER_CRITICAL( &s_lock );
+	*ip_info = s_ip;
+	bool tem_ip = s_tem_ip;
+	portEXIT_CRITICAL( &s_lock );
+	return tem_ip;
+}
@@ -0,0 +1,4 @@
+#
+# LED RGB por PWM (LEDC) com fades em hardware e fila de animações.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,62 @@
+/*
+	Objetivo: LED RGB por PWM (LEDC) com fades executados pelo hardware e fila de animações
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/ledc.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Quadro-chave de uma animação: cor de destino (0 a 255 por canal), duração do fade e tempo parado. */
+typedef struct {
+	uint8_t r;
+	uint8_t g;
+	uint8_t b;
+	uint16_t fade_ms;		//0: troca imediata.
+	uint16_t espera_ms;		//Tempo na cor de destino antes do próximo quadro.
+} led_rgb_quadro_t;
+
+/* Padrões de status usados pelos exemplos. */
+typedef enum {
+	LED_RGB_DESLIGADO,
+	LED_RGB_CONECTANDO,		//Azul "respirando".
+	LED_RGB_CONECTADO,		//Verde por 3 s, depois apagado (sem impedir o light sleep).
+	LED_RGB_FALHA,			//Vermelho piscando.
+} led_rgb_padrao_t;
+
+/*
+	Liga LED_R, LED_G e LED_B (placa.h) a três canais do LEDC com a resolução (LEDC_TIMER_8_BIT a
+	LEDC_TIMER_13_BIT) e a frequência pedidas, e cria a task que executa as animações. Depois desta
+	chamada os pinos deixam de responder a gpio_set_level e gpio_write_mask.
+*/
+esp_err_t led_rgb_iniciar( ledc_timer_bit_t resolucao, uint32_t frequencia_hz, UBaseType_t prioridade );
+
+/*
+	Substitui a animação atual, sem bloquear (pode ser chamada de callbacks do event loop). Os quadros
+	devem existir enquanto a animação estiver em uso. Cada fade é feito pelo LEDC: a task só acorda
+	na interrupção de fim do fade e no fim da espera de cada quadro, sem trabalho por passo.
+*/
+esp_err_t led_rgb_animacao( const led_rgb_quadro_t *quadros, size_t n, bool repetir );
+
+/* Fade único até a cor pedida, mantida até a próxima animação. */
+esp_err_t led_rgb_cor( uint8_t r, uint8_t g, uint8_t b, uint16_t fade_ms );
+
+/* Inicia um dos padrões de status. */
+esp_err_t led_rgb_padrao( led_rgb_padrao_t padrao );
+
+/* Cor atual dos três canais (0 a 255), lida do LEDC: durante um fade, o ponto em que ele está. */
+void led_rgb_atual( uint8_t cor[3] );
+
+#ifdef __cplusplus
+}
+#endif
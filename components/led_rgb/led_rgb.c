@@ -0,0 +1,267 @@
+/*
+	Objetivo: LED RGB por PWM (LEDC) com fades executados pelo hardware e fila de animações
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "esp_log.h"
+#include "esp_pm.h"
+#include "placa.h"
+#include "tarefas.h"
+#include "led_rgb.h"
+
+/* Definições e Constantes */
+#define MODO			LEDC_HIGH_SPEED_MODE
+#define TIMER			LEDC_TIMER_0
+#define NUM_CANAIS		3
+#define CLOCK_LEDC_HZ	80000000	//APB: frequência * 2^resolução não pode passar disso.
+
+/* Animação enviada à task. Uma cor única é levada no próprio comando (quadros == NULL). */
+typedef struct {
+	const led_rgb_quadro_t *quadros;
+	size_t n;
+	bool repetir;
+	led_rgb_quadro_t unico;
+} animacao_t;
+
+/* Variáveis Globais */
+static const char * TAG = "led_rgb";
+static const gpio_num_t s_pinos[NUM_CANAIS] = { LED_R, LED_G, LED_B };
+static QueueHandle_t s_fila;		//Uma posição: a animação mais recente substitui a pendente.
+static uint32_t s_duty_max;
+static uint32_t s_duty[NUM_CANAIS];	//Duty atual de cada canal (escrito somente pela task).
+static esp_pm_lock_handle_t s_lock;	//APB em 80 MHz enquanto o LED está aceso (NULL sem CONFIG_PM_ENABLE).
+static bool s_lock_ativo;
+
+static const led_rgb_quadro_t s_conectando[] = {
+	{ 0, 0, 255, 1000, 0 },
+	{ 0, 0, 16,  1000, 0 },
+};
+static const led_rgb_quadro_t s_conectado[] = {
+	{ 0, 255, 0, 300, 3000 },
+	{ 0, 0,   0, 300, 0 },
+};
+static const led_rgb_quadro_t s_falha[] = {
+	{ 255, 0, 0, 0, 200 },
+	{ 0,   0, 0, 0, 800 },
+};
+
+static uint32_t duty_de( uint8_t cor )
+{
+	return (uint32_t) cor * s_duty_max / 255;
+}
+
+/*
+	O LEDC usa o clock do APB: com o gerenciamento de energia ativo, o lock mantém a frequência do PWM
+	(e impede o light sleep) somente enquanto algum canal estiver aceso ou em fade.
+*/
+static void mantem_apb( bool aceso )
+{
+	if( s_lock == NULL || aceso == s_lock_ativo )
+		return;
+	if( aceso )
+		esp_pm_lock_acquire( s_lock );
+	else
+		esp_pm_lock_release( s_lock );
+	s_lock_ativo = aceso;
+}
+
+/*
+	Inicia o fade dos três canais. O canal com a maior variação é disparado por último e aguardado:
+	o bloqueio termina na interrupção de fim de fade do LEDC, sem a CPU acompanhar os passos.
+*/
+static void aplica( const led_rgb_quadro_t *q )
+{
+	const uint8_t cor[NUM_CANAIS] = { q->r, q->g, q->b };
+	uint32_t destino[NUM_CANAIS];
+	int maior = -1;
+	uint32_t maior_delta = 0;
+
+	for( int i = 0; i < NUM_CANAIS; i++ )
+	{
+		destino[i] = duty_de( cor[i] );
+		if( destino[i] || s_duty[i] )
+			mantem_apb( true );
+		uint32_t delta = destino[i] > s_duty[i] ? destino[i] - s_duty[i] : s_duty[i] - destino[i];
+		if( delta > maior_delta )
+		{
+			maior_delta = delta;
+			maior = i;
+		}
+	}
+
+	for( int i = 0; i < NUM_CANAIS; i++ )
+	{
+		if( destino[i] == s_duty[i] || i == maior )
+			continue;
+		if( q->fade_ms )
+		{
+			ledc_set_fade_with_time( MODO, i, destino[i], q->fade_ms );
+			ledc_fade_start( MODO, i, LEDC_FADE_NO_WAIT );
+		}
+		else
+		{
+			ledc_set_duty( MODO, i, destino[i] );
+			ledc_update_duty( MODO, i );
+		}
+		s_duty[i] = destino[i];
+	}
+
+	if( maior >= 0 )
+	{
+		if( q->fade_ms )
+		{
+			ledc_set_fade_with_time( MODO, maior, destino[maior], q->fade_ms );
+			ledc_fade_start( MODO, maior, LEDC_FADE_WAIT_DONE );
+		}
+		else
+		{
+			ledc_set_duty( MODO, maior, destino[maior] );
+			ledc_update_duty( MODO, maior );
+		}
+		s_duty[maior] = destino[maior];
+	}
+	else if( q->fade_ms )
+		vTaskDelay( q->fade_ms / portTICK_PERIOD_MS ); //Mesma cor: mantém a duração do quadro.
+
+	mantem_apb( s_duty[0] || s_duty[1] || s_duty[2] );
+}
+
+static void task_led_rgb( void *pvParameter )
+{
+	animacao_t atual = { 0 };
+	size_t quadro = 0;
+
+	while( 1 )
+	{
+		if( quadro >= atual.n )
+		{
+			if( atual.repetir && atual.n )
+				quadro = 0;
+			else
+			{
+				//Animação concluída: a task fica bloqueada até a próxima.
+				xQueueReceive( s_fila, &atual, portMAX_DELAY );
+				quadro = 0;
+				continue;
+			}
+		}
+
+		const led_rgb_quadro_t *q = atual.quadros ? &atual.quadros[quadro] : &atual.unico;
+		quadro++;
+		aplica( q );
+
+		//A espera do quadro é o próprio bloqueio na fila: uma nova animação interrompe a atual.
+		animacao_t nova;
+		if( xQueueReceive( s_fila, &nova, q->espera_ms / portTICK_PERIOD_MS ) )
+		{
+			atual = nova;
+			quadro = 0;
+		}
+	}
+}
+
+esp_err_t led_rgb_iniciar( ledc_timer_bit_t resolucao, uint32_t frequencia_hz, UBaseType_t prioridade )
+{
+	if( resolucao < LEDC_TIMER_8_BIT || resolucao > LEDC_TIMER_13_BIT || frequencia_hz == 0
+		|| (uint64_t) frequencia_hz << resolucao > CLOCK_LEDC_HZ )
+		return ESP_ERR_INVALID_ARG;
+	if( s_fila != NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	ledc_timer_config_t timer = {
+		.speed_mode = MODO,
+		.duty_resolution = resolucao,
+		.timer_num = TIMER,
+		.freq_hz = frequencia_hz,
+	};
+	esp_err_t ret = ledc_timer_config( &timer );
+	if( ret != ESP_OK )
+		return ret;
+	s_duty_max = ( 1 << resolucao ) - 1;
+
+	for( int i = 0; i < NUM_CANAIS; i++ )
+	{
+		ledc_channel_config_t canal = {
+			.gpio_num = s_pinos[i],
+			.speed_mode = MODO,
+			.channel = i,
+			.intr_type = LEDC_INTR_DISABLE,
+			.timer_sel = TIMER,
+			.duty = 0,
+			.hpoint = 0,
+		};
+		ret = ledc_channel_config( &canal );
+		if( ret != ESP_OK )
+			return ret;
+	}
+
+	//Instala a ISR de fim de fade usada por LEDC_FADE_WAIT_DONE.
+	ret = ledc_fade_func_install( 0 );
+	if( ret != ESP_OK )
+		return ret;
+
+	//Sem CONFIG_PM_ENABLE a criação falha e o lock não é usado.
+	if( esp_pm_lock_create( ESP_PM_APB_FREQ_MAX, 0, "led_rgb", &s_lock ) != ESP_OK )
+		s_lock = NULL;
+
+	s_fila = tarefas_fila( "led_rgb", 1, sizeof( animacao_t ) );
+	if( s_fila == NULL )
+		return ESP_ERR_NO_MEM;
+	if( tarefas_task( "led_rgb", task_led_rgb, "task_led_rgb", 2048, NULL, prioridade, tskNO_AFFINITY ) == NULL )
+		return ESP_ERR_NO_MEM;
+
+	ESP_LOGI( TAG, "LEDC com %u bits a %u Hz", (uint32_t) resolucao, frequencia_hz );
+	return ESP_OK;
+}
+
+static esp_err_t envia( const animacao_t *animacao )
+{
+	if( s_fila == NULL )
+		return ESP_ERR_INVALID_STATE;
+	xQueueOverwrite( s_fila, animacao );
+	return ESP_OK;
+}
+
+esp_err_t led_rgb_animacao( const led_rgb_quadro_t *quadros, size_t n, bool repetir )
+{
+	if( quadros == NULL || n == 0 )
+		return ESP_ERR_INVALID_ARG;
+	const animacao_t animacao = { .quadros = quadros, .n = n, .repetir = repetir };
+	return envia( &animacao );
+}
+
+esp_err_t led_rgb_cor( uint8_t r, uint8_t g, uint8_t b, uint16_t fade_ms )
+{
+	const animacao_t animacao = {
+		.n = 1,
+		.unico = { r, g, b, fade_ms, 0 },
+	};
+	return envia( &animacao );
+}
+
+esp_err_t led_rgb_padrao( led_rgb_padrao_t padrao )
+{
+	switch( padrao )
+	{
+		case LED_RGB_CONECTANDO:
+			return led_rgb_animacao( s_conectando, sizeof( s_conectando ) / sizeof( s_conectando[0] ), true );
+		case LED_RGB_CONECTADO:
+			return led_rgb_animacao( s_conectado, sizeof( s_conectado ) / sizeof( s_conectado[0] ), false );
+		case LED_RGB_FALHA:
+			return led_rgb_animacao( s_falha, sizeof( s_falha ) / sizeof( s_falha[0] ), true );
+		case LED_RGB_DESLIGADO:
+		default:
+			return led_rgb_cor( 0, 0, 0, 0 );
+	}
+}
+
+void led_rgb_atual( uint8_t cor[3] )
+{
+	for( int i = 0; i < NUM_CANAIS; i++ )
+		cor[i] = s_duty_max ? ledc_get_duty( MODO, i ) * 255 / s_duty_max : 0;
+}
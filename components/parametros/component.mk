@@ -0,0 +1,4 @@
+#
+# Parâmetros de configuração na NVS com cópia em RAM, gravação agrupada e aviso de alteração.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
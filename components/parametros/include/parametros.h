@@ -0,0 +1,120 @@
+/*
+	Objetivo: Parâmetros de configuração ajustáveis em campo - tabela tipada na NVS com cópia em RAM,
+			  gravações agrupadas, versão do esquema e aviso de alteração
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PARAMETROS_MAX			32		//Ids de 0 a 31 (bits das máscaras de assinatura).
+#define PARAMETROS_MAX_TEXTO	64		//Caracteres, sem o terminador (senha WPA2).
+#define PARAMETROS_MAX_ASSINANTES	4
+#define PARAMETROS_TODOS		0xFFFFFFFF
+#define PARAMETROS_NVS_NAMESPACE	"parametros"
+
+typedef enum {
+	PARAMETROS_INT = 0,		//int32_t entre "minimo" e "maximo".
+	PARAMETROS_TEXTO,		//Até "maximo" caracteres (no máximo PARAMETROS_MAX_TEXTO).
+	PARAMETROS_IP4,			//Endereço IPv4 na ordem da rede (esp_ip4_addr_t.addr); padrão em "a.b.c.d".
+} parametros_tipo_t;
+
+/* Linha da tabela de parâmetros; o índice na tabela é o id. */
+typedef struct {
+	const char *chave;			//Chave na NVS (até 15 caracteres).
+	parametros_tipo_t tipo;
+	int32_t padrao;				//INT.
+	const char *padrao_texto;	//TEXTO e IP4.
+	int32_t minimo;				//INT.
+	int32_t maximo;				//INT; TEXTO: comprimento máximo.
+	bool secreto;				//Não aparece no relatório nem nas listagens (ex.: senha).
+} parametros_def_t;
+
+/*
+	Conversão de uma versão anterior do esquema, chamada em parametros_iniciar() com a NVS aberta para
+	escrita (renomear ou converter chaves). As chaves que mantêm nome e tipo não precisam de migração.
+*/
+typedef esp_err_t (*parametros_migrar_t)( uint16_t versao_antiga, nvs_handle_t nvs );
+
+typedef struct {
+	const parametros_def_t *tabela;
+	size_t n;
+	uint16_t versao;				//Versão do esquema da tabela.
+	parametros_migrar_t migrar;		//Opcional (NULL).
+	uint32_t atraso_ms;				//Espera após a última alteração antes de gravar (agrupa rajadas).
+	uint32_t intervalo_min_ms;		//Intervalo mínimo entre duas gravações na flash.
+} parametros_config_t;
+
+/* Executado na task de quem alterou o parâmetro: não deve bloquear. */
+typedef void (*parametros_cb_t)( int id, void *arg );
+
+typedef struct {
+	uint32_t alteracoes;		//Chamadas de parametros_definir_* que mudaram o valor.
+	uint32_t gravacoes;			//nvs_commit feitos.
+	uint32_t escritas;			//Chaves escritas ou apagadas na NVS.
+} parametros_stats_t;
+
+/*
+	Carrega a tabela da NVS para a RAM. Chaves ausentes, com outro tipo ou fora dos limites ficam com o
+	valor padrão, que não é gravado: a NVS guarda somente o que foi alterado em campo. Se a versão
+	gravada for diferente de "versao", chama "migrar" e grava a nova versão. Requer nvs_flash_init().
+*/
+esp_err_t parametros_iniciar( const parametros_config_t *config );
+
+/* Leituras da cópia em RAM, O(1) e sem acesso à flash. */
+int32_t parametros_int( int id );
+uint32_t parametros_ip4( int id );
+
+/*
+	Copia o valor em texto (com terminador) para "destino": TEXTO como está, INT em decimal e IP4 em
+	"a.b.c.d". Retorna ESP_ERR_INVALID_SIZE se não couber.
+*/
+esp_err_t parametros_texto( int id, char *destino, size_t tamanho );
+
+/*
+	Alteram a cópia em RAM, avisam os assinantes e agendam a gravação: alterações seguidas dentro de
+	"atraso_ms" resultam em uma única gravação (na task do esp_timer), e somente as chaves com valor
+	diferente do gravado são escritas. parametros_definir_texto() aceita qualquer tipo: INT em decimal
+	e IP4 em "a.b.c.d".
+	Retornam ESP_ERR_INVALID_ARG para id, tipo ou valor inválido.
+*/
+esp_err_t parametros_definir_int( int id, int32_t valor );
+esp_err_t parametros_definir_ip4( int id, uint32_t endereco );
+esp_err_t parametros_definir_texto( int id, const char *texto );
+
+/* Volta o parâmetro ao valor padrão e apaga a chave da NVS. */
+esp_err_t parametros_restaurar( int id );
+
+/* Grava imediatamente as alterações pendentes (ex.: antes de um esp_restart()). */
+esp_err_t parametros_gravar( void );
+
+/* Avisa "callback" das alterações dos ids da máscara (bit 1 << id, ou PARAMETROS_TODOS). */
+esp_err_t parametros_assinar( uint32_t mascara, parametros_cb_t callback, void *arg );
+
+/* Número de parâmetros, chave e tipo do id (para quem lista a tabela, ex.: um servidor HTTP). */
+size_t parametros_quantidade( void );
+const parametros_def_t *parametros_definicao( int id );
+
+void parametros_estatisticas( parametros_stats_t *stats );
+void parametros_relatorio( void );
+
+/*
+	Benchmark no ESP32: ciclos de uma leitura da cópia em RAM contra a leitura direta da NVS para o
+	parâmetro inteiro "id_int" e o texto "id_texto", e entradas da NVS consumidas por alteração em uma
+	rajada de "alteracoes" escritas em "id_int" (o valor original é restaurado ao final).
+*/
+void parametros_benchmark( int id_int, int id_texto, uint32_t alteracoes );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,474 @@
+/*
+	Objetivo: Parâmetros de configuração ajustáveis em campo - tabela tipada na NVS com cópia em RAM,
+			  gravações agrupadas, versão do esquema e aviso de alteração
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "lwip/ip4_addr.h"
+#include "tarefas.h"
+#include "parametros.h"
+
+/* Definições e Constantes */
+#define NVS_CHAVE_VERSAO	"_versao"
+#define BIT_ID( id )		( 1u << ( id ) )
+
+/* Valor de um parâmetro (cópia em RAM e último valor gravado). */
+typedef union {
+	int32_t inteiro;
+	uint32_t ip4;
+	char texto[PARAMETROS_MAX_TEXTO + 1];
+} valor_t;
+
+typedef struct {
+	uint32_t mascara;
+	parametros_cb_t callback;
+	void *arg;
+} assinante_t;
+
+/* Variáveis Globais */
+static const char * TAG = "parametros";
+
+static parametros_config_t s_config;
+static valor_t *s_valores;				//Cópia em RAM, lida pela aplicação.
+static valor_t *s_gravados;				//Valor na NVS (ou o padrão, se a chave não existe).
+static uint32_t s_pendentes;			//Ids alterados desde a última gravação.
+static uint32_t s_apagar;				//Ids restaurados ao padrão: a chave é apagada.
+static bool s_agendado;
+static bool s_versao_gravada;
+static int64_t s_ultima_gravacao;		//Instante (us) da última gravação; 0 antes da primeira.
+static esp_timer_handle_t s_timer;
+static assinante_t s_assinantes[PARAMETROS_MAX_ASSINANTES];
+static parametros_stats_t s_stats;
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+
+static inline bool id_valido( int id )
+{
+	return id >= 0 && (size_t) id < s_config.n && s_valores != NULL;
+}
+
+static bool iguais( int id, const valor_t *a, const valor_t *b )
+{
+	if( s_config.tabela[id].tipo == PARAMETROS_TEXTO )
+		return strcmp( a->texto, b->texto ) == 0;
+	return a->inteiro == b->inteiro;
+}
+
+static void copia( int id, valor_t *destino, const valor_t *origem )
+{
+	if( s_config.tabela[id].tipo == PARAMETROS_TEXTO )
+		strlcpy( destino->texto, origem->texto, sizeof( destino->texto ) );
+	else
+		destino->inteiro = origem->inteiro;
+}
+
+static void padrao( int id, valor_t *valor )
+{
+	const parametros_def_t *d = &s_config.tabela[id];
+	memset( valor, 0, sizeof( *valor ) );
+	if( d->tipo == PARAMETROS_INT )
+		valor->inteiro = d->padrao;
+	else if( d->tipo == PARAMETROS_TEXTO && d->padrao_texto != NULL )
+		strlcpy( valor->texto, d->padrao_texto, sizeof( valor->texto ) );
+	else if( d->tipo == PARAMETROS_IP4 && d->padrao_texto != NULL )
+		ip4addr_aton( d->padrao_texto, (ip4_addr_t*) &valor->ip4 );
+}
+
+static bool valido( int id, const valor_t *valor )
+{
+	const parametros_def_t *d = &s_config.tabela[id];
+	if( d->tipo == PARAMETROS_INT )
+		return valor->inteiro >= d->minimo && valor->inteiro <= d->maximo;
+	if( d->tipo == PARAMETROS_TEXTO )
+		return strnlen( valor->texto, sizeof( valor->texto ) ) <= (size_t) d->maximo;
+	return true;
+}
+
+static void carrega( nvs_handle_t nvs, int id )
+{
+	const parametros_def_t *d = &s_config.tabela[id];
+	valor_t *valor = &s_valores[id];
+	size_t tamanho = sizeof( valor->texto );
+	esp_err_t ret;
+
+	if( d->tipo == PARAMETROS_INT )
+		ret = nvs_get_i32( nvs, d->chave, &valor->inteiro );
+	else if( d->tipo == PARAMETROS_TEXTO )
+		ret = nvs_get_str( nvs, d->chave, valor->texto, &tamanho );
+	else
+		ret = nvs_get_u32( nvs, d->chave, &valor->ip4 );
+
+	if( ret == ESP_OK && !valido( id, valor ) )
+		ret = ESP_ERR_INVALID_ARG;
+	if( ret != ESP_OK )
+	{
+		//Chave de outra versão do esquema (outro tipo ou tamanho) ou fora dos limites atuais.
+		if( ret != ESP_ERR_NVS_NOT_FOUND )
+			ESP_LOGW( TAG, "%s: valor da NVS invalido (%s), usando o padrao", d->chave, esp_err_to_name( ret ) );
+		padrao( id, valor );
+	}
+	copia( id, &s_gravados[id], valor );
+}
+
+static esp_err_t escreve( nvs_handle_t nvs, int id, const valor_t *valor )
+{
+	const parametros_def_t *d = &s_config.tabela[id];
+	if( d->tipo == PARAMETROS_INT )
+		return nvs_set_i32( nvs, d->chave, valor->inteiro );
+	if( d->tipo == PARAMETROS_TEXTO )
+		return nvs_set_str( nvs, d->chave, valor->texto );
+	return nvs_set_u32( nvs, d->chave, valor->ip4 );
+}
+
+/*
+	Agenda a gravação para "atraso_ms" após a primeira alteração pendente, respeitando o intervalo
+	mínimo desde a última gravação. A janela não é reiniciada pelas alterações seguintes, então uma
+	sequência contínua de alterações ainda é gravada a cada "atraso_ms".
+*/
+static void agenda( void )
+{
+	bool armar;
+	portENTER_CRITICAL( &s_mux );
+	armar = !s_agendado;
+	s_agendado = true;
+	portEXIT_CRITICAL( &s_mux );
+	if( !armar )
+		return;
+
+	int64_t agora = esp_timer_get_time();
+	int64_t quando = agora + (int64_t) s_config.atraso_ms * 1000;
+	int64_t minimo = s_ultima_gravacao + (int64_t) s_config.intervalo_min_ms * 1000;
+	if( s_ultima_gravacao && quando < minimo )
+		quando = minimo;
+	esp_timer_start_once( s_timer, quando - agora );
+}
+
+static void avisa( int id )
+{
+	assinante_t assinantes[PARAMETROS_MAX_ASSINANTES];
+	portENTER_CRITICAL( &s_mux );
+	memcpy( assinantes, s_assinantes, sizeof( assinantes ) );
+	portEXIT_CRITICAL( &s_mux );
+	for( int i = 0; i < PARAMETROS_MAX_ASSINANTES; i++ )
+		if( assinantes[i].mascara & BIT_ID( id ) )
+			assinantes[i].callback( id, assinantes[i].arg );
+}
+
+static esp_err_t altera( int id, const valor_t *novo )
+{
+	if( !valido( id, novo ) )
+		return ESP_ERR_INVALID_ARG;
+
+	bool mudou;
+	portENTER_CRITICAL( &s_mux );
+	mudou = !iguais( id, &s_valores[id], novo );
+	if( mudou )
+	{
+		copia( id, &s_valores[id], novo );
+		s_pendentes |= BIT_ID( id );
+		s_apagar &= ~BIT_ID( id );
+		s_stats.alteracoes++;
+	}
+	portEXIT_CRITICAL( &s_mux );
+
+	if( mudou )
+	{
+		agenda();
+		avisa( id );
+	}
+	return ESP_OK;
+}
+
+static void parametros_timer( void *arg )
+{
+	if( parametros_gravar() != ESP_OK )
+		ESP_LOGE( TAG, "Falha ao gravar os parametros; nova tentativa agendada" );
+}
+
+esp_err_t parametros_iniciar( const parametros_config_t *config )
+{
+	if( s_valores != NULL )
+		return ESP_ERR_INVALID_STATE;
+	if( config->tabela == NULL || config->n == 0 || config->n > PARAMETROS_MAX )
+		return ESP_ERR_INVALID_ARG;
+	for( size_t i = 0; i < config->n; i++ )
+	{
+		const parametros_def_t *d = &config->tabela[i];
+		if( d->chave == NULL || strlen( d->chave ) > NVS_KEY_NAME_MAX_SIZE - 1 || d->tipo > PARAMETROS_IP4
+			|| ( d->tipo == PARAMETROS_INT && ( d->padrao < d->minimo || d->padrao > d->maximo ) )
+			|| ( d->tipo == PARAMETROS_TEXTO && ( d->maximo < 0 || d->maximo > PARAMETROS_MAX_TEXTO ) ) )
+		{
+			ESP_LOGE( TAG, "Definicao invalida: id %zu (%s)", i, d->chave ? d->chave : "sem chave" );
+			return ESP_ERR_INVALID_ARG;
+		}
+	}
+
+	s_config = *config;
+	s_valores = tarefas_memoria( "parametros", 2 * config->n * sizeof( valor_t ) );
+	if( s_valores == NULL )
+		return ESP_ERR_NO_MEM;
+	s_gravados = s_valores + config->n;
+
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	if( ret != ESP_OK )
+	{
+		s_valores = NULL;
+		return ret;
+	}
+	uint16_t versao;
+	if( nvs_get_u16( nvs, NVS_CHAVE_VERSAO, &versao ) == ESP_OK )
+	{
+		s_versao_gravada = versao == config->versao;
+		if( !s_versao_gravada )
+		{
+			ESP_LOGW( TAG, "Esquema na NVS na versao %u, firmware na versao %u", versao, config->versao );
+			if( config->migrar != NULL && config->migrar( versao, nvs ) != ESP_OK )
+				ESP_LOGE( TAG, "Falha na migracao; as chaves incompativeis voltam ao padrao" );
+			if( nvs_set_u16( nvs, NVS_CHAVE_VERSAO, config->versao ) == ESP_OK && nvs_commit( nvs ) == ESP_OK )
+				s_versao_gravada = true;
+		}
+	}
+	for( size_t i = 0; i < config->n; i++ )
+		carrega( nvs, i );
+	nvs_close( nvs );
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = parametros_timer,
+		.name = "parametros",
+	};
+	ret = esp_timer_create( &timer_args, &s_timer );
+	if( ret != ESP_OK )
+		s_valores = NULL;
+	return ret;
+}
+
+int32_t parametros_int( int id )
+{
+	return id_valido( id ) ? s_valores[id].inteiro : 0;
+}
+
+uint32_t parametros_ip4( int id )
+{
+	return id_valido( id ) ? s_valores[id].ip4 : 0;
+}
+
+esp_err_t parametros_texto( int id, char *destino, size_t tamanho )
+{
+	if( !id_valido( id ) || tamanho == 0 )
+		return ESP_ERR_INVALID_ARG;
+
+	valor_t valor;
+	portENTER_CRITICAL( &s_mux );
+	copia( id, &valor, &s_valores[id] );
+	portEXIT_CRITICAL( &s_mux );
+
+	int n;
+	if( s_config.tabela[id].tipo == PARAMETROS_INT )
+		n = snprintf( destino, tamanho, "%d", valor.inteiro );
+	else if( s_config.tabela[id].tipo == PARAMETROS_IP4 )
+		n = ip4addr_ntoa_r( (const ip4_addr_t*) &valor.ip4, destino, tamanho ) ? strlen( destino ) : tamanho;
+	else
+		n = strlcpy( destino, valor.texto, tamanho );
+	return (size_t) n < tamanho ? ESP_OK : ESP_ERR_INVALID_SIZE;
+}
+
+esp_err_t parametros_definir_int( int id, int32_t valor )
+{
+	if( !id_valido( id ) || s_config.tabela[id].tipo != PARAMETROS_INT )
+		return ESP_ERR_INVALID_ARG;
+	valor_t novo = { .inteiro = valor };
+	return altera( id, &novo );
+}
+
+esp_err_t parametros_definir_ip4( int id, uint32_t endereco )
+{
+	if( !id_valido( id ) || s_config.tabela[id].tipo != PARAMETROS_IP4 )
+		return ESP_ERR_INVALID_ARG;
+	valor_t novo = { .ip4 = endereco };
+	return altera( id, &novo );
+}
+
+esp_err_t parametros_definir_texto( int id, const char *texto )
+{
+	if( !id_valido( id ) || texto == NULL )
+		return ESP_ERR_INVALID_ARG;
+
+	valor_t novo = { 0 };
+	if( s_config.tabela[id].tipo == PARAMETROS_INT )
+	{
+		char *fim;
+		long numero = strtol( texto, &fim, 10 );
+		if( fim == texto || *fim != '\0' || numero < INT32_MIN || numero > INT32_MAX )
+			return ESP_ERR_INVALID_ARG;
+		novo.inteiro = numero;
+	}
+	else if( s_config.tabela[id].tipo == PARAMETROS_IP4 )
+	{
+		if( !ip4addr_aton( texto, (ip4_addr_t*) &novo.ip4 ) )
+			return ESP_ERR_INVALID_ARG;
+	}
+	else if( strlcpy( novo.texto, texto, sizeof( novo.texto ) ) >= sizeof( novo.texto ) )
+		return ESP_ERR_INVALID_ARG;
+	return altera( id, &novo );
+}
+
+esp_err_t parametros_restaurar( int id )
+{
+	if( !id_valido( id ) )
+		return ESP_ERR_INVALID_ARG;
+	valor_t valor;
+	padrao( id, &valor );
+	esp_err_t ret = altera( id, &valor );
+	//Mesmo sem mudança na RAM a chave pode existir na NVS com o valor padrão.
+	portENTER_CRITICAL( &s_mux );
+	s_pendentes |= BIT_ID( id );
+	s_apagar |= BIT_ID( id );
+	portEXIT_CRITICAL( &s_mux );
+	agenda();
+	return ret;
+}
+
+esp_err_t parametros_gravar( void )
+{
+	if( s_valores == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	uint32_t pendentes, apagar;
+	esp_timer_stop( s_timer );
+	portENTER_CRITICAL( &s_mux );
+	pendentes = s_pendentes;
+	apagar = s_apagar;
+	s_pendentes = 0;
+	s_apagar = 0;
+	s_agendado = false;
+	portEXIT_CRITICAL( &s_mux );
+	if( pendentes == 0 )
+		return ESP_OK;
+
+	nvs_handle_t nvs;
+	uint32_t escritas = 0;
+	esp_err_t ret = nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	bool aberta = ret == ESP_OK;
+	for( size_t id = 0; id < s_config.n && ret == ESP_OK; id++ )
+	{
+		if( !( pendentes & BIT_ID( id ) ) )
+			continue;
+		valor_t valor;
+		portENTER_CRITICAL( &s_mux );
+		copia( id, &valor, &s_valores[id] );
+		portEXIT_CRITICAL( &s_mux );
+
+		if( apagar & BIT_ID( id ) )
+		{
+			ret = nvs_erase_key( nvs, s_config.tabela[id].chave );
+			if( ret == ESP_OK )
+				escritas++;
+			else if( ret == ESP_ERR_NVS_NOT_FOUND )
+				ret = ESP_OK;
+		}
+		else if( !iguais( id, &valor, &s_gravados[id] ) )	//Alteração revertida antes da gravação: nada a escrever.
+		{
+			ret = escreve( nvs, id, &valor );
+			if( ret == ESP_OK )
+				escritas++;
+		}
+		if( ret == ESP_OK )
+		{
+			copia( id, &s_gravados[id], &valor );
+			pendentes &= ~BIT_ID( id );
+			apagar &= ~BIT_ID( id );
+		}
+	}
+	if( ret == ESP_OK && escritas && !s_versao_gravada )
+	{
+		ret = nvs_set_u16( nvs, NVS_CHAVE_VERSAO, s_config.versao );
+		s_versao_gravada = ret == ESP_OK;
+	}
+	if( ret == ESP_OK && escritas )
+		ret = nvs_commit( nvs );
+	if( aberta )
+		nvs_close( nvs );
+
+	if( escritas )
+	{
+		s_stats.gravacoes++;
+		s_stats.escritas += escritas;
+		s_ultima_gravacao = esp_timer_get_time();
+	}
+	if( ret != ESP_OK )
+	{
+		//O que não foi gravado volta às pendências e é tentado de novo após o intervalo mínimo.
+		portENTER_CRITICAL( &s_mux );
+		s_pendentes |= pendentes;
+		s_apagar |= apagar;
+		portEXIT_CRITICAL( &s_mux );
+		agenda();
+	}
+	return ret;
+}
+
+esp_err_t parametros_assinar( uint32_t mascara, parametros_cb_t callback, void *arg )
+{
+	if( callback == NULL || mascara == 0 )
+		return ESP_ERR_INVALID_ARG;
+
+	esp_err_t ret = ESP_ERR_NO_MEM;
+	portENTER_CRITICAL( &s_mux );
+	for( int i = 0; i < PARAMETROS_MAX_ASSINANTES; i++ )
+	{
+		if( s_assinantes[i].mascara == 0 )
+		{
+			s_assinantes[i] = (assinante_t) { .mascara = mascara, .callback = callback, .arg = arg };
+			ret = ESP_OK;
+			break;
+		}
+	}
+	portEXIT_CRITICAL( &s_mux );
+	return ret;
+}
+
+size_t parametros_quantidade( void )
+{
+	return s_valores != NULL ? s_config.n : 0;
+}
+
+const parametros_def_t *parametros_definicao( int id )
+{
+	return id_valido( id ) ? &s_config.tabela[id] : NULL;
+}
+
+void parametros_estatisticas( parametros_stats_t *stats )
+{
+	portENTER_CRITICAL( &s_mux );
+	*stats = s_stats;
+	portEXIT_CRITICAL( &s_mux );
+}
+
+void parametros_relatorio( void )
+{
+	char texto[PARAMETROS_MAX_TEXTO + 1];
+	valor_t valor;
+	for( size_t id = 0; id < parametros_quantidade(); id++ )
+	{
+		const parametros_def_t *d = &s_config.tabela[id];
+		padrao( id, &valor );
+		bool alterado = !iguais( id, &valor, &s_valores[id] );
+		if( d->secreto )
+			ESP_LOGI( TAG, "  %-15s ***%s", d->chave, alterado ? "" : " (padrao)" );
+		else if( parametros_texto( id, texto, sizeof( texto ) ) == ESP_OK )
+			ESP_LOGI( TAG, "  %-15s %s%s", d->chave, texto, alterado ? "" : " (padrao)" );
+	}
+	parametros_stats_t stats;
+	parametros_estatisticas( &stats );
+	ESP_LOGI( TAG, "%u alteracoes, %u gravacoes, %u chaves escritas na NVS", stats.alteracoes, stats.gravacoes,
+			  stats.escritas );
+}
@@ -0,0 +1,112 @@
+/*
+	Objetivo: Benchmark dos parâmetros de configuração - leitura da cópia em RAM contra a NVS e
+			  entradas da flash consumidas por alteração (somente no ESP32)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "esp_log.h"
+#include "nvs.h"
+#include "benchmark.h"
+#include "parametros.h"
+
+/* Definições e Constantes */
+#define LEITURAS			1000
+#define NVS_CHAVE_BENCH		"_bench"	//Chave temporária das escritas diretas.
+
+/* Variáveis Globais */
+static const char * TAG = "parametros";
+
+/* Entradas livres da NVS (32 bytes cada): a diferença é o que as escritas consumiram da flash. */
+static uint32_t entradas_livres( void )
+{
+	nvs_stats_t stats;
+	return nvs_get_stats( NULL, &stats ) == ESP_OK ? stats.free_entries : 0;
+}
+
+void parametros_benchmark( int id_int, int id_texto, uint32_t alteracoes )
+{
+	const parametros_def_t *def_int = parametros_definicao( id_int );
+	const parametros_def_t *def_texto = parametros_definicao( id_texto );
+	if( def_int == NULL || def_int->tipo != PARAMETROS_INT || def_texto == NULL || def_texto->tipo != PARAMETROS_TEXTO
+		|| def_int->minimo == def_int->maximo )
+	{
+		ESP_LOGE( TAG, "Benchmark: ids invalidos" );
+		return;
+	}
+	nvs_handle_t nvs;
+	if( nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READWRITE, &nvs ) != ESP_OK )
+		return;
+
+	/*	Rajada pela cópia em RAM: alterna entre os limites e termina fora do valor original, então a
+		gravação agrupada escreve uma única chave. */
+	int32_t original = parametros_int( id_int );
+	int32_t outro = original == def_int->minimo ? def_int->maximo : def_int->minimo;
+	parametros_stats_t antes, depois;
+	parametros_gravar();
+	parametros_estatisticas( &antes );
+	uint32_t livres = entradas_livres();
+	for( uint32_t i = 0; i < alteracoes; i++ )
+		parametros_definir_int( id_int, i % 2 ? original : outro );
+	parametros_definir_int( id_int, outro );
+	parametros_gravar();
+	parametros_estatisticas( &depois );
+	uint32_t entradas_agrupado = livres - entradas_livres();
+
+	//A mesma rajada escrita direto na NVS, com um commit por alteração.
+	livres = entradas_livres();
+	for( uint32_t i = 0; i < alteracoes; i++ )
+	{
+		nvs_set_i32( nvs, NVS_CHAVE_BENCH, i % 2 ? original : outro );
+		nvs_commit( nvs );
+	}
+	uint32_t entradas_direto = livres - entradas_livres();
+	nvs_erase_key( nvs, NVS_CHAVE_BENCH );
+	nvs_commit( nvs );
+
+	ESP_LOGI( TAG, "Rajada de %u alteracoes: agrupada %u escritas (%u entradas da NVS), direta %u escritas (%u entradas)",
+			  alteracoes + 1, depois.escritas - antes.escritas, entradas_agrupado, alteracoes, entradas_direto );
+
+	//Leituras: cópia em RAM contra a NVS com o handle já aberto (o parâmetro está gravado).
+	bench_stats_t ram_int, nvs_int, ram_texto, nvs_texto;
+	char texto[PARAMETROS_MAX_TEXTO + 1];
+	int32_t valor;
+	size_t tamanho;
+	bench_stats_init( &ram_int, "leitura INT da RAM" );
+	bench_stats_init( &nvs_int, "leitura INT da NVS" );
+	bench_stats_init( &ram_texto, "leitura TEXTO da RAM" );
+	bench_stats_init( &nvs_texto, "leitura TEXTO da NVS" );
+	for( int i = 0; i < LEITURAS; i++ )
+	{
+		uint32_t inicio = bench_ciclos();
+		valor = parametros_int( id_int );
+		bench_stats_add( &ram_int, bench_ciclos() - inicio );
+
+		inicio = bench_ciclos();
+		nvs_get_i32( nvs, def_int->chave, &valor );
+		bench_stats_add( &nvs_int, bench_ciclos() - inicio );
+
+		inicio = bench_ciclos();
+		parametros_texto( id_texto, texto, sizeof( texto ) );
+		bench_stats_add( &ram_texto, bench_ciclos() - inicio );
+
+		//Sem a chave na NVS (valor padrão) a medida é a busca que falha.
+		tamanho = sizeof( texto );
+		inicio = bench_ciclos();
+		nvs_get_str( nvs, def_texto->chave, texto, &tamanho );
+		bench_stats_add( &nvs_texto, bench_ciclos() - inicio );
+	}
+	nvs_close( nvs );
+	(void) valor;
+	bench_stats_report( &ram_int, "ciclos" );
+	bench_stats_report( &nvs_int, "ciclos" );
+	bench_stats_report( &ram_texto, "ciclos" );
+	bench_stats_report( &nvs_texto, "ciclos" );
+
+	if( original == def_int->padrao )
+		parametros_restaurar( id_int );
+	else
+		parametros_definir_int( id_int, original );
+	parametros_gravar();
+}
@@ -0,0 +1,4 @@
+#
+# Perfil de execução: uso de CPU e de pilha por task e duração das ISRs.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,59 @@
+/*
+	Objetivo: Perfil de execução - uso de CPU e de pilha por task e contagem/duração das ISRs,
+			  com relatório periódico em JSON no log
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "xtensa/hal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PERFIL_MAX_TASKS	24
+#define PERFIL_MAX_ISRS		8
+
+/* Contadores de uma ISR. Um único escritor (a própria ISR); a leitura no relatório não é atômica. */
+typedef struct {
+	const char *nome;
+	uint32_t entradas;
+	uint32_t ciclos_max;
+	uint64_t ciclos_total;
+} perfil_isr_t;
+
+/* Chamar no fim da ISR com o valor de xthal_get_ccount() lido na entrada. */
+FORCE_INLINE_ATTR void perfil_isr_saida( perfil_isr_t *isr, uint32_t ciclos_entrada )
+{
+	uint32_t ciclos = xthal_get_ccount() - ciclos_entrada;
+	isr->entradas++;
+	isr->ciclos_total += ciclos;
+	if( ciclos > isr->ciclos_max )
+		isr->ciclos_max = ciclos;
+}
+
+/* Inclui a ISR no relatório. A estrutura deve existir durante toda a execução. */
+esp_err_t perfil_registrar_isr( perfil_isr_t *isr );
+
+/*
+	Cria a task que imprime o relatório a cada "periodo_ms". Requer no sdkconfig
+	CONFIG_FREERTOS_USE_TRACE_FACILITY e, para o uso de CPU, CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS.
+*/
+esp_err_t perfil_iniciar( uint32_t periodo_ms );
+
+/*
+	Imprime uma linha "perfil: {...}" com, para cada task, o uso de CPU desde o relatório anterior
+	(décimos de % da capacidade dos dois núcleos), a menor folga de pilha já registrada (bytes), a
+	prioridade e o núcleo; e, para cada ISR, entradas e ciclos médio e máximo.
+*/
+void perfil_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
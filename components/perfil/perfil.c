@@ -0,0 +1,139 @@
+/*
+	Objetivo: Perfil de execução - uso de CPU e de pilha por task e contagem/duração das ISRs,
+			  com relatório periódico em JSON no log
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "tarefas.h"
+#include "perfil.h"
+
+/* Definições e Constantes */
+#define TAMANHO_JSON	1536
+
+/* Tempo de execução de cada task no relatório anterior, para calcular o uso no intervalo. */
+typedef struct {
+	TaskHandle_t task;
+	uint32_t tempo;
+} perfil_anterior_t;
+
+/* Variáveis Globais */
+static const char * TAG = "perfil";
+static perfil_isr_t *s_isrs[PERFIL_MAX_ISRS];
+static uint32_t s_num_isrs;
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static uint32_t s_periodo_ms;
+/*	Usados somente por perfil_relatorio (uma chamada por vez). */
+static TaskStatus_t s_tasks[PERFIL_MAX_TASKS];
+static perfil_anterior_t s_anterior[PERFIL_MAX_TASKS];
+static uint32_t s_num_anterior;
+static uint32_t s_total_anterior;
+static char s_json[TAMANHO_JSON];
+#endif
+
+esp_err_t perfil_registrar_isr( perfil_isr_t *isr )
+{
+	if( s_num_isrs >= PERFIL_MAX_ISRS )
+		return ESP_ERR_NO_MEM;
+	s_isrs[s_num_isrs++] = isr;
+	return ESP_OK;
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static uint32_t tempo_anterior( TaskHandle_t task )
+{
+	for( uint32_t i = 0; i < s_num_anterior; i++ )
+		if( s_anterior[i].task == task )
+			return s_anterior[i].tempo;
+	return 0; //Task criada após o último relatório.
+}
+#endif
+
+void perfil_relatorio( void )
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+	uint32_t total = 0;
+	UBaseType_t n = uxTaskGetSystemState( s_tasks, PERFIL_MAX_TASKS, &total );
+	if( n == 0 )
+	{
+		ESP_LOGW( TAG, "mais de %u tasks, aumente PERFIL_MAX_TASKS", PERFIL_MAX_TASKS );
+		return;
+	}
+	//O contador total é o tempo decorrido; as tasks dos dois núcleos somam até portNUM_PROCESSORS vezes.
+	uint64_t capacidade = (uint64_t)( total - s_total_anterior ) * portNUM_PROCESSORS;
+
+	size_t pos = snprintf( s_json, TAMANHO_JSON, "{\"tasks\":[" );
+	for( UBaseType_t i = 0; i < n && pos < TAMANHO_JSON; i++ )
+	{
+		const TaskStatus_t *t = &s_tasks[i];
+		uint32_t cpu = 0;
+#if CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+		if( capacidade )
+			cpu = (uint32_t)( (uint64_t)( t->ulRunTimeCounter - tempo_anterior( t->xHandle ) ) * 1000 / capacidade );
+#endif
+		//Núcleo -1: task sem afinidade (tskNO_AFFINITY).
+		int nucleo = t->xCoreID < portNUM_PROCESSORS ? (int) t->xCoreID : -1;
+		pos += snprintf( s_json + pos, TAMANHO_JSON - pos, "%s{\"nome\":\"%s\",\"cpu\":%u,\"pilha\":%u,\"prio\":%u,\"nucleo\":%d}",
+						 i ? "," : "", t->pcTaskName, cpu, (uint32_t) t->usStackHighWaterMark,
+						 (uint32_t) t->uxCurrentPriority, nucleo );
+	}
+	if( pos < TAMANHO_JSON )
+		pos += snprintf( s_json + pos, TAMANHO_JSON - pos, "],\"isrs\":[" );
+	for( uint32_t i = 0; i < s_num_isrs && pos < TAMANHO_JSON; i++ )
+	{
+		const perfil_isr_t *isr = s_isrs[i];
+		uint32_t entradas = isr->entradas;
+		pos += snprintf( s_json + pos, TAMANHO_JSON - pos, "%s{\"nome\":\"%s\",\"n\":%u,\"med\":%u,\"max\":%u}",
+						 i ? "," : "", isr->nome, entradas,
+						 entradas ? (uint32_t)( isr->ciclos_total / entradas ) : 0, isr->ciclos_max );
+	}
+	if( pos < TAMANHO_JSON )
+		snprintf( s_json + pos, TAMANHO_JSON - pos, "]}" );
+	if( pos >= TAMANHO_JSON )
+		ESP_LOGW( TAG, "relatorio truncado, aumente TAMANHO_JSON" );
+	ESP_LOGI( TAG, "%s", s_json );
+
+	for( UBaseType_t i = 0; i < n; i++ )
+	{
+		s_anterior[i].task = s_tasks[i].xHandle;
+		s_anterior[i].tempo = s_tasks[i].ulRunTimeCounter;
+	}
+	s_num_anterior = n;
+	s_total_anterior = total;
+#else
+	ESP_LOGW( TAG, "habilite CONFIG_FREERTOS_USE_TRACE_FACILITY" );
+#endif
+}
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+static void task_perfil( void *pvParameter )
+{
+	while( 1 )
+	{
+		vTaskDelay( s_periodo_ms / portTICK_PERIOD_MS );
+		perfil_relatorio();
+	}
+}
+#endif
+
+esp_err_t perfil_iniciar( uint32_t periodo_ms )
+{
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+	if( periodo_ms < portTICK_PERIOD_MS )
+		return ESP_ERR_INVALID_ARG;
+	s_periodo_ms = periodo_ms;
+	//Relatório inicial com o uso desde o boot; os seguintes mostram o uso em cada período.
+	perfil_relatorio();
+	if( tarefas_task( "perfil", task_perfil, "task_perfil", 3072, NULL, 1, tskNO_AFFINITY ) == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+#else
+	return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
@@ -0,0 +1,4 @@
+#
+# Tabela de pinos da placa compartilhada entre os exemplos.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,85 @@
+/*
+	Objetivo: Tabela única de pinos da placa, validada em tempo de compilação
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "driver/gpio.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Flags da tabela */
+#define PINO_NORMAL			0
+#define PINO_STRAPPING_OK	1   //Uso consciente de um pino de strapping (nível no boot define o modo do chip).
+
+/* Pinagem da placa. Para mudar a pinagem basta alterar estas definições; os exemplos usam apenas os nomes. */
+#define LED_R			GPIO_NUM_15
+#define LED_G			GPIO_NUM_12
+#define LED_B 			GPIO_NUM_14
+#define BUTTON			GPIO_NUM_16
+
+/*
+	Tabela de pinos da placa: X( gpio, modo, pull-up, pull-down, flags )
+	Observação: GPIO12 (MTDI) e GPIO15 (MTDO) são pinos de strapping, os LEDs não podem forçar
+	nível alto nesses pinos durante o reset.
+*/
+#define PLACA_PINOS( X ) \
+	X( LED_R,  GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, PINO_STRAPPING_OK ) \
+	X( LED_G,  GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, PINO_STRAPPING_OK ) \
+	X( LED_B,  GPIO_MODE_OUTPUT, GPIO_PULLUP_DISABLE, GPIO_PULLDOWN_DISABLE, PINO_NORMAL ) \
+	X( BUTTON, GPIO_MODE_INPUT,  GPIO_PULLUP_ENABLE,  GPIO_PULLDOWN_DISABLE, PINO_NORMAL )
+
+/* Máscaras no formato do pin_bit_mask do gpio_config_t, calculadas a partir da tabela. */
+#define PLACA_X_SAIDA( gpio, modo, pu, pd, flags ) | ( ( (modo) & GPIO_MODE_DEF_OUTPUT ) ? ( 1ULL << (gpio) ) : 0 )
+#define PLACA_X_ENTRADA( gpio, modo, pu, pd, flags ) | ( ( (modo) == GPIO_MODE_INPUT ) ? ( 1ULL << (gpio) ) : 0 )
+#define PLACA_MASCARA_SAIDAS 	( 0ULL PLACA_PINOS( PLACA_X_SAIDA ) )
+#define PLACA_MASCARA_ENTRADAS 	( 0ULL PLACA_PINOS( PLACA_X_ENTRADA ) )
+
+/*
+	Validação em tempo de compilação (ESP32):
+	- GPIO inexistente ou ligado à flash SPI (6 a 11);
+	- GPIO 34 a 39 são somente entrada e não possuem pull-up/pull-down;
+	- pinos de strapping (0, 2, 5, 12 e 15) exigem PINO_STRAPPING_OK;
+	- pinos repetidos geram "duplicate case value" em placa_valida_duplicados().
+*/
+#define PLACA_GPIO_VALIDOS		0x000000FF0EEFF03FULL
+#define PLACA_GPIO_SO_ENTRADA	0x000000FC00000000ULL
+#define PLACA_GPIO_STRAPPING	( ( 1ULL << 0 ) | ( 1ULL << 2 ) | ( 1ULL << 5 ) | ( 1ULL << 12 ) | ( 1ULL << 15 ) )
+
+#define PLACA_X_VALIDA( gpio, modo, pu, pd, flags ) \
+	_Static_assert( ( PLACA_GPIO_VALIDOS >> (gpio) ) & 1, #gpio ": GPIO inexistente ou reservado para a flash" ); \
+	_Static_assert( !( ( modo ) & GPIO_MODE_DEF_OUTPUT ) || !( ( PLACA_GPIO_SO_ENTRADA >> (gpio) ) & 1 ), \
+					#gpio ": GPIO somente entrada configurado como saida" ); \
+	_Static_assert( !( (pu) || (pd) ) || !( ( PLACA_GPIO_SO_ENTRADA >> (gpio) ) & 1 ), \
+					#gpio ": GPIO 34 a 39 nao possui pull-up/pull-down interno" ); \
+	_Static_assert( ( (flags) & PINO_STRAPPING_OK ) || !( ( PLACA_GPIO_STRAPPING >> (gpio) ) & 1 ), \
+					#gpio ": pino de strapping sem PINO_STRAPPING_OK" );
+PLACA_PINOS( PLACA_X_VALIDA )
+
+#define PLACA_X_CASE( gpio, modo, pu, pd, flags ) case gpio:
+static inline void placa_valida_duplicados( int gpio )
+{
+	switch( gpio )
+	{
+		PLACA_PINOS( PLACA_X_CASE )
+		default:
+			break;
+	}
+}
+
+/*
+	Configura todos os pinos da tabela. Pinos com a mesma configuração (modo e pull) são agrupados em
+	uma única chamada de gpio_config. As interrupções ficam desabilitadas; quem precisar delas
+	habilita depois (ex.: gpio_input_iniciar).
+*/
+esp_err_t placa_configurar( void );
+
+#ifdef __cplusplus
+}
+#endif
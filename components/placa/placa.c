@@ -0,0 +1,62 @@
+/*
+	Objetivo: Tabela única de pinos da placa, validada em tempo de compilação
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdbool.h>
+#include "esp_log.h"
+#include "placa.h"
+
+typedef struct {
+	gpio_num_t gpio;
+	gpio_mode_t modo;
+	gpio_pullup_t pull_up;
+	gpio_pulldown_t pull_down;
+} placa_pino_t;
+
+/* Variáveis Globais */
+static const char * TAG = "placa";
+
+#define PLACA_X_DESCRITOR( gpio, modo, pu, pd, flags ) { gpio, modo, pu, pd },
+static const placa_pino_t s_pinos[] = { PLACA_PINOS( PLACA_X_DESCRITOR ) };
+#define NUM_PINOS ( sizeof( s_pinos ) / sizeof( s_pinos[0] ) )
+
+esp_err_t placa_configurar( void )
+{
+	bool configurado[NUM_PINOS] = { 0 };
+	uint32_t chamadas = 0;
+
+	for( size_t i = 0; i < NUM_PINOS; i++ )
+	{
+		if( configurado[i] )
+			continue;
+
+		//Reúne no mesmo descritor todos os pinos com configuração idêntica à do pino i.
+		gpio_config_t io_conf = {
+			.pin_bit_mask = 0,
+			.mode = s_pinos[i].modo,
+			.pull_up_en = s_pinos[i].pull_up,
+			.pull_down_en = s_pinos[i].pull_down,
+			.intr_type = GPIO_INTR_DISABLE,
+		};
+		for( size_t j = i; j < NUM_PINOS; j++ )
+		{
+			if( s_pinos[j].modo == io_conf.mode && s_pinos[j].pull_up == io_conf.pull_up_en
+				&& s_pinos[j].pull_down == io_conf.pull_down_en )
+			{
+				io_conf.pin_bit_mask |= 1ULL << s_pinos[j].gpio;
+				configurado[j] = true;
+			}
+		}
+
+		esp_err_t ret = gpio_config( &io_conf );
+		if( ret != ESP_OK )
+			return ret;
+		chamadas++;
+	}
+
+	ESP_LOGI( TAG, "%u pinos configurados com %u chamadas de gpio_config", (uint32_t) NUM_PINOS, chamadas );
+	return ESP_OK;
+}
@@ -0,0 +1,4 @@
+#
+# IP da station: DHCP com reaproveitamento da concessão, IP fixo ou híbrido.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
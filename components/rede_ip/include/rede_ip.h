@@ -0,0 +1,69 @@
+/*
+	Objetivo: Configuração do IP da station - DHCP com reaproveitamento da concessão, IP fixo ou
+			  híbrido (DHCP com fallback para o IP fixo), escolhido em tempo de execução
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_netif.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	REDE_IP_DHCP = 0,		//Somente DHCP.
+	REDE_IP_ESTATICO,		//Somente o IP fixo, sem tráfego DHCP.
+	REDE_IP_HIBRIDO,		//DHCP; sem resposta em "timeout_dhcp_ms", usa o IP fixo até a concessão ou a próxima associação.
+} rede_ip_modo_t;
+
+/* Como o IP atual foi obtido. */
+typedef enum {
+	REDE_IP_ORIGEM_NENHUMA = 0,
+	REDE_IP_ORIGEM_DHCP,		//Concessão nova (DISCOVER/OFFER/REQUEST/ACK) ou outro endereço.
+	REDE_IP_ORIGEM_CONCESSAO,	//Mesmo endereço da concessão salva (REQUEST do INIT-REBOOT aceito).
+	REDE_IP_ORIGEM_ESTATICO,
+	REDE_IP_ORIGEM_FALLBACK,	//IP fixo após o timeout do DHCP (modo híbrido).
+	REDE_IP_NUM_ORIGENS,
+} rede_ip_origem_t;
+
+typedef struct {
+	rede_ip_modo_t modo;
+	esp_netif_ip_info_t estatico;	//IP, máscara e gateway do modo estático e do fallback.
+	esp_ip4_addr_t dns;				//DNS do IP fixo (0: usa o gateway).
+	uint32_t timeout_dhcp_ms;		//Modo híbrido: espera do DHCP, contada a partir da associação.
+} rede_ip_config_t;
+
+/*
+	Aplica o modo à interface da station e registra os handlers da associação e do IP. Chamar após
+	esp_netif_create_default_wifi_sta() e antes de esp_wifi_start(). No DHCP o endereço anterior é
+	pedido direto (INIT-REBOOT) quando o lwIP é compilado com CONFIG_LWIP_DHCP_RESTORE_LAST_IP; a
+	concessão recebida é salva na NVS somente quando muda. Requer nvs_flash_init().
+*/
+esp_err_t rede_ip_iniciar( esp_netif_t *netif, const rede_ip_config_t *config );
+
+/* Modo salvo na NVS por rede_ip_salvar_modo(), ou "padrao" se não houver. */
+rede_ip_modo_t rede_ip_modo_salvo( rede_ip_modo_t padrao );
+
+/* Salva o modo na NVS, para o próximo boot (a aplicação o lê com rede_ip_modo_salvo()). */
+esp_err_t rede_ip_salvar_modo( rede_ip_modo_t modo );
+
+/* Converte os endereços do menuconfig ("a.b.c.d"). Retorna ESP_ERR_INVALID_ARG se algum for inválido. */
+esp_err_t rede_ip_endereco( const char *ip, const char *mascara, const char *gateway, esp_netif_ip_info_t *info );
+
+/* Origem do IP atual. */
+rede_ip_origem_t rede_ip_origem( void );
+
+/* Nome da origem, para os logs. */
+const char *rede_ip_nome_origem( rede_ip_origem_t origem );
+
+/* Imprime, para cada origem, o histograma do tempo (ms) entre a associação e o IP. */
+void rede_ip_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,247 @@
+/*
+	Objetivo: Configuração do IP da station - DHCP com reaproveitamento da concessão, IP fixo ou
+			  híbrido (DHCP com fallback para o IP fixo), escolhido em tempo de execução
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs.h"
+#include "lwip/ip4_addr.h"
+#include "benchmark.h"
+#include "rede_ip.h"
+
+/* Definições e Constantes */
+#define NVS_NAMESPACE		"rede_ip"
+#define NVS_CHAVE_MODO		"modo"
+#define NVS_CHAVE_CONCESSAO	"concessao"
+#define VERSAO_CONCESSAO	1
+
+/* Última concessão do DHCP, gravada na NVS */
+typedef struct {
+	uint8_t versao;
+	esp_netif_ip_info_t ip;
+	esp_ip4_addr_t dns;
+} rede_ip_concessao_t;
+
+/* Variáveis Globais */
+static const char * TAG = "rede_ip";
+static const char * s_nomes[REDE_IP_NUM_ORIGENS] = { "nenhuma", "DHCP", "concessao salva", "IP fixo", "IP fixo (timeout do DHCP)" };
+
+static rede_ip_config_t s_config;
+static esp_netif_t *s_netif;
+static esp_timer_handle_t s_timer;
+static rede_ip_concessao_t s_concessao;		//Versão 0: nenhuma concessão salva.
+static rede_ip_origem_t s_origem;
+static bool s_fallback;						//IP fixo aplicado pelo timeout do DHCP.
+static int64_t s_inicio;					//Instante (us) da associação; 0 após o IP.
+static bench_stats_t s_tempo[REDE_IP_NUM_ORIGENS - 1];	//Associação até o IP (ms), por origem.
+
+static esp_err_t aplica_estatico( void )
+{
+	esp_err_t ret = esp_netif_dhcpc_stop( s_netif );
+	if( ret != ESP_OK && ret != ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED )
+		return ret;
+	ret = esp_netif_set_ip_info( s_netif, &s_config.estatico );
+	if( ret != ESP_OK )
+		return ret;
+
+	esp_netif_dns_info_t dns = { .ip.type = ESP_IPADDR_TYPE_V4 };
+	dns.ip.u_addr.ip4.addr = s_config.dns.addr ? s_config.dns.addr : s_config.estatico.gw.addr;
+	return esp_netif_set_dns_info( s_netif, ESP_NETIF_DNS_MAIN, &dns );
+}
+
+static void le_concessao( void )
+{
+	nvs_handle_t nvs;
+	memset( &s_concessao, 0, sizeof( s_concessao ) );
+	if( nvs_open( NVS_NAMESPACE, NVS_READONLY, &nvs ) != ESP_OK )
+		return;
+	size_t tamanho = sizeof( s_concessao );
+	if( nvs_get_blob( nvs, NVS_CHAVE_CONCESSAO, &s_concessao, &tamanho ) != ESP_OK
+		|| tamanho != sizeof( s_concessao ) || s_concessao.versao != VERSAO_CONCESSAO )
+		memset( &s_concessao, 0, sizeof( s_concessao ) );
+	nvs_close( nvs );
+}
+
+/* Grava a concessão somente quando muda, para não desgastar a flash a cada boot. */
+static void salva_concessao( const esp_netif_ip_info_t *ip )
+{
+	rede_ip_concessao_t concessao = { .versao = VERSAO_CONCESSAO, .ip = *ip };
+	esp_netif_dns_info_t dns;
+	if( esp_netif_get_dns_info( s_netif, ESP_NETIF_DNS_MAIN, &dns ) == ESP_OK )
+		concessao.dns = dns.ip.u_addr.ip4;
+	if( memcmp( &concessao, &s_concessao, sizeof( concessao ) ) == 0 )
+		return;
+
+	nvs_handle_t nvs;
+	if( nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs ) != ESP_OK )
+		return;
+	if( nvs_set_blob( nvs, NVS_CHAVE_CONCESSAO, &concessao, sizeof( concessao ) ) == ESP_OK
+		&& nvs_commit( nvs ) == ESP_OK )
+	{
+		s_concessao = concessao;
+		ESP_LOGI( TAG, "Concessao salva: " IPSTR, IP2STR( &concessao.ip.ip ) );
+	}
+	nvs_close( nvs );
+}
+
+/*
+	Modo híbrido: o DHCP não respondeu a tempo da associação. O disparo pode já estar na fila do
+	esp_timer quando o IP chega ou o enlace cai e volta: só vale sem IP e com o timeout cumprido
+	na associação atual. O DHCP volta a rodar sobre o IP fixo, e uma concessão tardia o substitui.
+*/
+static void rede_ip_fallback( void *arg )
+{
+	if( s_inicio == 0 || s_origem != REDE_IP_ORIGEM_NENHUMA
+		|| esp_timer_get_time() - s_inicio < (int64_t) s_config.timeout_dhcp_ms * 1000 )
+		return;
+	ESP_LOGW( TAG, "DHCP sem resposta em %u ms, usando o IP fixo " IPSTR, s_config.timeout_dhcp_ms,
+			  IP2STR( &s_config.estatico.ip ) );
+	s_fallback = true;
+	if( aplica_estatico() != ESP_OK )
+		ESP_LOGE( TAG, "Nao foi possivel aplicar o IP fixo" );
+	if( esp_netif_dhcpc_start( s_netif ) != ESP_OK )
+		ESP_LOGE( TAG, "Nao foi possivel reiniciar o DHCP" );
+}
+
+static void rede_ip_handler( void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data )
+{
+	if( event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_CONNECTED )
+	{
+		s_inicio = esp_timer_get_time();
+		if( s_config.modo == REDE_IP_HIBRIDO && !s_fallback )
+			esp_timer_start_once( s_timer, (uint64_t) s_config.timeout_dhcp_ms * 1000 );
+	}
+	else if( event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED )
+	{
+		esp_timer_stop( s_timer );
+		s_inicio = 0;
+		s_origem = REDE_IP_ORIGEM_NENHUMA;
+		//O IP fixo do fallback vale até a queda ou a concessão: a próxima associação espera o DHCP de novo.
+		s_fallback = false;
+	}
+	else if( event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP )
+	{
+		const ip_event_got_ip_t *evento = (const ip_event_got_ip_t*) event_data;
+		esp_timer_stop( s_timer );
+		if( s_config.modo == REDE_IP_ESTATICO )
+			s_origem = REDE_IP_ORIGEM_ESTATICO;
+		else if( s_fallback && evento->ip_info.ip.addr == s_config.estatico.ip.addr )
+			s_origem = REDE_IP_ORIGEM_FALLBACK;
+		else if( s_concessao.versao && evento->ip_info.ip.addr == s_concessao.ip.ip.addr )
+			s_origem = REDE_IP_ORIGEM_CONCESSAO;
+		else
+			s_origem = REDE_IP_ORIGEM_DHCP;
+		if( s_origem != REDE_IP_ORIGEM_FALLBACK && s_fallback )
+		{
+			s_fallback = false;
+			ESP_LOGI( TAG, "Concessao tardia do DHCP substitui o IP fixo" );
+		}
+
+		//O IP fixo é aplicado antes da associação: somente o evento após a associação é medido.
+		if( s_inicio )
+		{
+			uint32_t ms = (uint32_t)( ( esp_timer_get_time() - s_inicio ) / 1000 );
+			bench_stats_add( &s_tempo[s_origem - 1], ms );
+			ESP_LOGI( TAG, "IP por %s em %u ms apos a associacao", s_nomes[s_origem], ms );
+			s_inicio = 0;
+		}
+		if( s_origem == REDE_IP_ORIGEM_DHCP || s_origem == REDE_IP_ORIGEM_CONCESSAO )
+			salva_concessao( &evento->ip_info );
+	}
+}
+
+esp_err_t rede_ip_iniciar( esp_netif_t *netif, const rede_ip_config_t *config )
+{
+	if( netif == NULL || config->modo > REDE_IP_HIBRIDO
+		|| ( config->modo != REDE_IP_DHCP && config->estatico.ip.addr == 0 )
+		|| ( config->modo == REDE_IP_HIBRIDO && config->timeout_dhcp_ms == 0 ) )
+		return ESP_ERR_INVALID_ARG;
+	s_config = *config;
+	s_netif = netif;
+	for( int i = 1; i < REDE_IP_NUM_ORIGENS; i++ )
+		bench_stats_init( &s_tempo[i - 1], s_nomes[i] );
+	le_concessao();
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = rede_ip_fallback,
+		.name = "rede_ip",
+	};
+	esp_err_t ret = esp_timer_create( &timer_args, &s_timer );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &rede_ip_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &rede_ip_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( IP_EVENT, IP_EVENT_STA_GOT_IP, &rede_ip_handler, NULL );
+	if( ret == ESP_OK && s_config.modo == REDE_IP_ESTATICO )
+		ret = aplica_estatico();
+
+	if( s_config.modo == REDE_IP_DHCP )
+		ESP_LOGI( TAG, "Modo DHCP" );
+	else
+		ESP_LOGI( TAG, "Modo %s, IP fixo " IPSTR, s_config.modo == REDE_IP_ESTATICO ? "estatico" : "hibrido",
+				  IP2STR( &s_config.estatico.ip ) );
+	if( s_concessao.versao && s_config.modo != REDE_IP_ESTATICO )
+		ESP_LOGI( TAG, "Ultima concessao: " IPSTR, IP2STR( &s_concessao.ip.ip ) );
+	return ret;
+}
+
+rede_ip_modo_t rede_ip_modo_salvo( rede_ip_modo_t padrao )
+{
+	nvs_handle_t nvs;
+	uint8_t modo;
+	if( nvs_open( NVS_NAMESPACE, NVS_READONLY, &nvs ) != ESP_OK )
+		return padrao;
+	if( nvs_get_u8( nvs, NVS_CHAVE_MODO, &modo ) != ESP_OK || modo > REDE_IP_HIBRIDO )
+		modo = padrao;
+	nvs_close( nvs );
+	return (rede_ip_modo_t) modo;
+}
+
+esp_err_t rede_ip_salvar_modo( rede_ip_modo_t modo )
+{
+	if( modo > REDE_IP_HIBRIDO )
+		return ESP_ERR_INVALID_ARG;
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	if( ret != ESP_OK )
+		return ret;
+	ret = nvs_set_u8( nvs, NVS_CHAVE_MODO, modo );
+	if( ret == ESP_OK )
+		ret = nvs_commit( nvs );
+	nvs_close( nvs );
+	return ret;
+}
+
+esp_err_t rede_ip_endereco( const char *ip, const char *mascara, const char *gateway, esp_netif_ip_info_t *info )
+{
+	if( !ip4addr_aton( ip, (ip4_addr_t*) &info->ip ) || !ip4addr_aton( mascara, (ip4_addr_t*) &info->netmask )
+		|| !ip4addr_aton( gateway, (ip4_addr_t*) &info->gw ) )
+		return ESP_ERR_INVALID_ARG;
+	return ESP_OK;
+}
+
+rede_ip_origem_t rede_ip_origem( void )
+{
+	return s_origem;
+}
+
+const char *rede_ip_nome_origem( rede_ip_origem_t origem )
+{
+	return origem < REDE_IP_NUM_ORIGENS ? s_nomes[origem] : "?";
+}
+
+void rede_ip_relatorio( void )
+{
+	ESP_LOGI( TAG, "IP atual por %s", s_nomes[s_origem] );
+	for( int i = 0; i < REDE_IP_NUM_ORIGENS - 1; i++ )
+		if( s_tempo[i].amostras )
+			bench_stats_report( &s_tempo[i], "ms" );
+}
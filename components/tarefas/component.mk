@@ -0,0 +1,5 @@
+#
+# Tabela de tasks com núcleo fixo, instalação do serviço de ISR de GPIO em um núcleo escolhido e
+# criação dos objetos do FreeRTOS em uma área estática (CONFIG_TAREFAS_ESTATICO).
+#
+COMPONENT_ADD_INCLUDEDIRS := include
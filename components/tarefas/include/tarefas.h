@@ -0,0 +1,91 @@
+/*
+	Objetivo: Criação das tasks a partir de uma tabela (núcleo, prioridade e pilha), instalação do
+			  serviço de ISR de GPIO em um núcleo escolhido e alocação estática dos objetos do FreeRTOS
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "soc/soc.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	Núcleos do ESP32: a pilha WiFi/lwIP roda no PRO_CPU (núcleo 0, CONFIG_ESP32_WIFI_TASK_PINNED_TO_CORE_0),
+	então as tasks e a ISR de GPIO ficam no APP_CPU (núcleo 1) para não disputar a CPU com ela.
+	tskNO_AFFINITY deixa a escolha com o escalonador.
+*/
+#define TAREFAS_NUCLEO_WIFI		PRO_CPU_NUM
+#define TAREFAS_NUCLEO_GPIO		APP_CPU_NUM
+
+/* Linha da tabela de tasks. */
+typedef struct {
+	TaskFunction_t funcao;
+	const char *nome;
+	uint32_t pilha;				//Bytes.
+	UBaseType_t prioridade;
+	BaseType_t nucleo;			//PRO_CPU_NUM, APP_CPU_NUM ou tskNO_AFFINITY.
+	void *parametro;
+	TaskHandle_t *handle;		//Opcional (NULL).
+} tarefas_t;
+
+/*
+	Cria as tasks da tabela na ordem com tarefas_task() (subsistema "app"). Com CONFIG_FREERTOS_UNICORE
+	os núcleos são ignorados. Para na primeira falha, registrando no log o nome da task.
+*/
+esp_err_t tarefas_criar( const tarefas_t *tabela, size_t n );
+
+/*
+	Instala o serviço de ISR de GPIO (gpio_install_isr_service) no núcleo pedido: a interrupção é
+	alocada no núcleo de quem faz a chamada, então uma task temporária fixa nesse núcleo faz a
+	instalação. Chamar antes de qualquer outro módulo instalar o serviço.
+*/
+esp_err_t tarefas_isr_gpio( BaseType_t nucleo, int flags );
+
+/* Núcleo em que tarefas_isr_gpio instalou o serviço, ou -1 se não foi chamada. */
+int tarefas_nucleo_isr_gpio( void );
+
+/*
+	Criação dos objetos do FreeRTOS e dos buffers dos componentes. Com CONFIG_TAREFAS_ESTATICO a
+	memória vem de uma área estática (.bss, CONFIG_TAREFAS_ESTATICO_KB) e os objetos são criados com
+	as funções xxxCreateStatic; sem ela, vem do heap. Nos dois casos os bytes são somados por
+	"subsistema" (nome do componente, sem cópia) para tarefas_relatorio(). Não há liberação: os
+	objetos vivem até o reset. Retornam NULL se não houver memória.
+*/
+TaskHandle_t tarefas_task( const char *subsistema, TaskFunction_t funcao, const char *nome, uint32_t pilha,
+						   void *parametro, UBaseType_t prioridade, BaseType_t nucleo );
+QueueHandle_t tarefas_fila( const char *subsistema, UBaseType_t tamanho, UBaseType_t tamanho_item );
+SemaphoreHandle_t tarefas_mutex( const char *subsistema );
+SemaphoreHandle_t tarefas_mutex_recursivo( const char *subsistema );
+EventGroupHandle_t tarefas_grupo( const char *subsistema );
+
+/* Buffer na RAM interna (acessível por ISRs), alinhado em 8 bytes. */
+void *tarefas_memoria( const char *subsistema, size_t bytes );
+
+/*
+	Marca o fim da inicialização e guarda o heap livre nesse instante. Depois dela cada criação é
+	contada como alocação em tempo de execução: com CONFIG_TAREFAS_ESTATICO ela falha (NULL), sem
+	ela é feita no heap com um aviso no log.
+*/
+void tarefas_selar( void );
+
+/* Criações feitas após tarefas_selar() (0 no funcionamento esperado). */
+uint32_t tarefas_apos_selar( void );
+
+/* Imprime a memória de cada subsistema, o uso da área estática e o heap livre. */
+void tarefas_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,294 @@
+/*
+	Objetivo: Criação das tasks a partir de uma tabela (núcleo, prioridade e pilha), instalação do
+			  serviço de ISR de GPIO em um núcleo escolhido e alocação estática dos objetos do FreeRTOS
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_heap_caps.h"
+#include "esp_log.h"
+#include "tarefas.h"
+
+/* Definições e Constantes */
+#define MAX_SUBSISTEMAS		16
+#define ALINHA( bytes )		( ( ( bytes ) + 7 ) & ~(size_t) 7 )
+#define CAPS_HEAP			( MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT )
+#if CONFIG_TAREFAS_ESTATICO
+#define ESTATICO			1
+#define TAMANHO_ARENA		( CONFIG_TAREFAS_ESTATICO_KB * 1024 )
+#else
+#define ESTATICO			0
+#endif
+
+/* Memória criada por um subsistema. */
+typedef struct {
+	const char *nome;
+	uint32_t bytes;
+	uint16_t objetos;
+} subsistema_t;
+
+/* Parâmetros da task temporária que instala o serviço de ISR. */
+typedef struct {
+	int flags;
+	esp_err_t ret;
+	TaskHandle_t chamador;
+} instalacao_t;
+
+/* Variáveis Globais */
+static const char * TAG = "tarefas";
+static int s_nucleo_isr = -1;
+
+#if CONFIG_TAREFAS_ESTATICO
+static uint8_t s_arena[TAMANHO_ARENA] __attribute__(( aligned( 8 ) ));
+static size_t s_usado;
+#endif
+static subsistema_t s_subsistemas[MAX_SUBSISTEMAS];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool s_selado;
+static uint32_t s_apos_selar;
+static size_t s_heap_selado;		//Heap livre em tarefas_selar().
+
+static BaseType_t nucleo_valido( BaseType_t nucleo )
+{
+	if( portNUM_PROCESSORS == 1 || nucleo < 0 || nucleo >= portNUM_PROCESSORS )
+		return tskNO_AFFINITY;
+	return nucleo;
+}
+
+esp_err_t tarefas_criar( const tarefas_t *tabela, size_t n )
+{
+	for( size_t i = 0; i < n; i++ )
+	{
+		const tarefas_t *t = &tabela[i];
+		BaseType_t nucleo = nucleo_valido( t->nucleo );
+		TaskHandle_t handle = tarefas_task( "app", t->funcao, t->nome, t->pilha, t->parametro, t->prioridade, nucleo );
+		if( t->handle != NULL )
+			*t->handle = handle;
+		if( handle == NULL )
+		{
+			ESP_LOGE( TAG, "Nao foi possivel alocar %s", t->nome );
+			return ESP_ERR_NO_MEM;
+		}
+		ESP_LOGI( TAG, "%s: prioridade %u, pilha %u, nucleo %d", t->nome, (uint32_t) t->prioridade,
+				  t->pilha, nucleo == tskNO_AFFINITY ? -1 : (int) nucleo );
+	}
+	return ESP_OK;
+}
+
+static void task_instala_isr( void *pvParameter )
+{
+	instalacao_t *instalacao = pvParameter;
+	instalacao->ret = gpio_install_isr_service( instalacao->flags );
+	xTaskNotifyGive( instalacao->chamador );
+	vTaskDelete( NULL );
+}
+
+esp_err_t tarefas_isr_gpio( BaseType_t nucleo, int flags )
+{
+	nucleo = nucleo_valido( nucleo );
+	if( nucleo == tskNO_AFFINITY )
+		nucleo = xPortGetCoreID();
+
+	instalacao_t instalacao = {
+		.flags = flags,
+		.ret = ESP_FAIL,
+		.chamador = xTaskGetCurrentTaskHandle(),
+	};
+	//Prioridade acima da chamadora para terminar antes que ela continue. A pilha vem do heap, mesmo
+	//com CONFIG_TAREFAS_ESTATICO, e é devolvida pela task idle após o vTaskDelete: não ocupa a área estática.
+	if( xTaskCreatePinnedToCore( task_instala_isr, "task_instala_isr", 2048, &instalacao,
+								 uxTaskPriorityGet( NULL ) + 1, NULL, nucleo ) != pdPASS )
+		return ESP_ERR_NO_MEM;
+	ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+
+	if( instalacao.ret == ESP_OK )
+		s_nucleo_isr = nucleo;
+	else
+		ESP_LOGE( TAG, "Falha ao instalar o servico de ISR de GPIO no nucleo %d", (int) nucleo );
+	return instalacao.ret;
+}
+
+int tarefas_nucleo_isr_gpio( void )
+{
+	return s_nucleo_isr;
+}
+
+/*
+	Contabiliza "bytes" para o subsistema e, com CONFIG_TAREFAS_ESTATICO, reserva-os na área estática
+	("memoria"). Retorna false se a criação não deve prosseguir.
+*/
+static bool reserva( const char *subsistema, size_t bytes, uint8_t **memoria )
+{
+	bool ok = true;
+	bool selado;
+	bytes = ALINHA( bytes );
+
+	portENTER_CRITICAL( &s_mux );
+	selado = s_selado;
+	if( selado )
+	{
+		s_apos_selar++;
+		ok = !ESTATICO;
+	}
+#if CONFIG_TAREFAS_ESTATICO
+	else if( s_usado + bytes > TAMANHO_ARENA )
+		ok = false;
+	else
+	{
+		*memoria = &s_arena[s_usado];
+		s_usado += bytes;
+	}
+#endif
+	if( ok )
+	{
+		//Subsistema novo ocupa a primeira posição livre; com a tabela cheia só a área é contada.
+		for( int i = 0; i < MAX_SUBSISTEMAS; i++ )
+		{
+			subsistema_t *s = &s_subsistemas[i];
+			if( s->nome == NULL || strcmp( s->nome, subsistema ) == 0 )
+			{
+				s->nome = subsistema;
+				s->bytes += bytes;
+				s->objetos++;
+				break;
+			}
+		}
+	}
+	portEXIT_CRITICAL( &s_mux );
+
+	if( selado )
+		ESP_LOGW( TAG, "%s: %zu bytes pedidos apos a inicializacao", subsistema, bytes );
+	else if( !ok )
+		ESP_LOGE( TAG, "%s: %zu bytes nao cabem na area estatica (CONFIG_TAREFAS_ESTATICO_KB)", subsistema, bytes );
+	return ok;
+}
+
+TaskHandle_t tarefas_task( const char *subsistema, TaskFunction_t funcao, const char *nome, uint32_t pilha,
+						   void *parametro, UBaseType_t prioridade, BaseType_t nucleo )
+{
+	uint8_t *memoria = NULL;
+	TaskHandle_t handle = NULL;
+	nucleo = nucleo_valido( nucleo );
+	if( !reserva( subsistema, ALINHA( sizeof( StaticTask_t ) ) + pilha, &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	//No ESP-IDF a pilha é dada em bytes (StackType_t de 8 bits).
+	handle = xTaskCreateStaticPinnedToCore( funcao, nome, pilha, parametro, prioridade,
+											(StackType_t*)( memoria + ALINHA( sizeof( StaticTask_t ) ) ),
+											(StaticTask_t*) memoria, nucleo );
+#else
+	if( xTaskCreatePinnedToCore( funcao, nome, pilha, parametro, prioridade, &handle, nucleo ) != pdTRUE )
+		handle = NULL;
+#endif
+	return handle;
+}
+
+QueueHandle_t tarefas_fila( const char *subsistema, UBaseType_t tamanho, UBaseType_t tamanho_item )
+{
+	uint8_t *memoria = NULL;
+	if( !reserva( subsistema, ALINHA( sizeof( StaticQueue_t ) ) + tamanho * tamanho_item, &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	return xQueueCreateStatic( tamanho, tamanho_item, memoria + ALINHA( sizeof( StaticQueue_t ) ),
+							   (StaticQueue_t*) memoria );
+#else
+	return xQueueCreate( tamanho, tamanho_item );
+#endif
+}
+
+SemaphoreHandle_t tarefas_mutex( const char *subsistema )
+{
+	uint8_t *memoria = NULL;
+	if( !reserva( subsistema, sizeof( StaticSemaphore_t ), &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	return xSemaphoreCreateMutexStatic( (StaticSemaphore_t*) memoria );
+#else
+	return xSemaphoreCreateMutex();
+#endif
+}
+
+SemaphoreHandle_t tarefas_mutex_recursivo( const char *subsistema )
+{
+	uint8_t *memoria = NULL;
+	if( !reserva( subsistema, sizeof( StaticSemaphore_t ), &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	return xSemaphoreCreateRecursiveMutexStatic( (StaticSemaphore_t*) memoria );
+#else
+	return xSemaphoreCreateRecursiveMutex();
+#endif
+}
+
+EventGroupHandle_t tarefas_grupo( const char *subsistema )
+{
+	uint8_t *memoria = NULL;
+	if( !reserva( subsistema, sizeof( StaticEventGroup_t ), &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	return xEventGroupCreateStatic( (StaticEventGroup_t*) memoria );
+#else
+	return xEventGroupCreate();
+#endif
+}
+
+void *tarefas_memoria( const char *subsistema, size_t bytes )
+{
+	uint8_t *memoria = NULL;
+	if( !reserva( subsistema, bytes, &memoria ) )
+		return NULL;
+#if CONFIG_TAREFAS_ESTATICO
+	return memoria;
+#else
+	return heap_caps_malloc( bytes, CAPS_HEAP );
+#endif
+}
+
+void tarefas_selar( void )
+{
+	portENTER_CRITICAL( &s_mux );
+	s_selado = true;
+	portEXIT_CRITICAL( &s_mux );
+	s_heap_selado = heap_caps_get_free_size( CAPS_HEAP );
+}
+
+uint32_t tarefas_apos_selar( void )
+{
+	return s_apos_selar;
+}
+
+void tarefas_relatorio( void )
+{
+	uint32_t total = 0;
+	ESP_LOGI( TAG, "Memoria dos objetos por subsistema (%s):",
+			  ESTATICO ? "area estatica" : "heap" );
+	for( int i = 0; i < MAX_SUBSISTEMAS && s_subsistemas[i].nome != NULL; i++ )
+	{
+		ESP_LOGI( TAG, "  %-12s %6u bytes em %u objetos", s_subsistemas[i].nome, s_subsistemas[i].bytes,
+				  s_subsistemas[i].objetos );
+		total += s_subsistemas[i].bytes;
+	}
+#if CONFIG_TAREFAS_ESTATICO
+	ESP_LOGI( TAG, "  total        %6u bytes (%zu de %u bytes da area usados)", total, s_usado, TAMANHO_ARENA );
+#else
+	ESP_LOGI( TAG, "  total        %6u bytes", total );
+#endif
+
+	size_t livre = heap_caps_get_free_size( CAPS_HEAP );
+	ESP_LOGI( TAG, "Heap interno livre: %zu bytes (minimo %zu, maior bloco %zu)", livre,
+			  heap_caps_get_minimum_free_size( CAPS_HEAP ), heap_caps_get_largest_free_block( CAPS_HEAP ) );
+	if( s_selado )
+	{
+		//A variação do heap vem do WiFi, do lwIP e dos timers, que não passam por este componente.
+		ESP_LOGI( TAG, "Desde o fim da inicializacao: heap %+d bytes", (int) livre - (int) s_heap_selado );
+		if( s_apos_selar )
+			ESP_LOGE( TAG, "%u criacoes apos o fim da inicializacao", s_apos_selar );
+		else
+			ESP_LOGI( TAG, "Nenhuma criacao apos o fim da inicializacao" );
+	}
+}
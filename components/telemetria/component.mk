@@ -0,0 +1,4 @@
+#
+# Telemetria em lotes: amostras agrupadas e enviadas por UDP ou TCP, com fila e NVS sem conexão.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
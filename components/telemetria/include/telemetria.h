@@ -0,0 +1,88 @@
+/*
+	Objetivo: Telemetria em lotes - amostras agrupadas em buffers pré-alocados e enviadas por UDP ou
+			  TCP por tamanho ou idade, mantidas em fila (e na NVS) enquanto não há conexão
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TELEMETRIA_VERSAO	1
+
+/*
+	Formato na rede (little-endian): um cabeçalho seguido de "n" amostras. No TCP os lotes são
+	enviados em sequência no mesmo fluxo; o "n" do cabeçalho delimita cada um.
+*/
+typedef struct {
+	uint16_t versao;
+	uint16_t n;					//Amostras no lote.
+	uint32_t sequencia;			//Lotes numerados desde o boot: lacunas no coletor indicam perdas.
+} telemetria_cabecalho_t;
+
+typedef struct {
+	uint32_t tempo_ms;			//Instante da amostra (ms desde o boot).
+	int32_t valor;
+	uint16_t canal;				//Sensor ou GPIO de origem (2 bytes de alinhamento no fim: 12 bytes).
+} telemetria_amostra_t;
+
+typedef struct {
+	EventGroupHandle_t grupo;	//O envio começa quando "bit_conectado" é setado pela primeira vez.
+	EventBits_t bit_conectado;
+	const char *destino;		//IPv4 do coletor.
+	uint16_t porta;
+	bool tcp;					//false: um datagrama UDP por lote.
+	uint16_t amostras_por_lote;	//O lote é enviado ao encher...
+	uint32_t idade_max_ms;		//...ou quando a primeira amostra fica mais velha que isto.
+	uint8_t lotes_fila;			//Lotes fechados mantidos na RAM aguardando a conexão.
+	uint8_t lotes_nvs;			//Lotes gravados na NVS quando a fila enche sem conexão (0: descarta o mais antigo).
+	UBaseType_t prioridade;		//Task que envia os lotes.
+	BaseType_t nucleo;
+} telemetria_config_t;
+
+typedef struct {
+	uint32_t amostras;			//Registradas.
+	uint32_t amostras_enviadas;
+	uint32_t amostras_descartadas;
+	uint32_t lotes_enviados;	//Cada envio é um despertar do rádio.
+	uint32_t bytes_enviados;
+	uint32_t lotes_nvs;			//Gravados na NVS sem conexão.
+	uint32_t lotes_recuperados;	//Lidos da NVS e enviados.
+	uint32_t falhas_envio;
+} telemetria_stats_t;
+
+/*
+	Aloca o lote aberto e a fila (todos os buffers são alocados aqui, uma única vez), assina os
+	eventos de IP (ip_eventos_iniciar já deve ter sido chamada) e cria a task de envio. Lotes da
+	NVS de uma execução anterior são enviados antes dos novos.
+*/
+esp_err_t telemetria_iniciar( const telemetria_config_t *config );
+
+/*
+	Acrescenta uma amostra ao lote aberto. Não chamar de ISR. Retorna ESP_ERR_NO_MEM quando todos os
+	lotes estão ocupados (a amostra é descartada e contada).
+*/
+esp_err_t telemetria_registrar( uint16_t canal, int32_t valor );
+
+/* Cópia dos contadores. */
+void telemetria_estatisticas( telemetria_stats_t *stats );
+
+/*
+	Imprime amostras por segundo, lotes enviados por hora (despertares do rádio, comparados a um
+	pacote por amostra), uso da NVS, descartes e a distribuição da latência (ms) entre a primeira
+	amostra do lote e o envio.
+*/
+void telemetria_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
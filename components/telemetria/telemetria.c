@@ -0,0 +1,437 @@
+/*
+	Objetivo: Telemetria em lotes - amostras agrupadas em buffers pré-alocados e enviadas por UDP ou
+			  TCP por tamanho ou idade, mantidas em fila (e na NVS) enquanto não há conexão
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "benchmark.h"
+#include "ip_eventos.h"
+#include "tarefas.h"
+#include "telemetria.h"
+
+/* Definições e Constantes */
+#define NVS_NAMESPACE		"telemetria"
+#define NVS_INICIO			"ini"		//Contador do lote mais antigo na NVS.
+#define NVS_FIM				"fim"		//Contador do próximo lote a gravar.
+#define TIMEOUT_ENVIO_MS	2000
+
+/* Lote na RAM: o mesmo layout enviado na rede. */
+typedef struct {
+	telemetria_cabecalho_t cabecalho;
+	telemetria_amostra_t amostras[];
+} lote_t;
+
+/* Variáveis Globais */
+static const char * TAG = "telemetria";
+static telemetria_config_t s_config;
+static uint8_t *s_lotes;				//lotes_fila + 1 lotes de s_tamanho_lote bytes.
+static size_t s_tamanho_lote;
+static lote_t *s_recuperado;			//Lote lido da NVS (somente a task).
+static bool s_nvs_pendente = true;		//Pode haver lotes na NVS (inclusive de um boot anterior).
+static QueueHandle_t s_livres;			//Índices dos lotes disponíveis.
+static QueueHandle_t s_fechados;		//Índices dos lotes aguardando envio, do mais antigo ao mais novo.
+static SemaphoreHandle_t s_mutex;		//Lote aberto, sequência e contadores das amostras.
+static int s_aberto = -1;				//Índice do lote recebendo amostras (-1: nenhum).
+static int64_t s_abertura;				//Instante da primeira amostra do lote aberto.
+static uint32_t s_sequencia;
+static TaskHandle_t s_task;
+static volatile bool s_conectado;
+static int s_sock = -1;
+static struct sockaddr_in s_destino;
+static telemetria_stats_t s_stats;
+static bench_stats_t s_latencia;		//ms entre a primeira amostra do lote e o envio (somente a task).
+static int64_t s_inicio;
+
+static inline lote_t *lote( uint8_t i )
+{
+	return (lote_t*)( s_lotes + i * s_tamanho_lote );
+}
+
+static inline size_t bytes_lote( const lote_t *l )
+{
+	return sizeof( telemetria_cabecalho_t ) + l->cabecalho.n * sizeof( telemetria_amostra_t );
+}
+
+/* Numera o lote aberto e o coloca na fila de envio. Chamar com s_mutex. */
+static void fecha_aberto( void )
+{
+	if( s_aberto < 0 )
+		return;
+	uint8_t i = s_aberto;
+	lote( i )->cabecalho.sequencia = s_sequencia++;
+	xQueueSend( s_fechados, &i, 0 ); //A fila comporta todos os lotes: nunca falha.
+	s_aberto = -1;
+}
+
+esp_err_t telemetria_registrar( uint16_t canal, int32_t valor )
+{
+	if( s_mutex == NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	int64_t agora = esp_timer_get_time();
+	bool acordar = false;
+	esp_err_t ret = ESP_OK;
+
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	s_stats.amostras++;
+	if( s_aberto < 0 )
+	{
+		uint8_t i;
+		if( xQueueReceive( s_livres, &i, 0 ) == pdTRUE )
+		{
+			s_aberto = i;
+			lote( i )->cabecalho.n = 0;
+			s_abertura = agora;
+			acordar = true; //A task passa a contar a idade deste lote.
+		}
+	}
+	if( s_aberto >= 0 )
+	{
+		lote_t *l = lote( s_aberto );
+		l->amostras[l->cabecalho.n++] = (telemetria_amostra_t) {
+			.tempo_ms = (uint32_t)( agora / 1000 ),
+			.valor = valor,
+			.canal = canal,
+		};
+		if( l->cabecalho.n >= s_config.amostras_por_lote )
+		{
+			fecha_aberto();
+			acordar = true;
+		}
+	}
+	else
+	{
+		//Todos os lotes aguardam envio e a task ainda não liberou nenhum (rede ou NVS).
+		s_stats.amostras_descartadas++;
+		ret = ESP_ERR_NO_MEM;
+		acordar = true;
+	}
+	xSemaphoreGive( s_mutex );
+
+	if( acordar )
+		xTaskNotifyGive( s_task );
+	return ret;
+}
+
+static void fecha_socket( void )
+{
+	if( s_sock >= 0 )
+	{
+		close( s_sock );
+		s_sock = -1;
+	}
+}
+
+static bool abre_socket( void )
+{
+	if( s_sock >= 0 )
+		return true;
+	s_sock = socket( AF_INET, s_config.tcp ? SOCK_STREAM : SOCK_DGRAM, IPPROTO_IP );
+	if( s_sock < 0 )
+		return false;
+	struct timeval timeout = { .tv_sec = TIMEOUT_ENVIO_MS / 1000, .tv_usec = ( TIMEOUT_ENVIO_MS % 1000 ) * 1000 };
+	setsockopt( s_sock, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof( timeout ) );
+	if( s_config.tcp && connect( s_sock, (struct sockaddr*) &s_destino, sizeof( s_destino ) ) != 0 )
+	{
+		ESP_LOGW( TAG, "Sem conexao TCP com o coletor (errno %d)", errno );
+		fecha_socket();
+		return false;
+	}
+	return true;
+}
+
+/* Conta uma falha de envio. Os contadores são lidos por telemetria_estatisticas() em outras tasks. */
+static void falha_envio( void )
+{
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	s_stats.falhas_envio++;
+	xSemaphoreGive( s_mutex );
+}
+
+/* Envia um lote inteiro; em caso de erro o socket é fechado e reaberto no próximo envio. */
+static bool envia( const lote_t *l )
+{
+	if( !abre_socket() )
+	{
+		falha_envio();
+		return false;
+	}
+	const uint8_t *dados = (const uint8_t*) l;
+	size_t total = bytes_lote( l );
+	size_t enviado = 0;
+	while( enviado < total )
+	{
+		int n = s_config.tcp ? send( s_sock, dados + enviado, total - enviado, 0 )
+							 : sendto( s_sock, dados, total, 0, (struct sockaddr*) &s_destino, sizeof( s_destino ) );
+		if( n <= 0 )
+		{
+			falha_envio();
+			fecha_socket();
+			return false;
+		}
+		enviado += n;
+	}
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	s_stats.lotes_enviados++;
+	s_stats.amostras_enviadas += l->cabecalho.n;
+	s_stats.bytes_enviados += total;
+	xSemaphoreGive( s_mutex );
+	return true;
+}
+
+static void le_posicoes( nvs_handle_t nvs, uint32_t *inicio, uint32_t *fim )
+{
+	*inicio = 0;
+	*fim = 0;
+	nvs_get_u32( nvs, NVS_INICIO, inicio );
+	nvs_get_u32( nvs, NVS_FIM, fim );
+}
+
+/* Grava o lote mais antigo da fila na NVS, descartando o lote mais antigo da NVS se ela estiver cheia. */
+static void guarda_na_nvs( const lote_t *l )
+{
+	nvs_handle_t nvs;
+	if( nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs ) != ESP_OK )
+		return;
+	uint32_t inicio, fim;
+	char chave[12];
+	le_posicoes( nvs, &inicio, &fim );
+
+	if( fim - inicio >= s_config.lotes_nvs )
+	{
+		size_t tamanho = 0;
+		snprintf( chave, sizeof( chave ), "l%u", inicio % s_config.lotes_nvs );
+		if( nvs_get_blob( nvs, chave, NULL, &tamanho ) == ESP_OK && tamanho >= sizeof( telemetria_cabecalho_t ) )
+		{
+			xSemaphoreTake( s_mutex, portMAX_DELAY );
+			s_stats.amostras_descartadas += ( tamanho - sizeof( telemetria_cabecalho_t ) ) / sizeof( telemetria_amostra_t );
+			xSemaphoreGive( s_mutex );
+		}
+		inicio++;
+		nvs_set_u32( nvs, NVS_INICIO, inicio );
+	}
+	snprintf( chave, sizeof( chave ), "l%u", fim % s_config.lotes_nvs );
+	if( nvs_set_blob( nvs, chave, l, bytes_lote( l ) ) == ESP_OK )
+	{
+		nvs_set_u32( nvs, NVS_FIM, fim + 1 );
+		xSemaphoreTake( s_mutex, portMAX_DELAY );
+		s_stats.lotes_nvs++;
+		xSemaphoreGive( s_mutex );
+		s_nvs_pendente = true;
+	}
+	nvs_commit( nvs );
+	nvs_close( nvs );
+}
+
+/* Envia os lotes guardados na NVS, do mais antigo ao mais novo. Retorna true quando não resta nenhum. */
+static bool envia_nvs( void )
+{
+	nvs_handle_t nvs;
+	if( !s_nvs_pendente || s_config.lotes_nvs == 0 )
+		return true;
+	if( nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs ) != ESP_OK )
+		return true;
+	uint32_t inicio, fim;
+	char chave[12];
+	le_posicoes( nvs, &inicio, &fim );
+
+	bool ok = true;
+	for( ; inicio != fim; inicio++ )
+	{
+		size_t tamanho = s_tamanho_lote;
+		snprintf( chave, sizeof( chave ), "l%u", inicio % s_config.lotes_nvs );
+		if( nvs_get_blob( nvs, chave, s_recuperado, &tamanho ) == ESP_OK && tamanho == bytes_lote( s_recuperado ) )
+		{
+			if( !envia( s_recuperado ) )
+			{
+				ok = false;
+				break;
+			}
+			xSemaphoreTake( s_mutex, portMAX_DELAY );
+			s_stats.lotes_recuperados++;
+			xSemaphoreGive( s_mutex );
+		}
+		nvs_erase_key( nvs, chave );
+		nvs_set_u32( nvs, NVS_INICIO, inicio + 1 );
+	}
+	nvs_commit( nvs );
+	nvs_close( nvs );
+	s_nvs_pendente = !ok;
+	return ok;
+}
+
+/* Sem envio e sem lote livre: libera metade da fila, para a NVS ou descartando os mais antigos. */
+static void libera_fila( void )
+{
+	uint8_t i;
+	if( uxQueueMessagesWaiting( s_livres ) > 0 )
+		return;
+	for( uint8_t n = ( s_config.lotes_fila + 1 ) / 2; n > 0 && xQueueReceive( s_fechados, &i, 0 ) == pdTRUE; n-- )
+	{
+		if( s_config.lotes_nvs )
+			guarda_na_nvs( lote( i ) );
+		else
+		{
+			xSemaphoreTake( s_mutex, portMAX_DELAY );
+			s_stats.amostras_descartadas += lote( i )->cabecalho.n;
+			xSemaphoreGive( s_mutex );
+		}
+		xQueueSend( s_livres, &i, 0 );
+	}
+}
+
+/* Envia a fila na ordem; um lote que falhar volta para o início dela. Retorna false na falha. */
+static bool envia_fila( void )
+{
+	uint8_t i;
+	while( xQueueReceive( s_fechados, &i, 0 ) == pdTRUE )
+	{
+		const lote_t *l = lote( i );
+		if( !envia( l ) )
+		{
+			xQueueSendToFront( s_fechados, &i, 0 );
+			return false;
+		}
+		//Os lotes da NVS podem ser de um boot anterior: a latência é medida somente nos da RAM.
+		bench_stats_add( &s_latencia, (uint32_t)( esp_timer_get_time() / 1000 ) - l->amostras[0].tempo_ms );
+		xQueueSend( s_livres, &i, 0 );
+	}
+	return true;
+}
+
+/* Ticks até o lote aberto atingir a idade máxima (portMAX_DELAY sem lote aberto). Chamar com s_mutex. */
+static TickType_t espera_idade( void )
+{
+	if( s_aberto < 0 )
+		return portMAX_DELAY;
+	int64_t restante_us = s_abertura + (int64_t) s_config.idade_max_ms * 1000 - esp_timer_get_time();
+	if( restante_us <= 0 )
+		return 0;
+	return restante_us / 1000 / portTICK_PERIOD_MS + 1;
+}
+
+static void task_telemetria( void *pvParameter )
+{
+	/*	Os envios começam com o bit de conexão da aplicação; depois as quedas e reconexões chegam pelo
+		ip_eventos. Sem conexão (ou sem o coletor), os lotes ficam na fila e, quando ela enche, vão para a NVS. */
+	if( xEventGroupGetBits( s_config.grupo ) & s_config.bit_conectado )
+		s_conectado = true;
+	ESP_LOGI( TAG, "Enviando lotes de ate %u amostras para %s:%u (%s)", s_config.amostras_por_lote,
+			  s_config.destino, s_config.porta, s_config.tcp ? "TCP" : "UDP" );
+
+	while( 1 )
+	{
+		xSemaphoreTake( s_mutex, portMAX_DELAY );
+		TickType_t espera = espera_idade();
+		if( espera == 0 )
+			fecha_aberto();
+		xSemaphoreGive( s_mutex );
+
+		if( !s_conectado )
+			fecha_socket();
+		//Com a rede fora ou o coletor sem responder, a fila cheia também vai para a NVS.
+		if( !s_conectado || !envia_nvs() || !envia_fila() )
+			libera_fila();
+
+		//Acorda com lote cheio, lote aberto, mudança da conexão ou no prazo do lote aberto.
+		if( espera )
+			ulTaskNotifyTake( pdTRUE, espera );
+	}
+}
+
+/* Executado na task do event loop. */
+static void evento_ip( const ip_eventos_t *evento, void *arg )
+{
+	s_conectado = evento->tipo == IP_EVENTOS_GOT_IP;
+	if( s_task )
+		xTaskNotifyGive( s_task );
+}
+
+esp_err_t telemetria_iniciar( const telemetria_config_t *config )
+{
+	if( config->amostras_por_lote == 0 || config->lotes_fila == 0 || config->idade_max_ms == 0
+		|| config->grupo == NULL || config->destino == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( s_mutex != NULL )
+		return ESP_ERR_INVALID_STATE;
+
+	s_destino = (struct sockaddr_in) {
+		.sin_family = AF_INET,
+		.sin_port = htons( config->porta ),
+	};
+	if( inet_aton( config->destino, &s_destino.sin_addr ) == 0 )
+		return ESP_ERR_INVALID_ARG;
+	s_config = *config;
+
+	s_tamanho_lote = sizeof( lote_t ) + config->amostras_por_lote * sizeof( telemetria_amostra_t );
+	size_t num_lotes = config->lotes_fila + 1; //Fila mais o lote aberto.
+	s_lotes = tarefas_memoria( "telemetria", num_lotes * s_tamanho_lote );
+	s_recuperado = tarefas_memoria( "telemetria", s_tamanho_lote );
+	s_livres = tarefas_fila( "telemetria", num_lotes, sizeof( uint8_t ) );
+	s_fechados = tarefas_fila( "telemetria", num_lotes, sizeof( uint8_t ) );
+	s_mutex = tarefas_mutex( "telemetria" );
+	if( s_lotes == NULL || s_recuperado == NULL || s_livres == NULL || s_fechados == NULL || s_mutex == NULL )
+		return ESP_ERR_NO_MEM;
+	for( uint8_t i = 0; i < num_lotes; i++ )
+	{
+		lote( i )->cabecalho.versao = TELEMETRIA_VERSAO;
+		xQueueSend( s_livres, &i, 0 );
+	}
+	bench_stats_init( &s_latencia, "latencia amostra->envio" );
+	s_inicio = esp_timer_get_time();
+
+	//Assina antes de criar a task: uma conexão entre a leitura do bit e a assinatura não é perdida.
+	esp_err_t ret = ip_eventos_assinar( IP_EVENTOS_GOT_IP | IP_EVENTOS_LOST_IP | IP_EVENTOS_LINK_DOWN, evento_ip, NULL );
+	if( ret != ESP_OK )
+		return ret;
+	s_task = tarefas_task( "telemetria", task_telemetria, "task_telemetria", 3072, NULL, config->prioridade,
+						   config->nucleo );
+	if( s_task == NULL )
+		return ESP_ERR_NO_MEM;
+	return ESP_OK;
+}
+
+void telemetria_estatisticas( telemetria_stats_t *stats )
+{
+	if( s_mutex == NULL )
+	{
+		memset( stats, 0, sizeof( *stats ) );
+		return;
+	}
+	xSemaphoreTake( s_mutex, portMAX_DELAY );
+	*stats = s_stats;
+	xSemaphoreGive( s_mutex );
+}
+
+void telemetria_relatorio( void )
+{
+	telemetria_stats_t st;
+	telemetria_estatisticas( &st );
+	uint64_t decorrido_ms = ( esp_timer_get_time() - s_inicio ) / 1000;
+	if( decorrido_ms == 0 )
+		return;
+
+	ESP_LOGI( TAG, "%u amostras (%u/s), %u enviadas em %u lotes, %u bytes",
+			  st.amostras, (uint32_t)( (uint64_t) st.amostras * 1000 / decorrido_ms ),
+			  st.amostras_enviadas, st.lotes_enviados, st.bytes_enviados );
+	ESP_LOGI( TAG, "Despertares do radio por hora: %u (um pacote por amostra: %u)",
+			  (uint32_t)( (uint64_t) st.lotes_enviados * 3600000 / decorrido_ms ),
+			  (uint32_t)( (uint64_t) st.amostras * 3600000 / decorrido_ms ) );
+	ESP_LOGI( TAG, "NVS: %u lotes gravados, %u recuperados; %u amostras descartadas, %u falhas de envio",
+			  st.lotes_nvs, st.lotes_recuperados, st.amostras_descartadas, st.falhas_envio );
+	bench_stats_report( &s_latencia, "ms" );
+}
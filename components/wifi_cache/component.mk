@@ -0,0 +1,4 @@
+#
+# Cache do AP (BSSID e canal) na NVS para conexão rápida do WiFi.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
@@ -0,0 +1,45 @@
+/*
+	Objetivo: Conexão rápida do WiFi reutilizando o BSSID e o canal do último AP (cache na NVS)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	Se houver na NVS um AP salvo para o mesmo SSID, preenche BSSID e canal em "config" para que o
+	driver conecte direto nesse canal, sem a varredura completa. A PMK (derivação da senha, a parte
+	mais lenta do WPA2) já é guardada na NVS pelo próprio driver quando o armazenamento do WiFi é
+	WIFI_STORAGE_FLASH (padrão), desde que SSID e senha não mudem.
+	Retorna ESP_ERR_NOT_FOUND se não houver cache válido. Requer nvs_flash_init().
+*/
+esp_err_t wifi_cache_aplicar( wifi_config_t *config );
+
+/*
+	Salva o AP atual (chamar no IP_EVENT_STA_GOT_IP). Só grava na flash se BSSID ou canal mudaram.
+	Depois do IP o cache deixa de estar em teste: wifi_cache_fallback não o apaga nas quedas seguintes.
+*/
+esp_err_t wifi_cache_salvar( void );
+
+/* Indica se a conexão do boot usou os dados do cache (continua valendo após o IP). */
+bool wifi_cache_em_uso( void );
+
+/*
+	Falha de conexão usando o cache, antes do primeiro IP: apaga o cache e restaura em "config" a
+	varredura completa. O chamador deve aplicar a configuração (esp_wifi_set_config) e chamar
+	esp_wifi_connect(). Retorna ESP_ERR_INVALID_STATE sem cache pendente (já houve IP ou o cache não
+	foi aplicado).
+*/
+esp_err_t wifi_cache_fallback( wifi_config_t *config );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,119 @@
+/*
+	Objetivo: Conexão rápida do WiFi reutilizando o BSSID e o canal do último AP (cache na NVS)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "esp_log.h"
+#include "nvs.h"
+#include "wifi_cache.h"
+
+/* Definições e Constantes */
+#define NVS_NAMESPACE	"wifi_cache"
+#define NVS_CHAVE		"ap"
+#define VERSAO_CACHE	1
+
+/* Registro gravado na NVS */
+typedef struct {
+	uint8_t versao;
+	uint8_t canal;
+	uint8_t bssid[6];
+	char ssid[33];
+} wifi_cache_ap_t;
+
+/* Variáveis Globais */
+static const char * TAG = "wifi_cache";
+static bool s_em_uso = false;		//A conexão do boot usa o cache (relatório do tempo até o IP).
+static bool s_pendente = false;		//Cache aplicado e ainda sem IP: uma falha leva ao fallback.
+
+static esp_err_t le_cache( wifi_cache_ap_t *ap )
+{
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open( NVS_NAMESPACE, NVS_READONLY, &nvs );
+	if( ret != ESP_OK )
+		return ret;
+	size_t tamanho = sizeof( *ap );
+	ret = nvs_get_blob( nvs, NVS_CHAVE, ap, &tamanho );
+	nvs_close( nvs );
+	if( ret == ESP_OK && ( tamanho != sizeof( *ap ) || ap->versao != VERSAO_CACHE ) )
+		ret = ESP_ERR_NOT_FOUND;
+	return ret;
+}
+
+esp_err_t wifi_cache_aplicar( wifi_config_t *config )
+{
+	wifi_cache_ap_t ap;
+	s_em_uso = s_pendente = false;
+	if( le_cache( &ap ) != ESP_OK
+		|| strncmp( ap.ssid, (const char*) config->sta.ssid, sizeof( config->sta.ssid ) ) != 0 )
+		return ESP_ERR_NOT_FOUND;
+
+	memcpy( config->sta.bssid, ap.bssid, sizeof( ap.bssid ) );
+	config->sta.bssid_set = true;
+	config->sta.channel = ap.canal;
+	config->sta.scan_method = WIFI_FAST_SCAN;
+	s_em_uso = s_pendente = true;
+	ESP_LOGI( TAG, "Conexao rapida: canal %u, BSSID %02x:%02x:%02x:%02x:%02x:%02x", ap.canal,
+			  ap.bssid[0], ap.bssid[1], ap.bssid[2], ap.bssid[3], ap.bssid[4], ap.bssid[5] );
+	return ESP_OK;
+}
+
+esp_err_t wifi_cache_salvar( void )
+{
+	//O AP salvo funcionou: as quedas seguintes não apagam o cache.
+	s_pendente = false;
+
+	wifi_ap_record_t info;
+	esp_err_t ret = esp_wifi_sta_get_ap_info( &info );
+	if( ret != ESP_OK )
+		return ret;
+
+	wifi_cache_ap_t ap = { .versao = VERSAO_CACHE, .canal = info.primary };
+	memcpy( ap.bssid, info.bssid, sizeof( ap.bssid ) );
+	strncpy( ap.ssid, (const char*) info.ssid, sizeof( ap.ssid ) - 1 );
+
+	//Evita desgastar a flash regravando o mesmo AP a cada boot.
+	wifi_cache_ap_t atual;
+	if( le_cache( &atual ) == ESP_OK && memcmp( &atual, &ap, sizeof( ap ) ) == 0 )
+		return ESP_OK;
+
+	nvs_handle_t nvs;
+	ret = nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	if( ret != ESP_OK )
+		return ret;
+	ret = nvs_set_blob( nvs, NVS_CHAVE, &ap, sizeof( ap ) );
+	if( ret == ESP_OK )
+		ret = nvs_commit( nvs );
+	nvs_close( nvs );
+	ESP_LOGI( TAG, "AP salvo: canal %u", ap.canal );
+	return ret;
+}
+
+bool wifi_cache_em_uso( void )
+{
+	return s_em_uso;
+}
+
+esp_err_t wifi_cache_fallback( wifi_config_t *config )
+{
+	if( !s_pendente )
+		return ESP_ERR_INVALID_STATE;
+	s_em_uso = s_pendente = false;
+
+	nvs_handle_t nvs;
+	if( nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs ) == ESP_OK )
+	{
+		nvs_erase_key( nvs, NVS_CHAVE );
+		nvs_commit( nvs );
+		nvs_close( nvs );
+	}
+
+	memset( config->sta.bssid, 0, sizeof( config->sta.bssid ) );
+	config->sta.bssid_set = false;
+	config->sta.channel = 0;
+	config->sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+	ESP_LOGW( TAG, "Falha com o AP salvo, voltando a varredura completa" );
+	return ESP_OK;
+}
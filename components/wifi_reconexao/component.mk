@@ -0,0 +1,4 @@
+#
+# Reconexão do WiFi com backoff exponencial e jitter.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
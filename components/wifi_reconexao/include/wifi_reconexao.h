@@ -0,0 +1,53 @@
+/*
+	Objetivo: Reconexão do WiFi com backoff exponencial e jitter (esp_timer), sem limite de tentativas
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	EventGroupHandle_t grupo;	//Grupo de eventos da aplicação.
+	EventBits_t bit_conectado;	//Setado com IP válido, apagado na queda.
+	EventBits_t bit_falha;		//Setado após "tentativas_falha" tentativas sem sucesso, apagado ao reconectar.
+	uint32_t tentativas_falha;	//As tentativas continuam depois de sinalizar a falha.
+	uint32_t atraso_base_ms;	//Atraso antes da 2ª tentativa; dobra a cada nova falha.
+	uint32_t atraso_teto_ms;	//Limite do atraso entre tentativas.
+} wifi_reconexao_config_t;
+
+typedef struct {
+	uint32_t quedas;			//Desconexões a partir do estado conectado (ou da primeira tentativa).
+	uint32_t tentativas;		//Chamadas de esp_wifi_connect() feitas pelo módulo.
+	uint32_t reconexoes;		//Quedas encerradas com um novo IP.
+} wifi_reconexao_stats_t;
+
+/* Cria o timer de reconexão. Chamar antes de esp_wifi_start(). */
+esp_err_t wifi_reconexao_iniciar( const wifi_reconexao_config_t *config );
+
+/*
+	Chamar no WIFI_EVENT_STA_DISCONNECTED. A 1ª tentativa é imediata; as seguintes esperam
+	min(teto, base * 2^(n-1)), com a metade superior sorteada para que vários nós não tentem juntos.
+*/
+void wifi_reconexao_desconectado( void );
+
+/* Chamar no IP_EVENT_STA_GOT_IP: zera o backoff e atualiza os bits do grupo. */
+void wifi_reconexao_conectado( void );
+
+/* Cópia dos contadores. */
+void wifi_reconexao_estatisticas( wifi_reconexao_stats_t *stats );
+
+/* Imprime os contadores e o histograma do tempo (ms) entre a queda e o novo IP. */
+void wifi_reconexao_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
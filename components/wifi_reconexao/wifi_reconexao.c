@@ -0,0 +1,126 @@
+/*
+	Objetivo: Reconexão do WiFi com backoff exponencial e jitter (esp_timer), sem limite de tentativas
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "benchmark.h"
+#include "wifi_reconexao.h"
+
+/* Definições e Constantes */
+#define MAX_DESLOCAMENTO	16 //Evita estouro de base << n antes de aplicar o teto.
+
+/* Variáveis Globais */
+static const char * TAG = "wifi_reconexao";
+
+static wifi_reconexao_config_t s_config;
+static esp_timer_handle_t s_timer;
+static wifi_reconexao_stats_t s_stats;	//Com s_lock: a task do esp_timer conta as tentativas agendadas.
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bench_stats_t s_duracao;		//Tempo (ms) entre a queda e o novo IP.
+/*	Estado alterado apenas pela task do event loop (desconectado/conectado). O callback do timer
+	somente chama esp_wifi_connect(). */
+static uint32_t s_falhas;			//Falhas consecutivas desde o último IP.
+static int64_t s_inicio_queda;		//Instante (us) da queda; 0 enquanto conectado.
+
+static void wifi_reconexao_tentar( void *arg )
+{
+	portENTER_CRITICAL( &s_lock );
+	s_stats.tentativas++;
+	portEXIT_CRITICAL( &s_lock );
+	esp_wifi_connect();
+}
+
+esp_err_t wifi_reconexao_iniciar( const wifi_reconexao_config_t *config )
+{
+	if( config->grupo == NULL || config->atraso_base_ms == 0 || config->atraso_teto_ms < config->atraso_base_ms )
+		return ESP_ERR_INVALID_ARG;
+	s_config = *config;
+	bench_stats_init( &s_duracao, "tempo de reconexao" );
+
+	const esp_timer_create_args_t timer_args = {
+		.callback = wifi_reconexao_tentar,
+		.name = "wifi_reconexao",
+	};
+	return esp_timer_create( &timer_args, &s_timer );
+}
+
+/* Atraso (ms) antes da tentativa seguinte à falha número "falhas" (1 = primeira falha). */
+static uint32_t calcula_atraso( uint32_t falhas )
+{
+	uint32_t n = falhas - 2;
+	if( n > MAX_DESLOCAMENTO )
+		n = MAX_DESLOCAMENTO;
+	uint64_t atraso = (uint64_t) s_config.atraso_base_ms << n;
+	if( atraso > s_config.atraso_teto_ms )
+		atraso = s_config.atraso_teto_ms;
+	//Jitter: metade fixa e metade sorteada.
+	uint32_t metade = (uint32_t) atraso / 2;
+	return metade + esp_random() % ( metade + 1 );
+}
+
+void wifi_reconexao_desconectado( void )
+{
+	xEventGroupClearBits( s_config.grupo, s_config.bit_conectado );
+	if( s_inicio_queda == 0 )
+	{
+		s_inicio_queda = esp_timer_get_time();
+		portENTER_CRITICAL( &s_lock );
+		s_stats.quedas++;
+		portEXIT_CRITICAL( &s_lock );
+	}
+
+	s_falhas++;
+	if( s_falhas == s_config.tentativas_falha )
+	{
+		ESP_LOGW( TAG, "%u tentativas sem sucesso, continuando com backoff", s_falhas );
+		xEventGroupSetBits( s_config.grupo, s_config.bit_falha );
+	}
+
+	//Uma tentativa pode já estar agendada se o driver gerar mais de um evento de desconexão.
+	esp_timer_stop( s_timer );
+	if( s_falhas == 1 )
+	{
+		wifi_reconexao_tentar( NULL );
+		return;
+	}
+	uint32_t atraso_ms = calcula_atraso( s_falhas );
+	ESP_LOGI( TAG, "Falha %u, nova tentativa em %u ms", s_falhas, atraso_ms );
+	esp_timer_start_once( s_timer, (uint64_t) atraso_ms * 1000 );
+}
+
+void wifi_reconexao_conectado( void )
+{
+	esp_timer_stop( s_timer );
+	if( s_inicio_queda != 0 )
+	{
+		bench_stats_add( &s_duracao, (uint32_t)( ( esp_timer_get_time() - s_inicio_queda ) / 1000 ) );
+		portENTER_CRITICAL( &s_lock );
+		s_stats.reconexoes++;
+		portEXIT_CRITICAL( &s_lock );
+	}
+	s_inicio_queda = 0;
+	s_falhas = 0;
+	xEventGroupClearBits( s_config.grupo, s_config.bit_falha );
+	xEventGroupSetBits( s_config.grupo, s_config.bit_conectado );
+}
+
+void wifi_reconexao_estatisticas( wifi_reconexao_stats_t *stats )
+{
+	portENTER_CRITICAL( &s_lock );
+	*stats = s_stats;
+	portEXIT_CRITICAL( &s_lock );
+}
+
+void wifi_reconexao_relatorio( void )
+{
+	wifi_reconexao_stats_t stats;
+	wifi_reconexao_estatisticas( &stats );
+	ESP_LOGI( TAG, "quedas: %u, tentativas: %u, reconexoes: %u", stats.quedas, stats.tentativas, stats.reconexoes );
+	bench_stats_report( &s_duracao, "ms" );
+}
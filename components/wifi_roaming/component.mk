@@ -0,0 +1,4 @@
+#
+# Roaming entre APs: perfis de SSID, varredura em segundo plano e troca de BSSID por RSSI.
+#
+COMPONENT_ADD_INCLUDEDIRS := include
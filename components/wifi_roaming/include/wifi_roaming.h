@@ -0,0 +1,80 @@
+/*
+	Objetivo: Roaming entre vários APs - perfis de SSID, varredura em segundo plano com cache e troca
+			  de BSSID por RSSI com histerese (e dicas do 802.11k/v quando disponíveis)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_wifi.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WIFI_ROAMING_MAX_PERFIS		4	//Perfis do Kconfig e da NVS somados.
+#define WIFI_ROAMING_MAX_APS		12	//APs (BSSIDs) guardados no cache da varredura.
+
+typedef struct {
+	char ssid[33];
+	char senha[65];
+} wifi_roaming_perfil_t;
+
+typedef struct {
+	const wifi_roaming_perfil_t *perfis;	//Perfis da aplicação (Kconfig); os salvos na NVS vêm depois.
+	size_t n_perfis;
+	int8_t rssi_limiar;				//Abaixo dele a conexão é fraca: varre mais e permite a troca de AP.
+	uint8_t histerese_db;			//Margem do candidato sobre o AP atual; a conexão volta a ser forte acima de limiar + histerese.
+	uint32_t varredura_forte_ms;	//Intervalo entre varreduras com a conexão forte (0: somente quando fraca).
+	uint32_t varredura_fraca_ms;	//Intervalo entre varreduras e leituras do RSSI com a conexão fraca.
+	uint32_t validade_cache_ms;		//Resultados mais antigos não são usados para escolher o AP.
+	uint32_t falhas_por_perfil;		//Falhas seguidas, sem candidato no cache, antes de passar ao próximo perfil.
+} wifi_roaming_config_t;
+
+typedef struct {
+	uint32_t varreduras;			//Varreduras completas (todos os canais).
+	uint32_t varreduras_canal;		//Varreduras de um canal indicado pelo vizinho do 802.11k.
+	uint32_t trocas;				//Trocas de AP pedidas pelo roaming.
+	uint32_t trocas_externas;		//Reconexões em outro BSSID sem pedido (queda, 802.11v BTM).
+	uint32_t trocas_perfil;			//Mudanças de SSID por falhas seguidas.
+	uint64_t ms_conectado;			//Tempo total conectado...
+	uint64_t ms_abaixo_limiar;		//...e a parte dele com a conexão fraca.
+	int8_t rssi;					//Última leitura do AP atual.
+} wifi_roaming_stats_t;
+
+/*
+	Carrega os perfis da NVS, escreve o primeiro perfil em "wifi" e registra os handlers da varredura
+	e do RSSI. "wifi" é a configuração da station mantida pela aplicação: wifi_roaming_desconectado()
+	a altera para a próxima tentativa. Chamar após esp_wifi_init() e nvs_flash_init(), antes de
+	esp_wifi_set_config().
+*/
+esp_err_t wifi_roaming_iniciar( const wifi_roaming_config_t *config, wifi_config_t *wifi );
+
+/* Acrescenta (ou atualiza a senha de) um perfil na NVS. Vale a partir do próximo boot. */
+esp_err_t wifi_roaming_salvar_perfil( const wifi_roaming_perfil_t *perfil );
+
+/*
+	Chamar no WIFI_EVENT_STA_DISCONNECTED, antes de agendar a nova tentativa. Retorna ESP_OK se escreveu
+	em "wifi" o próximo AP: o destino de uma troca pedida pelo roaming, o melhor AP do cache ou o
+	próximo perfil. A aplicação aplica a configuração (esp_wifi_set_config) e reconecta. Retorna
+	ESP_ERR_NOT_FOUND se a configuração atual deve ser mantida.
+*/
+esp_err_t wifi_roaming_desconectado( wifi_config_t *wifi );
+
+/* Chamar no IP_EVENT_STA_GOT_IP: mede a troca, se houve, e volta a monitorar o RSSI do novo AP. */
+void wifi_roaming_conectado( void );
+
+/* Cópia dos contadores. */
+void wifi_roaming_estatisticas( wifi_roaming_stats_t *stats );
+
+/* Imprime os contadores, o tempo abaixo do limiar, o cache de APs e o histograma do tempo de troca (ms). */
+void wifi_roaming_relatorio( void );
+
+#ifdef __cplusplus
+}
+#endif
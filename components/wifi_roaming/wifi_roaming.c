@@ -0,0 +1,615 @@
+/*
+	Objetivo: Roaming entre vários APs - perfis de SSID, varredura em segundo plano com cache e troca
+			  de BSSID por RSSI com histerese (e dicas do 802.11k/v quando disponíveis)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "esp_event.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "nvs.h"
+#include "benchmark.h"
+#include "wifi_roaming.h"
+#if CONFIG_WPA_11KV_SUPPORT
+#include "esp_rrm.h"
+#endif
+
+/* Definições e Constantes */
+#define NVS_NAMESPACE		"wifi_roaming"
+#define NVS_CHAVE			"perfis"
+#define PERFIL_VAZIO		0xFF	//Entrada livre do cache.
+#define MAX_REGISTROS		16		//Registros lidos por varredura (o driver descarta os demais).
+#define MAX_CANAIS			8		//Canais dos vizinhos informados pelo AP (802.11k).
+#define MAX_FALHAS_AP		2		//Tentativas sem sucesso antes de ignorar o AP até a próxima varredura.
+#define TEMPO_CANAL_MS		60		//Varredura ativa curta: a station precisa voltar ao canal do AP.
+#define PERIODO_RSSI_MS		2000	//Leitura do RSSI enquanto a conexão está fraca.
+#define ELEMENTO_VIZINHO	52		//Neighbor Report (IEEE 802.11-2016 9.4.2.37).
+#define TAMANHO_VIZINHO		13		//BSSID, informações, classe de operação, canal e tipo de PHY.
+
+/* AP visto em uma varredura */
+typedef struct {
+	uint8_t bssid[6];
+	uint8_t canal;
+	int8_t rssi;
+	uint8_t perfil;			//Índice em s_perfis, ou PERFIL_VAZIO.
+	uint8_t falhas;			//Conexões sem sucesso desde que apareceu na última varredura.
+	uint32_t instante_ms;
+} ap_cache_t;
+
+/* Variáveis Globais */
+static const char * TAG = "wifi_roaming";
+
+static wifi_roaming_config_t s_config;
+static wifi_roaming_perfil_t s_perfis[WIFI_ROAMING_MAX_PERFIS];
+static size_t s_n_perfis;
+static size_t s_perfil;						//Perfil da conexão atual ou da tentativa em andamento.
+static ap_cache_t s_aps[WIFI_ROAMING_MAX_APS];
+static wifi_ap_record_t s_registros[MAX_REGISTROS];
+static esp_timer_handle_t s_timer_varredura;
+static esp_timer_handle_t s_timer_rssi;
+static wifi_roaming_stats_t s_stats;
+static bench_stats_t s_tempo_troca;			//Tempo (ms) entre a desconexão e o IP no novo BSSID.
+
+/*	Estado compartilhado pelo event loop (eventos do WiFi, desconectado/conectado), pela task do
+	esp_timer (RSSI e varreduras periódicas) e pelo callback do 802.11k. */
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static bool s_conectado;
+static bool s_fraca;						//RSSI abaixo do limiar e ainda não acima de limiar + histerese.
+static bool s_varrendo;
+static bool s_troca_pedida;					//Desconexão pedida pelo roaming, destino em s_alvo.
+static bool s_ultima_pedida;				//A desconexão em andamento foi pedida pelo roaming.
+static bool s_bssid_forcado;				//A configuração aponta para um BSSID escolhido aqui.
+static ap_cache_t s_alvo;
+static uint8_t s_bssid_atual[6];
+static uint8_t s_bssid_tentado[6];
+static int64_t s_inicio_troca;				//Instante (us) da desconexão; 0 enquanto conectado.
+static int64_t s_marca;						//Último instante contabilizado em ms_conectado.
+static uint32_t s_falhas;					//Falhas seguidas desde o último IP.
+static uint8_t s_canais[MAX_CANAIS];
+static size_t s_n_canais;
+static size_t s_proximo_canal;
+
+static inline uint32_t agora_ms( void )
+{
+	return (uint32_t)( esp_timer_get_time() / 1000 );
+}
+
+/* Soma o tempo desde a última marca ao tempo conectado e, se fraca, ao tempo abaixo do limiar. Com s_lock. */
+static void contabiliza( void )
+{
+	int64_t agora = esp_timer_get_time();
+	if( s_conectado )
+	{
+		uint32_t ms = (uint32_t)( ( agora - s_marca ) / 1000 );
+		s_stats.ms_conectado += ms;
+		if( s_fraca )
+			s_stats.ms_abaixo_limiar += ms;
+	}
+	s_marca = agora;
+}
+
+static int perfil_do_ssid( const uint8_t *ssid )
+{
+	for( size_t i = 0; i < s_n_perfis; i++ )
+		if( strncmp( s_perfis[i].ssid, (const char*) ssid, sizeof( s_perfis[i].ssid ) ) == 0 )
+			return i;
+	return -1;
+}
+
+static ap_cache_t *procura_ap( const uint8_t *bssid )
+{
+	for( size_t i = 0; i < WIFI_ROAMING_MAX_APS; i++ )
+		if( s_aps[i].perfil != PERFIL_VAZIO && memcmp( s_aps[i].bssid, bssid, 6 ) == 0 )
+			return &s_aps[i];
+	return NULL;
+}
+
+/* Atualiza o AP no cache, substituindo o registro mais antigo se o cache estiver cheio. Com s_lock. */
+static void atualiza_ap( const wifi_ap_record_t *registro, int perfil, uint32_t instante )
+{
+	ap_cache_t *ap = procura_ap( registro->bssid );
+	for( size_t i = 0; ap == NULL && i < WIFI_ROAMING_MAX_APS; i++ )
+		if( s_aps[i].perfil == PERFIL_VAZIO )
+			ap = &s_aps[i];
+	if( ap == NULL )
+	{
+		ap = &s_aps[0];
+		for( size_t i = 1; i < WIFI_ROAMING_MAX_APS; i++ )
+			if( instante - s_aps[i].instante_ms > instante - ap->instante_ms )
+				ap = &s_aps[i];
+	}
+
+	memcpy( ap->bssid, registro->bssid, 6 );
+	ap->canal = registro->primary;
+	ap->rssi = registro->rssi;
+	ap->perfil = perfil;
+	ap->falhas = 0;
+	ap->instante_ms = instante;
+}
+
+/* Melhor AP recente do cache, diferente de "excluir". Com s_lock. */
+static bool escolhe_candidato( const uint8_t *excluir, ap_cache_t *saida )
+{
+	uint32_t agora = agora_ms();
+	const ap_cache_t *melhor = NULL;
+	for( size_t i = 0; i < WIFI_ROAMING_MAX_APS; i++ )
+	{
+		const ap_cache_t *ap = &s_aps[i];
+		if( ap->perfil == PERFIL_VAZIO || ap->falhas >= MAX_FALHAS_AP
+			|| agora - ap->instante_ms > s_config.validade_cache_ms
+			|| ( excluir && memcmp( ap->bssid, excluir, 6 ) == 0 ) )
+			continue;
+		if( melhor == NULL || ap->rssi > melhor->rssi )
+			melhor = ap;
+	}
+	if( melhor )
+		*saida = *melhor;
+	return melhor != NULL;
+}
+
+/* Configuração para conectar direto em um AP do cache, sem a varredura de todos os canais. Com s_lock. */
+static void aplica_ap( wifi_config_t *wifi, const ap_cache_t *ap )
+{
+	s_perfil = ap->perfil;
+	strlcpy( (char*) wifi->sta.ssid, s_perfis[s_perfil].ssid, sizeof( wifi->sta.ssid ) );
+	strlcpy( (char*) wifi->sta.password, s_perfis[s_perfil].senha, sizeof( wifi->sta.password ) );
+	memcpy( wifi->sta.bssid, ap->bssid, 6 );
+	wifi->sta.bssid_set = true;
+	wifi->sta.channel = ap->canal;
+	wifi->sta.scan_method = WIFI_FAST_SCAN;
+	memcpy( s_bssid_tentado, ap->bssid, 6 );
+	s_bssid_forcado = true;
+}
+
+/* Configuração para o perfil atual em qualquer AP, com a varredura de todos os canais. Com s_lock. */
+static void aplica_perfil( wifi_config_t *wifi )
+{
+	strlcpy( (char*) wifi->sta.ssid, s_perfis[s_perfil].ssid, sizeof( wifi->sta.ssid ) );
+	strlcpy( (char*) wifi->sta.password, s_perfis[s_perfil].senha, sizeof( wifi->sta.password ) );
+	memset( wifi->sta.bssid, 0, sizeof( wifi->sta.bssid ) );
+	wifi->sta.bssid_set = false;
+	wifi->sta.channel = 0;
+	wifi->sta.scan_method = WIFI_ALL_CHANNEL_SCAN;
+	s_bssid_forcado = false;
+}
+
+/* Varredura completa, ou do próximo canal indicado pelos vizinhos do 802.11k. */
+static void inicia_varredura( void )
+{
+	uint8_t canal = 0;
+
+	portENTER_CRITICAL( &s_lock );
+	bool pode = s_conectado && !s_varrendo && !s_troca_pedida;
+	if( pode )
+	{
+		s_varrendo = true;
+		if( s_n_canais )
+		{
+			if( s_proximo_canal >= s_n_canais )
+				s_proximo_canal = 0;
+			canal = s_canais[s_proximo_canal++];
+			s_stats.varreduras_canal++;
+		}
+		else
+			s_stats.varreduras++;
+	}
+	portEXIT_CRITICAL( &s_lock );
+	if( !pode )
+		return;
+
+	wifi_scan_config_t varredura = {
+		.channel = canal,
+		.show_hidden = false,
+		.scan_type = WIFI_SCAN_TYPE_ACTIVE,
+		.scan_time.active = { .min = 0, .max = TEMPO_CANAL_MS },
+	};
+	if( esp_wifi_scan_start( &varredura, false ) != ESP_OK )
+	{
+		portENTER_CRITICAL( &s_lock );
+		s_varrendo = false;
+		s_proximo_canal = 0;
+		portEXIT_CRITICAL( &s_lock );
+	}
+}
+
+/* Intervalo da varredura periódica conforme o estado da conexão. */
+static void agenda_varredura( void )
+{
+	esp_timer_stop( s_timer_varredura );
+	uint32_t periodo = s_fraca ? s_config.varredura_fraca_ms : s_config.varredura_forte_ms;
+	if( s_conectado && periodo )
+		esp_timer_start_periodic( s_timer_varredura, (uint64_t) periodo * 1000 );
+}
+
+/*
+	Com a conexão fraca, troca de AP se o melhor candidato recente supera o atual pela histerese. A
+	desconexão é tratada pela aplicação: wifi_roaming_desconectado() entrega o destino e a reconexão
+	segue o caminho normal (wifi_reconexao).
+*/
+static void avalia( void )
+{
+	ap_cache_t candidato;
+
+	portENTER_CRITICAL( &s_lock );
+	bool trocar = s_conectado && s_fraca && !s_troca_pedida && !s_varrendo
+				  && escolhe_candidato( s_bssid_atual, &candidato )
+				  && candidato.rssi >= s_stats.rssi + s_config.histerese_db;
+	if( trocar )
+	{
+		s_alvo = candidato;
+		s_troca_pedida = true;
+		s_inicio_troca = esp_timer_get_time();
+		s_stats.trocas++;
+	}
+	int8_t rssi = s_stats.rssi;
+	portEXIT_CRITICAL( &s_lock );
+
+	if( trocar )
+	{
+		ESP_LOGI( TAG, "Troca de AP: %d dBm -> %02x:%02x:%02x:%02x:%02x:%02x (%s, canal %u, %d dBm)", rssi,
+				  candidato.bssid[0], candidato.bssid[1], candidato.bssid[2], candidato.bssid[3],
+				  candidato.bssid[4], candidato.bssid[5], s_perfis[candidato.perfil].ssid, candidato.canal, candidato.rssi );
+		esp_wifi_disconnect();
+	}
+}
+
+static void entra_fraca( int8_t rssi )
+{
+	portENTER_CRITICAL( &s_lock );
+	bool mudou = s_conectado && !s_fraca;
+	if( mudou )
+	{
+		contabiliza();
+		s_fraca = true;
+		s_stats.rssi = rssi;
+	}
+	portEXIT_CRITICAL( &s_lock );
+	if( !mudou )
+		return;
+
+	ESP_LOGI( TAG, "Conexao fraca: %d dBm (limiar %d)", rssi, s_config.rssi_limiar );
+	esp_timer_start_periodic( s_timer_rssi, (uint64_t) PERIODO_RSSI_MS * 1000 );
+	agenda_varredura();
+	//Com um candidato no cache a troca é imediata; senão a varredura busca um.
+	avalia();
+	inicia_varredura();
+}
+
+/* Leitura do RSSI enquanto a conexão está fraca (timer desligado com a conexão forte). */
+static void le_rssi( void *arg )
+{
+	wifi_ap_record_t info;
+	if( esp_wifi_sta_get_ap_info( &info ) != ESP_OK )
+		return;
+
+	portENTER_CRITICAL( &s_lock );
+	s_stats.rssi = info.rssi;
+	ap_cache_t *ap = procura_ap( info.bssid );
+	if( ap )
+	{
+		ap->rssi = info.rssi;
+		ap->instante_ms = agora_ms();
+	}
+	bool recuperou = s_fraca && info.rssi >= s_config.rssi_limiar + s_config.histerese_db;
+	if( recuperou )
+	{
+		contabiliza();
+		s_fraca = false;
+	}
+	portEXIT_CRITICAL( &s_lock );
+
+	if( recuperou )
+	{
+		ESP_LOGI( TAG, "Conexao forte: %d dBm", info.rssi );
+		esp_timer_stop( s_timer_rssi );
+		esp_wifi_set_rssi_threshold( s_config.rssi_limiar );
+		agenda_varredura();
+		return;
+	}
+	avalia();
+}
+
+static void varredura_periodica( void *arg )
+{
+	portENTER_CRITICAL( &s_lock );
+	s_proximo_canal = 0;
+	portEXIT_CRITICAL( &s_lock );
+	inicia_varredura();
+}
+
+/* Resultado de uma varredura: guarda no cache os APs dos perfis conhecidos. */
+static void varredura_concluida( void )
+{
+	uint16_t n = MAX_REGISTROS;
+	if( esp_wifi_scan_get_ap_records( &n, s_registros ) != ESP_OK )
+		n = 0;
+
+	uint32_t instante = agora_ms();
+	portENTER_CRITICAL( &s_lock );
+	for( uint16_t i = 0; i < n; i++ )
+	{
+		int perfil = perfil_do_ssid( s_registros[i].ssid );
+		if( perfil >= 0 )
+			atualiza_ap( &s_registros[i], perfil, instante );
+	}
+	s_varrendo = false;
+	bool continuar = s_proximo_canal > 0 && s_proximo_canal < s_n_canais;
+	if( !continuar )
+		s_proximo_canal = 0;
+	portEXIT_CRITICAL( &s_lock );
+
+	if( continuar )
+		inicia_varredura();
+	else
+		avalia();
+}
+
+static void wifi_roaming_handler( void* arg, esp_event_base_t event_base, int32_t event_id, void* event_data )
+{
+	if( event_id == WIFI_EVENT_SCAN_DONE )
+	{
+		if( s_varrendo )
+			varredura_concluida();
+	}
+	else if( event_id == WIFI_EVENT_STA_BSS_RSSI_LOW )
+		entra_fraca( (int8_t)( (wifi_event_bss_rssi_low_t*) event_data )->rssi );
+}
+
+#if CONFIG_WPA_11KV_SUPPORT
+/*
+	Neighbor Report do AP atual (802.11k): as varreduras passam a visitar somente os canais dos
+	vizinhos, um por vez, em vez dos 13 canais. As requisições de BSS Transition (802.11v) são
+	respondidas pelo supplicant, que reassocia sozinho; a troca aparece em trocas_externas.
+*/
+static void vizinhos_recebidos( void *ctx, const uint8_t *relatorio, size_t tamanho )
+{
+	uint8_t canais[MAX_CANAIS];
+	size_t n = 0;
+
+	while( tamanho >= 2 && tamanho >= 2u + relatorio[1] )
+	{
+		if( relatorio[0] == ELEMENTO_VIZINHO && relatorio[1] >= TAMANHO_VIZINHO )
+		{
+			uint8_t canal = relatorio[2 + 11];
+			size_t i = 0;
+			while( i < n && canais[i] != canal )
+				i++;
+			if( i == n && n < MAX_CANAIS )
+				canais[n++] = canal;
+		}
+		tamanho -= 2 + relatorio[1];
+		relatorio += 2 + relatorio[1];
+	}
+
+	portENTER_CRITICAL( &s_lock );
+	memcpy( s_canais, canais, n );
+	s_n_canais = n;
+	s_proximo_canal = 0;
+	portEXIT_CRITICAL( &s_lock );
+	ESP_LOGI( TAG, "802.11k: %u canais de vizinhos", n );
+}
+#endif
+
+static void carrega_perfis_nvs( void )
+{
+	wifi_roaming_perfil_t salvos[WIFI_ROAMING_MAX_PERFIS];
+	nvs_handle_t nvs;
+	if( nvs_open( NVS_NAMESPACE, NVS_READONLY, &nvs ) != ESP_OK )
+		return;
+	size_t tamanho = sizeof( salvos );
+	if( nvs_get_blob( nvs, NVS_CHAVE, salvos, &tamanho ) != ESP_OK )
+		tamanho = 0;
+	nvs_close( nvs );
+
+	for( size_t i = 0; i < tamanho / sizeof( salvos[0] ) && s_n_perfis < WIFI_ROAMING_MAX_PERFIS; i++ )
+	{
+		salvos[i].ssid[sizeof( salvos[i].ssid ) - 1] = '\0';
+		salvos[i].senha[sizeof( salvos[i].senha ) - 1] = '\0';
+		if( perfil_do_ssid( (const uint8_t*) salvos[i].ssid ) < 0 )
+			s_perfis[s_n_perfis++] = salvos[i];
+	}
+}
+
+esp_err_t wifi_roaming_iniciar( const wifi_roaming_config_t *config, wifi_config_t *wifi )
+{
+	if( config->rssi_limiar >= 0 || config->varredura_fraca_ms == 0 || config->validade_cache_ms == 0 )
+		return ESP_ERR_INVALID_ARG;
+	s_config = *config;
+	bench_stats_init( &s_tempo_troca, "tempo de troca de AP" );
+	for( size_t i = 0; i < WIFI_ROAMING_MAX_APS; i++ )
+		s_aps[i].perfil = PERFIL_VAZIO;
+
+	//Perfis vazios (SSID opcional do Kconfig em branco) são ignorados.
+	for( size_t i = 0; i < config->n_perfis && s_n_perfis < WIFI_ROAMING_MAX_PERFIS; i++ )
+		if( config->perfis[i].ssid[0] && perfil_do_ssid( (const uint8_t*) config->perfis[i].ssid ) < 0 )
+			s_perfis[s_n_perfis++] = config->perfis[i];
+	carrega_perfis_nvs();
+	if( s_n_perfis == 0 )
+		return ESP_ERR_INVALID_ARG;
+	ESP_LOGI( TAG, "%zu perfis de SSID", s_n_perfis );
+
+	s_perfil = 0;
+	strlcpy( (char*) wifi->sta.ssid, s_perfis[0].ssid, sizeof( wifi->sta.ssid ) );
+	strlcpy( (char*) wifi->sta.password, s_perfis[0].senha, sizeof( wifi->sta.password ) );
+#if CONFIG_WPA_11KV_SUPPORT
+	wifi->sta.rm_enabled = 1;
+	wifi->sta.btm_enabled = 1;
+#endif
+
+	const esp_timer_create_args_t timer_varredura = {
+		.callback = varredura_periodica,
+		.name = "roaming_varredura",
+	};
+	const esp_timer_create_args_t timer_rssi = {
+		.callback = le_rssi,
+		.name = "roaming_rssi",
+	};
+	esp_err_t ret = esp_timer_create( &timer_varredura, &s_timer_varredura );
+	if( ret == ESP_OK )
+		ret = esp_timer_create( &timer_rssi, &s_timer_rssi );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &wifi_roaming_handler, NULL );
+	if( ret == ESP_OK )
+		ret = esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_BSS_RSSI_LOW, &wifi_roaming_handler, NULL );
+	return ret;
+}
+
+esp_err_t wifi_roaming_salvar_perfil( const wifi_roaming_perfil_t *perfil )
+{
+	wifi_roaming_perfil_t salvos[WIFI_ROAMING_MAX_PERFIS];
+	nvs_handle_t nvs;
+	esp_err_t ret = nvs_open( NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	if( ret != ESP_OK )
+		return ret;
+	size_t tamanho = sizeof( salvos );
+	if( nvs_get_blob( nvs, NVS_CHAVE, salvos, &tamanho ) != ESP_OK )
+		tamanho = 0;
+
+	size_t n = tamanho / sizeof( salvos[0] ), i = 0;
+	while( i < n && strncmp( salvos[i].ssid, perfil->ssid, sizeof( salvos[i].ssid ) ) != 0 )
+		i++;
+	if( i == WIFI_ROAMING_MAX_PERFIS )
+		ret = ESP_ERR_NO_MEM;
+	else
+	{
+		salvos[i] = *perfil;
+		if( i == n )
+			n++;
+		ret = nvs_set_blob( nvs, NVS_CHAVE, salvos, n * sizeof( salvos[0] ) );
+		if( ret == ESP_OK )
+			ret = nvs_commit( nvs );
+	}
+	nvs_close( nvs );
+	return ret;
+}
+
+esp_err_t wifi_roaming_desconectado( wifi_config_t *wifi )
+{
+	esp_timer_stop( s_timer_rssi );
+	esp_timer_stop( s_timer_varredura );
+
+	esp_err_t ret = ESP_OK;
+	ap_cache_t candidato;
+	portENTER_CRITICAL( &s_lock );
+	contabiliza();
+	s_conectado = false;
+	s_fraca = false;
+	s_varrendo = false;
+	s_proximo_canal = 0;
+	if( s_inicio_troca == 0 )
+		s_inicio_troca = esp_timer_get_time();
+
+	if( s_troca_pedida )
+	{
+		s_troca_pedida = false;
+		s_ultima_pedida = true;
+		aplica_ap( wifi, &s_alvo );
+	}
+	else
+	{
+		//Queda ou tentativa sem sucesso: o AP tentado perde prioridade até aparecer em nova varredura.
+		s_falhas++;
+		ap_cache_t *tentado = s_bssid_forcado ? procura_ap( s_bssid_tentado ) : NULL;
+		if( tentado && tentado->falhas < MAX_FALHAS_AP )
+			tentado->falhas++;
+
+		if( escolhe_candidato( NULL, &candidato ) )
+			aplica_ap( wifi, &candidato );
+		else if( s_falhas >= s_config.falhas_por_perfil && s_n_perfis > 1 )
+		{
+			s_perfil = ( s_perfil + 1 ) % s_n_perfis;
+			s_falhas = 0;
+			s_stats.trocas_perfil++;
+			aplica_perfil( wifi );
+		}
+		else if( s_bssid_forcado )
+			aplica_perfil( wifi );
+		else
+			ret = ESP_ERR_NOT_FOUND;
+	}
+	size_t perfil = s_perfil;
+	portEXIT_CRITICAL( &s_lock );
+
+	if( ret == ESP_OK )
+		ESP_LOGI( TAG, "Proxima tentativa: %s%s", s_perfis[perfil].ssid, wifi->sta.bssid_set ? " (AP do cache)" : "" );
+	return ret;
+}
+
+void wifi_roaming_conectado( void )
+{
+	static const uint8_t nenhum[6];
+	wifi_ap_record_t info;
+	if( esp_wifi_sta_get_ap_info( &info ) != ESP_OK )
+		return;
+
+	portENTER_CRITICAL( &s_lock );
+	bool trocou = memcmp( s_bssid_atual, nenhum, 6 ) != 0 && memcmp( s_bssid_atual, info.bssid, 6 ) != 0;
+	if( trocou && s_inicio_troca )
+	{
+		bench_stats_add( &s_tempo_troca, (uint32_t)( ( esp_timer_get_time() - s_inicio_troca ) / 1000 ) );
+		if( !s_ultima_pedida )
+			s_stats.trocas_externas++;
+	}
+	int perfil = perfil_do_ssid( info.ssid );
+	if( perfil >= 0 )
+	{
+		s_perfil = perfil;
+		atualiza_ap( &info, perfil, agora_ms() );
+	}
+	memcpy( s_bssid_atual, info.bssid, 6 );
+	s_inicio_troca = 0;
+	s_ultima_pedida = false;
+	s_falhas = 0;
+	s_stats.rssi = info.rssi;
+	s_conectado = true;
+	s_fraca = false;
+	s_n_canais = 0;
+	s_marca = esp_timer_get_time();
+	portEXIT_CRITICAL( &s_lock );
+
+	//O driver avisa (WIFI_EVENT_STA_BSS_RSSI_LOW) quando o RSSI cair abaixo do limiar: sem consultas com a conexão forte.
+	esp_wifi_set_rssi_threshold( s_config.rssi_limiar );
+	agenda_varredura();
+#if CONFIG_WPA_11KV_SUPPORT
+	esp_rrm_send_neighbor_rep_request( vizinhos_recebidos, NULL );
+#endif
+	if( info.rssi < s_config.rssi_limiar )
+		entra_fraca( info.rssi );
+}
+
+void wifi_roaming_estatisticas( wifi_roaming_stats_t *stats )
+{
+	portENTER_CRITICAL( &s_lock );
+	contabiliza();
+	*stats = s_stats;
+	portEXIT_CRITICAL( &s_lock );
+}
+
+void wifi_roaming_relatorio( void )
+{
+	wifi_roaming_stats_t stats;
+	ap_cache_t aps[WIFI_ROAMING_MAX_APS];
+
+	wifi_roaming_estatisticas( &stats );
+	portENTER_CRITICAL( &s_lock );
+	memcpy( aps, s_aps, sizeof( aps ) );
+	portEXIT_CRITICAL( &s_lock );
+
+	ESP_LOGI( TAG, "varreduras: %u completas, %u por canal; trocas: %u pedidas, %u externas, %u de perfil; RSSI %d dBm",
+			  stats.varreduras, stats.varreduras_canal, stats.trocas, stats.trocas_externas, stats.trocas_perfil, stats.rssi );
+	ESP_LOGI( TAG, "abaixo do limiar: %u de %u s conectado (%u%%)", (uint32_t)( stats.ms_abaixo_limiar / 1000 ),
+			  (uint32_t)( stats.ms_conectado / 1000 ),
+			  stats.ms_conectado ? (uint32_t)( stats.ms_abaixo_limiar * 100 / stats.ms_conectado ) : 0 );
+	uint32_t agora = agora_ms();
+	for( size_t i = 0; i < WIFI_ROAMING_MAX_APS; i++ )
+		if( aps[i].perfil != PERFIL_VAZIO )
+			ESP_LOGI( TAG, "  %02x:%02x:%02x:%02x:%02x:%02x %-12s canal %2u %4d dBm, visto ha %u s%s",
+					  aps[i].bssid[0], aps[i].bssid[1], aps[i].bssid[2], aps[i].bssid[3], aps[i].bssid[4], aps[i].bssid[5],
+					  s_perfis[aps[i].perfil].ssid, aps[i].canal, aps[i].rssi, ( agora - aps[i].instante_ms ) / 1000,
+					  aps[i].falhas >= MAX_FALHAS_AP ? " (ignorado)" : "" );
+	bench_stats_report( &s_tempo_troca, "ms" );
+}
@@ -0,0 +1,112 @@
+/*
+	Objetivo: Driver de GPIO do ESP-IDF no build para Linux - os pinos são simulados com nível,
+			  pull, direção e interrupções (host/simulacao/gpio.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "soc/soc.h"
+#include "soc/gpio_reg.h"
+#include "soc/gpio_struct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	GPIO_NUM_NC = -1,
+	GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7,
+	GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+	GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, GPIO_NUM_23,
+	GPIO_NUM_25 = 25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_28, GPIO_NUM_29, GPIO_NUM_30, GPIO_NUM_31,
+	GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35, GPIO_NUM_36, GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39,
+	GPIO_NUM_MAX,
+} gpio_num_t;
+
+#define GPIO_SEL_0					( BIT( 0 ) )
+#define GPIO_PIN_COUNT				40
+#define GPIO_IS_VALID_GPIO( pino )	( ( pino ) >= 0 && ( pino ) < GPIO_PIN_COUNT && ( pino ) != 20 && ( pino ) != 24 \
+									  && ( ( pino ) < 28 || ( pino ) > 31 ) )
+#define GPIO_IS_VALID_OUTPUT_GPIO( pino )	( GPIO_IS_VALID_GPIO( pino ) && ( pino ) < 34 )
+
+#define GPIO_MODE_DEF_DISABLE		( 0 )
+#define GPIO_MODE_DEF_INPUT			( BIT0 )
+#define GPIO_MODE_DEF_OUTPUT		( BIT1 )
+#define GPIO_MODE_DEF_OD			( BIT2 )
+
+typedef enum {
+	GPIO_MODE_DISABLE = GPIO_MODE_DEF_DISABLE,
+	GPIO_MODE_INPUT = GPIO_MODE_DEF_INPUT,
+	GPIO_MODE_OUTPUT = GPIO_MODE_DEF_OUTPUT,
+	GPIO_MODE_OUTPUT_OD = GPIO_MODE_DEF_OUTPUT | GPIO_MODE_DEF_OD,
+	GPIO_MODE_INPUT_OUTPUT_OD = GPIO_MODE_DEF_INPUT | GPIO_MODE_DEF_OUTPUT | GPIO_MODE_DEF_OD,
+	GPIO_MODE_INPUT_OUTPUT = GPIO_MODE_DEF_INPUT | GPIO_MODE_DEF_OUTPUT,
+} gpio_mode_t;
+
+typedef enum {
+	GPIO_INTR_DISABLE = 0,
+	GPIO_INTR_POSEDGE = 1,
+	GPIO_INTR_NEGEDGE = 2,
+	GPIO_INTR_ANYEDGE = 3,
+	GPIO_INTR_LOW_LEVEL = 4,
+	GPIO_INTR_HIGH_LEVEL = 5,
+	GPIO_INTR_MAX,
+} gpio_int_type_t;
+
+typedef enum {
+	GPIO_PULLUP_DISABLE = 0,
+	GPIO_PULLUP_ENABLE = 1,
+} gpio_pullup_t;
+
+typedef enum {
+	GPIO_PULLDOWN_DISABLE = 0,
+	GPIO_PULLDOWN_ENABLE = 1,
+} gpio_pulldown_t;
+
+typedef enum {
+	GPIO_PULLUP_ONLY,
+	GPIO_PULLDOWN_ONLY,
+	GPIO_PULLUP_PULLDOWN,
+	GPIO_FLOATING,
+} gpio_pull_mode_t;
+
+typedef struct {
+	uint64_t pin_bit_mask;
+	gpio_mode_t mode;
+	gpio_pullup_t pull_up_en;
+	gpio_pulldown_t pull_down_en;
+	gpio_int_type_t intr_type;
+} gpio_config_t;
+
+typedef void (*gpio_isr_t)( void *arg );
+typedef struct gpio_isr_handle *gpio_isr_handle_t;
+
+#define ESP_INTR_FLAG_LEVEL1		( 1 << 1 )
+#define ESP_INTR_FLAG_IRAM			( 1 << 10 )
+
+esp_err_t gpio_config( const gpio_config_t *config );
+esp_err_t gpio_reset_pin( gpio_num_t pino );
+void gpio_pad_select_gpio( uint8_t pino );
+esp_err_t gpio_set_direction( gpio_num_t pino, gpio_mode_t modo );
+esp_err_t gpio_set_pull_mode( gpio_num_t pino, gpio_pull_mode_t pull );
+esp_err_t gpio_set_level( gpio_num_t pino, uint32_t nivel );
+int gpio_get_level( gpio_num_t pino );
+esp_err_t gpio_set_intr_type( gpio_num_t pino, gpio_int_type_t tipo );
+esp_err_t gpio_intr_enable( gpio_num_t pino );
+esp_err_t gpio_intr_disable( gpio_num_t pino );
+esp_err_t gpio_install_isr_service( int flags );
+void gpio_uninstall_isr_service( void );
+esp_err_t gpio_isr_handler_add( gpio_num_t pino, gpio_isr_t isr, void *arg );
+esp_err_t gpio_isr_handler_remove( gpio_num_t pino );
+esp_err_t gpio_wakeup_enable( gpio_num_t pino, gpio_int_type_t tipo );
+esp_err_t gpio_wakeup_disable( gpio_num_t pino );
+void gpio_matrix_out( uint32_t pino, uint32_t sinal, bool inverte, bool inverte_oen );
+
+#ifdef __cplusplus
+}
+#endif
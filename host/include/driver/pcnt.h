@@ -0,0 +1,95 @@
+/*
+	Objetivo: Driver do PCNT do ESP-IDF no build para Linux - as bordas dos pinos simulados
+			  alimentam os contadores (host/simulacao/pcnt.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "soc/pcnt_struct.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCNT_PIN_NOT_USED		( -1 )
+
+typedef enum {
+	PCNT_UNIT_0 = 0,
+	PCNT_UNIT_1,
+	PCNT_UNIT_2,
+	PCNT_UNIT_3,
+	PCNT_UNIT_4,
+	PCNT_UNIT_5,
+	PCNT_UNIT_6,
+	PCNT_UNIT_7,
+	PCNT_UNIT_MAX,
+} pcnt_unit_t;
+
+typedef enum {
+	PCNT_CHANNEL_0 = 0,
+	PCNT_CHANNEL_1,
+	PCNT_CHANNEL_MAX,
+} pcnt_channel_t;
+
+typedef enum {
+	PCNT_COUNT_DIS = 0,
+	PCNT_COUNT_INC,
+	PCNT_COUNT_DEC,
+	PCNT_COUNT_MAX,
+} pcnt_count_mode_t;
+
+typedef enum {
+	PCNT_MODE_KEEP = 0,
+	PCNT_MODE_REVERSE,
+	PCNT_MODE_DISABLE,
+	PCNT_MODE_MAX,
+} pcnt_ctrl_mode_t;
+
+typedef enum {
+	PCNT_EVT_THRES_1 = 1 << 2,
+	PCNT_EVT_THRES_0 = 1 << 3,
+	PCNT_EVT_L_LIM = 1 << 4,
+	PCNT_EVT_H_LIM = 1 << 5,
+	PCNT_EVT_ZERO = 1 << 6,
+	PCNT_EVT_MAX,
+} pcnt_evt_type_t;
+
+typedef struct {
+	int pulse_gpio_num;
+	int ctrl_gpio_num;
+	pcnt_ctrl_mode_t lctrl_mode;
+	pcnt_ctrl_mode_t hctrl_mode;
+	pcnt_count_mode_t pos_mode;
+	pcnt_count_mode_t neg_mode;
+	int16_t counter_h_lim;
+	int16_t counter_l_lim;
+	pcnt_unit_t unit;
+	pcnt_channel_t channel;
+} pcnt_config_t;
+
+esp_err_t pcnt_unit_config( const pcnt_config_t *config );
+esp_err_t pcnt_get_counter_value( pcnt_unit_t unidade, int16_t *valor );
+esp_err_t pcnt_counter_pause( pcnt_unit_t unidade );
+esp_err_t pcnt_counter_resume( pcnt_unit_t unidade );
+esp_err_t pcnt_counter_clear( pcnt_unit_t unidade );
+esp_err_t pcnt_intr_enable( pcnt_unit_t unidade );
+esp_err_t pcnt_intr_disable( pcnt_unit_t unidade );
+esp_err_t pcnt_event_enable( pcnt_unit_t unidade, pcnt_evt_type_t evento );
+esp_err_t pcnt_event_disable( pcnt_unit_t unidade, pcnt_evt_type_t evento );
+esp_err_t pcnt_set_event_value( pcnt_unit_t unidade, pcnt_evt_type_t evento, int16_t valor );
+esp_err_t pcnt_set_filter_value( pcnt_unit_t unidade, uint16_t filtro );
+esp_err_t pcnt_filter_enable( pcnt_unit_t unidade );
+esp_err_t pcnt_filter_disable( pcnt_unit_t unidade );
+esp_err_t pcnt_isr_service_install( int flags );
+void pcnt_isr_service_uninstall( void );
+esp_err_t pcnt_isr_handler_add( pcnt_unit_t unidade, void (*isr)( void *arg ), void *arg );
+esp_err_t pcnt_isr_handler_remove( pcnt_unit_t unidade );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,102 @@
+/*
+	Objetivo: Driver do RMT do ESP-IDF no build para Linux - o RX mede as bordas dos pinos simulados
+			  e entrega os quadros no ringbuffer do canal; o TX gera os níveis no pino (host/simulacao/rmt.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/ringbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	RMT_CHANNEL_0 = 0,
+	RMT_CHANNEL_1,
+	RMT_CHANNEL_2,
+	RMT_CHANNEL_3,
+	RMT_CHANNEL_4,
+	RMT_CHANNEL_5,
+	RMT_CHANNEL_6,
+	RMT_CHANNEL_7,
+	RMT_CHANNEL_MAX,
+} rmt_channel_t;
+
+typedef enum {
+	RMT_MODE_TX = 0,
+	RMT_MODE_RX,
+	RMT_MODE_MAX,
+} rmt_mode_t;
+
+typedef enum {
+	RMT_IDLE_LEVEL_LOW = 0,
+	RMT_IDLE_LEVEL_HIGH,
+	RMT_IDLE_LEVEL_MAX,
+} rmt_idle_level_t;
+
+typedef enum {
+	RMT_CARRIER_LEVEL_LOW = 0,
+	RMT_CARRIER_LEVEL_HIGH,
+	RMT_CARRIER_LEVEL_MAX,
+} rmt_carrier_level_t;
+
+typedef struct {
+	union {
+		struct {
+			uint32_t duration0:	15;
+			uint32_t level0:	1;
+			uint32_t duration1:	15;
+			uint32_t level1:	1;
+		};
+		uint32_t val;
+	};
+} rmt_item32_t;
+
+typedef struct {
+	bool loop_en;
+	uint32_t carrier_freq_hz;
+	uint8_t carrier_duty_percent;
+	rmt_carrier_level_t carrier_level;
+	bool carrier_en;
+	rmt_idle_level_t idle_level;
+	bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+	bool filter_en;
+	uint8_t filter_ticks_thresh;
+	uint16_t idle_threshold;
+} rmt_rx_config_t;
+
+typedef struct {
+	rmt_mode_t rmt_mode;
+	rmt_channel_t channel;
+	uint8_t clk_div;
+	gpio_num_t gpio_num;
+	uint8_t mem_block_num;
+	union {
+		rmt_tx_config_t tx_config;
+		rmt_rx_config_t rx_config;
+	};
+} rmt_config_t;
+
+esp_err_t rmt_config( const rmt_config_t *config );
+esp_err_t rmt_driver_install( rmt_channel_t canal, size_t tamanho_ring, int flags );
+esp_err_t rmt_driver_uninstall( rmt_channel_t canal );
+esp_err_t rmt_get_ringbuf_handle( rmt_channel_t canal, RingbufHandle_t *ring );
+esp_err_t rmt_rx_start( rmt_channel_t canal, bool zera_memoria );
+esp_err_t rmt_rx_stop( rmt_channel_t canal );
+esp_err_t rmt_write_items( rmt_channel_t canal, const rmt_item32_t *itens, int n, bool espera );
+esp_err_t rmt_wait_tx_done( rmt_channel_t canal, TickType_t espera );
+
+#ifdef __cplusplus
+}
+#endif
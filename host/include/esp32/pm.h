@@ -0,0 +1,24 @@
+/*
+	Objetivo: Configuração do gerenciamento de energia do ESP32 no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_pm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+	int max_freq_mhz;
+	int min_freq_mhz;
+	bool light_sleep_enable;
+} esp_pm_config_esp32_t;
+
+#ifdef __cplusplus
+}
+#endif
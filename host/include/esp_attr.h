@@ -0,0 +1,16 @@
+/*
+	Objetivo: Atributos de seção do ESP-IDF no build para Linux (sem efeito)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_IRAM_ATTR
+#define WORD_ALIGNED_ATTR	__attribute__( ( aligned( 4 ) ) )
+#define NOINLINE_ATTR		__attribute__( ( noinline ) )
+#define FORCE_INLINE_ATTR	static inline __attribute__( ( always_inline ) )
@@ -0,0 +1,37 @@
+/*
+	Objetivo: Laço de eventos padrão do ESP-IDF no build para Linux - os handlers rodam na task
+			  "sys_evt", na ordem em que os eventos foram postados
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)( void *arg, esp_event_base_t base, int32_t id, void *dados );
+
+#define ESP_EVENT_ANY_BASE		NULL
+#define ESP_EVENT_ANY_ID		-1
+#define ESP_EVENT_DECLARE_BASE( id )	extern esp_event_base_t id
+#define ESP_EVENT_DEFINE_BASE( id )		esp_event_base_t id = #id
+
+ESP_EVENT_DECLARE_BASE( WIFI_EVENT );
+ESP_EVENT_DECLARE_BASE( IP_EVENT );
+
+esp_err_t esp_event_loop_create_default( void );
+esp_err_t esp_event_handler_register( esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg );
+esp_err_t esp_event_handler_unregister( esp_event_base_t base, int32_t id, esp_event_handler_t handler );
+esp_err_t esp_event_post( esp_event_base_t base, int32_t id, const void *dados, size_t tamanho, TickType_t espera );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,57 @@
+/*
+	Objetivo: Log do ESP-IDF no build para Linux - mesmo formato da UART ("I (ms) tag: texto")
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdarg.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	ESP_LOG_NONE,
+	ESP_LOG_ERROR,
+	ESP_LOG_WARN,
+	ESP_LOG_INFO,
+	ESP_LOG_DEBUG,
+	ESP_LOG_VERBOSE
+} esp_log_level_t;
+
+#ifndef LOG_LOCAL_LEVEL
+#define LOG_LOCAL_LEVEL		CONFIG_LOG_DEFAULT_LEVEL
+#endif
+
+typedef int (*vprintf_like_t)( const char *formato, va_list args );
+
+uint32_t esp_log_timestamp( void );
+/* Troca a saída do log (cada linha completa passa pela função); retorna a anterior. */
+vprintf_like_t esp_log_set_vprintf( vprintf_like_t funcao );
+void esp_log_level_set( const char *tag, esp_log_level_t nivel );
+void esp_log_write( esp_log_level_t nivel, const char *tag, const char *formato, ... )
+	__attribute__( ( format( printf, 3, 4 ) ) );
+void esp_log_writev( esp_log_level_t nivel, const char *tag, const char *formato, va_list args );
+
+#define ESP_LOG_LEVEL( nivel, tag, formato, ... ) do {						\
+		if( LOG_LOCAL_LEVEL >= nivel )										\
+			esp_log_write( nivel, tag, formato, ##__VA_ARGS__ );			\
+	} while( 0 )
+
+#define ESP_LOGE( tag, formato, ... )	ESP_LOG_LEVEL( ESP_LOG_ERROR, tag, formato, ##__VA_ARGS__ )
+#define ESP_LOGW( tag, formato, ... )	ESP_LOG_LEVEL( ESP_LOG_WARN, tag, formato, ##__VA_ARGS__ )
+#define ESP_LOGI( tag, formato, ... )	ESP_LOG_LEVEL( ESP_LOG_INFO, tag, formato, ##__VA_ARGS__ )
+#define ESP_LOGD( tag, formato, ... )	ESP_LOG_LEVEL( ESP_LOG_DEBUG, tag, formato, ##__VA_ARGS__ )
+#define ESP_LOGV( tag, formato, ... )	ESP_LOG_LEVEL( ESP_LOG_VERBOSE, tag, formato, ##__VA_ARGS__ )
+#define ESP_LOG( nivel, tag, formato, ... )	ESP_LOG_LEVEL( nivel, tag, formato, ##__VA_ARGS__ )
+#define ESP_EARLY_LOGE					ESP_LOGE
+#define ESP_EARLY_LOGW					ESP_LOGW
+#define ESP_EARLY_LOGI					ESP_LOGI
+
+#ifdef __cplusplus
+}
+#endif
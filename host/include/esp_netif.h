@@ -0,0 +1,95 @@
+/*
+	Objetivo: Interface de rede (esp_netif) do ESP-IDF no build para Linux - o IP da station vem do
+			  DHCP simulado do AP ou do IP fixo (host/simulacao/wifi.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "esp_event.h"
+#include "lwip/ip4_addr.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_ESP_NETIF_BASE					0x5000
+#define ESP_ERR_ESP_NETIF_INVALID_PARAMS		( ESP_ERR_ESP_NETIF_BASE + 0x01 )
+#define ESP_ERR_ESP_NETIF_IF_NOT_READY			( ESP_ERR_ESP_NETIF_BASE + 0x02 )
+#define ESP_ERR_ESP_NETIF_DHCPC_START_FAILED	( ESP_ERR_ESP_NETIF_BASE + 0x03 )
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED	( ESP_ERR_ESP_NETIF_BASE + 0x04 )
+#define ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED	( ESP_ERR_ESP_NETIF_BASE + 0x05 )
+
+typedef struct {
+	uint32_t addr;
+} esp_ip4_addr_t;
+
+#define ESP_IPADDR_TYPE_V4		0
+#define ESP_IPADDR_TYPE_V6		6
+
+typedef struct {
+	union {
+		esp_ip4_addr_t ip4;
+		uint32_t ip6[4];
+	} u_addr;
+	uint8_t type;
+} esp_ip_addr_t;
+
+typedef struct {
+	esp_ip4_addr_t ip;
+	esp_ip4_addr_t netmask;
+	esp_ip4_addr_t gw;
+} esp_netif_ip_info_t;
+
+typedef struct {
+	esp_ip_addr_t ip;
+} esp_netif_dns_info_t;
+
+typedef enum {
+	ESP_NETIF_DNS_MAIN = 0,
+	ESP_NETIF_DNS_BACKUP,
+	ESP_NETIF_DNS_FALLBACK,
+	ESP_NETIF_DNS_MAX,
+} esp_netif_dns_type_t;
+
+typedef struct esp_netif_obj esp_netif_t;
+
+typedef enum {
+	IP_EVENT_STA_GOT_IP,
+	IP_EVENT_STA_LOST_IP,
+	IP_EVENT_AP_STAIPASSIGNED,
+	IP_EVENT_GOT_IP6,
+	IP_EVENT_ETH_GOT_IP,
+} ip_event_t;
+
+typedef struct {
+	int if_index;
+	esp_netif_t *esp_netif;
+	esp_netif_ip_info_t ip_info;
+	bool ip_changed;
+} ip_event_got_ip_t;
+
+#define esp_ip4_addr1( a )		( ( (const uint8_t*)( &( a )->addr ) )[0] )
+#define esp_ip4_addr2( a )		( ( (const uint8_t*)( &( a )->addr ) )[1] )
+#define esp_ip4_addr3( a )		( ( (const uint8_t*)( &( a )->addr ) )[2] )
+#define esp_ip4_addr4( a )		( ( (const uint8_t*)( &( a )->addr ) )[3] )
+#define IPSTR					"%d.%d.%d.%d"
+#define IP2STR( a )				esp_ip4_addr1( a ), esp_ip4_addr2( a ), esp_ip4_addr3( a ), esp_ip4_addr4( a )
+#define ESP_IP4TOADDR( a, b, c, d )	( ( (uint32_t)( d ) << 24 ) | ( (uint32_t)( c ) << 16 ) | ( (uint32_t)( b ) << 8 ) | (uint32_t)( a ) )
+
+esp_err_t esp_netif_init( void );
+esp_netif_t *esp_netif_create_default_wifi_sta( void );
+esp_err_t esp_netif_dhcpc_start( esp_netif_t *netif );
+esp_err_t esp_netif_dhcpc_stop( esp_netif_t *netif );
+esp_err_t esp_netif_set_ip_info( esp_netif_t *netif, const esp_netif_ip_info_t *info );
+esp_err_t esp_netif_get_ip_info( esp_netif_t *netif, esp_netif_ip_info_t *info );
+esp_err_t esp_netif_set_dns_info( esp_netif_t *netif, esp_netif_dns_type_t tipo, esp_netif_dns_info_t *dns );
+esp_err_t esp_netif_get_dns_info( esp_netif_t *netif, esp_netif_dns_type_t tipo, esp_netif_dns_info_t *dns );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,35 @@
+/*
+	Objetivo: Gerenciamento de energia do ESP-IDF no build para Linux - os locks definem o modo
+			  simulado, e o tempo em cada modo é contado para esp_pm_dump_locks
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdio.h>
+#include "esp_err.h"
+#include "esp32/pm.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+	ESP_PM_CPU_FREQ_MAX,
+	ESP_PM_APB_FREQ_MAX,
+	ESP_PM_NO_LIGHT_SLEEP,
+} esp_pm_lock_type_t;
+
+typedef struct esp_pm_lock *esp_pm_lock_handle_t;
+
+esp_err_t esp_pm_configure( const void *config );
+esp_err_t esp_pm_lock_create( esp_pm_lock_type_t tipo, int arg, const char *nome, esp_pm_lock_handle_t *lock );
+esp_err_t esp_pm_lock_acquire( esp_pm_lock_handle_t lock );
+esp_err_t esp_pm_lock_release( esp_pm_lock_handle_t lock );
+esp_err_t esp_pm_lock_delete( esp_pm_lock_handle_t lock );
+esp_err_t esp_pm_dump_locks( FILE *saida );
+
+#ifdef __cplusplus
+}
+#endif
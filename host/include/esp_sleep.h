@@ -0,0 +1,20 @@
+/*
+	Objetivo: Fontes de despertar do light sleep no build para Linux (somente registradas)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t esp_sleep_enable_gpio_wakeup( void );
+esp_err_t esp_sleep_enable_timer_wakeup( uint64_t tempo_us );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,27 @@
+/*
+	Objetivo: Funções de sistema do ESP-IDF no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Heap da simulação (esp_heap_caps.h): livre e menor livre desde o início. */
+uint32_t esp_get_free_heap_size( void );
+uint32_t esp_get_minimum_free_heap_size( void );
+uint32_t esp_random( void );
+void esp_fill_random( void *buffer, size_t tamanho );
+
+/* Termina o processo com o código 0 (como um reset, a simulação não recomeça). */
+void esp_restart( void ) __attribute__( ( noreturn ) );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,85 @@
+/*
+	Objetivo: FreeRTOS do build para Linux - tipos, constantes e seções críticas do port do ESP32
+			  sobre pthreads (host/simulacao/freertos.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+typedef uint32_t TickType_t;
+typedef uint8_t StackType_t;		//Pilha em bytes, como no port do ESP32.
+
+#define pdFALSE					( (BaseType_t) 0 )
+#define pdTRUE					( (BaseType_t) 1 )
+#define pdPASS					pdTRUE
+#define pdFAIL					pdFALSE
+#define errQUEUE_EMPTY			( (BaseType_t) 0 )
+#define errQUEUE_FULL			( (BaseType_t) 0 )
+
+#define configTICK_RATE_HZ		CONFIG_FREERTOS_HZ
+#define configMAX_PRIORITIES	25
+#define configMAX_TASK_NAME_LEN	16
+#define configMINIMAL_STACK_SIZE	768
+#define portMAX_DELAY			( (TickType_t) 0xffffffffUL )
+#define portTICK_PERIOD_MS		( (TickType_t) 1000 / configTICK_RATE_HZ )
+#define portTICK_RATE_MS		portTICK_PERIOD_MS
+#define pdMS_TO_TICKS( ms )		( (TickType_t) ( ( (TickType_t) ( ms ) * (TickType_t) configTICK_RATE_HZ ) / (TickType_t) 1000 ) )
+#define portNUM_PROCESSORS		2
+#define tskNO_AFFINITY			0x7FFFFFFF
+#define tskIDLE_PRIORITY		( (UBaseType_t) 0U )
+
+/*
+	Trava de seção crítica: recursiva por thread, como o spinlock do port. Enquanto a thread estiver em
+	uma seção crítica as interrupções simuladas que ela disparar ficam pendentes até a saída da
+	última seção, como com as interrupções mascaradas no ESP32.
+*/
+typedef struct {
+	volatile uint32_t dono;
+	uint32_t contagem;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED	{ .dono = 0, .contagem = 0 }
+
+void vPortEnterCritical( portMUX_TYPE *mux );
+void vPortExitCritical( portMUX_TYPE *mux );
+void vPortCPUInitializeMutex( portMUX_TYPE *mux );
+
+#define portENTER_CRITICAL( mux )			vPortEnterCritical( mux )
+#define portEXIT_CRITICAL( mux )			vPortExitCritical( mux )
+#define portENTER_CRITICAL_ISR( mux )		vPortEnterCritical( mux )
+#define portEXIT_CRITICAL_ISR( mux )		vPortExitCritical( mux )
+#define portENTER_CRITICAL_SAFE( mux )		vPortEnterCritical( mux )
+#define portEXIT_CRITICAL_SAFE( mux )		vPortExitCritical( mux )
+
+UBaseType_t xPortSetInterruptMaskFromISR( void );
+void vPortClearInterruptMaskFromISR( UBaseType_t estado );
+#define portSET_INTERRUPT_MASK_FROM_ISR()		xPortSetInterruptMaskFromISR()
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( e )	vPortClearInterruptMaskFromISR( e )
+
+BaseType_t xPortGetCoreID( void );
+BaseType_t xPortInIsrContext( void );
+void vPortYield( void );
+#define portYIELD()							vPortYield()
+#define portYIELD_FROM_ISR()				( (void) 0 )
+
+/* Blocos de controle dos objetos estáticos: opacos, com o tamanho das estruturas da simulação. */
+typedef struct { uint64_t reservado[48]; } StaticTask_t;
+typedef struct { uint64_t reservado[32]; } StaticQueue_t;
+typedef StaticQueue_t StaticSemaphore_t;
+typedef struct { uint64_t reservado[16]; } StaticEventGroup_t;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,29 @@
+/*
+	Objetivo: Grupos de eventos do FreeRTOS no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct EventGroupDef_t *EventGroupHandle_t;
+typedef TickType_t EventBits_t;
+
+EventGroupHandle_t xEventGroupCreate( void );
+EventGroupHandle_t xEventGroupCreateStatic( StaticEventGroup_t *buffer );
+EventBits_t xEventGroupSetBits( EventGroupHandle_t grupo, EventBits_t bits );
+EventBits_t xEventGroupClearBits( EventGroupHandle_t grupo, EventBits_t bits );
+EventBits_t xEventGroupGetBits( EventGroupHandle_t grupo );
+EventBits_t xEventGroupWaitBits( EventGroupHandle_t grupo, EventBits_t bits, BaseType_t limpar, BaseType_t todos,
+								 TickType_t espera );
+BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t grupo, EventBits_t bits, BaseType_t *acordou );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,37 @@
+/*
+	Objetivo: Filas do FreeRTOS no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct QueueDefinition *QueueHandle_t;
+
+QueueHandle_t xQueueCreate( UBaseType_t tamanho, UBaseType_t tamanho_item );
+QueueHandle_t xQueueCreateStatic( UBaseType_t tamanho, UBaseType_t tamanho_item, uint8_t *armazenamento,
+								  StaticQueue_t *buffer );
+void vQueueDelete( QueueHandle_t fila );
+
+BaseType_t xQueueSend( QueueHandle_t fila, const void *item, TickType_t espera );
+BaseType_t xQueueSendToFront( QueueHandle_t fila, const void *item, TickType_t espera );
+BaseType_t xQueueOverwrite( QueueHandle_t fila, const void *item );
+BaseType_t xQueueReceive( QueueHandle_t fila, void *item, TickType_t espera );
+BaseType_t xQueuePeek( QueueHandle_t fila, void *item, TickType_t espera );
+BaseType_t xQueueSendFromISR( QueueHandle_t fila, const void *item, BaseType_t *acordou );
+BaseType_t xQueueReceiveFromISR( QueueHandle_t fila, void *item, BaseType_t *acordou );
+UBaseType_t uxQueueMessagesWaiting( QueueHandle_t fila );
+UBaseType_t uxQueueSpacesAvailable( QueueHandle_t fila );
+BaseType_t xQueueReset( QueueHandle_t fila );
+
+#define xQueueSendToBack( f, i, e )		xQueueSend( f, i, e )
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,33 @@
+/*
+	Objetivo: Ringbuffer do ESP-IDF no build para Linux (somente RINGBUF_TYPE_NOSPLIT)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ringbuf_sim *RingbufHandle_t;
+
+typedef enum {
+	RINGBUF_TYPE_NOSPLIT = 0,
+	RINGBUF_TYPE_ALLOWSPLIT,
+	RINGBUF_TYPE_BYTEBUF,
+} ringbuf_type_t;
+
+RingbufHandle_t xRingbufferCreate( size_t tamanho, ringbuf_type_t tipo );
+void vRingbufferDelete( RingbufHandle_t ring );
+BaseType_t xRingbufferSend( RingbufHandle_t ring, const void *dados, size_t tamanho, TickType_t espera );
+BaseType_t xRingbufferSendFromISR( RingbufHandle_t ring, const void *dados, size_t tamanho, BaseType_t *acordou );
+void *xRingbufferReceive( RingbufHandle_t ring, size_t *tamanho, TickType_t espera );
+void vRingbufferReturnItem( RingbufHandle_t ring, void *item );
+size_t xRingbufferGetCurFreeSize( RingbufHandle_t ring );
+
+#ifdef __cplusplus
+}
+#endif
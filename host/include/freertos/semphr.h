@@ -0,0 +1,34 @@
+/*
+	Objetivo: Semáforos e mutexes do FreeRTOS no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef QueueHandle_t SemaphoreHandle_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex( void );
+SemaphoreHandle_t xSemaphoreCreateMutexStatic( StaticSemaphore_t *buffer );
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex( void );
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic( StaticSemaphore_t *buffer );
+SemaphoreHandle_t xSemaphoreCreateBinary( void );
+SemaphoreHandle_t xSemaphoreCreateCounting( UBaseType_t maximo, UBaseType_t inicial );
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t semaforo, TickType_t espera );
+BaseType_t xSemaphoreGive( SemaphoreHandle_t semaforo );
+BaseType_t xSemaphoreTakeRecursive( SemaphoreHandle_t semaforo, TickType_t espera );
+BaseType_t xSemaphoreGiveRecursive( SemaphoreHandle_t semaforo );
+BaseType_t xSemaphoreGiveFromISR( SemaphoreHandle_t semaforo, BaseType_t *acordou );
+#define vSemaphoreDelete( s )		vQueueDelete( s )
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+	Objetivo: Tasks do FreeRTOS no build para Linux - cada task é uma thread com pilha própria
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "freertos/FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct tskTaskControlBlock *TaskHandle_t;
+typedef void (*TaskFunction_t)( void *pvParameters );
+
+#define taskYIELD()		portYIELD()
+
+typedef enum {
+	eRunning = 0,
+	eReady,
+	eBlocked,
+	eSuspended,
+	eDeleted,
+	eInvalid,
+} eTaskState;
+
+typedef struct {
+	TaskHandle_t xHandle;
+	const char *pcTaskName;
+	UBaseType_t xTaskNumber;
+	eTaskState eCurrentState;
+	UBaseType_t uxCurrentPriority;
+	UBaseType_t uxBasePriority;
+	uint32_t ulRunTimeCounter;		//Tempo de CPU da thread (us).
+	StackType_t *pxStackBase;
+	uint32_t usStackHighWaterMark;	//Bytes nunca usados da pilha.
+	BaseType_t xCoreID;
+} TaskStatus_t;
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t funcao, const char *nome, uint32_t pilha, void *parametro,
+									UBaseType_t prioridade, TaskHandle_t *handle, BaseType_t nucleo );
+TaskHandle_t xTaskCreateStaticPinnedToCore( TaskFunction_t funcao, const char *nome, uint32_t pilha, void *parametro,
+											UBaseType_t prioridade, StackType_t *buffer_pilha, StaticTask_t *buffer_task,
+											BaseType_t nucleo );
+#define xTaskCreate( f, n, p, a, pr, h )	xTaskCreatePinnedToCore( f, n, p, a, pr, h, tskNO_AFFINITY )
+
+void vTaskDelete( TaskHandle_t task );
+void vTaskDelay( TickType_t ticks );
+void vTaskDelayUntil( TickType_t *anterior, TickType_t incremento );
+TickType_t xTaskGetTickCount( void );
+TickType_t xTaskGetTickCountFromISR( void );
+TaskHandle_t xTaskGetCurrentTaskHandle( void );
+UBaseType_t uxTaskPriorityGet( TaskHandle_t task );
+char *pcTaskGetTaskName( TaskHandle_t task );
+UBaseType_t uxTaskGetStackHighWaterMark( TaskHandle_t task );
+UBaseType_t uxTaskGetNumberOfTasks( void );
+UBaseType_t uxTaskGetSystemState( TaskStatus_t *tasks, UBaseType_t max, uint32_t *tempo_total );
+void vTaskSuspendAll( void );
+BaseType_t xTaskResumeAll( void );
+
+/* Notificação direta (contador). */
+BaseType_t xTaskNotifyGive( TaskHandle_t task );
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t *acordou );
+uint32_t ulTaskNotifyTake( BaseType_t zerar, TickType_t espera );
+
+#ifdef __cplusplus
+}
+#endif
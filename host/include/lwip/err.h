@@ -0,0 +1,14 @@
+/*
+	Objetivo: Códigos de erro do lwIP no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+typedef signed char err_t;
+
+#define ERR_OK		0
+#define ERR_MEM		-1
+#define ERR_TIMEOUT	-3
+#define ERR_VAL		-6
@@ -0,0 +1,27 @@
+/*
+	Objetivo: Endereços IPv4 do lwIP no build para Linux (ordem de rede, como no lwIP)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ip4_addr {
+	uint32_t addr;
+} ip4_addr_t;
+
+#define IP4ADDR_STRLEN_MAX		16
+
+/* Retornam 1 se o texto for um endereço válido, 0 caso contrário. */
+int ip4addr_aton( const char *texto, ip4_addr_t *endereco );
+char *ip4addr_ntoa_r( const ip4_addr_t *endereco, char *buffer, int tamanho );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,19 @@
+/*
+	Objetivo: Sockets do lwIP no build para Linux - a API BSD do lwIP é a mesma do sistema, então os
+			  componentes usam os sockets do Linux (localhost nos testes)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/select.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
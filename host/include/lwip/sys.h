@@ -0,0 +1,9 @@
+/*
+	Objetivo: Camada de sistema do lwIP no build para Linux (sem uso nos exemplos)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "lwip/err.h"
@@ -0,0 +1,76 @@
+/*
+	Objetivo: NVS do ESP-IDF no build para Linux - páginas de 126 entradas de 32 bytes emuladas na RAM,
+			  com o mesmo consumo de entradas da flash (host/simulacao/nvs.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ESP_ERR_NVS_BASE					0x1100
+#define ESP_ERR_NVS_NOT_INITIALIZED			( ESP_ERR_NVS_BASE + 0x01 )
+#define ESP_ERR_NVS_NOT_FOUND				( ESP_ERR_NVS_BASE + 0x02 )
+#define ESP_ERR_NVS_TYPE_MISMATCH			( ESP_ERR_NVS_BASE + 0x03 )
+#define ESP_ERR_NVS_READ_ONLY				( ESP_ERR_NVS_BASE + 0x04 )
+#define ESP_ERR_NVS_NOT_ENOUGH_SPACE		( ESP_ERR_NVS_BASE + 0x05 )
+#define ESP_ERR_NVS_INVALID_NAME			( ESP_ERR_NVS_BASE + 0x06 )
+#define ESP_ERR_NVS_INVALID_HANDLE			( ESP_ERR_NVS_BASE + 0x07 )
+#define ESP_ERR_NVS_REMOVE_FAILED			( ESP_ERR_NVS_BASE + 0x08 )
+#define ESP_ERR_NVS_KEY_TOO_LONG			( ESP_ERR_NVS_BASE + 0x09 )
+#define ESP_ERR_NVS_PAGE_FULL				( ESP_ERR_NVS_BASE + 0x0a )
+#define ESP_ERR_NVS_INVALID_STATE			( ESP_ERR_NVS_BASE + 0x0b )
+#define ESP_ERR_NVS_INVALID_LENGTH			( ESP_ERR_NVS_BASE + 0x0c )
+#define ESP_ERR_NVS_NO_FREE_PAGES			( ESP_ERR_NVS_BASE + 0x0d )
+#define ESP_ERR_NVS_VALUE_TOO_LONG			( ESP_ERR_NVS_BASE + 0x0e )
+#define ESP_ERR_NVS_PART_NOT_FOUND			( ESP_ERR_NVS_BASE + 0x0f )
+#define ESP_ERR_NVS_NEW_VERSION_FOUND		( ESP_ERR_NVS_BASE + 0x10 )
+
+#define NVS_KEY_NAME_MAX_SIZE				16
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+	NVS_READONLY,
+	NVS_READWRITE
+} nvs_open_mode_t;
+
+typedef struct {
+	size_t used_entries;
+	size_t free_entries;
+	size_t total_entries;
+	size_t namespace_count;
+} nvs_stats_t;
+
+esp_err_t nvs_open( const char *nome, nvs_open_mode_t modo, nvs_handle_t *handle );
+void nvs_close( nvs_handle_t handle );
+esp_err_t nvs_commit( nvs_handle_t handle );
+esp_err_t nvs_erase_key( nvs_handle_t handle, const char *chave );
+esp_err_t nvs_erase_all( nvs_handle_t handle );
+
+esp_err_t nvs_set_u8( nvs_handle_t handle, const char *chave, uint8_t valor );
+esp_err_t nvs_set_u16( nvs_handle_t handle, const char *chave, uint16_t valor );
+esp_err_t nvs_set_u32( nvs_handle_t handle, const char *chave, uint32_t valor );
+esp_err_t nvs_set_i32( nvs_handle_t handle, const char *chave, int32_t valor );
+esp_err_t nvs_set_str( nvs_handle_t handle, const char *chave, const char *valor );
+esp_err_t nvs_set_blob( nvs_handle_t handle, const char *chave, const void *valor, size_t tamanho );
+
+esp_err_t nvs_get_u8( nvs_handle_t handle, const char *chave, uint8_t *valor );
+esp_err_t nvs_get_u16( nvs_handle_t handle, const char *chave, uint16_t *valor );
+esp_err_t nvs_get_u32( nvs_handle_t handle, const char *chave, uint32_t *valor );
+esp_err_t nvs_get_i32( nvs_handle_t handle, const char *chave, int32_t *valor );
+esp_err_t nvs_get_str( nvs_handle_t handle, const char *chave, char *valor, size_t *tamanho );
+esp_err_t nvs_get_blob( nvs_handle_t handle, const char *chave, void *valor, size_t *tamanho );
+
+esp_err_t nvs_get_stats( const char *particao, nvs_stats_t *stats );
+
+#ifdef __cplusplus
+}
+#endif
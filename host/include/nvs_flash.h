@@ -0,0 +1,22 @@
+/*
+	Objetivo: Inicialização da partição NVS no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "esp_err.h"
+#include "nvs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+esp_err_t nvs_flash_init( void );
+esp_err_t nvs_flash_erase( void );
+esp_err_t nvs_flash_deinit( void );
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,58 @@
+/*
+	Objetivo: Configuração (menuconfig) usada no build para Linux - os valores padrão do Kconfig dos
+			  exemplos e dos componentes; cada alvo do host/CMakeLists.txt define os do seu sdkconfig.defaults
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#define CONFIG_IDF_TARGET_LINUX					1
+#define CONFIG_IDF_TARGET						"linux"
+#define CONFIG_FREERTOS_HZ						100
+#define CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ		160
+#define CONFIG_LOG_DEFAULT_LEVEL				3
+#define CONFIG_LWIP_MAX_SOCKETS					10
+
+/* Deferred log (dlog) */
+#ifndef CONFIG_DLOG_NIVEL
+#define CONFIG_DLOG_NIVEL						3
+#endif
+
+/* Task table (tarefas) */
+#ifndef CONFIG_TAREFAS_ESTATICO_KB
+#define CONFIG_TAREFAS_ESTATICO_KB				48
+#endif
+
+/* Example Configuration (EX05/EX06) */
+#define CONFIG_ESP_WIFI_SSID					"myssid"
+#define CONFIG_ESP_WIFI_PASSWORD				"mypassword"
+#define CONFIG_ESP_WIFI_SSID_2					""
+#define CONFIG_ESP_WIFI_PASSWORD_2				""
+#define CONFIG_ESP_MAXIMUM_RETRY				5
+#define CONFIG_ESP_RECONEXAO_BASE_MS			500
+#define CONFIG_ESP_RECONEXAO_TETO_MS			60000
+#define CONFIG_ESP_INTERVALO_ESCUTA				3
+#if !defined( CONFIG_ESP_IP_MODO_DHCP ) && !defined( CONFIG_ESP_IP_MODO_ESTATICO ) && !defined( CONFIG_ESP_IP_MODO_HIBRIDO )
+#define CONFIG_ESP_IP_MODO_DHCP					1
+#endif
+#define CONFIG_ESP_IP_FIXO						"10.0.0.145"
+#define CONFIG_ESP_IP_MASCARA					"255.255.255.0"
+#define CONFIG_ESP_IP_GATEWAY					"10.0.0.1"
+#define CONFIG_ESP_IP_DNS						"10.0.0.1"
+#define CONFIG_ESP_IP_TIMEOUT_DHCP_MS			3000
+#define CONFIG_ESP_ROAMING_RSSI					-70
+#define CONFIG_ESP_ROAMING_HISTERESE			8
+#define CONFIG_ESP_ROAMING_VARREDURA_S			300
+#define CONFIG_ESP_ROAMING_VARREDURA_FRACA_S	10
+#ifndef CONFIG_ESP_TELEMETRIA_DESTINO
+#define CONFIG_ESP_TELEMETRIA_DESTINO			"192.168.0.100"
+#endif
+#ifndef CONFIG_ESP_TELEMETRIA_PORTA
+#define CONFIG_ESP_TELEMETRIA_PORTA				5005
+#endif
+#define CONFIG_ESP_TELEMETRIA_LOTE				64
+#define CONFIG_ESP_TELEMETRIA_IDADE_MS			60000
+#ifndef CONFIG_ESP_HTTP_PORTA
+#define CONFIG_ESP_HTTP_PORTA					8080	//80 exige root no Linux.
+#endif
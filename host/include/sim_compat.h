@@ -0,0 +1,24 @@
+/*
+	Objetivo: Funções da newlib do ESP-IDF ausentes na glibc, incluído em todas as unidades do build
+			  para Linux pelo host/CMakeLists.txt (-include)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stddef.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined( __GLIBC__ ) && __GLIBC__ == 2 && __GLIBC_MINOR__ < 38
+size_t strlcpy( char *destino, const char *origem, size_t tamanho );
+#define SIM_STRLCPY		1
+#endif
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,98 @@
+/*
+	Objetivo: API da simulação para os testes do build para Linux - estímulos externos (pinos, APs),
+			  observação do hardware simulado (LEDC, heap, NVS, WiFi) e término do processo
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Termina a simulação com o código de saída (as tasks não são encerradas uma a uma). */
+void sim_encerrar( int codigo ) __attribute__( ( noreturn ) );
+
+/* ---------------------------------------------------------------------------------------------- */
+/* GPIO                                                                                           */
+
+/* Nível imposto por um circuito externo no pino (0 ou 1); -1 solta o pino (vale o pull). */
+void sim_gpio_externo( int pino, int nivel );
+/* Nível elétrico atual do pino (saída, periférico, circuito externo ou pull). */
+int sim_gpio_nivel( int pino );
+
+/* ---------------------------------------------------------------------------------------------- */
+/* LEDC: cada escrita de duty (imediata ou o início de um fade) é registrada com o instante.        */
+
+typedef struct {
+	int64_t instante_us;
+	uint32_t duty;			//Duty no instante (início do fade).
+	uint32_t duty_final;	//Duty ao fim do fade (igual a duty sem fade).
+	uint32_t duracao_ms;	//Duração do fade (0 sem fade).
+} sim_ledc_ponto_t;
+
+/* Copia até "max" pontos do canal (modo de velocidade e canal do driver); retorna o total registrado. */
+size_t sim_ledc_linha( int modo, int canal, sim_ledc_ponto_t *pontos, size_t max );
+/* Duty efetivo do canal em um instante (interpola os fades). */
+uint32_t sim_ledc_duty_em( int modo, int canal, int64_t instante_us );
+
+/* ---------------------------------------------------------------------------------------------- */
+/* WiFi: pontos de acesso visíveis para a estação simulada.                                        */
+
+/* Inclui ou atualiza (pelo BSSID) um AP. Sem chamadas, existe um AP com o SSID e a senha do menuconfig. */
+void sim_wifi_ap( const char *ssid, const char *senha, const uint8_t bssid[6], uint8_t canal, int8_t rssi );
+/* Remove o AP: se a estação estiver associada a ele, recebe STA_DISCONNECTED (BEACON_TIMEOUT). */
+void sim_wifi_remove_ap( const uint8_t bssid[6] );
+void sim_wifi_remove_todos( void );
+/* Muda o RSSI de um AP (gera WIFI_EVENT_STA_BSS_RSSI_LOW se cruzar o limiar configurado). */
+void sim_wifi_rssi( const uint8_t bssid[6], int8_t rssi );
+/* Atraso da concessão do DHCP; negativo: o servidor DHCP não responde. */
+void sim_wifi_dhcp_atraso_ms( int32_t atraso_ms );
+
+typedef struct {
+	uint32_t conexoes;				//esp_wifi_connect().
+	uint32_t conexoes_rapidas;		//Conexões com canal e BSSID fixados (sem varredura completa).
+	uint32_t varreduras;			//esp_wifi_scan_start().
+	uint32_t associacoes;			//STA_CONNECTED.
+	int64_t primeira_conexao_us;	//Do esp_wifi_connect() ao primeiro STA_CONNECTED (-1 se nunca).
+	int64_t primeiro_ip_us;			//Do esp_wifi_connect() ao primeiro GOT_IP (-1 se nunca).
+	uint8_t bssid[6];				//AP associado (zeros se desconectado).
+} sim_wifi_stats_t;
+
+void sim_wifi_estatisticas( sim_wifi_stats_t *stats );
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Heap: malloc/calloc/realloc/free das bibliotecas e do FreeRTOS contados pela simulação.         */
+
+typedef struct {
+	uint32_t alocacoes;
+	uint32_t liberacoes;
+	size_t livre;
+	size_t minimo_livre;
+} sim_heap_stats_t;
+
+void sim_heap_estatisticas( sim_heap_stats_t *stats );
+
+/* ---------------------------------------------------------------------------------------------- */
+/* NVS: contadores do emulador (páginas de 126 entradas de 32 bytes).                              */
+
+typedef struct {
+	uint32_t leituras;				//nvs_get_*.
+	uint32_t escritas;				//nvs_set_* que mudaram o valor.
+	uint32_t escritas_iguais;		//nvs_set_* com o valor já gravado (não escrevem na flash).
+	uint32_t entradas_escritas;		//Entradas de 32 bytes gravadas (desgaste).
+	uint32_t commits;
+	uint32_t apagamentos;
+} sim_nvs_stats_t;
+
+void sim_nvs_estatisticas( sim_nvs_stats_t *stats );
+void sim_nvs_zera_estatisticas( void );
+
+#ifdef __cplusplus
+}
+#endif
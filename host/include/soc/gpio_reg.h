@@ -0,0 +1,22 @@
+/*
+	Objetivo: Endereços dos registradores de GPIO do ESP32 no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include "soc/soc.h"
+
+#define GPIO_OUT_REG			( DR_REG_GPIO_BASE + 0x0004 )
+#define GPIO_OUT_W1TS_REG		( DR_REG_GPIO_BASE + 0x0008 )
+#define GPIO_OUT_W1TC_REG		( DR_REG_GPIO_BASE + 0x000c )
+#define GPIO_OUT1_REG			( DR_REG_GPIO_BASE + 0x0010 )
+#define GPIO_OUT1_W1TS_REG		( DR_REG_GPIO_BASE + 0x0014 )
+#define GPIO_OUT1_W1TC_REG		( DR_REG_GPIO_BASE + 0x0018 )
+#define GPIO_ENABLE_REG			( DR_REG_GPIO_BASE + 0x0020 )
+#define GPIO_ENABLE1_REG		( DR_REG_GPIO_BASE + 0x002c )
+#define GPIO_IN_REG				( DR_REG_GPIO_BASE + 0x003c )
+#define GPIO_IN1_REG			( DR_REG_GPIO_BASE + 0x0040 )
+#define GPIO_STATUS_REG			( DR_REG_GPIO_BASE + 0x0044 )
+#define GPIO_STATUS1_REG		( DR_REG_GPIO_BASE + 0x0050 )
@@ -0,0 +1,12 @@
+/*
+	Objetivo: Sinais da matriz de GPIO do ESP32 usados pelos exemplos (build para Linux)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#define LEDC_HS_SIG_OUT0_IDX	71
+#define LEDC_LS_SIG_OUT0_IDX	79
+#define RMT_SIG_OUT0_IDX		87
+#define SIG_GPIO_OUT_IDX		256
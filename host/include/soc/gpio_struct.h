@@ -0,0 +1,36 @@
+/*
+	Objetivo: Estrutura dos registradores de GPIO do ESP32 (somente os campos PIN) no build para
+			  Linux; a simulação consulta int_ena e int_type a cada borda
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef volatile struct {
+	union {
+		struct {
+			uint32_t reserved0:		2;
+			uint32_t pad_driver:	1;
+			uint32_t reserved3:		4;
+			uint32_t int_type:		3;
+			uint32_t wakeup_enable:	1;
+			uint32_t config:		2;
+			uint32_t int_ena:		5;
+			uint32_t reserved18:	14;
+		};
+		uint32_t val;
+	} pin[40];
+} gpio_dev_t;
+
+extern gpio_dev_t GPIO;
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,40 @@
+/*
+	Objetivo: Registradores de estado e de interrupção do PCNT do ESP32 no build para Linux
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PCNT_STATUS_THRES1_M	( 1 << 2 )
+#define PCNT_STATUS_THRES0_M	( 1 << 3 )
+#define PCNT_STATUS_L_LIM_M		( 1 << 4 )
+#define PCNT_STATUS_H_LIM_M		( 1 << 5 )
+#define PCNT_STATUS_ZERO_M		( 1 << 6 )
+
+typedef volatile struct {
+	union {
+		struct {
+			uint32_t cnt_val:	16;
+			uint32_t reserved:	16;
+		};
+		uint32_t val;
+	} cnt_unit[8];
+	union { uint32_t val; } int_raw;
+	union { uint32_t val; } int_st;
+	union { uint32_t val; } int_ena;
+	union { uint32_t val; } int_clr;
+	union { uint32_t val; } status_unit[8];
+} pcnt_dev_t;
+
+extern pcnt_dev_t PCNT;
+
+#ifdef __cplusplus
+}
+#endif
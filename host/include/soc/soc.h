@@ -0,0 +1,44 @@
+/*
+	Objetivo: Definições do SoC do ESP32 no build para Linux - os registradores de periféricos são
+			  lidos e escritos pelas funções da simulação (host/simulacao/gpio.c)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define PRO_CPU_NUM				0
+#define APP_CPU_NUM				1
+
+#ifndef BIT
+#define BIT( n )				( 1UL << ( n ) )
+#endif
+#define BIT0					0x00000001
+#define BIT1					0x00000002
+#define BIT2					0x00000004
+#define BIT3					0x00000008
+#define BIT4					0x00000010
+#define BIT5					0x00000020
+#define BIT6					0x00000040
+#define BIT7					0x00000080
+
+#define DR_REG_GPIO_BASE		0x3ff44000
+#define APB_CLK_FREQ			( 80 * 1000000 )
+
+uint32_t sim_reg_ler( uint32_t endereco );
+void sim_reg_escrever( uint32_t endereco, uint32_t valor );
+
+#define REG_READ( reg )				sim_reg_ler( (uint32_t)( reg ) )
+#define REG_WRITE( reg, valor )		sim_reg_escrever( (uint32_t)( reg ), (uint32_t)( valor ) )
+#define REG_SET_BIT( reg, bit )		REG_WRITE( reg, REG_READ( reg ) | ( bit ) )
+#define REG_CLR_BIT( reg, bit )		REG_WRITE( reg, REG_READ( reg ) & ~( bit ) )
+
+#ifdef __cplusplus
+}
+#endif
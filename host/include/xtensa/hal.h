@@ -0,0 +1,20 @@
+/*
+	Objetivo: Contador de ciclos do Xtensa no build para Linux - derivado do relógio monotônico na
+			  frequência de CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ (32 bits, dá a volta como o CCOUNT)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t xthal_get_ccount( void );
+
+#ifdef __cplusplus
+}
+#endif
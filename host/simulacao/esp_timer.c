@@ -0,0 +1,182 @@
+/*
+	Objetivo: esp_timer no build para Linux - lista ordenada por prazo, despachada pela task
+			  "esp_timer" no núcleo 0 (como no ESP-IDF, callbacks longos atrasam os seguintes)
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include <string.h>
+#include "esp_timer.h"
+#include "sim_interno.h"
+
+struct esp_timer {
+	esp_timer_cb_t callback;
+	void *arg;
+	const char *nome;
+	int64_t alarme;				//Instante do próximo disparo (us); 0: desarmado.
+	uint64_t periodo;			//0: disparo único.
+	struct esp_timer *proximo;	//Lista dos armados, em ordem de alarme.
+};
+
+/* Variáveis Globais */
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond;
+static struct esp_timer *s_armados;
+
+int64_t esp_timer_get_time( void )
+{
+	return sim_agora_us();
+}
+
+static void insere( struct esp_timer *timer )
+{
+	struct esp_timer **p = &s_armados;
+	while( *p && ( *p )->alarme <= timer->alarme )
+		p = &( *p )->proximo;
+	timer->proximo = *p;
+	*p = timer;
+	pthread_cond_signal( &s_cond );
+}
+
+static bool remove_da_lista( struct esp_timer *timer )
+{
+	for( struct esp_timer **p = &s_armados; *p; p = &( *p )->proximo )
+		if( *p == timer )
+		{
+			*p = timer->proximo;
+			return true;
+		}
+	return false;
+}
+
+esp_err_t esp_timer_create( const esp_timer_create_args_t *args, esp_timer_handle_t *timer )
+{
+	if( args == NULL || args->callback == NULL || timer == NULL )
+		return ESP_ERR_INVALID_ARG;
+	struct esp_timer *novo = calloc( 1, sizeof( *novo ) );
+	if( novo == NULL )
+		return ESP_ERR_NO_MEM;
+	novo->callback = args->callback;
+	novo->arg = args->arg;
+	novo->nome = args->name;
+	*timer = novo;
+	return ESP_OK;
+}
+
+static esp_err_t arma( esp_timer_handle_t timer, uint64_t timeout_us, uint64_t periodo_us )
+{
+	if( timer == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	if( timer->alarme != 0 )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ESP_ERR_INVALID_STATE;
+	}
+	timer->alarme = esp_timer_get_time() + (int64_t) timeout_us;
+	if( timer->alarme == 0 )
+		timer->alarme = 1;
+	timer->periodo = periodo_us;
+	insere( timer );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once( esp_timer_handle_t timer, uint64_t timeout_us )
+{
+	return arma( timer, timeout_us, 0 );
+}
+
+esp_err_t esp_timer_start_periodic( esp_timer_handle_t timer, uint64_t periodo_us )
+{
+	if( periodo_us == 0 )
+		return ESP_ERR_INVALID_ARG;
+	return arma( timer, periodo_us, periodo_us );
+}
+
+esp_err_t esp_timer_stop( esp_timer_handle_t timer )
+{
+	if( timer == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = ESP_OK;
+	if( timer->alarme == 0 )
+		ret = ESP_ERR_INVALID_STATE;
+	else
+	{
+		remove_da_lista( timer );
+		timer->alarme = 0;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_timer_delete( esp_timer_handle_t timer )
+{
+	if( timer == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	if( timer->alarme != 0 )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ESP_ERR_INVALID_STATE;
+	}
+	pthread_mutex_unlock( &s_trava );
+	free( timer );
+	return ESP_OK;
+}
+
+int64_t esp_timer_get_next_alarm( void )
+{
+	pthread_mutex_lock( &s_trava );
+	int64_t proximo = s_armados ? s_armados->alarme : INT64_MAX;
+	pthread_mutex_unlock( &s_trava );
+	return proximo;
+}
+
+static void task_esp_timer( void *arg )
+{
+	(void) arg;
+	pthread_mutex_lock( &s_trava );
+	while( 1 )
+	{
+		if( s_armados == NULL )
+		{
+			pthread_cond_wait( &s_cond, &s_trava );
+			continue;
+		}
+		int64_t agora = esp_timer_get_time();
+		struct esp_timer *timer = s_armados;
+		if( timer->alarme > agora )
+		{
+			struct timespec prazo = sim_instante( timer->alarme * 1000 );
+			sim_espera( &s_cond, &s_trava, &prazo );
+			continue;
+		}
+		s_armados = timer->proximo;
+		if( timer->periodo )
+		{
+			timer->alarme += timer->periodo;
+			//Como no ESP-IDF, períodos perdidos não são recuperados em rajada.
+			if( timer->alarme <= agora )
+				timer->alarme = agora + 1;
+			insere( timer );
+		}
+		else
+			timer->alarme = 0;
+
+		esp_timer_cb_t callback = timer->callback;
+		void *arg_cb = timer->arg;
+		pthread_mutex_unlock( &s_trava );
+		callback( arg_cb );
+		pthread_mutex_lock( &s_trava );
+	}
+}
+
+void sim_esp_timer_iniciar( void )
+{
+	sim_cond_init( &s_cond );
+	sim_task_sistema( task_esp_timer, "esp_timer", 22, PRO_CPU_NUM );
+}
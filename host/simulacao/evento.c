@@ -0,0 +1,145 @@
+/*
+	Objetivo: Laço de eventos padrão do ESP-IDF no build para Linux - fila de eventos postados e a
+			  task "sys_evt", que chama os handlers registrados na ordem de registro
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "esp_event.h"
+#include "esp_log.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define MAX_HANDLERS		48
+#define TAMANHO_FILA		64
+#define MAX_DADOS			64		//Maior estrutura de evento usada (wifi_event_sta_connected_t).
+#define PRIORIDADE_EVENTOS	20		//ESP_TASKD_EVENT_PRIO do ESP-IDF.
+
+typedef struct {
+	esp_event_base_t base;
+	int32_t id;
+	esp_event_handler_t handler;
+	void *arg;
+} registro_t;
+
+typedef struct {
+	esp_event_base_t base;
+	int32_t id;
+	size_t tamanho;
+	uint64_t dados[MAX_DADOS / sizeof( uint64_t )];
+} evento_t;
+
+/* Variáveis Globais */
+ESP_EVENT_DEFINE_BASE( WIFI_EVENT );
+ESP_EVENT_DEFINE_BASE( IP_EVENT );
+
+static const char * TAG = "event";
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond;
+static bool s_criado;
+static registro_t s_handlers[MAX_HANDLERS];
+static size_t s_n_handlers;
+static evento_t s_fila[TAMANHO_FILA];
+static size_t s_leitura;
+static size_t s_n_fila;
+
+static void task_eventos( void *arg )
+{
+	evento_t evento;
+	registro_t handlers[MAX_HANDLERS];
+	while( 1 )
+	{
+		pthread_mutex_lock( &s_trava );
+		while( s_n_fila == 0 )
+			pthread_cond_wait( &s_cond, &s_trava );
+		evento = s_fila[s_leitura];
+		s_leitura = ( s_leitura + 1 ) % TAMANHO_FILA;
+		s_n_fila--;
+		pthread_cond_broadcast( &s_cond );
+		//Os handlers podem registrar outros ou postar eventos: chamados sem a trava.
+		size_t n = s_n_handlers;
+		memcpy( handlers, s_handlers, n * sizeof( handlers[0] ) );
+		pthread_mutex_unlock( &s_trava );
+
+		for( size_t i = 0; i < n; i++ )
+			if( ( handlers[i].base == ESP_EVENT_ANY_BASE || handlers[i].base == evento.base )
+				&& ( handlers[i].id == ESP_EVENT_ANY_ID || handlers[i].id == evento.id ) )
+				handlers[i].handler( handlers[i].arg, evento.base, evento.id, evento.tamanho ? evento.dados : NULL );
+	}
+}
+
+esp_err_t esp_event_loop_create_default( void )
+{
+	pthread_mutex_lock( &s_trava );
+	bool criado = s_criado;
+	if( !criado )
+	{
+		s_criado = true;
+		sim_cond_init( &s_cond );
+	}
+	pthread_mutex_unlock( &s_trava );
+	if( criado )
+		return ESP_ERR_INVALID_STATE;
+	sim_task_sistema( task_eventos, "sys_evt", PRIORIDADE_EVENTOS, 0 );
+	return ESP_OK;
+}
+
+esp_err_t esp_event_handler_register( esp_event_base_t base, int32_t id, esp_event_handler_t handler, void *arg )
+{
+	if( handler == NULL || ( base == ESP_EVENT_ANY_BASE && id != ESP_EVENT_ANY_ID ) )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = ESP_OK;
+	if( !s_criado )
+		ret = ESP_ERR_INVALID_STATE;
+	else if( s_n_handlers == MAX_HANDLERS )
+		ret = ESP_ERR_NO_MEM;
+	else
+		s_handlers[s_n_handlers++] = (registro_t) { base, id, handler, arg };
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_event_handler_unregister( esp_event_base_t base, int32_t id, esp_event_handler_t handler )
+{
+	pthread_mutex_lock( &s_trava );
+	for( size_t i = 0; i < s_n_handlers; i++ )
+		if( s_handlers[i].base == base && s_handlers[i].id == id && s_handlers[i].handler == handler )
+		{
+			memmove( &s_handlers[i], &s_handlers[i + 1], ( s_n_handlers - i - 1 ) * sizeof( s_handlers[0] ) );
+			s_n_handlers--;
+			break;
+		}
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_event_post( esp_event_base_t base, int32_t id, const void *dados, size_t tamanho, TickType_t espera )
+{
+	if( tamanho > MAX_DADOS || ( tamanho && dados == NULL ) )
+		return ESP_ERR_INVALID_ARG;
+	struct timespec prazo;
+	bool com_prazo = sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_criado ? ESP_OK : ESP_ERR_INVALID_STATE;
+	while( ret == ESP_OK && s_n_fila == TAMANHO_FILA )
+		if( espera == 0 || !sim_espera( &s_cond, &s_trava, com_prazo ? &prazo : NULL ) )
+			ret = s_n_fila == TAMANHO_FILA ? ESP_ERR_TIMEOUT : ESP_OK;
+	if( ret == ESP_OK )
+	{
+		evento_t *evento = &s_fila[( s_leitura + s_n_fila ) % TAMANHO_FILA];
+		evento->base = base;
+		evento->id = id;
+		evento->tamanho = tamanho;
+		if( tamanho )
+			memcpy( evento->dados, dados, tamanho );
+		s_n_fila++;
+		pthread_cond_broadcast( &s_cond );
+	}
+	pthread_mutex_unlock( &s_trava );
+	if( ret == ESP_ERR_TIMEOUT )
+		ESP_LOGE( TAG, "fila de eventos cheia: %s %d descartado", base, id );
+	return ret;
+}
@@ -0,0 +1,993 @@
+/*
+	Objetivo: FreeRTOS do build para Linux - tasks em pthreads (pilha própria, núcleo lógico e tempo
+			  de CPU), filas, semáforos, grupos de eventos, notificações, seções críticas e o
+			  despacho das interrupções simuladas
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <errno.h>
+#include <sched.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/event_groups.h"
+#include "esp_heap_caps.h"
+#include "sim_interno.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define PILHA_HOST			( 256 * 1024 )	//Pilha real de cada task: printf e a libc do Linux usam mais que no ESP32.
+#define PADRAO_PILHA		0xA5
+#define MAX_PENDENTES		32
+#define MAGIA_TASK			0x7A5C0001
+#define MAGIA_FILA			0x7A5C0002
+#define MAGIA_GRUPO			0x7A5C0003
+
+typedef enum {
+	FILA,
+	MUTEX,
+	MUTEX_RECURSIVO,
+	BINARIO,
+	CONTADOR,
+} tipo_fila_t;
+
+struct tskTaskControlBlock {
+	uint32_t magia;
+	char nome[configMAX_TASK_NAME_LEN];
+	TaskFunction_t funcao;
+	void *parametro;
+	UBaseType_t prioridade;
+	BaseType_t nucleo;
+	UBaseType_t numero;
+	uint32_t pilha_pedida;
+	uint8_t *pilha;					//PILHA_HOST bytes (mmap), pintada com PADRAO_PILHA.
+	pthread_t thread;
+	clockid_t relogio;
+	pthread_mutex_t trava;
+	pthread_cond_t cond;
+	uint32_t notificacao;
+	volatile eTaskState estado;
+	bool dinamica;					//TCB no heap simulado.
+	struct tskTaskControlBlock *proxima;
+};
+
+struct QueueDefinition {
+	uint32_t magia;
+	tipo_fila_t tipo;
+	pthread_mutex_t trava;
+	pthread_cond_t nao_vazia;
+	pthread_cond_t nao_cheia;
+	uint8_t *itens;
+	UBaseType_t tamanho;
+	UBaseType_t tamanho_item;
+	UBaseType_t n;
+	UBaseType_t cabeca;
+	TaskHandle_t dono;
+	UBaseType_t recursao;
+	bool dinamica;
+};
+
+struct EventGroupDef_t {
+	uint32_t magia;
+	pthread_mutex_t trava;
+	pthread_cond_t cond;
+	EventBits_t bits;
+	bool dinamico;
+};
+
+_Static_assert( sizeof( struct tskTaskControlBlock ) <= sizeof( StaticTask_t ), "aumente StaticTask_t" );
+_Static_assert( sizeof( struct QueueDefinition ) <= sizeof( StaticQueue_t ), "aumente StaticQueue_t" );
+_Static_assert( sizeof( struct EventGroupDef_t ) <= sizeof( StaticEventGroup_t ), "aumente StaticEventGroup_t" );
+
+/* Interrupção pendente na thread (seção crítica ou ISR em andamento). */
+typedef struct {
+	void (*isr)( void *arg );
+	void *arg;
+	int nucleo;
+} pendente_t;
+
+/* Variáveis Globais */
+static struct timespec s_inicio;
+static pthread_mutex_t s_tasks_trava = PTHREAD_MUTEX_INITIALIZER;
+static struct tskTaskControlBlock *s_tasks;
+static struct tskTaskControlBlock *s_encerradas;	//Pilhas liberadas depois do fim da thread.
+static UBaseType_t s_numero_tasks;
+static uint32_t s_proximo_id = 1;
+static pthread_mutex_t s_isr_trava[portNUM_PROCESSORS];
+static portMUX_TYPE s_mascara[portNUM_PROCESSORS] = { portMUX_INITIALIZER_UNLOCKED, portMUX_INITIALIZER_UNLOCKED };
+
+static __thread struct tskTaskControlBlock *t_task;
+static __thread uint32_t t_id;
+static __thread int t_critico;
+static __thread int t_isr;
+static __thread int t_nucleo_isr;
+static __thread pendente_t t_pendentes[MAX_PENDENTES];
+static __thread int t_n_pendentes;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Tempo                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+int64_t sim_agora_ns( void )
+{
+	struct timespec agora;
+	clock_gettime( CLOCK_MONOTONIC, &agora );
+	return (int64_t)( agora.tv_sec - s_inicio.tv_sec ) * 1000000000LL + ( agora.tv_nsec - s_inicio.tv_nsec );
+}
+
+int64_t sim_agora_us( void )
+{
+	return sim_agora_ns() / 1000;
+}
+
+struct timespec sim_instante( int64_t ns )
+{
+	int64_t total = (int64_t) s_inicio.tv_sec * 1000000000LL + s_inicio.tv_nsec + ns;
+	return (struct timespec) { .tv_sec = total / 1000000000LL, .tv_nsec = total % 1000000000LL };
+}
+
+void sim_espera_ate_ns( int64_t ns )
+{
+	int64_t falta = ns - sim_agora_ns();
+	//Dorme enquanto houver folga e termina em espera ocupada (o nanosleep atrasa dezenas de us).
+	if( falta > 200000 )
+	{
+		struct timespec prazo = sim_instante( ns - 100000 );
+		while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL ) == EINTR )
+			;
+	}
+	while( sim_agora_ns() < ns )
+		;
+}
+
+static int64_t tick_ns( TickType_t tick )
+{
+	return (int64_t) tick * SIM_PERIODO_TICK_US * 1000;
+}
+
+bool sim_prazo( TickType_t ticks, struct timespec *prazo )
+{
+	if( ticks == portMAX_DELAY )
+		return false;
+	*prazo = sim_instante( tick_ns( xTaskGetTickCount() + ticks ) );
+	return true;
+}
+
+void sim_cond_init( pthread_cond_t *cond )
+{
+	pthread_condattr_t atributos;
+	pthread_condattr_init( &atributos );
+	pthread_condattr_setclock( &atributos, CLOCK_MONOTONIC );
+	pthread_cond_init( cond, &atributos );
+	pthread_condattr_destroy( &atributos );
+}
+
+bool sim_espera( pthread_cond_t *cond, pthread_mutex_t *trava, const struct timespec *prazo )
+{
+	if( prazo == NULL )
+	{
+		pthread_cond_wait( cond, trava );
+		return true;
+	}
+	return pthread_cond_timedwait( cond, trava, prazo ) != ETIMEDOUT;
+}
+
+/* Espera sem prazo quando ticks = portMAX_DELAY; com ticks = 0 não espera. */
+static bool espera_ticks( pthread_cond_t *cond, pthread_mutex_t *trava, TickType_t ticks, const struct timespec *prazo )
+{
+	if( ticks == 0 )
+		return false;
+	return sim_espera( cond, trava, ticks == portMAX_DELAY ? NULL : prazo );
+}
+
+TickType_t xTaskGetTickCount( void )
+{
+	return (TickType_t)( sim_agora_us() / SIM_PERIODO_TICK_US );
+}
+
+TickType_t xTaskGetTickCountFromISR( void )
+{
+	return xTaskGetTickCount();
+}
+
+/* Tick em 64 bits: vTaskDelay( portMAX_DELAY ) passa do limite do TickType_t e não pode dar a volta. */
+static void dorme_ate_tick( int64_t tick )
+{
+	struct timespec prazo = sim_instante( tick * SIM_PERIODO_TICK_US * 1000 );
+	while( clock_nanosleep( CLOCK_MONOTONIC, TIMER_ABSTIME, &prazo, NULL ) == EINTR )
+		;
+}
+
+void vTaskDelay( TickType_t ticks )
+{
+	if( ticks == 0 )
+	{
+		sched_yield();
+		return;
+	}
+	if( t_task )
+		t_task->estado = eBlocked;
+	dorme_ate_tick( (int64_t) xTaskGetTickCount() + ticks );
+	if( t_task )
+		t_task->estado = eRunning;
+}
+
+void vTaskDelayUntil( TickType_t *anterior, TickType_t incremento )
+{
+	TickType_t alvo = *anterior + incremento;
+	*anterior = alvo;
+	if( (int32_t)( alvo - xTaskGetTickCount() ) > 0 )
+		dorme_ate_tick( alvo );
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Seções críticas e interrupções                                                                 */
+/* ---------------------------------------------------------------------------------------------- */
+
+static uint32_t id_thread( void )
+{
+	if( t_id == 0 )
+		t_id = __atomic_fetch_add( &s_proximo_id, 1, __ATOMIC_RELAXED );
+	return t_id;
+}
+
+void vPortCPUInitializeMutex( portMUX_TYPE *mux )
+{
+	mux->dono = 0;
+	mux->contagem = 0;
+}
+
+static void executa_pendentes( void )
+{
+	while( t_n_pendentes > 0 && t_critico == 0 && t_isr == 0 )
+	{
+		pendente_t p = t_pendentes[0];
+		t_n_pendentes--;
+		memmove( &t_pendentes[0], &t_pendentes[1], t_n_pendentes * sizeof( pendente_t ) );
+		sim_isr_disparar( p.isr, p.arg, p.nucleo );
+	}
+}
+
+void vPortEnterCritical( portMUX_TYPE *mux )
+{
+	uint32_t eu = id_thread();
+	if( __atomic_load_n( &mux->dono, __ATOMIC_ACQUIRE ) == eu )
+		mux->contagem++;
+	else
+	{
+		uint32_t voltas = 0;
+		uint32_t livre = 0;
+		while( !__atomic_compare_exchange_n( &mux->dono, &livre, eu, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED ) )
+		{
+			livre = 0;
+			if( ++voltas > 64 )
+				sched_yield();
+		}
+		mux->contagem = 1;
+	}
+	t_critico++;
+}
+
+void vPortExitCritical( portMUX_TYPE *mux )
+{
+	if( __atomic_load_n( &mux->dono, __ATOMIC_RELAXED ) != id_thread() )
+	{
+		fprintf( stderr, "portEXIT_CRITICAL sem portENTER_CRITICAL na mesma thread\n" );
+		abort();
+	}
+	//Escritas de registradores feitas na seção (ex.: PCNT.int_clr) valem antes da liberação.
+	sim_pcnt_registradores();
+	if( --mux->contagem == 0 )
+		__atomic_store_n( &mux->dono, 0, __ATOMIC_RELEASE );
+	t_critico--;
+	executa_pendentes();
+}
+
+/* A máscara de interrupções de um núcleo impede que outro escritor no mesmo núcleo intercale. */
+UBaseType_t xPortSetInterruptMaskFromISR( void )
+{
+	BaseType_t nucleo = xPortGetCoreID();
+	vPortEnterCritical( &s_mascara[nucleo] );
+	return (UBaseType_t) nucleo;
+}
+
+void vPortClearInterruptMaskFromISR( UBaseType_t estado )
+{
+	vPortExitCritical( &s_mascara[estado] );
+}
+
+BaseType_t xPortGetCoreID( void )
+{
+	if( t_isr )
+		return t_nucleo_isr;
+	if( t_task && t_task->nucleo != tskNO_AFFINITY )
+		return t_task->nucleo;
+	return PRO_CPU_NUM;
+}
+
+BaseType_t xPortInIsrContext( void )
+{
+	return t_isr > 0;
+}
+
+bool sim_em_isr( void )
+{
+	return t_isr > 0;
+}
+
+void vPortYield( void )
+{
+	sched_yield();
+}
+
+void sim_isr_disparar( void (*isr)( void *arg ), void *arg, int nucleo )
+{
+	if( nucleo < 0 || nucleo >= portNUM_PROCESSORS )
+		nucleo = PRO_CPU_NUM;
+	if( t_critico > 0 || t_isr > 0 )
+	{
+		for( int i = 0; i < t_n_pendentes; i++ )
+			if( t_pendentes[i].isr == isr && t_pendentes[i].arg == arg )
+				return;
+		if( t_n_pendentes < MAX_PENDENTES )
+			t_pendentes[t_n_pendentes++] = (pendente_t) { isr, arg, nucleo };
+		return;
+	}
+
+	//Uma ISR por vez em cada núcleo, como no hardware.
+	pthread_mutex_lock( &s_isr_trava[nucleo] );
+	int nucleo_anterior = t_nucleo_isr;
+	t_isr++;
+	t_nucleo_isr = nucleo;
+	isr( arg );
+	sim_pcnt_registradores();
+	t_nucleo_isr = nucleo_anterior;
+	t_isr--;
+	pthread_mutex_unlock( &s_isr_trava[nucleo] );
+	executa_pendentes();
+}
+
+void vTaskSuspendAll( void )
+{
+	vPortEnterCritical( &s_mascara[xPortGetCoreID()] );
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+	vPortExitCritical( &s_mascara[xPortGetCoreID()] );
+	return pdFALSE;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Tasks                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+static void libera_encerradas( void )
+{
+	struct tskTaskControlBlock **p = &s_encerradas;
+	while( *p )
+	{
+		struct tskTaskControlBlock *t = *p;
+		if( pthread_tryjoin_np( t->thread, NULL ) == 0 )
+		{
+			*p = t->proxima;
+			munmap( t->pilha, PILHA_HOST );
+			if( t->dinamica )
+				sim_heap_liberar( t );
+		}
+		else
+			p = &t->proxima;
+	}
+}
+
+static void *executa_task( void *arg )
+{
+	struct tskTaskControlBlock *task = arg;
+	t_task = task;
+	id_thread();
+	pthread_getcpuclockid( pthread_self(), &task->relogio );
+	task->estado = eRunning;
+	task->funcao( task->parametro );
+	//Uma task não pode retornar: como no FreeRTOS, é um erro do programa.
+	fprintf( stderr, "task %s retornou sem vTaskDelete\n", task->nome );
+	abort();
+	return NULL;
+}
+
+static TaskHandle_t cria_task( struct tskTaskControlBlock *task, TaskFunction_t funcao, const char *nome, uint32_t pilha,
+							   void *parametro, UBaseType_t prioridade, BaseType_t nucleo, bool dinamica )
+{
+	memset( task, 0, sizeof( *task ) );
+	task->magia = MAGIA_TASK;
+	strncpy( task->nome, nome ? nome : "", sizeof( task->nome ) - 1 );
+	task->funcao = funcao;
+	task->parametro = parametro;
+	task->prioridade = prioridade;
+	task->nucleo = ( nucleo >= 0 && nucleo < portNUM_PROCESSORS ) ? nucleo : tskNO_AFFINITY;
+	task->pilha_pedida = pilha;
+	task->dinamica = dinamica;
+	task->estado = eReady;
+	pthread_mutex_init( &task->trava, NULL );
+	sim_cond_init( &task->cond );
+
+	task->pilha = mmap( NULL, PILHA_HOST, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_STACK, -1, 0 );
+	if( task->pilha == MAP_FAILED )
+		return NULL;
+	memset( task->pilha, PADRAO_PILHA, PILHA_HOST );
+
+	pthread_mutex_lock( &s_tasks_trava );
+	libera_encerradas();
+	task->numero = ++s_numero_tasks;
+	task->proxima = s_tasks;
+	s_tasks = task;
+
+	pthread_attr_t atributos;
+	pthread_attr_init( &atributos );
+	pthread_attr_setstack( &atributos, task->pilha, PILHA_HOST );
+	int ret = pthread_create( &task->thread, &atributos, executa_task, task );
+	pthread_attr_destroy( &atributos );
+	if( ret == 0 )
+		pthread_setname_np( task->thread, task->nome );
+	else
+	{
+		s_tasks = task->proxima;
+		munmap( task->pilha, PILHA_HOST );
+		task = NULL;
+	}
+	pthread_mutex_unlock( &s_tasks_trava );
+	return task;
+}
+
+BaseType_t xTaskCreatePinnedToCore( TaskFunction_t funcao, const char *nome, uint32_t pilha, void *parametro,
+									UBaseType_t prioridade, TaskHandle_t *handle, BaseType_t nucleo )
+{
+	//Como no ESP-IDF, o TCB e a pilha pedida saem do heap (a pilha real da thread é separada).
+	struct tskTaskControlBlock *task = sim_heap_alocar( sizeof( *task ) + pilha );
+	if( task == NULL )
+		return pdFAIL;
+	TaskHandle_t criada = cria_task( task, funcao, nome, pilha, parametro, prioridade, nucleo, true );
+	if( criada == NULL )
+	{
+		sim_heap_liberar( task );
+		return pdFAIL;
+	}
+	if( handle )
+		*handle = criada;
+	return pdPASS;
+}
+
+TaskHandle_t xTaskCreateStaticPinnedToCore( TaskFunction_t funcao, const char *nome, uint32_t pilha, void *parametro,
+											UBaseType_t prioridade, StackType_t *buffer_pilha, StaticTask_t *buffer_task,
+											BaseType_t nucleo )
+{
+	if( buffer_pilha == NULL || buffer_task == NULL )
+		return NULL;
+	return cria_task( (struct tskTaskControlBlock*) buffer_task, funcao, nome, pilha, parametro, prioridade, nucleo, false );
+}
+
+TaskHandle_t sim_task_sistema( TaskFunction_t funcao, const char *nome, UBaseType_t prioridade, BaseType_t nucleo )
+{
+	struct tskTaskControlBlock *task = calloc( 1, sizeof( *task ) );
+	return task ? cria_task( task, funcao, nome, 4096, NULL, prioridade, nucleo, false ) : NULL;
+}
+
+void vTaskDelete( TaskHandle_t task )
+{
+	if( task != NULL && task != t_task )
+	{
+		fprintf( stderr, "vTaskDelete de outra task nao suportado na simulacao\n" );
+		abort();
+	}
+	task = t_task;
+	pthread_mutex_lock( &s_tasks_trava );
+	struct tskTaskControlBlock **p = &s_tasks;
+	while( *p && *p != task )
+		p = &( *p )->proxima;
+	if( *p )
+		*p = task->proxima;
+	task->estado = eDeleted;
+	task->proxima = s_encerradas;
+	s_encerradas = task;
+	pthread_mutex_unlock( &s_tasks_trava );
+	pthread_exit( NULL );
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle( void )
+{
+	return t_task;
+}
+
+UBaseType_t uxTaskPriorityGet( TaskHandle_t task )
+{
+	task = task ? task : t_task;
+	return task ? task->prioridade : 0;
+}
+
+char *pcTaskGetTaskName( TaskHandle_t task )
+{
+	task = task ? task : t_task;
+	return task ? task->nome : NULL;
+}
+
+/*
+	Folga da pilha nos bytes pedidos pela task: bytes pedidos menos os usados da pilha real (contados
+	pela pintura). O código no x86-64 usa mais pilha que no ESP32, então a folga é pessimista.
+*/
+static uint32_t folga_pilha( const struct tskTaskControlBlock *task )
+{
+	size_t livres = 0;
+	while( livres < PILHA_HOST && task->pilha[livres] == PADRAO_PILHA )
+		livres++;
+	size_t usados = PILHA_HOST - livres;
+	return usados >= task->pilha_pedida ? 0 : task->pilha_pedida - (uint32_t) usados;
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark( TaskHandle_t task )
+{
+	task = task ? task : t_task;
+	return task ? folga_pilha( task ) : 0;
+}
+
+UBaseType_t uxTaskGetNumberOfTasks( void )
+{
+	UBaseType_t n = 0;
+	pthread_mutex_lock( &s_tasks_trava );
+	for( struct tskTaskControlBlock *t = s_tasks; t; t = t->proxima )
+		n++;
+	pthread_mutex_unlock( &s_tasks_trava );
+	return n;
+}
+
+UBaseType_t uxTaskGetSystemState( TaskStatus_t *tasks, UBaseType_t max, uint32_t *tempo_total )
+{
+	UBaseType_t n = 0;
+	pthread_mutex_lock( &s_tasks_trava );
+	for( struct tskTaskControlBlock *t = s_tasks; t; t = t->proxima )
+	{
+		if( n == max )
+		{
+			n = 0;		//Como no FreeRTOS: vetor pequeno demais não recebe nada.
+			break;
+		}
+		struct timespec cpu = { 0 };
+		if( t->estado != eReady )
+			clock_gettime( t->relogio, &cpu );
+		tasks[n++] = (TaskStatus_t) {
+			.xHandle = t,
+			.pcTaskName = t->nome,
+			.xTaskNumber = t->numero,
+			.eCurrentState = t == t_task ? eRunning : t->estado,
+			.uxCurrentPriority = t->prioridade,
+			.uxBasePriority = t->prioridade,
+			.ulRunTimeCounter = (uint32_t)( (uint64_t) cpu.tv_sec * 1000000 + cpu.tv_nsec / 1000 ),
+			.pxStackBase = t->pilha,
+			.usStackHighWaterMark = folga_pilha( t ),
+			.xCoreID = t->nucleo,
+		};
+	}
+	pthread_mutex_unlock( &s_tasks_trava );
+	if( tempo_total )
+		*tempo_total = (uint32_t) sim_agora_us();
+	return n;
+}
+
+/* Notificações: contador por task. */
+BaseType_t xTaskNotifyGive( TaskHandle_t task )
+{
+	pthread_mutex_lock( &task->trava );
+	task->notificacao++;
+	pthread_cond_signal( &task->cond );
+	pthread_mutex_unlock( &task->trava );
+	return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR( TaskHandle_t task, BaseType_t *acordou )
+{
+	xTaskNotifyGive( task );
+	if( acordou )
+		*acordou = pdTRUE;
+}
+
+uint32_t ulTaskNotifyTake( BaseType_t zerar, TickType_t espera )
+{
+	struct tskTaskControlBlock *task = t_task;
+	struct timespec prazo;
+	sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &task->trava );
+	task->estado = eBlocked;
+	while( task->notificacao == 0 && espera_ticks( &task->cond, &task->trava, espera, &prazo ) )
+		;
+	task->estado = eRunning;
+	uint32_t valor = task->notificacao;
+	if( valor )
+		task->notificacao = zerar ? 0 : valor - 1;
+	pthread_mutex_unlock( &task->trava );
+	return valor;
+}
+
+pthread_t sim_thread( void *(*funcao)( void *arg ), void *arg )
+{
+	pthread_t thread;
+	if( pthread_create( &thread, NULL, funcao, arg ) != 0 )
+	{
+		fprintf( stderr, "simulacao: falha ao criar thread\n" );
+		abort();
+	}
+	pthread_detach( thread );
+	return thread;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Filas e semáforos                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+static QueueHandle_t inicia_fila( struct QueueDefinition *fila, tipo_fila_t tipo, UBaseType_t tamanho,
+								  UBaseType_t tamanho_item, uint8_t *itens, bool dinamica )
+{
+	memset( fila, 0, sizeof( *fila ) );
+	fila->magia = MAGIA_FILA;
+	fila->tipo = tipo;
+	fila->tamanho = tamanho;
+	fila->tamanho_item = tamanho_item;
+	fila->itens = itens;
+	fila->dinamica = dinamica;
+	pthread_mutex_init( &fila->trava, NULL );
+	sim_cond_init( &fila->nao_vazia );
+	sim_cond_init( &fila->nao_cheia );
+	if( tipo == MUTEX || tipo == MUTEX_RECURSIVO )
+		fila->n = 1;
+	return fila;
+}
+
+static QueueHandle_t cria_fila( tipo_fila_t tipo, UBaseType_t tamanho, UBaseType_t tamanho_item )
+{
+	struct QueueDefinition *fila = sim_heap_alocar( sizeof( *fila ) + tamanho * tamanho_item );
+	if( fila == NULL )
+		return NULL;
+	return inicia_fila( fila, tipo, tamanho, tamanho_item, (uint8_t*)( fila + 1 ), true );
+}
+
+QueueHandle_t xQueueCreate( UBaseType_t tamanho, UBaseType_t tamanho_item )
+{
+	return tamanho ? cria_fila( FILA, tamanho, tamanho_item ) : NULL;
+}
+
+QueueHandle_t xQueueCreateStatic( UBaseType_t tamanho, UBaseType_t tamanho_item, uint8_t *armazenamento,
+								  StaticQueue_t *buffer )
+{
+	if( tamanho == 0 || buffer == NULL || ( tamanho_item && armazenamento == NULL ) )
+		return NULL;
+	return inicia_fila( (struct QueueDefinition*) buffer, FILA, tamanho, tamanho_item, armazenamento, false );
+}
+
+void vQueueDelete( QueueHandle_t fila )
+{
+	pthread_mutex_destroy( &fila->trava );
+	pthread_cond_destroy( &fila->nao_vazia );
+	pthread_cond_destroy( &fila->nao_cheia );
+	fila->magia = 0;
+	if( fila->dinamica )
+		sim_heap_liberar( fila );
+}
+
+static void copia_para( struct QueueDefinition *fila, const void *item, bool frente, bool sobrescrever )
+{
+	if( sobrescrever && fila->n == fila->tamanho )
+	{
+		memcpy( fila->itens + fila->cabeca * fila->tamanho_item, item, fila->tamanho_item );
+		return;
+	}
+	UBaseType_t pos;
+	if( frente )
+	{
+		fila->cabeca = ( fila->cabeca + fila->tamanho - 1 ) % fila->tamanho;
+		pos = fila->cabeca;
+	}
+	else
+		pos = ( fila->cabeca + fila->n ) % fila->tamanho;
+	if( fila->tamanho_item )
+		memcpy( fila->itens + pos * fila->tamanho_item, item, fila->tamanho_item );
+	fila->n++;
+}
+
+static BaseType_t envia( QueueHandle_t fila, const void *item, TickType_t espera, bool frente, bool sobrescrever )
+{
+	struct timespec prazo;
+	sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &fila->trava );
+	while( fila->n == fila->tamanho && !sobrescrever )
+	{
+		if( !espera_ticks( &fila->nao_cheia, &fila->trava, espera, &prazo ) && fila->n == fila->tamanho )
+		{
+			pthread_mutex_unlock( &fila->trava );
+			return errQUEUE_FULL;
+		}
+	}
+	copia_para( fila, item, frente, sobrescrever );
+	pthread_cond_signal( &fila->nao_vazia );
+	pthread_mutex_unlock( &fila->trava );
+	return pdPASS;
+}
+
+static BaseType_t recebe( QueueHandle_t fila, void *item, TickType_t espera, bool remover )
+{
+	struct timespec prazo;
+	sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &fila->trava );
+	while( fila->n == 0 )
+	{
+		if( !espera_ticks( &fila->nao_vazia, &fila->trava, espera, &prazo ) && fila->n == 0 )
+		{
+			pthread_mutex_unlock( &fila->trava );
+			return errQUEUE_EMPTY;
+		}
+	}
+	if( fila->tamanho_item && item )
+		memcpy( item, fila->itens + fila->cabeca * fila->tamanho_item, fila->tamanho_item );
+	if( remover )
+	{
+		fila->cabeca = ( fila->cabeca + 1 ) % ( fila->tamanho ? fila->tamanho : 1 );
+		fila->n--;
+		pthread_cond_signal( &fila->nao_cheia );
+	}
+	pthread_mutex_unlock( &fila->trava );
+	return pdPASS;
+}
+
+BaseType_t xQueueSend( QueueHandle_t fila, const void *item, TickType_t espera )
+{
+	return envia( fila, item, espera, false, false );
+}
+
+BaseType_t xQueueSendToFront( QueueHandle_t fila, const void *item, TickType_t espera )
+{
+	return envia( fila, item, espera, true, false );
+}
+
+BaseType_t xQueueOverwrite( QueueHandle_t fila, const void *item )
+{
+	return envia( fila, item, 0, false, true );
+}
+
+BaseType_t xQueueReceive( QueueHandle_t fila, void *item, TickType_t espera )
+{
+	return recebe( fila, item, espera, true );
+}
+
+BaseType_t xQueuePeek( QueueHandle_t fila, void *item, TickType_t espera )
+{
+	return recebe( fila, item, espera, false );
+}
+
+BaseType_t xQueueSendFromISR( QueueHandle_t fila, const void *item, BaseType_t *acordou )
+{
+	if( acordou )
+		*acordou = pdFALSE;
+	return envia( fila, item, 0, false, false );
+}
+
+BaseType_t xQueueReceiveFromISR( QueueHandle_t fila, void *item, BaseType_t *acordou )
+{
+	if( acordou )
+		*acordou = pdFALSE;
+	return recebe( fila, item, 0, true );
+}
+
+UBaseType_t uxQueueMessagesWaiting( QueueHandle_t fila )
+{
+	pthread_mutex_lock( &fila->trava );
+	UBaseType_t n = fila->n;
+	pthread_mutex_unlock( &fila->trava );
+	return n;
+}
+
+UBaseType_t uxQueueSpacesAvailable( QueueHandle_t fila )
+{
+	pthread_mutex_lock( &fila->trava );
+	UBaseType_t n = fila->tamanho - fila->n;
+	pthread_mutex_unlock( &fila->trava );
+	return n;
+}
+
+BaseType_t xQueueReset( QueueHandle_t fila )
+{
+	pthread_mutex_lock( &fila->trava );
+	fila->n = 0;
+	fila->cabeca = 0;
+	pthread_cond_broadcast( &fila->nao_cheia );
+	pthread_mutex_unlock( &fila->trava );
+	return pdPASS;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex( void )
+{
+	return cria_fila( MUTEX, 1, 0 );
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutexStatic( StaticSemaphore_t *buffer )
+{
+	return buffer ? inicia_fila( (struct QueueDefinition*) buffer, MUTEX, 1, 0, NULL, false ) : NULL;
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex( void )
+{
+	return cria_fila( MUTEX_RECURSIVO, 1, 0 );
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutexStatic( StaticSemaphore_t *buffer )
+{
+	return buffer ? inicia_fila( (struct QueueDefinition*) buffer, MUTEX_RECURSIVO, 1, 0, NULL, false ) : NULL;
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary( void )
+{
+	return cria_fila( BINARIO, 1, 0 );
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting( UBaseType_t maximo, UBaseType_t inicial )
+{
+	SemaphoreHandle_t semaforo = cria_fila( CONTADOR, maximo, 0 );
+	if( semaforo )
+		semaforo->n = inicial;
+	return semaforo;
+}
+
+BaseType_t xSemaphoreTake( SemaphoreHandle_t semaforo, TickType_t espera )
+{
+	if( recebe( semaforo, NULL, espera, true ) != pdPASS )
+		return pdFALSE;
+	semaforo->dono = t_task;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive( SemaphoreHandle_t semaforo )
+{
+	if( semaforo->tipo == MUTEX && semaforo->dono != t_task )
+		return pdFALSE;
+	semaforo->dono = NULL;
+	return envia( semaforo, NULL, 0, false, false );
+}
+
+BaseType_t xSemaphoreTakeRecursive( SemaphoreHandle_t semaforo, TickType_t espera )
+{
+	if( semaforo->dono == t_task && t_task != NULL )
+	{
+		semaforo->recursao++;
+		return pdTRUE;
+	}
+	if( recebe( semaforo, NULL, espera, true ) != pdPASS )
+		return pdFALSE;
+	semaforo->dono = t_task;
+	semaforo->recursao = 1;
+	return pdTRUE;
+}
+
+BaseType_t xSemaphoreGiveRecursive( SemaphoreHandle_t semaforo )
+{
+	if( semaforo->dono != t_task )
+		return pdFALSE;
+	if( --semaforo->recursao > 0 )
+		return pdTRUE;
+	semaforo->dono = NULL;
+	return envia( semaforo, NULL, 0, false, false );
+}
+
+BaseType_t xSemaphoreGiveFromISR( SemaphoreHandle_t semaforo, BaseType_t *acordou )
+{
+	if( acordou )
+		*acordou = pdFALSE;
+	return envia( semaforo, NULL, 0, false, false );
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Grupos de eventos                                                                              */
+/* ---------------------------------------------------------------------------------------------- */
+
+static EventGroupHandle_t inicia_grupo( struct EventGroupDef_t *grupo, bool dinamico )
+{
+	memset( grupo, 0, sizeof( *grupo ) );
+	grupo->magia = MAGIA_GRUPO;
+	grupo->dinamico = dinamico;
+	pthread_mutex_init( &grupo->trava, NULL );
+	sim_cond_init( &grupo->cond );
+	return grupo;
+}
+
+EventGroupHandle_t xEventGroupCreate( void )
+{
+	struct EventGroupDef_t *grupo = sim_heap_alocar( sizeof( *grupo ) );
+	return grupo ? inicia_grupo( grupo, true ) : NULL;
+}
+
+EventGroupHandle_t xEventGroupCreateStatic( StaticEventGroup_t *buffer )
+{
+	return buffer ? inicia_grupo( (struct EventGroupDef_t*) buffer, false ) : NULL;
+}
+
+EventBits_t xEventGroupSetBits( EventGroupHandle_t grupo, EventBits_t bits )
+{
+	pthread_mutex_lock( &grupo->trava );
+	grupo->bits |= bits;
+	EventBits_t atual = grupo->bits;
+	pthread_cond_broadcast( &grupo->cond );
+	pthread_mutex_unlock( &grupo->trava );
+	return atual;
+}
+
+BaseType_t xEventGroupSetBitsFromISR( EventGroupHandle_t grupo, EventBits_t bits, BaseType_t *acordou )
+{
+	xEventGroupSetBits( grupo, bits );
+	if( acordou )
+		*acordou = pdFALSE;
+	return pdPASS;
+}
+
+EventBits_t xEventGroupClearBits( EventGroupHandle_t grupo, EventBits_t bits )
+{
+	pthread_mutex_lock( &grupo->trava );
+	EventBits_t anterior = grupo->bits;
+	grupo->bits &= ~bits;
+	pthread_mutex_unlock( &grupo->trava );
+	return anterior;
+}
+
+EventBits_t xEventGroupGetBits( EventGroupHandle_t grupo )
+{
+	pthread_mutex_lock( &grupo->trava );
+	EventBits_t bits = grupo->bits;
+	pthread_mutex_unlock( &grupo->trava );
+	return bits;
+}
+
+EventBits_t xEventGroupWaitBits( EventGroupHandle_t grupo, EventBits_t bits, BaseType_t limpar, BaseType_t todos,
+								 TickType_t espera )
+{
+	struct timespec prazo;
+	sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &grupo->trava );
+	while( 1 )
+	{
+		EventBits_t atual = grupo->bits;
+		bool ok = todos ? ( atual & bits ) == bits : ( atual & bits ) != 0;
+		if( ok )
+		{
+			if( limpar )
+				grupo->bits &= ~bits;
+			pthread_mutex_unlock( &grupo->trava );
+			return atual;
+		}
+		if( !espera_ticks( &grupo->cond, &grupo->trava, espera, &prazo ) )
+		{
+			atual = grupo->bits;
+			bool ok_prazo = todos ? ( atual & bits ) == bits : ( atual & bits ) != 0;
+			if( !ok_prazo )
+			{
+				pthread_mutex_unlock( &grupo->trava );
+				return atual;
+			}
+		}
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+
+void sim_freertos_iniciar( void )
+{
+	clock_gettime( CLOCK_MONOTONIC, &s_inicio );
+	for( int i = 0; i < portNUM_PROCESSORS; i++ )
+	{
+		pthread_mutexattr_t atributos;
+		pthread_mutexattr_init( &atributos );
+		pthread_mutexattr_settype( &atributos, PTHREAD_MUTEX_RECURSIVE );
+		pthread_mutex_init( &s_isr_trava[i], &atributos );
+		pthread_mutexattr_destroy( &atributos );
+	}
+}
@@ -0,0 +1,445 @@
+/*
+	Objetivo: GPIO do ESP32 no build para Linux - nível de cada pino (saída do GPIO ou de um periférico
+			  pela matriz, circuito externo ou pull), registradores OUT/IN e o serviço de ISR por pino
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "driver/gpio.h"
+#include "soc/gpio_sig_map.h"
+#include "esp_log.h"
+#include "sim_interno.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define INTR_ENA_APP_CPU	BIT0
+#define INTR_ENA_PRO_CPU	BIT2
+#define NUM_SINAIS			( SIG_GPIO_OUT_IDX + 1 )
+
+typedef struct {
+	uint8_t modo;				//Bits GPIO_MODE_DEF_*.
+	bool pull_up;
+	bool pull_down;
+	int8_t externo;				//Nível imposto externamente (-1: nenhum).
+	uint8_t nivel;				//Nível atual do pad.
+	uint16_t sinal;				//Sinal de saída roteado pela matriz.
+	gpio_isr_t isr;
+	void *arg;
+} pino_t;
+
+/* Variáveis Globais */
+static const char * TAG = "gpio";
+gpio_dev_t GPIO;
+static portMUX_TYPE s_trava = portMUX_INITIALIZER_UNLOCKED;	//As ISRs disparadas com a trava ficam pendentes.
+static pino_t s_pinos[GPIO_PIN_COUNT];
+static uint64_t s_saida;						//Registradores GPIO_OUT_REG e GPIO_OUT1_REG.
+static uint8_t s_sinais[NUM_SINAIS];			//Nível atual de cada sinal de periférico.
+static bool s_servico;
+static int s_nucleo_servico;
+
+static int nivel_pad( int pino )
+{
+	const pino_t *p = &s_pinos[pino];
+	if( p->modo & GPIO_MODE_DEF_OUTPUT )
+	{
+		int saida = p->sinal == SIG_GPIO_OUT_IDX ? (int)( ( s_saida >> pino ) & 1 ) : s_sinais[p->sinal];
+		//Em dreno aberto o nível alto solta o pino.
+		if( !( p->modo & GPIO_MODE_DEF_OD ) || saida == 0 )
+			return saida;
+	}
+	if( p->externo >= 0 )
+		return p->externo;
+	return p->pull_up ? 1 : 0;
+}
+
+static bool borda_interrompe( gpio_int_type_t tipo, int nivel )
+{
+	switch( tipo )
+	{
+		case GPIO_INTR_ANYEDGE:		return true;
+		case GPIO_INTR_POSEDGE:
+		case GPIO_INTR_HIGH_LEVEL:	return nivel;
+		case GPIO_INTR_NEGEDGE:
+		case GPIO_INTR_LOW_LEVEL:	return !nivel;
+		default:					return false;
+	}
+}
+
+/* Entrega a interrupção do pino ao núcleo do serviço, se ela estiver habilitada para esse núcleo. */
+static void interrompe( int pino )
+{
+	const pino_t *p = &s_pinos[pino];
+	uint32_t ena = s_nucleo_servico == APP_CPU_NUM ? INTR_ENA_APP_CPU : INTR_ENA_PRO_CPU;
+	if( s_servico && p->isr && ( GPIO.pin[pino].int_ena & ena ) )
+		sim_isr_disparar( p->isr, p->arg, s_nucleo_servico );
+}
+
+/* Recalcula o pad depois de uma mudança. Com s_trava. */
+static void atualiza( int pino )
+{
+	pino_t *p = &s_pinos[pino];
+	int nivel = nivel_pad( pino );
+	if( nivel == p->nivel )
+		return;
+	p->nivel = nivel;
+	if( !( p->modo & GPIO_MODE_DEF_INPUT ) )
+		return;
+	int64_t agora = sim_agora_ns();
+	sim_pcnt_borda( pino, nivel, agora );
+	sim_rmt_borda( pino, nivel, agora );
+	if( borda_interrompe( GPIO.pin[pino].int_type, nivel ) )
+		interrompe( pino );
+}
+
+static bool valido( gpio_num_t pino )
+{
+	return GPIO_IS_VALID_GPIO( pino );
+}
+
+esp_err_t gpio_set_direction( gpio_num_t pino, gpio_mode_t modo )
+{
+	if( !valido( pino ) || ( ( modo & GPIO_MODE_DEF_OUTPUT ) && !GPIO_IS_VALID_OUTPUT_GPIO( pino ) ) )
+	{
+		ESP_LOGE( TAG, "GPIO %d invalido para o modo %d", pino, modo );
+		return ESP_ERR_INVALID_ARG;
+	}
+	portENTER_CRITICAL( &s_trava );
+	s_pinos[pino].modo = modo;
+	//Como no gpio_output_enable do ESP-IDF, a saída volta para o GPIO (desconecta LEDC/RMT).
+	if( modo & GPIO_MODE_DEF_OUTPUT )
+		s_pinos[pino].sinal = SIG_GPIO_OUT_IDX;
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_pull_mode( gpio_num_t pino, gpio_pull_mode_t pull )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	s_pinos[pino].pull_up = pull == GPIO_PULLUP_ONLY || pull == GPIO_PULLUP_PULLDOWN;
+	s_pinos[pino].pull_down = pull == GPIO_PULLDOWN_ONLY || pull == GPIO_PULLUP_PULLDOWN;
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t gpio_set_level( gpio_num_t pino, uint32_t nivel )
+{
+	if( !GPIO_IS_VALID_OUTPUT_GPIO( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	if( nivel )
+		s_saida |= 1ULL << pino;
+	else
+		s_saida &= ~( 1ULL << pino );
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+int gpio_get_level( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return 0;
+	portENTER_CRITICAL( &s_trava );
+	int nivel = ( s_pinos[pino].modo & GPIO_MODE_DEF_INPUT ) ? s_pinos[pino].nivel : 0;
+	portEXIT_CRITICAL( &s_trava );
+	return nivel;
+}
+
+esp_err_t gpio_set_intr_type( gpio_num_t pino, gpio_int_type_t tipo )
+{
+	if( !valido( pino ) || tipo >= GPIO_INTR_MAX )
+		return ESP_ERR_INVALID_ARG;
+	GPIO.pin[pino].int_type = tipo;
+	return ESP_OK;
+}
+
+esp_err_t gpio_intr_enable( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	GPIO.pin[pino].int_ena = xPortGetCoreID() == APP_CPU_NUM ? INTR_ENA_APP_CPU : INTR_ENA_PRO_CPU;
+	//Interrupção por nível: dispara logo se o pino já estiver no nível.
+	gpio_int_type_t tipo = GPIO.pin[pino].int_type;
+	if( ( tipo == GPIO_INTR_LOW_LEVEL || tipo == GPIO_INTR_HIGH_LEVEL ) && borda_interrompe( tipo, s_pinos[pino].nivel ) )
+		interrompe( pino );
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t gpio_intr_disable( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	GPIO.pin[pino].int_ena = 0;
+	return ESP_OK;
+}
+
+esp_err_t gpio_config( const gpio_config_t *config )
+{
+	if( config == NULL || config->pin_bit_mask == 0 || config->pin_bit_mask >> GPIO_PIN_COUNT )
+		return ESP_ERR_INVALID_ARG;
+	for( int pino = 0; pino < GPIO_PIN_COUNT; pino++ )
+	{
+		if( !( config->pin_bit_mask & ( 1ULL << pino ) ) )
+			continue;
+		if( !valido( pino ) )
+			return ESP_ERR_INVALID_ARG;
+		esp_err_t ret = gpio_set_direction( pino, config->mode );
+		if( ret != ESP_OK )
+			return ret;
+		portENTER_CRITICAL( &s_trava );
+		s_pinos[pino].pull_up = config->pull_up_en;
+		s_pinos[pino].pull_down = config->pull_down_en;
+		atualiza( pino );
+		portEXIT_CRITICAL( &s_trava );
+		gpio_set_intr_type( pino, config->intr_type );
+		if( config->intr_type )
+			gpio_intr_enable( pino );
+		else
+			gpio_intr_disable( pino );
+	}
+	return ESP_OK;
+}
+
+esp_err_t gpio_reset_pin( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	gpio_config_t config = {
+		.pin_bit_mask = 1ULL << pino,
+		.mode = GPIO_MODE_DISABLE,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+	};
+	return gpio_config( &config );
+}
+
+void gpio_pad_select_gpio( uint8_t pino )
+{
+	if( !valido( pino ) )
+		return;
+	portENTER_CRITICAL( &s_trava );
+	s_pinos[pino].sinal = SIG_GPIO_OUT_IDX;
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+}
+
+void gpio_matrix_out( uint32_t pino, uint32_t sinal, bool inverte, bool inverte_oen )
+{
+	(void) inverte;
+	(void) inverte_oen;
+	if( !valido( pino ) || sinal >= NUM_SINAIS )
+		return;
+	portENTER_CRITICAL( &s_trava );
+	s_pinos[pino].sinal = sinal;
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+}
+
+esp_err_t gpio_wakeup_enable( gpio_num_t pino, gpio_int_type_t tipo )
+{
+	if( !valido( pino ) || ( tipo != GPIO_INTR_LOW_LEVEL && tipo != GPIO_INTR_HIGH_LEVEL ) )
+		return ESP_ERR_INVALID_ARG;
+	GPIO.pin[pino].int_type = tipo;
+	GPIO.pin[pino].wakeup_enable = 1;
+	return ESP_OK;
+}
+
+esp_err_t gpio_wakeup_disable( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	GPIO.pin[pino].wakeup_enable = 0;
+	return ESP_OK;
+}
+
+esp_err_t gpio_install_isr_service( int flags )
+{
+	(void) flags;
+	portENTER_CRITICAL( &s_trava );
+	esp_err_t ret = ESP_ERR_INVALID_STATE;
+	if( !s_servico )
+	{
+		//A interrupção é alocada no núcleo de quem instala o serviço.
+		s_servico = true;
+		s_nucleo_servico = xPortGetCoreID();
+		ret = ESP_OK;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	if( ret != ESP_OK )
+		ESP_LOGE( TAG, "GPIO isr service already installed" );
+	return ret;
+}
+
+void gpio_uninstall_isr_service( void )
+{
+	portENTER_CRITICAL( &s_trava );
+	s_servico = false;
+	for( int pino = 0; pino < GPIO_PIN_COUNT; pino++ )
+		s_pinos[pino].isr = NULL;
+	portEXIT_CRITICAL( &s_trava );
+}
+
+esp_err_t gpio_isr_handler_add( gpio_num_t pino, gpio_isr_t isr, void *arg )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	esp_err_t ret = ESP_ERR_INVALID_STATE;
+	if( s_servico )
+	{
+		s_pinos[pino].isr = isr;
+		s_pinos[pino].arg = arg;
+		ret = ESP_OK;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	return ret;
+}
+
+esp_err_t gpio_isr_handler_remove( gpio_num_t pino )
+{
+	if( !valido( pino ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	esp_err_t ret = ESP_ERR_INVALID_STATE;
+	if( s_servico )
+	{
+		s_pinos[pino].isr = NULL;
+		s_pinos[pino].arg = NULL;
+		ret = ESP_OK;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	return ret;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Registradores                                                                                  */
+/* ---------------------------------------------------------------------------------------------- */
+
+static uint32_t entradas( int base )
+{
+	uint32_t valor = 0;
+	for( int i = 0; i < 32 && base + i < GPIO_PIN_COUNT; i++ )
+		if( ( s_pinos[base + i].modo & GPIO_MODE_DEF_INPUT ) && s_pinos[base + i].nivel )
+			valor |= 1UL << i;
+	return valor;
+}
+
+uint32_t sim_reg_ler( uint32_t endereco )
+{
+	uint32_t valor = 0;
+	portENTER_CRITICAL( &s_trava );
+	switch( endereco )
+	{
+		case GPIO_OUT_REG:		valor = (uint32_t) s_saida; break;
+		case GPIO_OUT1_REG:		valor = (uint32_t)( s_saida >> 32 ); break;
+		case GPIO_IN_REG:		valor = entradas( 0 ); break;
+		case GPIO_IN1_REG:		valor = entradas( 32 ); break;
+		case GPIO_ENABLE_REG:
+		case GPIO_ENABLE1_REG:
+		{
+			int base = endereco == GPIO_ENABLE_REG ? 0 : 32;
+			for( int i = 0; i < 32 && base + i < GPIO_PIN_COUNT; i++ )
+				if( s_pinos[base + i].modo & GPIO_MODE_DEF_OUTPUT )
+					valor |= 1UL << i;
+			break;
+		}
+		default:
+			break;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	return valor;
+}
+
+/* Muda o registrador de saída e propaga para todos os pinos afetados em uma única seção. */
+static void escreve_saida( uint64_t nova )
+{
+	uint64_t mudou = s_saida ^ nova;
+	s_saida = nova;
+	for( int pino = 0; mudou && pino < GPIO_PIN_COUNT; pino++ )
+		if( mudou & ( 1ULL << pino ) )
+			atualiza( pino );
+}
+
+void sim_reg_escrever( uint32_t endereco, uint32_t valor )
+{
+	portENTER_CRITICAL( &s_trava );
+	switch( endereco )
+	{
+		case GPIO_OUT_REG:			escreve_saida( ( s_saida & ~0xffffffffULL ) | valor ); break;
+		case GPIO_OUT_W1TS_REG:		escreve_saida( s_saida | valor ); break;
+		case GPIO_OUT_W1TC_REG:		escreve_saida( s_saida & ~(uint64_t) valor ); break;
+		case GPIO_OUT1_REG:			escreve_saida( ( s_saida & 0xffffffffULL ) | ( (uint64_t) valor << 32 ) ); break;
+		case GPIO_OUT1_W1TS_REG:	escreve_saida( s_saida | ( (uint64_t) valor << 32 ) ); break;
+		case GPIO_OUT1_W1TC_REG:	escreve_saida( s_saida & ~( (uint64_t) valor << 32 ) ); break;
+		default:
+			break;
+	}
+	portEXIT_CRITICAL( &s_trava );
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Simulação                                                                                      */
+/* ---------------------------------------------------------------------------------------------- */
+
+void sim_gpio_periferico( int pino, uint32_t sinal, int nivel )
+{
+	(void) pino;
+	if( sinal >= NUM_SINAIS )
+		return;
+	portENTER_CRITICAL( &s_trava );
+	if( s_sinais[sinal] != nivel )
+	{
+		s_sinais[sinal] = nivel;
+		for( int p = 0; p < GPIO_PIN_COUNT; p++ )
+			if( s_pinos[p].sinal == sinal )
+				atualiza( p );
+	}
+	portEXIT_CRITICAL( &s_trava );
+}
+
+uint32_t sim_gpio_sinal( int pino )
+{
+	return valido( pino ) ? s_pinos[pino].sinal : SIG_GPIO_OUT_IDX;
+}
+
+bool sim_gpio_entrada_habilitada( int pino )
+{
+	return valido( pino ) && ( s_pinos[pino].modo & GPIO_MODE_DEF_INPUT );
+}
+
+void sim_gpio_externo( int pino, int nivel )
+{
+	if( !valido( pino ) )
+		return;
+	portENTER_CRITICAL( &s_trava );
+	s_pinos[pino].externo = nivel < 0 ? -1 : !!nivel;
+	atualiza( pino );
+	portEXIT_CRITICAL( &s_trava );
+}
+
+int sim_gpio_nivel( int pino )
+{
+	if( !valido( pino ) )
+		return 0;
+	portENTER_CRITICAL( &s_trava );
+	int nivel = s_pinos[pino].nivel;
+	portEXIT_CRITICAL( &s_trava );
+	return nivel;
+}
+
+void sim_gpio_iniciar( void )
+{
+	for( int pino = 0; pino < GPIO_PIN_COUNT; pino++ )
+	{
+		s_pinos[pino].externo = -1;
+		s_pinos[pino].sinal = SIG_GPIO_OUT_IDX;
+	}
+	memset( (void*) &GPIO, 0, sizeof( GPIO ) );
+}
@@ -0,0 +1,362 @@
+/*
+	Objetivo: LEDC do ESP32 no build para Linux - duty e fades calculados pelo tempo, linha do tempo
+			  do duty para os testes e a onda quadrada gerada no pino quando ele também é entrada
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "driver/ledc.h"
+#include "soc/gpio_sig_map.h"
+#include "esp_log.h"
+#include "sim_interno.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define CLOCK_APB_HZ		80000000
+#define MAX_PONTOS			4096	//Pontos da linha do tempo de cada canal.
+
+typedef struct {
+	uint32_t freq_hz;
+	ledc_timer_bit_t bits;
+	bool configurado;
+} timer_ledc_t;
+
+typedef struct {
+	bool configurado;
+	bool parado;				//ledc_stop: saída no nível ocioso até o próximo update.
+	uint8_t nivel_ocioso;
+	int pino;
+	ledc_timer_t timer;
+	uint32_t duty_pendente;		//ledc_set_duty, vale no ledc_update_duty.
+	uint32_t duty_inicio;
+	uint32_t duty_fim;
+	int64_t inicio_us;
+	int64_t duracao_us;			//0: sem fade.
+	uint32_t fade_alvo;			//ledc_set_fade_with_time.
+	uint32_t fade_ms;
+	bool fade_pronto;
+	sim_ledc_ponto_t pontos[MAX_PONTOS];
+	size_t n_pontos;
+	bool gerador;				//Thread da onda quadrada criada.
+} canal_t;
+
+/* Variáveis Globais */
+static const char * TAG = "ledc";
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_fim_fade;
+static bool s_cond_iniciada;
+static timer_ledc_t s_timers[LEDC_SPEED_MODE_MAX][LEDC_TIMER_MAX];
+static canal_t s_canais[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+static bool s_fade_instalado;
+
+static uint32_t sinal_do_canal( ledc_mode_t modo, ledc_channel_t canal )
+{
+	return ( modo == LEDC_HIGH_SPEED_MODE ? LEDC_HS_SIG_OUT0_IDX : LEDC_LS_SIG_OUT0_IDX ) + canal;
+}
+
+/* Duty efetivo no instante (fade linear; o hardware faz passos de 1 unidade). Com s_trava. */
+static uint32_t duty_em( const canal_t *c, int64_t instante )
+{
+	if( c->duracao_us == 0 || instante >= c->inicio_us + c->duracao_us )
+		return c->duty_fim;
+	if( instante <= c->inicio_us )
+		return c->duty_inicio;
+	int64_t delta = (int64_t) c->duty_fim - c->duty_inicio;
+	return (uint32_t)( c->duty_inicio + delta * ( instante - c->inicio_us ) / c->duracao_us );
+}
+
+static void registra( canal_t *c )
+{
+	if( c->n_pontos < MAX_PONTOS )
+		c->pontos[c->n_pontos] = (sim_ledc_ponto_t) {
+			.instante_us = c->inicio_us,
+			.duty = c->duty_inicio,
+			.duty_final = c->duty_fim,
+			.duracao_ms = (uint32_t)( c->duracao_us / 1000 ),
+		};
+	c->n_pontos++;
+}
+
+static bool canal_valido( ledc_mode_t modo, ledc_channel_t canal )
+{
+	return modo < LEDC_SPEED_MODE_MAX && canal < LEDC_CHANNEL_MAX && s_canais[modo][canal].configurado;
+}
+
+typedef struct {
+	ledc_mode_t modo;
+	ledc_channel_t canal;
+} id_canal_t;
+
+/*
+	Gera a onda no sinal do canal. Com o pino somente de saída (LEDs), o nível é 1 enquanto o duty for
+	diferente de zero; com o pino também de entrada (loopback dos benchmarks), a forma de onda completa
+	é gerada com espera ocupada.
+*/
+static void *gerador( void *arg )
+{
+	id_canal_t id = *(id_canal_t*) arg;
+	canal_t *c = &s_canais[id.modo][id.canal];
+	uint32_t sinal = sinal_do_canal( id.modo, id.canal );
+	int64_t t = sim_agora_ns();
+	while( 1 )
+	{
+		pthread_mutex_lock( &s_trava );
+		int pino = c->pino;
+		timer_ledc_t tm = s_timers[id.modo][c->timer];
+		uint32_t duty = duty_em( c, sim_agora_us() );
+		bool parado = c->parado;
+		int ocioso = c->nivel_ocioso;
+		pthread_mutex_unlock( &s_trava );
+
+		uint32_t maximo = 1UL << tm.bits;
+		bool onda = !parado && tm.freq_hz && duty > 0 && duty < maximo
+			&& sim_gpio_sinal( pino ) == sinal && sim_gpio_entrada_habilitada( pino );
+		if( !onda )
+		{
+			sim_gpio_periferico( pino, sinal, parado ? ocioso : duty > 0 );
+			struct timespec pausa = { 0, 1000000 };
+			nanosleep( &pausa, NULL );
+			t = sim_agora_ns();
+			continue;
+		}
+		//Um período por vez: as mudanças de duty e de frequência valem no período seguinte.
+		int64_t periodo = 1000000000LL / tm.freq_hz;
+		int64_t alto = periodo * duty / maximo;
+		if( sim_agora_ns() - t > 100 * periodo )
+			t = sim_agora_ns();
+		sim_gpio_periferico( pino, sinal, 1 );
+		sim_espera_ate_ns( t + alto );
+		sim_gpio_periferico( pino, sinal, 0 );
+		t += periodo;
+		sim_espera_ate_ns( t );
+	}
+	return NULL;
+}
+
+esp_err_t ledc_timer_config( const ledc_timer_config_t *config )
+{
+	if( config == NULL || config->speed_mode >= LEDC_SPEED_MODE_MAX || config->timer_num >= LEDC_TIMER_MAX
+		|| config->duty_resolution == 0 || config->duty_resolution >= LEDC_TIMER_BIT_MAX || config->freq_hz == 0 )
+		return ESP_ERR_INVALID_ARG;
+	if( (uint64_t) config->freq_hz << config->duty_resolution > CLOCK_APB_HZ )
+	{
+		ESP_LOGE( TAG, "requested frequency and duty resolution can not be achieved, try reducing freq_hz or duty_resolution. div_param=%u",
+				  (uint32_t)( ( (uint64_t) CLOCK_APB_HZ << 8 ) / config->freq_hz >> config->duty_resolution ) );
+		return ESP_FAIL;
+	}
+	pthread_mutex_lock( &s_trava );
+	s_timers[config->speed_mode][config->timer_num] = (timer_ledc_t) {
+		.freq_hz = config->freq_hz,
+		.bits = config->duty_resolution,
+		.configurado = true,
+	};
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t ledc_channel_config( const ledc_channel_config_t *config )
+{
+	if( config == NULL || config->speed_mode >= LEDC_SPEED_MODE_MAX || config->channel >= LEDC_CHANNEL_MAX
+		|| config->timer_sel >= LEDC_TIMER_MAX || !GPIO_IS_VALID_OUTPUT_GPIO( config->gpio_num ) )
+		return ESP_ERR_INVALID_ARG;
+
+	pthread_mutex_lock( &s_trava );
+	if( !s_cond_iniciada )
+	{
+		sim_cond_init( &s_fim_fade );
+		s_cond_iniciada = true;
+	}
+	canal_t *c = &s_canais[config->speed_mode][config->channel];
+	c->configurado = true;
+	c->parado = false;
+	c->pino = config->gpio_num;
+	c->timer = config->timer_sel;
+	c->duty_pendente = config->duty;
+	c->duty_inicio = c->duty_fim = config->duty;
+	c->inicio_us = sim_agora_us();
+	c->duracao_us = 0;
+	registra( c );
+	bool cria = !c->gerador;
+	c->gerador = true;
+	pthread_mutex_unlock( &s_trava );
+
+	//Como no ESP-IDF: o pino vira saída roteada para o sinal do canal.
+	gpio_set_direction( config->gpio_num, GPIO_MODE_OUTPUT );
+	gpio_matrix_out( config->gpio_num, sinal_do_canal( config->speed_mode, config->channel ), false, false );
+	if( cria )
+	{
+		static id_canal_t ids[LEDC_SPEED_MODE_MAX][LEDC_CHANNEL_MAX];
+		ids[config->speed_mode][config->channel] = (id_canal_t) { config->speed_mode, config->channel };
+		sim_thread( gerador, &ids[config->speed_mode][config->channel] );
+	}
+	return ESP_OK;
+}
+
+esp_err_t ledc_set_duty( ledc_mode_t modo, ledc_channel_t canal, uint32_t duty )
+{
+	if( !canal_valido( modo, canal ) )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	s_canais[modo][canal].duty_pendente = duty;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t ledc_update_duty( ledc_mode_t modo, ledc_channel_t canal )
+{
+	if( !canal_valido( modo, canal ) )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[modo][canal];
+	c->duty_inicio = c->duty_fim = c->duty_pendente;
+	c->inicio_us = sim_agora_us();
+	c->duracao_us = 0;
+	c->parado = false;
+	registra( c );
+	pthread_cond_broadcast( &s_fim_fade );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+uint32_t ledc_get_duty( ledc_mode_t modo, ledc_channel_t canal )
+{
+	if( !canal_valido( modo, canal ) )
+		return 0;
+	pthread_mutex_lock( &s_trava );
+	uint32_t duty = duty_em( &s_canais[modo][canal], sim_agora_us() );
+	pthread_mutex_unlock( &s_trava );
+	return duty;
+}
+
+esp_err_t ledc_set_freq( ledc_mode_t modo, ledc_timer_t timer, uint32_t freq_hz )
+{
+	if( modo >= LEDC_SPEED_MODE_MAX || timer >= LEDC_TIMER_MAX || freq_hz == 0 )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	s_timers[modo][timer].freq_hz = freq_hz;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+uint32_t ledc_get_freq( ledc_mode_t modo, ledc_timer_t timer )
+{
+	if( modo >= LEDC_SPEED_MODE_MAX || timer >= LEDC_TIMER_MAX )
+		return 0;
+	return s_timers[modo][timer].freq_hz;
+}
+
+esp_err_t ledc_stop( ledc_mode_t modo, ledc_channel_t canal, uint32_t nivel_ocioso )
+{
+	if( !canal_valido( modo, canal ) )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[modo][canal];
+	c->parado = true;
+	c->nivel_ocioso = !!nivel_ocioso;
+	int pino = c->pino;
+	pthread_mutex_unlock( &s_trava );
+	sim_gpio_periferico( pino, sinal_do_canal( modo, canal ), !!nivel_ocioso );
+	return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install( int flags )
+{
+	(void) flags;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_fade_instalado ? ESP_ERR_INVALID_STATE : ESP_OK;
+	s_fade_instalado = true;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+void ledc_fade_func_uninstall( void )
+{
+	s_fade_instalado = false;
+}
+
+esp_err_t ledc_set_fade_with_time( ledc_mode_t modo, ledc_channel_t canal, uint32_t duty, int tempo_ms )
+{
+	if( !canal_valido( modo, canal ) || tempo_ms < 0 )
+		return ESP_ERR_INVALID_ARG;
+	if( !s_fade_instalado )
+		return ESP_FAIL;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[modo][canal];
+	c->fade_alvo = duty;
+	c->fade_ms = tempo_ms;
+	c->fade_pronto = true;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t ledc_fade_start( ledc_mode_t modo, ledc_channel_t canal, ledc_fade_mode_t espera )
+{
+	if( !canal_valido( modo, canal ) || espera >= LEDC_FADE_MAX )
+		return ESP_ERR_INVALID_ARG;
+	if( !s_fade_instalado )
+		return ESP_FAIL;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[modo][canal];
+	if( !c->fade_pronto )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ESP_ERR_INVALID_STATE;
+	}
+	int64_t agora = sim_agora_us();
+	c->duty_inicio = duty_em( c, agora );
+	c->duty_fim = c->fade_alvo;
+	c->duty_pendente = c->fade_alvo;
+	c->inicio_us = agora;
+	c->duracao_us = (int64_t) c->fade_ms * 1000;
+	c->parado = false;
+	c->fade_pronto = false;
+	registra( c );
+	if( espera == LEDC_FADE_WAIT_DONE )
+	{
+		//Termina no fim do fade ou quando outro fade/update do canal o substitui.
+		int64_t inicio = c->inicio_us;
+		struct timespec prazo = sim_instante( ( c->inicio_us + c->duracao_us ) * 1000 );
+		while( c->inicio_us == inicio && sim_espera( &s_fim_fade, &s_trava, &prazo ) )
+			;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+size_t sim_ledc_linha( int modo, int canal, sim_ledc_ponto_t *pontos, size_t max )
+{
+	if( modo < 0 || modo >= LEDC_SPEED_MODE_MAX || canal < 0 || canal >= LEDC_CHANNEL_MAX )
+		return 0;
+	pthread_mutex_lock( &s_trava );
+	const canal_t *c = &s_canais[modo][canal];
+	size_t n = c->n_pontos < MAX_PONTOS ? c->n_pontos : MAX_PONTOS;
+	if( pontos )
+		memcpy( pontos, c->pontos, ( n < max ? n : max ) * sizeof( *pontos ) );
+	size_t total = c->n_pontos;
+	pthread_mutex_unlock( &s_trava );
+	return total;
+}
+
+uint32_t sim_ledc_duty_em( int modo, int canal, int64_t instante_us )
+{
+	if( modo < 0 || modo >= LEDC_SPEED_MODE_MAX || canal < 0 || canal >= LEDC_CHANNEL_MAX )
+		return 0;
+	pthread_mutex_lock( &s_trava );
+	//Procura o último ponto até o instante e interpola o fade dele.
+	const canal_t *c = &s_canais[modo][canal];
+	size_t n = c->n_pontos < MAX_PONTOS ? c->n_pontos : MAX_PONTOS;
+	uint32_t duty = 0;
+	for( size_t i = 0; i < n && c->pontos[i].instante_us <= instante_us; i++ )
+	{
+		const sim_ledc_ponto_t *p = &c->pontos[i];
+		int64_t duracao = (int64_t) p->duracao_ms * 1000;
+		if( duracao == 0 || instante_us >= p->instante_us + duracao )
+			duty = p->duty_final;
+		else
+			duty = (uint32_t)( p->duty + ( (int64_t) p->duty_final - p->duty ) * ( instante_us - p->instante_us ) / duracao );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return duty;
+}
@@ -0,0 +1,60 @@
+/*
+	Objetivo: Ponto de entrada do build para Linux - inicia o hardware simulado, cria a task "main" que
+			  chama o app_main do exemplo (ou do teste) e encerra após a duração pedida
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "simulacao.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define PILHA_MAIN			3584	//CONFIG_MAIN_TASK_STACK_SIZE
+#define PRIORIDADE_MAIN		1		//ESP_TASK_MAIN_PRIO
+#define DURACAO_PADRAO_MS	5000
+
+void app_main( void );
+
+/* Como no ESP-IDF: a task "main" se apaga quando o app_main retorna. */
+static void task_main( void *arg )
+{
+	app_main();
+	vTaskDelete( NULL );
+}
+
+/*
+	Uso: <exemplo> [duração em ms]. Sem argumento vale a variável SIM_DURACAO_MS; 0 roda até o
+	processo ser encerrado (ou até um teste chamar sim_encerrar).
+*/
+int main( int argc, char **argv )
+{
+	const char *texto = argc > 1 ? argv[1] : getenv( "SIM_DURACAO_MS" );
+	long duracao_ms = texto ? strtol( texto, NULL, 10 ) : DURACAO_PADRAO_MS;
+
+	setvbuf( stdout, NULL, _IOLBF, 0 );
+	signal( SIGPIPE, SIG_IGN );		//Conexões fechadas pelo cliente são tratadas pelo send().
+	sim_freertos_iniciar();
+	sim_gpio_iniciar();
+	sim_esp_timer_iniciar();
+	sim_nvs_iniciar();
+
+	if( xTaskCreatePinnedToCore( task_main, "main", PILHA_MAIN, NULL, PRIORIDADE_MAIN, NULL, 0 ) != pdPASS )
+	{
+		fprintf( stderr, "simulacao: falha ao criar a task main\n" );
+		return 1;
+	}
+	while( duracao_ms <= 0 )
+		pause();
+	struct timespec espera = { duracao_ms / 1000, ( duracao_ms % 1000 ) * 1000000 };
+	while( nanosleep( &espera, &espera ) != 0 )
+		;
+	sim_encerrar( 0 );
+}
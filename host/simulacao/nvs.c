@@ -0,0 +1,465 @@
+/*
+	Objetivo: NVS do ESP-IDF no build para Linux - emula a partição padrão (6 páginas de 126 entradas
+			  de 32 bytes, uma reservada para a coleta de lixo) com o mesmo consumo de entradas e a
+			  mesma regra de não regravar um valor igual; SIM_NVS_ARQUIVO persiste a partição entre execuções
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "simulacao.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define PAGINAS					6
+#define ENTRADAS_POR_PAGINA		126
+#define BYTES_ENTRADA			32
+#define ENTRADAS_TOTAIS			( PAGINAS * ENTRADAS_POR_PAGINA )
+#define ENTRADAS_UTEIS			( ( PAGINAS - 1 ) * ENTRADAS_POR_PAGINA )
+#define MAX_NAMESPACES			32
+#define MAX_HANDLES				32
+#define TEXTO_MAX				4000	//Como o ESP-IDF: uma string cabe em uma página.
+#define BLOB_MAX				( ( ENTRADAS_POR_PAGINA - 2 ) * BYTES_ENTRADA )
+
+typedef enum {
+	TIPO_U8,
+	TIPO_U16,
+	TIPO_U32,
+	TIPO_I32,
+	TIPO_STR,
+	TIPO_BLOB,
+} tipo_t;
+
+typedef struct {
+	bool usada;
+	uint8_t ns;
+	char chave[NVS_KEY_NAME_MAX_SIZE];
+	uint8_t tipo;
+	uint32_t tamanho;
+	uint8_t *dados;			//Memória da "flash": não é contada no heap simulado.
+} entrada_t;
+
+typedef struct {
+	bool aberto;
+	uint8_t ns;
+	bool somente_leitura;
+} handle_t;
+
+/* Variáveis Globais */
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static bool s_iniciada;
+static char s_namespaces[MAX_NAMESPACES][NVS_KEY_NAME_MAX_SIZE];
+static size_t s_n_namespaces;
+static entrada_t s_entradas[ENTRADAS_TOTAIS];
+static handle_t s_handles[MAX_HANDLES];
+static sim_nvs_stats_t s_stats;
+
+void *__real_malloc( size_t bytes );
+void __real_free( void *ptr );
+
+/* Entradas de 32 bytes ocupadas por um item (cabeçalho + dados). */
+static size_t custo( uint8_t tipo, size_t tamanho )
+{
+	if( tipo == TIPO_STR )
+		return 1 + ( tamanho + BYTES_ENTRADA - 1 ) / BYTES_ENTRADA;
+	if( tipo == TIPO_BLOB )
+		return 2 + ( tamanho + BYTES_ENTRADA - 1 ) / BYTES_ENTRADA;	//Dados + índice do blob.
+	return 1;
+}
+
+static size_t entradas_usadas( void )
+{
+	size_t usadas = s_n_namespaces;
+	for( size_t i = 0; i < ENTRADAS_TOTAIS; i++ )
+		if( s_entradas[i].usada )
+			usadas += custo( s_entradas[i].tipo, s_entradas[i].tamanho );
+	return usadas;
+}
+
+static entrada_t *procura( uint8_t ns, const char *chave )
+{
+	for( size_t i = 0; i < ENTRADAS_TOTAIS; i++ )
+		if( s_entradas[i].usada && s_entradas[i].ns == ns && strcmp( s_entradas[i].chave, chave ) == 0 )
+			return &s_entradas[i];
+	return NULL;
+}
+
+static void apaga( entrada_t *e )
+{
+	__real_free( e->dados );
+	memset( e, 0, sizeof( *e ) );
+}
+
+/* Formato: namespaces e entradas em sequência, sem compatibilidade entre versões da simulação. */
+static void salva( void )
+{
+	const char *arquivo = getenv( "SIM_NVS_ARQUIVO" );
+	if( arquivo == NULL )
+		return;
+	FILE *f = fopen( arquivo, "wb" );
+	if( f == NULL )
+		return;
+	fwrite( &s_n_namespaces, sizeof( s_n_namespaces ), 1, f );
+	fwrite( s_namespaces, sizeof( s_namespaces[0] ), s_n_namespaces, f );
+	for( size_t i = 0; i < ENTRADAS_TOTAIS; i++ )
+	{
+		const entrada_t *e = &s_entradas[i];
+		if( !e->usada )
+			continue;
+		fwrite( e, sizeof( *e ), 1, f );
+		fwrite( e->dados, 1, e->tamanho, f );
+	}
+	fclose( f );
+}
+
+static void carrega( void )
+{
+	const char *arquivo = getenv( "SIM_NVS_ARQUIVO" );
+	FILE *f = arquivo ? fopen( arquivo, "rb" ) : NULL;
+	if( f == NULL )
+		return;
+	if( fread( &s_n_namespaces, sizeof( s_n_namespaces ), 1, f ) != 1 || s_n_namespaces > MAX_NAMESPACES
+		|| fread( s_namespaces, sizeof( s_namespaces[0] ), s_n_namespaces, f ) != s_n_namespaces )
+		s_n_namespaces = 0;
+	for( size_t i = 0; i < ENTRADAS_TOTAIS && s_n_namespaces; i++ )
+	{
+		entrada_t *e = &s_entradas[i];
+		if( fread( e, sizeof( *e ), 1, f ) != 1 )
+		{
+			memset( e, 0, sizeof( *e ) );
+			break;
+		}
+		e->dados = __real_malloc( e->tamanho ? e->tamanho : 1 );
+		if( e->dados == NULL || fread( e->dados, 1, e->tamanho, f ) != e->tamanho )
+		{
+			__real_free( e->dados );
+			memset( e, 0, sizeof( *e ) );
+			break;
+		}
+	}
+	fclose( f );
+}
+
+void sim_nvs_iniciar( void )
+{
+	carrega();
+}
+
+esp_err_t nvs_flash_init( void )
+{
+	pthread_mutex_lock( &s_trava );
+	s_iniciada = true;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t nvs_flash_deinit( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_iniciada ? ESP_OK : ESP_ERR_NVS_NOT_INITIALIZED;
+	s_iniciada = false;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t nvs_flash_erase( void )
+{
+	pthread_mutex_lock( &s_trava );
+	for( size_t i = 0; i < ENTRADAS_TOTAIS; i++ )
+		if( s_entradas[i].usada )
+			apaga( &s_entradas[i] );
+	s_n_namespaces = 0;
+	s_stats.apagamentos++;
+	salva();
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t nvs_open( const char *nome, nvs_open_mode_t modo, nvs_handle_t *handle )
+{
+	if( nome == NULL || handle == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( strlen( nome ) >= NVS_KEY_NAME_MAX_SIZE )
+		return ESP_ERR_NVS_KEY_TOO_LONG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = ESP_OK;
+	size_t ns = 0;
+	size_t h = 0;
+	if( !s_iniciada )
+		ret = ESP_ERR_NVS_NOT_INITIALIZED;
+	while( ret == ESP_OK && ns < s_n_namespaces && strcmp( s_namespaces[ns], nome ) != 0 )
+		ns++;
+	if( ret == ESP_OK && ns == s_n_namespaces )
+	{
+		//Namespace novo: só é criado em modo de escrita e ocupa uma entrada.
+		if( modo == NVS_READONLY )
+			ret = ESP_ERR_NVS_NOT_FOUND;
+		else if( s_n_namespaces == MAX_NAMESPACES || entradas_usadas() + 1 > ENTRADAS_UTEIS )
+			ret = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+		else
+		{
+			strcpy( s_namespaces[s_n_namespaces++], nome );
+			s_stats.entradas_escritas++;
+		}
+	}
+	while( ret == ESP_OK && h < MAX_HANDLES && s_handles[h].aberto )
+		h++;
+	if( ret == ESP_OK && h == MAX_HANDLES )
+		ret = ESP_ERR_NO_MEM;
+	if( ret == ESP_OK )
+	{
+		s_handles[h] = (handle_t) { true, (uint8_t) ns, modo == NVS_READONLY };
+		*handle = (nvs_handle_t)( h + 1 );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+void nvs_close( nvs_handle_t handle )
+{
+	pthread_mutex_lock( &s_trava );
+	if( handle >= 1 && handle <= MAX_HANDLES )
+		s_handles[handle - 1].aberto = false;
+	pthread_mutex_unlock( &s_trava );
+}
+
+/* Handle aberto (com s_trava). */
+static handle_t *handle_valido( nvs_handle_t handle )
+{
+	if( handle < 1 || handle > MAX_HANDLES || !s_handles[handle - 1].aberto )
+		return NULL;
+	return &s_handles[handle - 1];
+}
+
+esp_err_t nvs_commit( nvs_handle_t handle )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = handle_valido( handle ) ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+	if( ret == ESP_OK )
+	{
+		s_stats.commits++;
+		salva();
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+static esp_err_t escreve( nvs_handle_t handle, const char *chave, uint8_t tipo, const void *dados, size_t tamanho )
+{
+	if( chave == NULL || dados == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( strlen( chave ) >= NVS_KEY_NAME_MAX_SIZE )
+		return ESP_ERR_NVS_KEY_TOO_LONG;
+	if( ( tipo == TIPO_STR && tamanho > TEXTO_MAX ) || ( tipo == TIPO_BLOB && tamanho > BLOB_MAX ) )
+		return ESP_ERR_NVS_VALUE_TOO_LONG;
+	pthread_mutex_lock( &s_trava );
+	handle_t *h = handle_valido( handle );
+	esp_err_t ret = ESP_OK;
+	if( h == NULL )
+		ret = ESP_ERR_NVS_INVALID_HANDLE;
+	else if( h->somente_leitura )
+		ret = ESP_ERR_NVS_READ_ONLY;
+	entrada_t *e = ret == ESP_OK ? procura( h->ns, chave ) : NULL;
+	if( e && e->tipo == tipo && e->tamanho == tamanho && memcmp( e->dados, dados, tamanho ) == 0 )
+	{
+		//Como o ESP-IDF: o valor igual ao gravado não é escrito de novo.
+		s_stats.escritas_iguais++;
+		pthread_mutex_unlock( &s_trava );
+		return ESP_OK;
+	}
+	size_t usadas = ret == ESP_OK ? entradas_usadas() - ( e ? custo( e->tipo, e->tamanho ) : 0 ) : 0;
+	if( ret == ESP_OK && usadas + custo( tipo, tamanho ) > ENTRADAS_UTEIS )
+		ret = ESP_ERR_NVS_NOT_ENOUGH_SPACE;
+	uint8_t *copia = NULL;
+	if( ret == ESP_OK && ( copia = __real_malloc( tamanho ? tamanho : 1 ) ) == NULL )
+		ret = ESP_ERR_NO_MEM;
+	if( ret == ESP_OK && e == NULL )
+	{
+		for( size_t i = 0; i < ENTRADAS_TOTAIS && e == NULL; i++ )
+			if( !s_entradas[i].usada )
+				e = &s_entradas[i];
+	}
+	if( ret == ESP_OK )
+	{
+		__real_free( e->dados );
+		memcpy( copia, dados, tamanho );
+		*e = (entrada_t) { .usada = true, .ns = h->ns, .tipo = tipo, .tamanho = (uint32_t) tamanho, .dados = copia };
+		strcpy( e->chave, chave );
+		s_stats.escritas++;
+		s_stats.entradas_escritas += custo( tipo, tamanho );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+/* Lê o item: "tamanho" entra com o espaço de "dados" (NULL: só informa o tamanho). */
+static esp_err_t le( nvs_handle_t handle, const char *chave, uint8_t tipo, void *dados, size_t *tamanho )
+{
+	if( chave == NULL || tamanho == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	handle_t *h = handle_valido( handle );
+	esp_err_t ret = h ? ESP_OK : ESP_ERR_NVS_INVALID_HANDLE;
+	entrada_t *e = ret == ESP_OK ? procura( h->ns, chave ) : NULL;
+	if( ret == ESP_OK && ( e == NULL || e->tipo != tipo ) )
+		ret = ESP_ERR_NVS_NOT_FOUND;
+	if( ret == ESP_OK )
+	{
+		s_stats.leituras++;
+		if( dados == NULL )
+			*tamanho = e->tamanho;
+		else if( *tamanho < e->tamanho )
+			ret = ESP_ERR_NVS_INVALID_LENGTH;
+		else
+		{
+			memcpy( dados, e->dados, e->tamanho );
+			*tamanho = e->tamanho;
+		}
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t nvs_erase_key( nvs_handle_t handle, const char *chave )
+{
+	if( chave == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	handle_t *h = handle_valido( handle );
+	esp_err_t ret = ESP_OK;
+	if( h == NULL )
+		ret = ESP_ERR_NVS_INVALID_HANDLE;
+	else if( h->somente_leitura )
+		ret = ESP_ERR_NVS_READ_ONLY;
+	entrada_t *e = ret == ESP_OK ? procura( h->ns, chave ) : NULL;
+	if( ret == ESP_OK && e == NULL )
+		ret = ESP_ERR_NVS_NOT_FOUND;
+	if( ret == ESP_OK )
+	{
+		apaga( e );
+		s_stats.apagamentos++;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t nvs_erase_all( nvs_handle_t handle )
+{
+	pthread_mutex_lock( &s_trava );
+	handle_t *h = handle_valido( handle );
+	esp_err_t ret = ESP_OK;
+	if( h == NULL )
+		ret = ESP_ERR_NVS_INVALID_HANDLE;
+	else if( h->somente_leitura )
+		ret = ESP_ERR_NVS_READ_ONLY;
+	for( size_t i = 0; i < ENTRADAS_TOTAIS && ret == ESP_OK; i++ )
+		if( s_entradas[i].usada && s_entradas[i].ns == h->ns )
+		{
+			apaga( &s_entradas[i] );
+			s_stats.apagamentos++;
+		}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t nvs_set_u8( nvs_handle_t handle, const char *chave, uint8_t valor )
+{
+	return escreve( handle, chave, TIPO_U8, &valor, sizeof( valor ) );
+}
+
+esp_err_t nvs_set_u16( nvs_handle_t handle, const char *chave, uint16_t valor )
+{
+	return escreve( handle, chave, TIPO_U16, &valor, sizeof( valor ) );
+}
+
+esp_err_t nvs_set_u32( nvs_handle_t handle, const char *chave, uint32_t valor )
+{
+	return escreve( handle, chave, TIPO_U32, &valor, sizeof( valor ) );
+}
+
+esp_err_t nvs_set_i32( nvs_handle_t handle, const char *chave, int32_t valor )
+{
+	return escreve( handle, chave, TIPO_I32, &valor, sizeof( valor ) );
+}
+
+esp_err_t nvs_set_str( nvs_handle_t handle, const char *chave, const char *valor )
+{
+	return escreve( handle, chave, TIPO_STR, valor, valor ? strlen( valor ) + 1 : 0 );
+}
+
+esp_err_t nvs_set_blob( nvs_handle_t handle, const char *chave, const void *valor, size_t tamanho )
+{
+	return escreve( handle, chave, TIPO_BLOB, valor, tamanho );
+}
+
+esp_err_t nvs_get_u8( nvs_handle_t handle, const char *chave, uint8_t *valor )
+{
+	size_t tamanho = sizeof( *valor );
+	return valor ? le( handle, chave, TIPO_U8, valor, &tamanho ) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_get_u16( nvs_handle_t handle, const char *chave, uint16_t *valor )
+{
+	size_t tamanho = sizeof( *valor );
+	return valor ? le( handle, chave, TIPO_U16, valor, &tamanho ) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_get_u32( nvs_handle_t handle, const char *chave, uint32_t *valor )
+{
+	size_t tamanho = sizeof( *valor );
+	return valor ? le( handle, chave, TIPO_U32, valor, &tamanho ) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_get_i32( nvs_handle_t handle, const char *chave, int32_t *valor )
+{
+	size_t tamanho = sizeof( *valor );
+	return valor ? le( handle, chave, TIPO_I32, valor, &tamanho ) : ESP_ERR_INVALID_ARG;
+}
+
+esp_err_t nvs_get_str( nvs_handle_t handle, const char *chave, char *valor, size_t *tamanho )
+{
+	return le( handle, chave, TIPO_STR, valor, tamanho );
+}
+
+esp_err_t nvs_get_blob( nvs_handle_t handle, const char *chave, void *valor, size_t *tamanho )
+{
+	return le( handle, chave, TIPO_BLOB, valor, tamanho );
+}
+
+esp_err_t nvs_get_stats( const char *particao, nvs_stats_t *stats )
+{
+	(void) particao;
+	if( stats == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_iniciada ? ESP_OK : ESP_ERR_NVS_NOT_INITIALIZED;
+	if( ret == ESP_OK )
+	{
+		stats->used_entries = entradas_usadas();
+		stats->total_entries = ENTRADAS_TOTAIS;
+		stats->free_entries = ENTRADAS_TOTAIS - stats->used_entries;
+		stats->namespace_count = s_n_namespaces;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+void sim_nvs_estatisticas( sim_nvs_stats_t *stats )
+{
+	pthread_mutex_lock( &s_trava );
+	*stats = s_stats;
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_nvs_zera_estatisticas( void )
+{
+	pthread_mutex_lock( &s_trava );
+	memset( &s_stats, 0, sizeof( s_stats ) );
+	pthread_mutex_unlock( &s_trava );
+}
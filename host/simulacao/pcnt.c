@@ -0,0 +1,286 @@
+/*
+	Objetivo: PCNT do ESP32 no build para Linux - contagem das bordas do pino, filtro de glitch, eventos
+			  de limite e de limiar, registradores de estado e o serviço de ISR compartilhado
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "driver/pcnt.h"
+#include "esp_log.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define NS_POR_CICLO_APB_X2		25	//Um ciclo do APB (80 MHz) = 12,5 ns.
+
+typedef struct {
+	bool configurado;
+	int pino;
+	pcnt_count_mode_t subida;
+	pcnt_count_mode_t descida;
+	int16_t h_lim;
+	int16_t l_lim;
+	int16_t limiar0;
+	int16_t limiar1;
+	uint32_t eventos;			//Bits PCNT_EVT_* habilitados.
+	bool pausado;
+	bool filtro;
+	uint16_t filtro_apb;
+	int64_t ultima_borda_ns;
+	void (*isr)( void *arg );
+	void *arg;
+} unidade_t;
+
+/* Variáveis Globais */
+static const char * TAG = "pcnt";
+pcnt_dev_t PCNT;
+static portMUX_TYPE s_trava = portMUX_INITIALIZER_UNLOCKED;
+static unidade_t s_unidades[PCNT_UNIT_MAX];
+static bool s_servico;
+static int s_nucleo_servico;
+
+static inline void escreve( volatile uint32_t *reg, uint32_t valor )
+{
+	__atomic_store_n( reg, valor, __ATOMIC_SEQ_CST );
+}
+
+/* Interrupção compartilhada das unidades, como o pcnt_isr_service do ESP-IDF. */
+static void servico_isr( void *arg )
+{
+	(void) arg;
+	uint32_t status = PCNT.int_st.val;
+	for( int u = 0; u < PCNT_UNIT_MAX; u++ )
+	{
+		if( !( status & BIT( u ) ) )
+			continue;
+		if( s_unidades[u].isr )
+			s_unidades[u].isr( s_unidades[u].arg );
+		PCNT.int_clr.val = BIT( u );
+	}
+}
+
+/* Evento na unidade: status (último evento), interrupção bruta e, se habilitada, a ISR. Com s_trava. */
+static void evento( int u, uint32_t status )
+{
+	escreve( &PCNT.status_unit[u].val, status );
+	escreve( &PCNT.int_raw.val, PCNT.int_raw.val | BIT( u ) );
+	escreve( &PCNT.int_st.val, PCNT.int_raw.val & PCNT.int_ena.val );
+	if( s_servico && ( PCNT.int_st.val & BIT( u ) ) )
+		sim_isr_disparar( servico_isr, NULL, s_nucleo_servico );
+}
+
+void sim_pcnt_borda( int pino, int nivel, int64_t instante_ns )
+{
+	for( int u = 0; u < PCNT_UNIT_MAX; u++ )
+	{
+		unidade_t *un = &s_unidades[u];
+		if( !un->configurado || un->pino != pino )
+			continue;
+
+		portENTER_CRITICAL( &s_trava );
+		//Filtro aproximado: descarta a borda que chega antes de o nível anterior ficar estável.
+		int64_t intervalo = instante_ns - un->ultima_borda_ns;
+		un->ultima_borda_ns = instante_ns;
+		bool filtrada = un->filtro && intervalo * 2 < (int64_t) un->filtro_apb * NS_POR_CICLO_APB_X2;
+		pcnt_count_mode_t modo = nivel ? un->subida : un->descida;
+		if( !un->pausado && !filtrada && modo != PCNT_COUNT_DIS )
+		{
+			int16_t valor = (int16_t) PCNT.cnt_unit[u].cnt_val + ( modo == PCNT_COUNT_INC ? 1 : -1 );
+			if( un->h_lim && valor >= un->h_lim )
+			{
+				//Estado e interrupção antes de zerar o contador: quem lê vê o estouro pendente junto com o zero.
+				if( un->eventos & PCNT_EVT_H_LIM )
+					evento( u, PCNT_STATUS_H_LIM_M );
+				valor = 0;
+			}
+			else if( un->l_lim && valor <= un->l_lim )
+			{
+				if( un->eventos & PCNT_EVT_L_LIM )
+					evento( u, PCNT_STATUS_L_LIM_M );
+				valor = 0;
+			}
+			else if( ( un->eventos & PCNT_EVT_THRES_0 ) && valor == un->limiar0 )
+				evento( u, PCNT_STATUS_THRES0_M );
+			else if( ( un->eventos & PCNT_EVT_THRES_1 ) && valor == un->limiar1 )
+				evento( u, PCNT_STATUS_THRES1_M );
+			escreve( &PCNT.cnt_unit[u].val, (uint16_t) valor );
+		}
+		portEXIT_CRITICAL( &s_trava );
+	}
+}
+
+/* Escrita em PCNT.int_clr: limpa as interrupções brutas indicadas. */
+void sim_pcnt_registradores( void )
+{
+	if( __atomic_load_n( &PCNT.int_clr.val, __ATOMIC_SEQ_CST ) == 0 )
+		return;
+	portENTER_CRITICAL( &s_trava );
+	uint32_t limpar = __atomic_exchange_n( &PCNT.int_clr.val, 0, __ATOMIC_SEQ_CST );
+	escreve( &PCNT.int_raw.val, PCNT.int_raw.val & ~limpar );
+	escreve( &PCNT.int_st.val, PCNT.int_raw.val & PCNT.int_ena.val );
+	portEXIT_CRITICAL( &s_trava );
+}
+
+static bool valida( pcnt_unit_t unidade )
+{
+	return unidade < PCNT_UNIT_MAX;
+}
+
+esp_err_t pcnt_unit_config( const pcnt_config_t *config )
+{
+	if( config == NULL || !valida( config->unit ) || config->channel >= PCNT_CHANNEL_MAX
+		|| ( config->pulse_gpio_num != PCNT_PIN_NOT_USED && !GPIO_IS_VALID_GPIO( config->pulse_gpio_num ) )
+		|| config->pos_mode >= PCNT_COUNT_MAX || config->neg_mode >= PCNT_COUNT_MAX )
+		return ESP_ERR_INVALID_ARG;
+
+	//Como no ESP-IDF: o pino de pulso vira entrada com pull-up (a saída é desabilitada).
+	if( config->pulse_gpio_num != PCNT_PIN_NOT_USED )
+	{
+		gpio_set_direction( config->pulse_gpio_num, GPIO_MODE_INPUT );
+		gpio_set_pull_mode( config->pulse_gpio_num, GPIO_PULLUP_ONLY );
+	}
+
+	portENTER_CRITICAL( &s_trava );
+	unidade_t *un = &s_unidades[config->unit];
+	un->configurado = config->pulse_gpio_num != PCNT_PIN_NOT_USED;
+	un->pino = config->pulse_gpio_num;
+	un->subida = config->pos_mode;
+	un->descida = config->neg_mode;
+	un->h_lim = config->counter_h_lim;
+	un->l_lim = config->counter_l_lim;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t pcnt_get_counter_value( pcnt_unit_t unidade, int16_t *valor )
+{
+	if( !valida( unidade ) || valor == NULL )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	*valor = (int16_t) PCNT.cnt_unit[unidade].cnt_val;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+static esp_err_t altera( pcnt_unit_t unidade, void (*operacao)( unidade_t *un, int u ) )
+{
+	if( !valida( unidade ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	operacao( &s_unidades[unidade], unidade );
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+static void pausa( unidade_t *un, int u )				{ (void) u; un->pausado = true; }
+static void continua( unidade_t *un, int u )			{ (void) u; un->pausado = false; }
+static void zera( unidade_t *un, int u )				{ (void) un; escreve( &PCNT.cnt_unit[u].val, 0 ); }
+static void habilita_filtro( unidade_t *un, int u )		{ (void) u; un->filtro = true; }
+static void desabilita_filtro( unidade_t *un, int u )	{ (void) u; un->filtro = false; }
+static void habilita_intr( unidade_t *un, int u )		{ (void) un; escreve( &PCNT.int_ena.val, PCNT.int_ena.val | BIT( u ) ); }
+static void desabilita_intr( unidade_t *un, int u )		{ (void) un; escreve( &PCNT.int_ena.val, PCNT.int_ena.val & ~BIT( u ) ); }
+
+esp_err_t pcnt_counter_pause( pcnt_unit_t unidade )		{ return altera( unidade, pausa ); }
+esp_err_t pcnt_counter_resume( pcnt_unit_t unidade )	{ return altera( unidade, continua ); }
+esp_err_t pcnt_counter_clear( pcnt_unit_t unidade )		{ return altera( unidade, zera ); }
+esp_err_t pcnt_filter_enable( pcnt_unit_t unidade )		{ return altera( unidade, habilita_filtro ); }
+esp_err_t pcnt_filter_disable( pcnt_unit_t unidade )	{ return altera( unidade, desabilita_filtro ); }
+esp_err_t pcnt_intr_enable( pcnt_unit_t unidade )		{ return altera( unidade, habilita_intr ); }
+esp_err_t pcnt_intr_disable( pcnt_unit_t unidade )		{ return altera( unidade, desabilita_intr ); }
+
+esp_err_t pcnt_event_enable( pcnt_unit_t unidade, pcnt_evt_type_t evento )
+{
+	if( !valida( unidade ) || evento >= PCNT_EVT_MAX )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	s_unidades[unidade].eventos |= evento;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t pcnt_event_disable( pcnt_unit_t unidade, pcnt_evt_type_t evento )
+{
+	if( !valida( unidade ) || evento >= PCNT_EVT_MAX )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	s_unidades[unidade].eventos &= ~evento;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t pcnt_set_event_value( pcnt_unit_t unidade, pcnt_evt_type_t evento, int16_t valor )
+{
+	if( !valida( unidade ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	esp_err_t ret = ESP_OK;
+	switch( evento )
+	{
+		case PCNT_EVT_THRES_0:	s_unidades[unidade].limiar0 = valor; break;
+		case PCNT_EVT_THRES_1:	s_unidades[unidade].limiar1 = valor; break;
+		case PCNT_EVT_H_LIM:	s_unidades[unidade].h_lim = valor; break;
+		case PCNT_EVT_L_LIM:	s_unidades[unidade].l_lim = valor; break;
+		default:				ret = ESP_ERR_INVALID_ARG; break;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	return ret;
+}
+
+esp_err_t pcnt_set_filter_value( pcnt_unit_t unidade, uint16_t filtro )
+{
+	if( !valida( unidade ) || filtro > 1023 )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	s_unidades[unidade].filtro_apb = filtro;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t pcnt_isr_service_install( int flags )
+{
+	(void) flags;
+	portENTER_CRITICAL( &s_trava );
+	esp_err_t ret = ESP_ERR_INVALID_STATE;
+	if( !s_servico )
+	{
+		s_servico = true;
+		s_nucleo_servico = xPortGetCoreID();
+		ret = ESP_OK;
+	}
+	portEXIT_CRITICAL( &s_trava );
+	if( ret != ESP_OK )
+		ESP_LOGE( TAG, "pcnt isr service already installed" );
+	return ret;
+}
+
+void pcnt_isr_service_uninstall( void )
+{
+	portENTER_CRITICAL( &s_trava );
+	s_servico = false;
+	portEXIT_CRITICAL( &s_trava );
+}
+
+esp_err_t pcnt_isr_handler_add( pcnt_unit_t unidade, void (*isr)( void *arg ), void *arg )
+{
+	if( !valida( unidade ) )
+		return ESP_ERR_INVALID_ARG;
+	if( !s_servico )
+		return ESP_ERR_INVALID_STATE;
+	portENTER_CRITICAL( &s_trava );
+	s_unidades[unidade].isr = isr;
+	s_unidades[unidade].arg = arg;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t pcnt_isr_handler_remove( pcnt_unit_t unidade )
+{
+	if( !valida( unidade ) )
+		return ESP_ERR_INVALID_ARG;
+	portENTER_CRITICAL( &s_trava );
+	s_unidades[unidade].isr = NULL;
+	s_unidades[unidade].arg = NULL;
+	portEXIT_CRITICAL( &s_trava );
+	return ESP_OK;
+}
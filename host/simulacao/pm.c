@@ -0,0 +1,184 @@
+/*
+	Objetivo: Gerenciamento de energia do ESP-IDF no build para Linux - os locks escolhem o modo (CPU_MAX,
+			  APB_MAX ou APB_MIN) e, com o light sleep ligado, a parte ociosa do APB_MIN conta como SLEEP,
+			  estimada pelo tempo de CPU do processo nos dois núcleos
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_pm.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define MAX_LOCKS		16
+#define NUM_NUCLEOS		2
+
+typedef enum {
+	MODO_SLEEP,
+	MODO_APB_MIN,
+	MODO_APB_MAX,
+	MODO_CPU_MAX,
+	NUM_MODOS
+} modo_t;
+
+struct esp_pm_lock {
+	esp_pm_lock_type_t tipo;
+	const char *nome;
+	int contagem;
+	uint32_t aquisicoes;
+};
+
+/* Variáveis Globais */
+static const char * s_nomes[NUM_MODOS] = { "SLEEP", "APB_MIN", "APB_MAX", "CPU_MAX" };
+static const char * s_tipos[] = { "CPU_FREQ_MAX", "APB_FREQ_MAX", "NO_SLEEP" };
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static esp_pm_config_esp32_t s_config = { .max_freq_mhz = 160, .min_freq_mhz = 160 };
+static struct esp_pm_lock s_locks[MAX_LOCKS];
+static size_t s_n_locks;
+static int s_ativos[3];				//Locks adquiridos por tipo.
+static int64_t s_tempo[NUM_MODOS];	//us em cada modo.
+static int64_t s_marca_us;
+static int64_t s_marca_cpu_us;
+
+static int64_t cpu_us( void )
+{
+	struct timespec t;
+	clock_gettime( CLOCK_PROCESS_CPUTIME_ID, &t );
+	return (int64_t) t.tv_sec * 1000000 + t.tv_nsec / 1000;
+}
+
+static modo_t modo_atual( void )
+{
+	if( s_ativos[ESP_PM_CPU_FREQ_MAX] )
+		return MODO_CPU_MAX;
+	if( s_ativos[ESP_PM_APB_FREQ_MAX] )
+		return MODO_APB_MAX;
+	return MODO_APB_MIN;
+}
+
+/* Soma o intervalo desde a marca ao modo vigente. Com s_trava. */
+static void contabiliza( void )
+{
+	int64_t agora = sim_agora_us();
+	int64_t cpu = cpu_us();
+	int64_t decorrido = agora - s_marca_us;
+	modo_t modo = modo_atual();
+	if( modo == MODO_APB_MIN && s_config.light_sleep_enable && s_ativos[ESP_PM_NO_LIGHT_SLEEP] == 0 )
+	{
+		int64_t ocupado = ( cpu - s_marca_cpu_us ) / NUM_NUCLEOS;
+		ocupado = ocupado > decorrido ? decorrido : ocupado;
+		s_tempo[MODO_APB_MIN] += ocupado;
+		s_tempo[MODO_SLEEP] += decorrido - ocupado;
+	}
+	else
+		s_tempo[modo] += decorrido;
+	s_marca_us = agora;
+	s_marca_cpu_us = cpu;
+}
+
+esp_err_t esp_pm_configure( const void *config )
+{
+	const esp_pm_config_esp32_t *pm = config;
+	if( pm == NULL || pm->min_freq_mhz > pm->max_freq_mhz
+		|| ( pm->max_freq_mhz != 80 && pm->max_freq_mhz != 160 && pm->max_freq_mhz != 240 )
+		|| ( pm->min_freq_mhz != 40 && pm->min_freq_mhz != 80 && pm->min_freq_mhz != 160 && pm->min_freq_mhz != 240 ) )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	contabiliza();
+	s_config = *pm;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_create( esp_pm_lock_type_t tipo, int arg, const char *nome, esp_pm_lock_handle_t *lock )
+{
+	(void) arg;
+	if( tipo > ESP_PM_NO_LIGHT_SLEEP || lock == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_n_locks < MAX_LOCKS ? ESP_OK : ESP_ERR_NO_MEM;
+	if( ret == ESP_OK )
+	{
+		*lock = &s_locks[s_n_locks++];
+		**lock = (struct esp_pm_lock) { .tipo = tipo, .nome = nome ? nome : "?" };
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_pm_lock_acquire( esp_pm_lock_handle_t lock )
+{
+	if( lock == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	contabiliza();
+	if( lock->contagem++ == 0 )
+		s_ativos[lock->tipo]++;
+	lock->aquisicoes++;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_pm_lock_release( esp_pm_lock_handle_t lock )
+{
+	if( lock == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = lock->contagem > 0 ? ESP_OK : ESP_ERR_INVALID_STATE;
+	if( ret == ESP_OK )
+	{
+		contabiliza();
+		if( --lock->contagem == 0 )
+			s_ativos[lock->tipo]--;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_pm_lock_delete( esp_pm_lock_handle_t lock )
+{
+	if( lock == NULL )
+		return ESP_ERR_INVALID_ARG;
+	return lock->contagem ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+/* Frequência da CPU no modo, no formato do ESP-IDF ("XTAL" ou os MHz). */
+static void frequencia( modo_t modo, char *texto, size_t tamanho )
+{
+	int mhz = s_config.min_freq_mhz;
+	if( modo == MODO_CPU_MAX )
+		mhz = s_config.max_freq_mhz;
+	else if( modo == MODO_APB_MAX )
+		mhz = s_config.max_freq_mhz < 80 ? s_config.max_freq_mhz : 80;
+	if( modo == MODO_SLEEP || mhz == 40 )
+		strlcpy( texto, "XTAL", tamanho );
+	else
+		snprintf( texto, tamanho, "%d", mhz );
+}
+
+esp_err_t esp_pm_dump_locks( FILE *saida )
+{
+	pthread_mutex_lock( &s_trava );
+	contabiliza();
+	fprintf( saida, "Lock stats:\n" );
+	for( size_t i = 0; i < s_n_locks; i++ )
+		fprintf( saida, "%-15s  %14s  %3d  %10u\n", s_locks[i].nome, s_tipos[s_locks[i].tipo],
+				 s_locks[i].contagem, s_locks[i].aquisicoes );
+	int64_t total = 0;
+	for( int i = 0; i < NUM_MODOS; i++ )
+		total += s_tempo[i];
+	fprintf( saida, "Mode stats:\n" );
+	for( int i = 0; i < NUM_MODOS; i++ )
+	{
+		char freq[8];
+		frequencia( (modo_t) i, freq, sizeof( freq ) );
+		fprintf( saida, "%8s  %6s  %12lld  %2d%%\n", s_nomes[i], freq, (long long) s_tempo[i],
+				 total ? (int)( s_tempo[i] * 100 / total ) : 0 );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
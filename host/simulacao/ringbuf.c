@@ -0,0 +1,189 @@
+/*
+	Objetivo: Ringbuffer do ESP-IDF (RINGBUF_TYPE_NOSPLIT) no build para Linux - itens contíguos em um
+			  buffer alocado na criação, com cabeçalho de 8 bytes e devolução em ordem
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/ringbuf.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define ALINHA( n )			( ( ( n ) + 3 ) & ~(size_t) 3 )
+#define CABECALHO			sizeof( cabecalho_t )
+#define ITEM_VOLTA			( 1 << 0 )	//Fim do buffer: o próximo item começa no início.
+#define ITEM_DEVOLVIDO		( 1 << 1 )
+
+typedef struct {
+	uint32_t tamanho;
+	uint32_t flags;
+} cabecalho_t;
+
+struct ringbuf_sim {
+	uint8_t *buffer;
+	size_t tamanho;
+	size_t escrita;			//Próximo item a ser escrito.
+	size_t leitura;			//Próximo item a ser recebido.
+	size_t liberado;		//Item mais antigo ainda não devolvido.
+	size_t usado;			//Bytes ocupados, incluindo o fim desperdiçado antes de uma volta.
+	size_t disponiveis;		//Itens escritos e ainda não recebidos.
+	pthread_mutex_t trava;
+	pthread_cond_t cond;
+};
+
+RingbufHandle_t xRingbufferCreate( size_t tamanho, ringbuf_type_t tipo )
+{
+	if( tipo != RINGBUF_TYPE_NOSPLIT || tamanho < 2 * CABECALHO + 8 )
+		return NULL;
+	struct ringbuf_sim *ring = calloc( 1, sizeof( *ring ) );
+	if( ring == NULL )
+		return NULL;
+	ring->tamanho = tamanho & ~(size_t) 3;
+	ring->buffer = malloc( ring->tamanho );
+	if( ring->buffer == NULL )
+	{
+		free( ring );
+		return NULL;
+	}
+	pthread_mutex_init( &ring->trava, NULL );
+	sim_cond_init( &ring->cond );
+	return ring;
+}
+
+void vRingbufferDelete( RingbufHandle_t ring )
+{
+	pthread_mutex_destroy( &ring->trava );
+	pthread_cond_destroy( &ring->cond );
+	free( ring->buffer );
+	free( ring );
+}
+
+/* Bytes necessários para escrever o item agora (com o fim desperdiçado se ele não couber). */
+static size_t necessario( const struct ringbuf_sim *ring, size_t tamanho, bool *volta )
+{
+	size_t item = CABECALHO + ALINHA( tamanho );
+	*volta = ring->escrita + item > ring->tamanho;
+	return item + ( *volta ? ring->tamanho - ring->escrita : 0 );
+}
+
+static bool escreve( struct ringbuf_sim *ring, const void *dados, size_t tamanho )
+{
+	bool volta;
+	size_t bytes = necessario( ring, tamanho, &volta );
+	if( ring->usado + bytes > ring->tamanho )
+		return false;
+	if( volta )
+	{
+		if( ring->tamanho - ring->escrita >= CABECALHO )
+			*(cabecalho_t*)( ring->buffer + ring->escrita ) = (cabecalho_t) { 0, ITEM_VOLTA };
+		ring->escrita = 0;
+	}
+	*(cabecalho_t*)( ring->buffer + ring->escrita ) = (cabecalho_t) { (uint32_t) tamanho, 0 };
+	memcpy( ring->buffer + ring->escrita + CABECALHO, dados, tamanho );
+	ring->escrita += CABECALHO + ALINHA( tamanho );
+	if( ring->escrita == ring->tamanho )
+		ring->escrita = 0;
+	ring->usado += bytes;
+	ring->disponiveis++;
+	pthread_cond_broadcast( &ring->cond );
+	return true;
+}
+
+BaseType_t xRingbufferSend( RingbufHandle_t ring, const void *dados, size_t tamanho, TickType_t espera )
+{
+	//Como no ESP-IDF, um item sem divisão não pode passar de metade do buffer.
+	if( CABECALHO + ALINHA( tamanho ) > ring->tamanho / 2 )
+		return pdFALSE;
+	struct timespec prazo;
+	bool com_prazo = sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &ring->trava );
+	bool ok;
+	while( !( ok = escreve( ring, dados, tamanho ) ) && espera != 0 )
+		if( !sim_espera( &ring->cond, &ring->trava, com_prazo ? &prazo : NULL ) )
+		{
+			ok = escreve( ring, dados, tamanho );
+			break;
+		}
+	pthread_mutex_unlock( &ring->trava );
+	return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xRingbufferSendFromISR( RingbufHandle_t ring, const void *dados, size_t tamanho, BaseType_t *acordou )
+{
+	if( acordou )
+		*acordou = pdFALSE;
+	return xRingbufferSend( ring, dados, tamanho, 0 );
+}
+
+/* Posição do item em "pos", pulando a marca de volta. */
+static size_t item_em( const struct ringbuf_sim *ring, size_t pos, size_t *desperdicio )
+{
+	*desperdicio = 0;
+	if( ring->tamanho - pos < CABECALHO || ( (cabecalho_t*)( ring->buffer + pos ) )->flags & ITEM_VOLTA )
+	{
+		*desperdicio = ring->tamanho - pos;
+		return 0;
+	}
+	return pos;
+}
+
+void *xRingbufferReceive( RingbufHandle_t ring, size_t *tamanho, TickType_t espera )
+{
+	struct timespec prazo;
+	bool com_prazo = sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &ring->trava );
+	while( ring->disponiveis == 0 )
+	{
+		if( espera == 0 || !sim_espera( &ring->cond, &ring->trava, com_prazo ? &prazo : NULL ) )
+			if( ring->disponiveis == 0 )
+			{
+				pthread_mutex_unlock( &ring->trava );
+				return NULL;
+			}
+	}
+	size_t desperdicio;
+	size_t pos = item_em( ring, ring->leitura, &desperdicio );
+	cabecalho_t *cab = (cabecalho_t*)( ring->buffer + pos );
+	ring->leitura = pos + CABECALHO + ALINHA( cab->tamanho );
+	if( ring->leitura == ring->tamanho )
+		ring->leitura = 0;
+	ring->disponiveis--;
+	if( tamanho )
+		*tamanho = cab->tamanho;
+	pthread_mutex_unlock( &ring->trava );
+	return cab + 1;
+}
+
+void vRingbufferReturnItem( RingbufHandle_t ring, void *item )
+{
+	pthread_mutex_lock( &ring->trava );
+	( (cabecalho_t*) item - 1 )->flags |= ITEM_DEVOLVIDO;
+	//Libera os itens devolvidos a partir do mais antigo (a devolução fora de ordem espera os anteriores).
+	while( ring->usado > 0 )
+	{
+		size_t desperdicio;
+		size_t pos = item_em( ring, ring->liberado, &desperdicio );
+		cabecalho_t *cab = (cabecalho_t*)( ring->buffer + pos );
+		if( !( cab->flags & ITEM_DEVOLVIDO ) )
+			break;
+		size_t bytes = CABECALHO + ALINHA( cab->tamanho );
+		ring->usado -= desperdicio + bytes;
+		ring->liberado = pos + bytes;
+		if( ring->liberado == ring->tamanho )
+			ring->liberado = 0;
+	}
+	pthread_cond_broadcast( &ring->cond );
+	pthread_mutex_unlock( &ring->trava );
+}
+
+size_t xRingbufferGetCurFreeSize( RingbufHandle_t ring )
+{
+	pthread_mutex_lock( &ring->trava );
+	size_t livre = ring->tamanho - ring->usado;
+	pthread_mutex_unlock( &ring->trava );
+	livre = livre > CABECALHO ? livre - CABECALHO : 0;
+	return livre < ring->tamanho / 2 - CABECALHO ? livre : ring->tamanho / 2 - CABECALHO;
+}
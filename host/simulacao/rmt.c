@@ -0,0 +1,371 @@
+/*
+	Objetivo: RMT do ESP32 no build para Linux - o receptor mede as bordas do pino em itens e entrega o
+			  quadro no ringbuffer do driver quando a linha fica ociosa; o transmissor gera os itens
+			  no pino com espera ocupada
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdlib.h>
+#include <string.h>
+#include "driver/rmt.h"
+#include "soc/gpio_sig_map.h"
+#include "esp_log.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define ITENS_POR_BLOCO		64
+#define NS_POR_CICLO_APB_X2		25		//Clock do RMT: APB de 80 MHz (12,5 ns) dividido por clk_div.
+#define DURACAO_MAX			0x7FFF
+
+typedef struct {
+	bool configurado;
+	rmt_mode_t modo;
+	int pino;
+	uint8_t divisor;
+	uint8_t blocos;
+	/* Receptor */
+	bool filtro;
+	uint8_t filtro_apb;
+	uint16_t ocioso_ticks;
+	bool recebendo;
+	bool em_quadro;
+	bool estourou;
+	uint8_t nivel;				//Nível depois da última borda aceita.
+	int64_t ultima_borda_ns;
+	rmt_item32_t *itens;		//blocos * ITENS_POR_BLOCO.
+	size_t duracoes;			//Durações gravadas no quadro atual.
+	RingbufHandle_t ring;
+	pthread_cond_t ocioso;		//Acorda a thread de fim de quadro.
+	/* Transmissor */
+	uint8_t nivel_ocioso;
+	const rmt_item32_t *tx_itens;
+	int tx_n;
+	bool transmitindo;
+	pthread_cond_t tx_cond;
+} canal_t;
+
+/* Variáveis Globais */
+static const char * TAG = "rmt";
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static canal_t s_canais[RMT_CHANNEL_MAX];
+
+static int64_t ticks_para_ns( const canal_t *c, uint32_t ticks )
+{
+	return (int64_t) ticks * c->divisor * NS_POR_CICLO_APB_X2 / 2;
+}
+
+static void grava( canal_t *c, uint32_t ticks, uint32_t nivel )
+{
+	size_t max = (size_t) c->blocos * ITENS_POR_BLOCO * 2;
+	//A última posição fica para a duração zero que encerra o quadro.
+	if( c->duracoes + 1 >= max )
+	{
+		c->estourou = true;
+		return;
+	}
+	rmt_item32_t *item = &c->itens[c->duracoes / 2];
+	if( c->duracoes & 1 )
+	{
+		item->duration1 = ticks;
+		item->level1 = nivel;
+	}
+	else
+	{
+		item->val = 0;
+		item->duration0 = ticks;
+		item->level0 = nivel;
+	}
+	c->duracoes++;
+}
+
+/* Linha ociosa: grava a duração zero e entrega o quadro. Com s_trava. */
+static void fecha_quadro( int canal )
+{
+	canal_t *c = &s_canais[canal];
+	if( !c->estourou )
+	{
+		grava( c, 0, c->nivel );
+		size_t itens = ( c->duracoes + 1 ) / 2;
+		if( c->ring )
+			xRingbufferSendFromISR( c->ring, c->itens, itens * sizeof( rmt_item32_t ), NULL );
+	}
+	else
+		ESP_LOGE( TAG, "RMT RX BUFFER FULL" );
+	c->em_quadro = false;
+	c->estourou = false;
+	c->duracoes = 0;
+}
+
+void sim_rmt_borda( int pino, int nivel, int64_t instante_ns )
+{
+	pthread_mutex_lock( &s_trava );
+	for( int i = 0; i < RMT_CHANNEL_MAX; i++ )
+	{
+		canal_t *c = &s_canais[i];
+		if( !c->configurado || c->modo != RMT_MODE_RX || c->pino != pino || !c->recebendo )
+			continue;
+		int64_t intervalo = instante_ns - c->ultima_borda_ns;
+		int64_t tick_ns = (int64_t) c->divisor * NS_POR_CICLO_APB_X2;	//Em meios ns.
+		if( c->em_quadro && intervalo * 2 >= (int64_t) c->ocioso_ticks * tick_ns )
+			fecha_quadro( i );		//A thread de fim de quadro ainda não tinha rodado.
+		if( !c->em_quadro )
+		{
+			c->em_quadro = true;
+			c->ultima_borda_ns = instante_ns;
+			c->nivel = nivel;
+			pthread_cond_signal( &c->ocioso );
+			continue;
+		}
+		//Filtro aproximado: pulsos mais curtos que o limiar não geram borda.
+		if( c->filtro && intervalo * 2 < (int64_t) c->filtro_apb * NS_POR_CICLO_APB_X2 )
+			continue;
+		uint32_t ticks = (uint32_t)( intervalo * 2 / tick_ns );
+		grava( c, ticks > DURACAO_MAX ? DURACAO_MAX : ( ticks ? ticks : 1 ), !nivel );
+		//Sem acordar a thread de fim de quadro: ela recalcula o prazo quando o anterior vence.
+		c->ultima_borda_ns = instante_ns;
+		c->nivel = nivel;
+	}
+	pthread_mutex_unlock( &s_trava );
+}
+
+/* Fim de quadro: a linha ficou ociosa por ocioso_ticks desde a última borda. */
+static void *thread_ocioso( void *arg )
+{
+	int canal = (int)(intptr_t) arg;
+	canal_t *c = &s_canais[canal];
+	pthread_mutex_lock( &s_trava );
+	while( c->configurado )
+	{
+		if( !c->em_quadro )
+		{
+			pthread_cond_wait( &c->ocioso, &s_trava );
+			continue;
+		}
+		int64_t fim = c->ultima_borda_ns + ticks_para_ns( c, c->ocioso_ticks );
+		if( sim_agora_ns() >= fim )
+		{
+			fecha_quadro( canal );
+			continue;
+		}
+		struct timespec prazo = sim_instante( fim );
+		sim_espera( &c->ocioso, &s_trava, &prazo );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return NULL;
+}
+
+/* Transmissor: cada duração é gerada no sinal do canal; a duração zero encerra. */
+static void *thread_tx( void *arg )
+{
+	int canal = (int)(intptr_t) arg;
+	canal_t *c = &s_canais[canal];
+	uint32_t sinal = RMT_SIG_OUT0_IDX + canal;
+	pthread_mutex_lock( &s_trava );
+	while( c->configurado )
+	{
+		if( c->tx_itens == NULL )
+		{
+			pthread_cond_wait( &c->tx_cond, &s_trava );
+			continue;
+		}
+		const rmt_item32_t *itens = c->tx_itens;
+		int n = c->tx_n;
+		int pino = c->pino;
+		pthread_mutex_unlock( &s_trava );
+
+		int64_t t = sim_agora_ns();
+		for( int i = 0; i < 2 * n; i++ )
+		{
+			const rmt_item32_t *item = &itens[i / 2];
+			uint32_t ticks = ( i & 1 ) ? item->duration1 : item->duration0;
+			uint32_t nivel = ( i & 1 ) ? item->level1 : item->level0;
+			if( ticks == 0 )
+				break;
+			sim_gpio_periferico( pino, sinal, nivel );
+			t += ticks_para_ns( c, ticks );
+			sim_espera_ate_ns( t );
+		}
+		sim_gpio_periferico( pino, sinal, c->nivel_ocioso );
+
+		pthread_mutex_lock( &s_trava );
+		c->tx_itens = NULL;
+		c->transmitindo = false;
+		pthread_cond_broadcast( &c->tx_cond );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return NULL;
+}
+
+esp_err_t rmt_config( const rmt_config_t *config )
+{
+	if( config == NULL || config->channel >= RMT_CHANNEL_MAX || config->rmt_mode >= RMT_MODE_MAX
+		|| config->clk_div == 0 || config->mem_block_num == 0 || config->channel + config->mem_block_num > RMT_CHANNEL_MAX
+		|| !GPIO_IS_VALID_GPIO( config->gpio_num ) )
+		return ESP_ERR_INVALID_ARG;
+
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[config->channel];
+	c->modo = config->rmt_mode;
+	c->pino = config->gpio_num;
+	c->divisor = config->clk_div;
+	c->blocos = config->mem_block_num;
+	if( c->modo == RMT_MODE_RX )
+	{
+		c->filtro = config->rx_config.filter_en;
+		c->filtro_apb = config->rx_config.filter_ticks_thresh;
+		c->ocioso_ticks = config->rx_config.idle_threshold;
+	}
+	else
+		c->nivel_ocioso = config->tx_config.idle_level;
+	pthread_mutex_unlock( &s_trava );
+
+	if( config->rmt_mode == RMT_MODE_RX )
+		gpio_set_direction( config->gpio_num, GPIO_MODE_INPUT );
+	else
+	{
+		//Como no ESP-IDF: saída roteada para o sinal do canal.
+		gpio_set_direction( config->gpio_num, GPIO_MODE_OUTPUT );
+		gpio_matrix_out( config->gpio_num, RMT_SIG_OUT0_IDX + config->channel, false, false );
+		if( config->tx_config.idle_output_en )
+			sim_gpio_periferico( config->gpio_num, RMT_SIG_OUT0_IDX + config->channel, config->tx_config.idle_level );
+	}
+	return ESP_OK;
+}
+
+esp_err_t rmt_driver_install( rmt_channel_t canal, size_t tamanho_ring, int flags )
+{
+	(void) flags;
+	if( canal >= RMT_CHANNEL_MAX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[canal];
+	if( c->configurado )
+	{
+		pthread_mutex_unlock( &s_trava );
+		ESP_LOGE( TAG, "RMT driver already installed" );
+		return ESP_ERR_INVALID_STATE;
+	}
+	esp_err_t ret = ESP_OK;
+	if( c->modo == RMT_MODE_RX )
+	{
+		c->itens = calloc( (size_t) c->blocos * ITENS_POR_BLOCO, sizeof( rmt_item32_t ) );
+		c->ring = tamanho_ring ? xRingbufferCreate( tamanho_ring, RINGBUF_TYPE_NOSPLIT ) : NULL;
+		if( c->itens == NULL || ( tamanho_ring && c->ring == NULL ) )
+			ret = ESP_ERR_NO_MEM;
+	}
+	if( ret == ESP_OK )
+	{
+		c->configurado = true;
+		sim_cond_init( &c->ocioso );
+		sim_cond_init( &c->tx_cond );
+		sim_thread( c->modo == RMT_MODE_RX ? thread_ocioso : thread_tx, (void*)(intptr_t) canal );
+	}
+	else
+	{
+		free( c->itens );
+		c->itens = NULL;
+		if( c->ring )
+			vRingbufferDelete( c->ring );
+		c->ring = NULL;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t rmt_driver_uninstall( rmt_channel_t canal )
+{
+	if( canal >= RMT_CHANNEL_MAX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[canal];
+	if( !c->configurado )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ESP_ERR_INVALID_STATE;
+	}
+	while( c->transmitindo )
+		pthread_cond_wait( &c->tx_cond, &s_trava );
+	//As threads do canal terminam ao ver o canal desconfigurado (a memória fica com elas até lá).
+	c->configurado = false;
+	c->recebendo = false;
+	pthread_cond_broadcast( &c->ocioso );
+	pthread_cond_broadcast( &c->tx_cond );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t rmt_get_ringbuf_handle( rmt_channel_t canal, RingbufHandle_t *ring )
+{
+	if( canal >= RMT_CHANNEL_MAX || ring == NULL )
+		return ESP_ERR_INVALID_ARG;
+	*ring = s_canais[canal].ring;
+	return *ring ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t rmt_rx_start( rmt_channel_t canal, bool zera_memoria )
+{
+	if( canal >= RMT_CHANNEL_MAX || s_canais[canal].modo != RMT_MODE_RX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[canal];
+	if( zera_memoria )
+	{
+		c->em_quadro = false;
+		c->duracoes = 0;
+	}
+	c->recebendo = true;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t rmt_rx_stop( rmt_channel_t canal )
+{
+	if( canal >= RMT_CHANNEL_MAX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	s_canais[canal].recebendo = false;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t rmt_write_items( rmt_channel_t canal, const rmt_item32_t *itens, int n, bool espera )
+{
+	if( canal >= RMT_CHANNEL_MAX || itens == NULL || n <= 0 || s_canais[canal].modo != RMT_MODE_TX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[canal];
+	if( !c->configurado )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ESP_ERR_INVALID_STATE;
+	}
+	while( c->transmitindo )
+		pthread_cond_wait( &c->tx_cond, &s_trava );
+	c->tx_itens = itens;
+	c->tx_n = n;
+	c->transmitindo = true;
+	pthread_cond_broadcast( &c->tx_cond );
+	//Sem espera, os itens precisam continuar válidos até o fim (como no driver com itens na RAM do RMT).
+	while( espera && c->transmitindo )
+		pthread_cond_wait( &c->tx_cond, &s_trava );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t rmt_wait_tx_done( rmt_channel_t canal, TickType_t espera )
+{
+	if( canal >= RMT_CHANNEL_MAX )
+		return ESP_ERR_INVALID_ARG;
+	struct timespec prazo;
+	bool com_prazo = sim_prazo( espera, &prazo );
+	pthread_mutex_lock( &s_trava );
+	canal_t *c = &s_canais[canal];
+	bool ok = true;
+	while( c->transmitindo && ok )
+		ok = espera != 0 && sim_espera( &c->tx_cond, &s_trava, com_prazo ? &prazo : NULL );
+	ok = !c->transmitindo;
+	pthread_mutex_unlock( &s_trava );
+	return ok ? ESP_OK : ESP_ERR_TIMEOUT;
+}
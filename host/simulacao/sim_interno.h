@@ -0,0 +1,66 @@
+/*
+	Objetivo: Funções compartilhadas entre os módulos da simulação (tempo, interrupções, threads
+			  de hardware e heap); não fazem parte da API dos componentes nem dos testes
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <time.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/soc.h"
+
+#define SIM_PERIODO_TICK_US		( 1000000 / configTICK_RATE_HZ )
+
+/* Tempo monotônico desde o início da simulação. */
+int64_t sim_agora_ns( void );
+int64_t sim_agora_us( void );
+/* Converte um instante da simulação (ns) para o relógio CLOCK_MONOTONIC. */
+struct timespec sim_instante( int64_t ns );
+/* Espera ocupada até o instante (ns), para os geradores de sinal de alta frequência. */
+void sim_espera_ate_ns( int64_t ns );
+/* Prazo absoluto de uma espera de "ticks" (portMAX_DELAY: sem prazo, retorna false). */
+bool sim_prazo( TickType_t ticks, struct timespec *prazo );
+/* pthread_cond_wait com prazo opcional (NULL espera para sempre). Retorna false no fim do prazo. */
+bool sim_espera( pthread_cond_t *cond, pthread_mutex_t *trava, const struct timespec *prazo );
+void sim_cond_init( pthread_cond_t *cond );
+
+/*
+	Interrupções: a ISR roda na thread que provocou o evento, no núcleo informado. Se a thread estiver
+	em uma seção crítica ou em outra ISR, a interrupção fica pendente (uma por função e argumento,
+	como o bit de status do periférico) até a saída.
+*/
+void sim_isr_disparar( void (*isr)( void *arg ), void *arg, int nucleo );
+bool sim_em_isr( void );
+/* Chamadas na saída de uma seção crítica e de uma ISR: efeitos das escritas em registradores. */
+void sim_pcnt_registradores( void );
+
+/* Thread de "hardware" (geradores, rádio): não aparece como task. */
+pthread_t sim_thread( void *(*funcao)( void *arg ), void *arg );
+/* Task interna do ESP-IDF (esp_timer, sys_evt), visível em uxTaskGetSystemState. */
+TaskHandle_t sim_task_sistema( TaskFunction_t funcao, const char *nome, UBaseType_t prioridade, BaseType_t nucleo );
+
+/* Conta no heap simulado uma alocação feita pela própria simulação (TCB e pilha dinâmicos). */
+void *sim_heap_alocar( size_t bytes );
+void sim_heap_liberar( void *ptr );
+
+/* Ganchos das bordas dos pinos simulados (chamados com a trava do GPIO). */
+void sim_pcnt_borda( int pino, int nivel, int64_t instante_ns );
+void sim_rmt_borda( int pino, int nivel, int64_t instante_ns );
+/* Saída de um periférico roteado pela matriz (LEDC, RMT) para o pino. */
+void sim_gpio_periferico( int pino, uint32_t sinal, int nivel );
+/* Sinal roteado para o pino (SIG_GPIO_OUT_IDX quando controlado pelo GPIO). */
+uint32_t sim_gpio_sinal( int pino );
+bool sim_gpio_entrada_habilitada( int pino );
+
+/* Inicialização dos módulos, chamada pelo main da simulação. */
+void sim_freertos_iniciar( void );
+void sim_esp_timer_iniciar( void );
+void sim_gpio_iniciar( void );
+void sim_nvs_iniciar( void );
@@ -0,0 +1,385 @@
+/*
+	Objetivo: Serviços de sistema do ESP-IDF no build para Linux - log, códigos de erro, números
+			  aleatórios, heap contado, contador de ciclos, endereços IPv4 e término da simulação
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <malloc.h>
+#include <sys/random.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_sleep.h"
+#include "esp_timer.h"
+#include "xtensa/hal.h"
+#include "lwip/ip4_addr.h"
+#include "sim_interno.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define HEAP_TOTAL			( 300 * 1024 )	//Heap livre típico do ESP32 depois do boot.
+#define MAX_NIVEIS_TAG		16
+
+/* Variáveis Globais */
+static pthread_mutex_t s_log_trava = PTHREAD_MUTEX_INITIALIZER;
+static struct {
+	char tag[24];
+	esp_log_level_t nivel;
+} s_niveis[MAX_NIVEIS_TAG];
+static uint32_t s_n_niveis;
+static esp_log_level_t s_nivel_padrao = ESP_LOG_VERBOSE;
+static vprintf_like_t s_saida_log = vprintf;
+static char s_texto_log[2048];			//Linha em formatação (com s_log_trava); cabe o JSON do perfil.
+
+static volatile size_t s_heap_usado;
+static volatile size_t s_heap_pico;
+static volatile uint32_t s_alocacoes;
+static volatile uint32_t s_liberacoes;
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Log                                                                                            */
+/* ---------------------------------------------------------------------------------------------- */
+
+uint32_t esp_log_timestamp( void )
+{
+	return (uint32_t)( sim_agora_us() / 1000 );
+}
+
+void esp_log_level_set( const char *tag, esp_log_level_t nivel )
+{
+	pthread_mutex_lock( &s_log_trava );
+	if( strcmp( tag, "*" ) == 0 )
+	{
+		s_nivel_padrao = nivel;
+		s_n_niveis = 0;
+	}
+	else
+	{
+		uint32_t i = 0;
+		while( i < s_n_niveis && strcmp( s_niveis[i].tag, tag ) != 0 )
+			i++;
+		if( i < MAX_NIVEIS_TAG )
+		{
+			strncpy( s_niveis[i].tag, tag, sizeof( s_niveis[i].tag ) - 1 );
+			s_niveis[i].nivel = nivel;
+			if( i == s_n_niveis )
+				s_n_niveis++;
+		}
+	}
+	pthread_mutex_unlock( &s_log_trava );
+}
+
+static esp_log_level_t nivel_da_tag( const char *tag )
+{
+	for( uint32_t i = 0; i < s_n_niveis; i++ )
+		if( strcmp( s_niveis[i].tag, tag ) == 0 )
+			return s_niveis[i].nivel;
+	return s_nivel_padrao;
+}
+
+/* Passa a linha pela função de saída do log (vprintf ou a de esp_log_set_vprintf). */
+static void escreve( const char *formato, ... )
+{
+	va_list args;
+	va_start( args, formato );
+	s_saida_log( formato, args );
+	va_end( args );
+}
+
+void esp_log_writev( esp_log_level_t nivel, const char *tag, const char *formato, va_list args )
+{
+	static const char letras[] = "NEWIDV";
+	pthread_mutex_lock( &s_log_trava );
+	if( nivel <= nivel_da_tag( tag ) )
+	{
+		//Mesmo formato da UART: "I (1234) tag: texto".
+		vsnprintf( s_texto_log, sizeof( s_texto_log ), formato, args );
+		escreve( "%c (%u) %s: %s\n", letras[nivel], esp_log_timestamp(), tag, s_texto_log );
+	}
+	pthread_mutex_unlock( &s_log_trava );
+}
+
+vprintf_like_t esp_log_set_vprintf( vprintf_like_t funcao )
+{
+	pthread_mutex_lock( &s_log_trava );
+	vprintf_like_t anterior = s_saida_log;
+	s_saida_log = funcao;
+	pthread_mutex_unlock( &s_log_trava );
+	return anterior;
+}
+
+void esp_log_write( esp_log_level_t nivel, const char *tag, const char *formato, ... )
+{
+	va_list args;
+	va_start( args, formato );
+	esp_log_writev( nivel, tag, formato, args );
+	va_end( args );
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Erros                                                                                          */
+/* ---------------------------------------------------------------------------------------------- */
+
+const char *esp_err_to_name( esp_err_t codigo )
+{
+	switch( codigo )
+	{
+		case ESP_OK:					return "ESP_OK";
+		case ESP_FAIL:					return "ESP_FAIL";
+		case ESP_ERR_NO_MEM:			return "ESP_ERR_NO_MEM";
+		case ESP_ERR_INVALID_ARG:		return "ESP_ERR_INVALID_ARG";
+		case ESP_ERR_INVALID_STATE:		return "ESP_ERR_INVALID_STATE";
+		case ESP_ERR_INVALID_SIZE:		return "ESP_ERR_INVALID_SIZE";
+		case ESP_ERR_NOT_FOUND:			return "ESP_ERR_NOT_FOUND";
+		case ESP_ERR_NOT_SUPPORTED:		return "ESP_ERR_NOT_SUPPORTED";
+		case ESP_ERR_TIMEOUT:			return "ESP_ERR_TIMEOUT";
+		case ESP_ERR_INVALID_RESPONSE:	return "ESP_ERR_INVALID_RESPONSE";
+		case ESP_ERR_INVALID_CRC:		return "ESP_ERR_INVALID_CRC";
+		case ESP_ERR_INVALID_VERSION:	return "ESP_ERR_INVALID_VERSION";
+		case ESP_ERR_INVALID_MAC:		return "ESP_ERR_INVALID_MAC";
+		case 0x1101:					return "ESP_ERR_NVS_NOT_INITIALIZED";
+		case 0x1102:					return "ESP_ERR_NVS_NOT_FOUND";
+		case 0x1103:					return "ESP_ERR_NVS_TYPE_MISMATCH";
+		case 0x1104:					return "ESP_ERR_NVS_READ_ONLY";
+		case 0x1105:					return "ESP_ERR_NVS_NOT_ENOUGH_SPACE";
+		case 0x1107:					return "ESP_ERR_NVS_INVALID_HANDLE";
+		case 0x110c:					return "ESP_ERR_NVS_INVALID_LENGTH";
+		case 0x110d:					return "ESP_ERR_NVS_NO_FREE_PAGES";
+		case 0x1110:					return "ESP_ERR_NVS_NEW_VERSION_FOUND";
+		case 0x3001:					return "ESP_ERR_WIFI_NOT_INIT";
+		case 0x3002:					return "ESP_ERR_WIFI_NOT_STARTED";
+		case 0x300f:					return "ESP_ERR_WIFI_NOT_CONNECT";
+		case 0x5005:					return "ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED";
+		default:						return "UNKNOWN ERROR";
+	}
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Sistema                                                                                        */
+/* ---------------------------------------------------------------------------------------------- */
+
+uint32_t esp_random( void )
+{
+	uint32_t valor;
+	esp_fill_random( &valor, sizeof( valor ) );
+	return valor;
+}
+
+void esp_fill_random( void *buffer, size_t tamanho )
+{
+	uint8_t *p = buffer;
+	while( tamanho > 0 )
+	{
+		ssize_t n = getrandom( p, tamanho, 0 );
+		if( n <= 0 )
+			abort();
+		p += n;
+		tamanho -= n;
+	}
+}
+
+void esp_restart( void )
+{
+	printf( "Rebooting...\n" );
+	sim_encerrar( 0 );
+}
+
+void sim_encerrar( int codigo )
+{
+	fflush( stdout );
+	fflush( stderr );
+	_exit( codigo );
+}
+
+uint32_t xthal_get_ccount( void )
+{
+	return (uint32_t)( sim_agora_ns() * CONFIG_ESP32_DEFAULT_CPU_FREQ_MHZ / 1000 );
+}
+
+esp_err_t esp_sleep_enable_gpio_wakeup( void )
+{
+	return ESP_OK;
+}
+
+esp_err_t esp_sleep_enable_timer_wakeup( uint64_t tempo_us )
+{
+	(void) tempo_us;
+	return ESP_OK;
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* Heap: as chamadas de malloc das bibliotecas são redirecionadas (-Wl,--wrap) para estas funções. */
+/* ---------------------------------------------------------------------------------------------- */
+
+void *__real_malloc( size_t tamanho );
+void *__real_calloc( size_t n, size_t tamanho );
+void *__real_realloc( void *ptr, size_t tamanho );
+void __real_free( void *ptr );
+
+static void conta_alocacao( void *ptr )
+{
+	if( ptr == NULL )
+		return;
+	size_t usado = __atomic_add_fetch( &s_heap_usado, malloc_usable_size( ptr ), __ATOMIC_RELAXED );
+	__atomic_add_fetch( &s_alocacoes, 1, __ATOMIC_RELAXED );
+	size_t pico = __atomic_load_n( &s_heap_pico, __ATOMIC_RELAXED );
+	while( usado > pico && !__atomic_compare_exchange_n( &s_heap_pico, &pico, usado, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED ) )
+		;
+}
+
+static void conta_liberacao( void *ptr )
+{
+	if( ptr == NULL )
+		return;
+	size_t tamanho = malloc_usable_size( ptr );
+	size_t usado = __atomic_load_n( &s_heap_usado, __ATOMIC_RELAXED );
+	//Blocos alocados pela libc (strdup, getaddrinfo) não foram contados na alocação.
+	__atomic_sub_fetch( &s_heap_usado, tamanho < usado ? tamanho : usado, __ATOMIC_RELAXED );
+	__atomic_add_fetch( &s_liberacoes, 1, __ATOMIC_RELAXED );
+}
+
+void *__wrap_malloc( size_t tamanho )
+{
+	if( s_heap_usado + tamanho > HEAP_TOTAL )
+		return NULL;
+	void *ptr = __real_malloc( tamanho );
+	conta_alocacao( ptr );
+	return ptr;
+}
+
+void *__wrap_calloc( size_t n, size_t tamanho )
+{
+	if( tamanho && n > HEAP_TOTAL / tamanho )
+		return NULL;
+	if( s_heap_usado + n * tamanho > HEAP_TOTAL )
+		return NULL;
+	void *ptr = __real_calloc( n, tamanho );
+	conta_alocacao( ptr );
+	return ptr;
+}
+
+void *__wrap_realloc( void *ptr, size_t tamanho )
+{
+	conta_liberacao( ptr );
+	void *novo = __real_realloc( ptr, tamanho );
+	conta_alocacao( novo );
+	if( novo == NULL && ptr != NULL && tamanho != 0 )
+		conta_alocacao( ptr );
+	return novo;
+}
+
+void __wrap_free( void *ptr )
+{
+	conta_liberacao( ptr );
+	__real_free( ptr );
+}
+
+void *sim_heap_alocar( size_t bytes )
+{
+	return __wrap_calloc( 1, bytes );
+}
+
+void sim_heap_liberar( void *ptr )
+{
+	__wrap_free( ptr );
+}
+
+void *heap_caps_malloc( size_t tamanho, uint32_t caps )
+{
+	(void) caps;
+	return __wrap_malloc( tamanho );
+}
+
+void *heap_caps_calloc( size_t n, size_t tamanho, uint32_t caps )
+{
+	(void) caps;
+	return __wrap_calloc( n, tamanho );
+}
+
+void heap_caps_free( void *ptr )
+{
+	__wrap_free( ptr );
+}
+
+size_t heap_caps_get_free_size( uint32_t caps )
+{
+	(void) caps;
+	return HEAP_TOTAL - s_heap_usado;
+}
+
+size_t heap_caps_get_minimum_free_size( uint32_t caps )
+{
+	(void) caps;
+	return HEAP_TOTAL - s_heap_pico;
+}
+
+size_t heap_caps_get_largest_free_block( uint32_t caps )
+{
+	//Sem fragmentação simulada: o maior bloco é limitado como na DRAM do ESP32.
+	size_t livre = heap_caps_get_free_size( caps );
+	return livre < 113 * 1024 ? livre : 113 * 1024;
+}
+
+uint32_t esp_get_free_heap_size( void )
+{
+	return (uint32_t) heap_caps_get_free_size( MALLOC_CAP_DEFAULT );
+}
+
+uint32_t esp_get_minimum_free_heap_size( void )
+{
+	return (uint32_t) heap_caps_get_minimum_free_size( MALLOC_CAP_DEFAULT );
+}
+
+void sim_heap_estatisticas( sim_heap_stats_t *stats )
+{
+	stats->alocacoes = s_alocacoes;
+	stats->liberacoes = s_liberacoes;
+	stats->livre = heap_caps_get_free_size( MALLOC_CAP_DEFAULT );
+	stats->minimo_livre = heap_caps_get_minimum_free_size( MALLOC_CAP_DEFAULT );
+}
+
+/* ---------------------------------------------------------------------------------------------- */
+/* lwIP                                                                                           */
+/* ---------------------------------------------------------------------------------------------- */
+
+int ip4addr_aton( const char *texto, ip4_addr_t *endereco )
+{
+	unsigned int partes[4];
+	char resto;
+	if( texto == NULL || sscanf( texto, "%u.%u.%u.%u%c", &partes[0], &partes[1], &partes[2], &partes[3], &resto ) != 4 )
+		return 0;
+	for( int i = 0; i < 4; i++ )
+		if( partes[i] > 255 )
+			return 0;
+	if( endereco )
+		endereco->addr = partes[0] | ( partes[1] << 8 ) | ( partes[2] << 16 ) | ( (uint32_t) partes[3] << 24 );
+	return 1;
+}
+
+char *ip4addr_ntoa_r( const ip4_addr_t *endereco, char *buffer, int tamanho )
+{
+	const uint8_t *b = (const uint8_t*) &endereco->addr;
+	int n = snprintf( buffer, tamanho, "%u.%u.%u.%u", b[0], b[1], b[2], b[3] );
+	return n < tamanho ? buffer : NULL;
+}
+
+#ifdef SIM_STRLCPY
+size_t strlcpy( char *destino, const char *origem, size_t tamanho )
+{
+	size_t n = strlen( origem );
+	if( tamanho > 0 )
+	{
+		size_t copia = n < tamanho - 1 ? n : tamanho - 1;
+		memcpy( destino, origem, copia );
+		destino[copia] = '\0';
+	}
+	return n;
+}
+#endif
@@ -0,0 +1,670 @@
+/*
+	Objetivo: WiFi (station) e esp_netif do ESP-IDF no build para Linux - APs simulados com SSID, senha,
+			  canal e RSSI controlados pelos testes; a thread do rádio cumpre os tempos da varredura, da
+			  associação e do DHCP e posta os mesmos eventos que o driver
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <string.h>
+#include "sdkconfig.h"
+#include "esp_wifi.h"
+#include "esp_netif.h"
+#include "simulacao.h"
+#include "sim_interno.h"
+
+/* Definições e Constantes */
+#define MAX_APS				16
+#define NUM_CANAIS			13
+#define TEMPO_CANAL_MS		30		//Varredura de cada canal na conexão sem BSSID fixado.
+#define TEMPO_VARREDURA_MS	120		//Padrão do esp_wifi_scan_start (scan_time.active.max = 0).
+#define TEMPO_ASSOCIACAO_MS	40		//Autenticação, associação e 4-way handshake.
+#define TEMPO_SENHA_MS		100		//Handshake com a senha errada até o timeout.
+#define DHCP_ATRASO_MS		200
+#define NUNCA				INT64_MAX
+
+typedef struct {
+	char ssid[33];
+	char senha[65];
+	uint8_t bssid[6];
+	uint8_t canal;
+	int8_t rssi;
+} ap_t;
+
+typedef enum {
+	PARADO,
+	OCIOSO,			//Iniciado e desconectado.
+	CONECTANDO,
+	ASSOCIADO,
+} estado_t;
+
+struct esp_netif_obj {
+	bool criado;
+	bool dhcp;				//Cliente DHCP ligado.
+	esp_netif_ip_info_t ip;
+	esp_netif_dns_info_t dns[ESP_NETIF_DNS_MAX];
+};
+
+/* Variáveis Globais */
+static pthread_mutex_t s_trava = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_cond;
+
+static ap_t s_aps[MAX_APS];
+static size_t s_n_aps;
+static bool s_aps_padrao = true;		//Sem APs dos testes: um AP com o SSID e a senha do menuconfig.
+static int32_t s_dhcp_atraso_ms = DHCP_ATRASO_MS;
+
+static bool s_iniciado;					//esp_wifi_init().
+static wifi_mode_t s_modo;
+static wifi_config_t s_config;
+static estado_t s_estado = PARADO;
+static ap_t s_ap;						//AP associado ou da conexão em andamento.
+static uint8_t s_motivo;				//Motivo da falha da conexão em andamento (0: sucesso).
+static int64_t s_fim_conexao = NUNCA;	//Instantes (ns) das ações pendentes da thread do rádio.
+static int64_t s_fim_dhcp = NUNCA;
+static int64_t s_fim_varredura = NUNCA;
+static wifi_scan_config_t s_varredura;
+static uint8_t s_varredura_ssid[33];
+static uint8_t s_varredura_bssid[6];
+static bool s_varrendo;
+static wifi_ap_record_t s_resultado[MAX_APS];
+static uint16_t s_n_resultado;
+static int32_t s_limiar_rssi;			//0: WIFI_EVENT_STA_BSS_RSSI_LOW desarmado.
+static int64_t s_inicio_us = -1;		//Primeiro esp_wifi_connect().
+static sim_wifi_stats_t s_stats = { .primeira_conexao_us = -1, .primeiro_ip_us = -1 };
+
+static struct esp_netif_obj s_netif = { .dhcp = true };
+
+/* A lista começa com o AP do menuconfig até o primeiro estímulo dos testes. Com s_trava. */
+static void aps_padrao( void )
+{
+	if( !s_aps_padrao )
+		return;
+	s_aps_padrao = false;
+	s_aps[0] = (ap_t) { .bssid = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01 }, .canal = 6, .rssi = -50 };
+	strlcpy( s_aps[0].ssid, CONFIG_ESP_WIFI_SSID, sizeof( s_aps[0].ssid ) );
+	strlcpy( s_aps[0].senha, CONFIG_ESP_WIFI_PASSWORD, sizeof( s_aps[0].senha ) );
+	s_n_aps = 1;
+}
+
+static ap_t *procura_ap( const uint8_t *bssid )
+{
+	aps_padrao();
+	for( size_t i = 0; i < s_n_aps; i++ )
+		if( memcmp( s_aps[i].bssid, bssid, 6 ) == 0 )
+			return &s_aps[i];
+	return NULL;
+}
+
+static void posta( esp_event_base_t base, int32_t id, const void *dados, size_t tamanho )
+{
+	//A fila do laço de eventos não pode bloquear a thread do rádio (os handlers chamam o driver).
+	esp_event_post( base, id, dados, tamanho, 0 );
+}
+
+/* Desassocia e avisa a aplicação. Com s_trava. */
+static void desconecta( uint8_t motivo )
+{
+	wifi_event_sta_disconnected_t evento = { .reason = motivo };
+	const ap_t *ap = s_estado == ASSOCIADO ? &s_ap : NULL;
+	if( ap )
+	{
+		memcpy( evento.ssid, ap->ssid, sizeof( evento.ssid ) );
+		evento.ssid_len = strnlen( ap->ssid, sizeof( evento.ssid ) );
+		memcpy( evento.bssid, ap->bssid, 6 );
+	}
+	s_estado = OCIOSO;
+	s_fim_conexao = NUNCA;
+	s_fim_dhcp = NUNCA;
+	memset( s_stats.bssid, 0, sizeof( s_stats.bssid ) );
+	posta( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &evento, sizeof( evento ) );
+}
+
+static void posta_ip( bool mudou )
+{
+	ip_event_got_ip_t evento = { .esp_netif = &s_netif, .ip_info = s_netif.ip, .ip_changed = mudou };
+	if( s_stats.primeiro_ip_us < 0 )
+		s_stats.primeiro_ip_us = sim_agora_us() - s_inicio_us;
+	posta( IP_EVENT, IP_EVENT_STA_GOT_IP, &evento, sizeof( evento ) );
+}
+
+/* Fim da associação: sucesso ou o motivo da falha escolhido no esp_wifi_connect. Com s_trava. */
+static void conclui_conexao( void )
+{
+	s_fim_conexao = NUNCA;
+	if( s_motivo )
+	{
+		//A falha é antes da associação: o evento leva só o SSID pedido.
+		s_estado = OCIOSO;
+		wifi_event_sta_disconnected_t evento = { .reason = s_motivo };
+		memcpy( evento.ssid, s_config.sta.ssid, sizeof( evento.ssid ) );
+		evento.ssid_len = strnlen( (const char*) s_config.sta.ssid, sizeof( evento.ssid ) );
+		posta( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, &evento, sizeof( evento ) );
+		return;
+	}
+	s_estado = ASSOCIADO;
+	s_stats.associacoes++;
+	memcpy( s_stats.bssid, s_ap.bssid, 6 );
+	if( s_stats.primeira_conexao_us < 0 )
+		s_stats.primeira_conexao_us = sim_agora_us() - s_inicio_us;
+	wifi_event_sta_connected_t evento = { .channel = s_ap.canal, .authmode = s_ap.senha[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN };
+	memcpy( evento.ssid, s_ap.ssid, sizeof( evento.ssid ) );
+	evento.ssid_len = strnlen( s_ap.ssid, sizeof( evento.ssid ) );
+	memcpy( evento.bssid, s_ap.bssid, 6 );
+	posta( WIFI_EVENT, WIFI_EVENT_STA_CONNECTED, &evento, sizeof( evento ) );
+
+	//Como o esp_netif: com o DHCP desligado, o IP fixo vale assim que o enlace sobe.
+	if( s_netif.dhcp )
+		s_fim_dhcp = s_dhcp_atraso_ms >= 0 ? sim_agora_ns() + (int64_t) s_dhcp_atraso_ms * 1000000 : NUNCA;
+	else if( s_netif.ip.ip.addr )
+		posta_ip( false );
+}
+
+/* Concessão do servidor DHCP simulado (10.0.0.100/24, gateway e DNS 10.0.0.1). Com s_trava. */
+static void conclui_dhcp( void )
+{
+	s_fim_dhcp = NUNCA;
+	esp_netif_ip_info_t ip = {
+		.ip.addr = ESP_IP4TOADDR( 10, 0, 0, 100 ),
+		.netmask.addr = ESP_IP4TOADDR( 255, 255, 255, 0 ),
+		.gw.addr = ESP_IP4TOADDR( 10, 0, 0, 1 ),
+	};
+	bool mudou = memcmp( &ip, &s_netif.ip, sizeof( ip ) ) != 0;
+	s_netif.ip = ip;
+	s_netif.dns[ESP_NETIF_DNS_MAIN].ip.type = ESP_IPADDR_TYPE_V4;
+	s_netif.dns[ESP_NETIF_DNS_MAIN].ip.u_addr.ip4.addr = ip.gw.addr;
+	posta_ip( mudou );
+}
+
+static bool varredura_inclui( const ap_t *ap )
+{
+	if( s_varredura.channel && ap->canal != s_varredura.channel )
+		return false;
+	if( s_varredura.ssid && strcmp( ap->ssid, (const char*) s_varredura_ssid ) != 0 )
+		return false;
+	if( s_varredura.bssid && memcmp( ap->bssid, s_varredura_bssid, 6 ) != 0 )
+		return false;
+	return true;
+}
+
+/* Resultado ordenado pelo RSSI, como o driver entrega. Com s_trava. */
+static void conclui_varredura( void )
+{
+	s_fim_varredura = NUNCA;
+	s_varrendo = false;
+	s_n_resultado = 0;
+	aps_padrao();
+	for( size_t i = 0; i < s_n_aps; i++ )
+	{
+		if( !varredura_inclui( &s_aps[i] ) )
+			continue;
+		wifi_ap_record_t r = { .primary = s_aps[i].canal, .rssi = s_aps[i].rssi,
+							   .authmode = s_aps[i].senha[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN };
+		memcpy( r.bssid, s_aps[i].bssid, 6 );
+		memcpy( r.ssid, s_aps[i].ssid, sizeof( r.ssid ) );
+		size_t j = s_n_resultado++;
+		while( j > 0 && s_resultado[j - 1].rssi < r.rssi )
+		{
+			s_resultado[j] = s_resultado[j - 1];
+			j--;
+		}
+		s_resultado[j] = r;
+	}
+	wifi_event_sta_scan_done_t evento = { .status = 0, .number = s_n_resultado };
+	posta( WIFI_EVENT, WIFI_EVENT_SCAN_DONE, &evento, sizeof( evento ) );
+	pthread_cond_broadcast( &s_cond );
+}
+
+static void *thread_radio( void *arg )
+{
+	pthread_mutex_lock( &s_trava );
+	while( 1 )
+	{
+		int64_t agora = sim_agora_ns();
+		if( s_fim_conexao <= agora )
+			conclui_conexao();
+		else if( s_fim_dhcp <= agora )
+			conclui_dhcp();
+		else if( s_fim_varredura <= agora )
+			conclui_varredura();
+		else
+		{
+			int64_t fim = s_fim_conexao;
+			fim = s_fim_dhcp < fim ? s_fim_dhcp : fim;
+			fim = s_fim_varredura < fim ? s_fim_varredura : fim;
+			struct timespec prazo = sim_instante( fim );
+			sim_espera( &s_cond, &s_trava, fim == NUNCA ? NULL : &prazo );
+		}
+	}
+	return NULL;
+}
+
+esp_err_t esp_netif_init( void )
+{
+	return ESP_OK;
+}
+
+esp_netif_t *esp_netif_create_default_wifi_sta( void )
+{
+	pthread_mutex_lock( &s_trava );
+	s_netif.criado = true;
+	pthread_mutex_unlock( &s_trava );
+	return &s_netif;
+}
+
+esp_err_t esp_netif_dhcpc_start( esp_netif_t *netif )
+{
+	if( netif != &s_netif )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = ESP_OK;
+	if( s_netif.dhcp )
+		ret = ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED;
+	else
+	{
+		//O endereço atual continua valendo até a concessão (DISCOVER com o enlace já de pé).
+		s_netif.dhcp = true;
+		if( s_estado == ASSOCIADO && s_dhcp_atraso_ms >= 0 )
+		{
+			s_fim_dhcp = sim_agora_ns() + (int64_t) s_dhcp_atraso_ms * 1000000;
+			pthread_cond_broadcast( &s_cond );
+		}
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_netif_dhcpc_stop( esp_netif_t *netif )
+{
+	if( netif != &s_netif )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_netif.dhcp ? ESP_OK : ESP_ERR_ESP_NETIF_DHCP_ALREADY_STOPPED;
+	s_netif.dhcp = false;
+	s_fim_dhcp = NUNCA;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_netif_set_ip_info( esp_netif_t *netif, const esp_netif_ip_info_t *info )
+{
+	if( netif != &s_netif || info == NULL )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = ESP_OK;
+	if( s_netif.dhcp )
+		ret = ESP_ERR_ESP_NETIF_DHCP_ALREADY_STARTED;
+	else
+	{
+		bool mudou = memcmp( info, &s_netif.ip, sizeof( *info ) ) != 0;
+		s_netif.ip = *info;
+		//Com o enlace de pé o IP fixo vale na hora; senão, na associação.
+		if( s_estado == ASSOCIADO && info->ip.addr )
+			posta_ip( mudou );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_netif_get_ip_info( esp_netif_t *netif, esp_netif_ip_info_t *info )
+{
+	if( netif != &s_netif || info == NULL )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	*info = s_netif.ip;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_set_dns_info( esp_netif_t *netif, esp_netif_dns_type_t tipo, esp_netif_dns_info_t *dns )
+{
+	if( netif != &s_netif || tipo >= ESP_NETIF_DNS_MAX || dns == NULL )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	s_netif.dns[tipo] = *dns;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_netif_get_dns_info( esp_netif_t *netif, esp_netif_dns_type_t tipo, esp_netif_dns_info_t *dns )
+{
+	if( netif != &s_netif || tipo >= ESP_NETIF_DNS_MAX || dns == NULL )
+		return ESP_ERR_ESP_NETIF_INVALID_PARAMS;
+	pthread_mutex_lock( &s_trava );
+	*dns = s_netif.dns[tipo];
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_init( const wifi_init_config_t *config )
+{
+	if( config == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	bool primeiro = !s_iniciado;
+	if( primeiro )
+	{
+		sim_cond_init( &s_cond );
+		s_iniciado = true;
+	}
+	pthread_mutex_unlock( &s_trava );
+	if( primeiro )
+		sim_thread( thread_radio, NULL );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_deinit( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_estado != PARADO ? ESP_ERR_WIFI_NOT_STOPPED : ESP_OK;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_wifi_set_mode( wifi_mode_t modo )
+{
+	if( modo >= WIFI_MODE_MAX )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_iniciado ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+	if( ret == ESP_OK )
+		s_modo = modo;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_wifi_set_storage( wifi_storage_t armazenamento )
+{
+	(void) armazenamento;
+	return s_iniciado ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_set_config( esp_interface_t interface, wifi_config_t *config )
+{
+	if( config == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( interface != ESP_IF_WIFI_STA )
+		return ESP_ERR_WIFI_IF;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_modo != WIFI_MODE_STA && s_modo != WIFI_MODE_APSTA ? ESP_ERR_WIFI_MODE : ESP_OK;
+	if( ret == ESP_OK )
+		s_config = *config;
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_wifi_get_config( esp_interface_t interface, wifi_config_t *config )
+{
+	if( config == NULL )
+		return ESP_ERR_INVALID_ARG;
+	if( interface != ESP_IF_WIFI_STA )
+		return ESP_ERR_WIFI_IF;
+	pthread_mutex_lock( &s_trava );
+	*config = s_config;
+	pthread_mutex_unlock( &s_trava );
+	return s_iniciado ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_start( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_modo == WIFI_MODE_NULL ? ESP_ERR_WIFI_MODE : ESP_OK;
+	bool iniciou = ret == ESP_OK && s_estado == PARADO;
+	if( iniciou )
+		s_estado = OCIOSO;
+	pthread_mutex_unlock( &s_trava );
+	if( iniciou )
+		posta( WIFI_EVENT, WIFI_EVENT_STA_START, NULL, 0 );
+	return ret;
+}
+
+esp_err_t esp_wifi_stop( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_iniciado ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+	bool parou = ret == ESP_OK && s_estado != PARADO;
+	if( s_estado == ASSOCIADO || s_estado == CONECTANDO )
+		desconecta( WIFI_REASON_ASSOC_LEAVE );
+	if( parou )
+	{
+		s_estado = PARADO;
+		s_fim_varredura = NUNCA;
+		s_varrendo = false;
+		posta( WIFI_EVENT, WIFI_EVENT_STA_STOP, NULL, 0 );
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+/*
+	Escolhe o AP como o supplicant: com o BSSID e o canal fixados (WIFI_FAST_SCAN) só esse canal é
+	visitado; senão todos os canais são varridos e vence o melhor RSSI com o SSID (e o BSSID, se fixado).
+*/
+esp_err_t esp_wifi_connect( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_estado == PARADO ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+	if( ret == ESP_OK && s_estado != OCIOSO )
+		ret = ESP_ERR_WIFI_CONN;
+	if( ret != ESP_OK )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ret;
+	}
+
+	aps_padrao();
+	s_stats.conexoes++;
+	if( s_inicio_us < 0 )
+		s_inicio_us = sim_agora_us();
+	const wifi_sta_config_t *sta = &s_config.sta;
+	bool rapida = sta->bssid_set && sta->channel && sta->scan_method == WIFI_FAST_SCAN;
+	int64_t atraso_ms = rapida ? TEMPO_CANAL_MS : NUM_CANAIS * TEMPO_CANAL_MS;
+	const ap_t *escolhido = NULL;
+	if( rapida )
+		s_stats.conexoes_rapidas++;
+	for( size_t i = 0; i < s_n_aps; i++ )
+	{
+		const ap_t *ap = &s_aps[i];
+		if( strncmp( ap->ssid, (const char*) sta->ssid, sizeof( sta->ssid ) ) != 0
+			|| ( sta->bssid_set && memcmp( ap->bssid, sta->bssid, 6 ) != 0 )
+			|| ( rapida && ap->canal != sta->channel ) )
+			continue;
+		if( escolhido == NULL || ap->rssi > escolhido->rssi )
+			escolhido = ap;
+	}
+	if( escolhido == NULL )
+		s_motivo = WIFI_REASON_NO_AP_FOUND;
+	else if( strncmp( escolhido->senha, (const char*) sta->password, sizeof( sta->password ) ) != 0 )
+	{
+		s_motivo = WIFI_REASON_4WAY_HANDSHAKE_TIMEOUT;
+		atraso_ms += TEMPO_SENHA_MS;
+	}
+	else
+	{
+		s_motivo = 0;
+		atraso_ms += TEMPO_ASSOCIACAO_MS;
+	}
+	if( escolhido )
+		s_ap = *escolhido;
+	s_estado = CONECTANDO;
+	s_fim_conexao = sim_agora_ns() + atraso_ms * 1000000;
+	pthread_cond_broadcast( &s_cond );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_disconnect( void )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_estado == PARADO ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+	if( s_estado == ASSOCIADO || s_estado == CONECTANDO )
+		desconecta( WIFI_REASON_ASSOC_LEAVE );
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_wifi_set_ps( wifi_ps_type_t tipo )
+{
+	(void) tipo;
+	return s_iniciado ? ESP_OK : ESP_ERR_WIFI_NOT_INIT;
+}
+
+esp_err_t esp_wifi_scan_start( const wifi_scan_config_t *config, bool bloquear )
+{
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = !s_iniciado ? ESP_ERR_WIFI_NOT_INIT : s_estado == PARADO ? ESP_ERR_WIFI_NOT_STARTED : ESP_OK;
+	if( ret == ESP_OK && ( s_varrendo || s_estado == CONECTANDO ) )
+		ret = ESP_ERR_WIFI_STATE;
+	if( ret != ESP_OK )
+	{
+		pthread_mutex_unlock( &s_trava );
+		return ret;
+	}
+	s_varredura = config ? *config : (wifi_scan_config_t) { 0 };
+	if( s_varredura.ssid )
+		strlcpy( (char*) s_varredura_ssid, (const char*) s_varredura.ssid, sizeof( s_varredura_ssid ) );
+	if( s_varredura.bssid )
+		memcpy( s_varredura_bssid, s_varredura.bssid, 6 );
+	uint32_t tempo = s_varredura.scan_type == WIFI_SCAN_TYPE_PASSIVE ? s_varredura.scan_time.passive : s_varredura.scan_time.active.max;
+	tempo = tempo ? tempo : TEMPO_VARREDURA_MS;
+	s_stats.varreduras++;
+	s_varrendo = true;
+	s_fim_varredura = sim_agora_ns() + (int64_t) tempo * ( s_varredura.channel ? 1 : NUM_CANAIS ) * 1000000;
+	pthread_cond_broadcast( &s_cond );
+	while( bloquear && s_varrendo )
+		pthread_cond_wait( &s_cond, &s_trava );
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_num( uint16_t *n )
+{
+	if( n == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	*n = s_n_resultado;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_scan_get_ap_records( uint16_t *n, wifi_ap_record_t *registros )
+{
+	if( n == NULL || registros == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	if( *n > s_n_resultado )
+		*n = s_n_resultado;
+	memcpy( registros, s_resultado, *n * sizeof( registros[0] ) );
+	//Como o driver, os registros são liberados após a leitura.
+	s_n_resultado = 0;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+esp_err_t esp_wifi_sta_get_ap_info( wifi_ap_record_t *info )
+{
+	if( info == NULL )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	esp_err_t ret = s_estado == ASSOCIADO ? ESP_OK : ESP_ERR_WIFI_NOT_CONNECT;
+	if( ret == ESP_OK )
+	{
+		memset( info, 0, sizeof( *info ) );
+		memcpy( info->bssid, s_ap.bssid, 6 );
+		memcpy( info->ssid, s_ap.ssid, sizeof( info->ssid ) );
+		info->primary = s_ap.canal;
+		info->rssi = s_ap.rssi;
+		info->authmode = s_ap.senha[0] ? WIFI_AUTH_WPA2_PSK : WIFI_AUTH_OPEN;
+	}
+	pthread_mutex_unlock( &s_trava );
+	return ret;
+}
+
+esp_err_t esp_wifi_set_rssi_threshold( int32_t rssi )
+{
+	if( rssi >= 0 || rssi < -100 )
+		return ESP_ERR_INVALID_ARG;
+	pthread_mutex_lock( &s_trava );
+	s_limiar_rssi = rssi;
+	pthread_mutex_unlock( &s_trava );
+	return ESP_OK;
+}
+
+void sim_wifi_ap( const char *ssid, const char *senha, const uint8_t bssid[6], uint8_t canal, int8_t rssi )
+{
+	pthread_mutex_lock( &s_trava );
+	s_aps_padrao = false;
+	ap_t *ap = procura_ap( bssid );
+	if( ap == NULL && s_n_aps < MAX_APS )
+		ap = &s_aps[s_n_aps++];
+	if( ap )
+	{
+		*ap = (ap_t) { .canal = canal, .rssi = rssi };
+		strlcpy( ap->ssid, ssid, sizeof( ap->ssid ) );
+		strlcpy( ap->senha, senha, sizeof( ap->senha ) );
+		memcpy( ap->bssid, bssid, 6 );
+		if( s_estado == ASSOCIADO && memcmp( s_ap.bssid, bssid, 6 ) == 0 )
+			s_ap.rssi = rssi;
+	}
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_wifi_remove_ap( const uint8_t bssid[6] )
+{
+	pthread_mutex_lock( &s_trava );
+	s_aps_padrao = false;
+	ap_t *ap = procura_ap( bssid );
+	if( ap )
+	{
+		*ap = s_aps[--s_n_aps];
+		if( s_estado == ASSOCIADO && memcmp( s_ap.bssid, bssid, 6 ) == 0 )
+			desconecta( WIFI_REASON_BEACON_TIMEOUT );
+	}
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_wifi_remove_todos( void )
+{
+	pthread_mutex_lock( &s_trava );
+	s_aps_padrao = false;
+	s_n_aps = 0;
+	if( s_estado == ASSOCIADO )
+		desconecta( WIFI_REASON_BEACON_TIMEOUT );
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_wifi_rssi( const uint8_t bssid[6], int8_t rssi )
+{
+	pthread_mutex_lock( &s_trava );
+	ap_t *ap = procura_ap( bssid );
+	if( ap )
+		ap->rssi = rssi;
+	if( s_estado == ASSOCIADO && memcmp( s_ap.bssid, bssid, 6 ) == 0 )
+	{
+		int8_t anterior = s_ap.rssi;
+		s_ap.rssi = rssi;
+		//Como o driver: o evento é gerado uma vez por limiar configurado.
+		if( s_limiar_rssi && anterior >= s_limiar_rssi && rssi < s_limiar_rssi )
+		{
+			wifi_event_bss_rssi_low_t evento = { .rssi = rssi };
+			s_limiar_rssi = 0;
+			posta( WIFI_EVENT, WIFI_EVENT_STA_BSS_RSSI_LOW, &evento, sizeof( evento ) );
+		}
+	}
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_wifi_dhcp_atraso_ms( int32_t atraso_ms )
+{
+	pthread_mutex_lock( &s_trava );
+	s_dhcp_atraso_ms = atraso_ms;
+	pthread_mutex_unlock( &s_trava );
+}
+
+void sim_wifi_estatisticas( sim_wifi_stats_t *stats )
+{
+	pthread_mutex_lock( &s_trava );
+	*stats = s_stats;
+	pthread_mutex_unlock( &s_trava );
+}
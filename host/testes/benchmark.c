@@ -0,0 +1,110 @@
+/*
+	Objetivo: Teste do benchmark no build para Linux - percentis do histograma contra amostras
+			  conhecidas e a latência BUTTON -> LED com o injetor de bordas, como no laço do EX02
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "benchmark.h"
+#include "placa.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define AMOSTRAS			10000
+#define DURACAO_MS			3000
+#define INTERVALO_MIN_MS	5
+#define INTERVALO_MAX_MS	20
+
+/* Variáveis Globais */
+static bench_stats_t s_latencia;
+static bench_stats_t s_cpu;
+static TaskHandle_t s_task_controle;
+static volatile uint32_t s_divergencias;	//LED_G diferente do inverso do BUTTON após a escrita.
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Percentil dentro do erro do histograma (até 25% acima do valor exato). */
+static bool percentil_ok( const bench_stats_t *st, uint32_t percentil, uint32_t exato )
+{
+	uint32_t valor = bench_stats_percentil( st, percentil );
+	return valor >= exato && valor <= exato + exato / 4;
+}
+
+static void isr_button( void *arg )
+{
+	BaseType_t acordou = pdFALSE;
+	vTaskNotifyGiveFromISR( s_task_controle, &acordou );
+	if( acordou )
+		portYIELD_FROM_ISR();
+}
+
+/* Laço de controle do EX02 no modo por interrupção: os LEDs acompanham o BUTTON. */
+static void task_controle( void *arg )
+{
+	int anterior = gpio_get_level( BUTTON );
+	while( 1 )
+	{
+		ulTaskNotifyTake( pdTRUE, portMAX_DELAY );
+		int nivel = gpio_get_level( BUTTON );
+		uint32_t inicio = bench_ciclos();
+		gpio_set_level( LED_G, !nivel );
+		gpio_set_level( LED_B, nivel );
+		bench_stats_add( &s_cpu, bench_ciclos() - inicio );
+		if( nivel != anterior )
+			bench_latencia_marcar( &s_latencia );
+		if( sim_gpio_nivel( LED_G ) == nivel )
+			s_divergencias++;
+		anterior = nivel;
+	}
+}
+
+void app_main( void )
+{
+	//1. Histograma: amostras 1..10000, percentis pelo limite superior da faixa.
+	bench_stats_t st;
+	bench_stats_init( &st, "sequencia" );
+	for( uint32_t i = 1; i <= AMOSTRAS; i++ )
+		bench_stats_add( &st, i );
+	VERIFICA( st.amostras == AMOSTRAS && st.minimo == 1 && st.maximo == AMOSTRAS, "amostras %u, minimo %u, maximo %u",
+			  st.amostras, st.minimo, st.maximo );
+	VERIFICA( percentil_ok( &st, 50, AMOSTRAS / 2 ), "p50 %u", bench_stats_percentil( &st, 50 ) );
+	VERIFICA( percentil_ok( &st, 90, AMOSTRAS * 9 / 10 ), "p90 %u", bench_stats_percentil( &st, 90 ) );
+	VERIFICA( percentil_ok( &st, 99, AMOSTRAS * 99 / 100 ), "p99 %u", bench_stats_percentil( &st, 99 ) );
+	bench_stats_report( &st, "us" );
+
+	//2. Latência BUTTON -> LED: o injetor alterna o BUTTON e a ISR acorda o laço de controle.
+	const gpio_config_t leds = { .pin_bit_mask = ( 1ULL << LED_G ) | ( 1ULL << LED_B ), .mode = GPIO_MODE_OUTPUT };
+	const gpio_config_t botao = {
+		.pin_bit_mask = 1ULL << BUTTON,
+		.mode = GPIO_MODE_INPUT,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+		.intr_type = GPIO_INTR_ANYEDGE,
+	};
+	gpio_config( &leds );
+	gpio_config( &botao );
+	bench_stats_init( &s_latencia, "latencia botao->LED" );
+	bench_stats_init( &s_cpu, "ciclos por loop" );
+	xTaskCreate( task_controle, "task_controle", 2048, NULL, 5, &s_task_controle );
+	gpio_install_isr_service( 0 );
+	gpio_isr_handler_add( BUTTON, isr_button, NULL );
+	VERIFICA( bench_injetor_iniciar( BUTTON, INTERVALO_MIN_MS, INTERVALO_MAX_MS, &s_latencia, 0 ) == ESP_OK,
+			  "bench_injetor_iniciar" );
+	VERIFICA( bench_injetor_iniciar( BUTTON, 20, 10, &s_latencia, 0 ) == ESP_ERR_INVALID_ARG, "intervalo invertido aceito" );
+	vTaskDelay( DURACAO_MS / portTICK_PERIOD_MS );
+
+	uint32_t minimo = DURACAO_MS / INTERVALO_MAX_MS / 2;
+	VERIFICA( s_latencia.amostras >= minimo, "%u bordas medidas (minimo %u)", s_latencia.amostras, minimo );
+	VERIFICA( s_cpu.amostras >= s_latencia.amostras, "%u lacos para %u bordas", s_cpu.amostras, s_latencia.amostras );
+	VERIFICA( s_divergencias == 0, "%u escritas sem efeito no LED_G", s_divergencias );
+	bench_stats_report( &s_latencia, "us" );
+	bench_stats_report( &s_cpu, "ciclos" );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
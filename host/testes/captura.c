@@ -0,0 +1,221 @@
+/*
+	Objetivo: Teste da captura no build para Linux - transmissor do RMT no mesmo pino do receptor,
+			  captura de um quadro gerado no BUTTON e a sua reprodução pelo mesmo caminho de
+			  decodificação, lotes parciais e descarte com o ringbuffer cheio
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/gpio_sig_map.h"
+#include "captura.h"
+#include "placa.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define RESOLUCAO_NS	1000		//Divisor 80.
+#define OCIOSO_US		20000		//Fim de quadro: folga para o escalonador do Linux com outros testes rodando.
+#define MAX_PULSOS		64
+#define RAJADA			20
+
+/* Variáveis Globais */
+static const uint32_t s_quadro_us[] = { 200, 350, 120, 500, 80, 300, 260, 150, 400 };	//Níveis 0, 1, 0, ...
+static captura_pulso_t s_capturados[MAX_PULSOS];
+static captura_pulso_t s_reproduzidos[MAX_PULSOS];
+static volatile uint32_t s_taxa_maxima = UINT32_MAX;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Saída do log: lê o resultado do captura_benchmark e repassa tudo ao terminal. */
+static int captura_log( const char *formato, va_list args )
+{
+	va_list copia;
+	va_copy( copia, args );
+	char linha[256];
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	const char *taxa = strstr( linha, "Maior taxa sem perdas: " );
+	if( taxa )
+		s_taxa_maxima = strtoul( taxa + strlen( "Maior taxa sem perdas: " ), NULL, 10 );
+	return vprintf( formato, args );
+}
+
+static void espera_us( uint32_t us )
+{
+	int64_t fim = esp_timer_get_time() + us;
+	while( esp_timer_get_time() < fim )
+		;
+}
+
+/* Lê um quadro inteiro em lotes de até "lote" pulsos. */
+static size_t le_quadro( captura_pulso_t *pulsos, size_t lote )
+{
+	size_t n = 0;
+	while( n < MAX_PULSOS )
+	{
+		size_t lidos = captura_ler( pulsos + n, lote < MAX_PULSOS - n ? lote : MAX_PULSOS - n, 200 / portTICK_PERIOD_MS );
+		if( lidos == 0 )
+			break;
+		n += lidos;
+		if( pulsos[n - 1].fim_quadro )
+			break;
+	}
+	return n;
+}
+
+/* Converte pulsos de volta para os itens do RMT, com a duração zero que encerra o quadro. */
+static size_t para_itens( const captura_pulso_t *pulsos, size_t n, rmt_item32_t *itens )
+{
+	memset( itens, 0, ( n / 2 + 1 ) * sizeof( rmt_item32_t ) );
+	for( size_t i = 0; i < n; i++ )
+	{
+		rmt_item32_t *item = &itens[i / 2];
+		if( i & 1 )
+		{
+			item->duration1 = pulsos[i].duracao_ns / RESOLUCAO_NS;
+			item->level1 = pulsos[i].nivel;
+		}
+		else
+		{
+			item->duration0 = pulsos[i].duracao_ns / RESOLUCAO_NS;
+			item->level0 = pulsos[i].nivel;
+		}
+	}
+	return n / 2 + 1;
+}
+
+/* Confere a quantidade, os níveis (0, 1, 0, ...) e o fim de quadro no último pulso. Retorna a duração total. */
+static int64_t confere( const char *nome, const captura_pulso_t *pulsos, size_t n, size_t n_esperado )
+{
+	VERIFICA( n == n_esperado, "%s: %zu pulsos (esperados %zu)", nome, n, n_esperado );
+	int64_t total_ns = 0;
+	for( size_t i = 0; i < n; i++ )
+	{
+		VERIFICA( pulsos[i].nivel == ( i & 1 ) && pulsos[i].fim_quadro == ( i == n - 1 ),
+				  "%s: pulso %zu com nivel %u, %u ns", nome, i, pulsos[i].nivel, pulsos[i].duracao_ns );
+		total_ns += pulsos[i].duracao_ns;
+	}
+	return total_ns;
+}
+
+void app_main( void )
+{
+	gpio_config_t entrada = {
+		.pin_bit_mask = 1ULL << BUTTON,
+		.mode = GPIO_MODE_INPUT,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+	};
+	gpio_config( &entrada );
+	const captura_config_t config = {
+		.pino = BUTTON,
+		.canal = RMT_CHANNEL_4,
+		.blocos_memoria = 4,
+		.divisor = 80,
+		.filtro_apb = 0,
+		.ocioso_ticks = OCIOSO_US * 1000 / RESOLUCAO_NS,
+		.tamanho_buffer = 4096,
+	};
+	VERIFICA( captura_reproduzir( NULL, 0, 0 ) == ESP_ERR_INVALID_STATE, "reproducao antes do iniciar" );
+	VERIFICA( captura_iniciar( &config ) == ESP_OK, "captura_iniciar" );
+	VERIFICA( captura_iniciar( &config ) == ESP_ERR_INVALID_STATE, "segunda captura_iniciar" );
+
+	//1. Transmissor do RMT no próprio BUTTON, roteado pela matriz depois do gpio_set_direction (como no
+	//captura_benchmark), com meio período de 500 us: a precisão de 225 ns do benchmark não cabe no
+	//escalonador do Linux, aqui só se confere que as rajadas chegam ao receptor.
+	rmt_config_t tx = {
+		.rmt_mode = RMT_MODE_TX,
+		.channel = RMT_CHANNEL_2,
+		.gpio_num = BUTTON,
+		.clk_div = 80,
+		.mem_block_num = 1,
+		.tx_config = { .idle_level = RMT_IDLE_LEVEL_HIGH, .idle_output_en = true },
+	};
+	gpio_set_level( BUTTON, 1 );
+	VERIFICA( rmt_config( &tx ) == ESP_OK && rmt_driver_install( RMT_CHANNEL_2, 0, 0 ) == ESP_OK, "transmissor" );
+	gpio_set_direction( BUTTON, GPIO_MODE_INPUT_OUTPUT );
+	gpio_matrix_out( BUTTON, RMT_SIG_OUT0_IDX + RMT_CHANNEL_2, false, false );
+	rmt_item32_t rajada[RAJADA + 1] = { 0 };
+	for( int i = 0; i < RAJADA; i++ )
+		rajada[i] = (rmt_item32_t) { .duration0 = 500, .level0 = 0, .duration1 = 500, .level1 = 1 };
+	rmt_write_items( RMT_CHANNEL_2, rajada, RAJADA + 1, true );
+	//O transmissor agenda as bordas em instantes absolutos e nunca as adianta: uma borda atrasada pelo
+	//escalonador alonga um pulso e encurta o seguinte, e a soma só cresce com o atraso da última
+	//(menor que o fim de quadro, senão a rajada se divide). Cada pulso perde até um tick no arredondamento.
+	size_t n = le_quadro( s_capturados, MAX_PULSOS );
+	int64_t total_ns = confere( "rajada", s_capturados, n, 2 * RAJADA - 1 );
+	int64_t esperado_ns = ( 2 * RAJADA - 1 ) * 500000LL;
+	VERIFICA( total_ns > esperado_ns - ( 2 * RAJADA - 1 ) * RESOLUCAO_NS && total_ns < esperado_ns + OCIOSO_US * 1000LL,
+			  "rajada: %lld ns (esperados %lld)", (long long) total_ns, (long long) esperado_ns );
+	rmt_driver_uninstall( RMT_CHANNEL_2 );
+	gpio_set_direction( BUTTON, GPIO_MODE_INPUT );
+	gpio_matrix_out( BUTTON, SIG_GPIO_OUT_IDX, false, false );
+
+	//O benchmark roda até o fim, reporta a taxa e devolve o BUTTON ao repouso sem pulsos espúrios.
+	esp_log_set_vprintf( captura_log );
+	VERIFICA( captura_benchmark( RMT_CHANNEL_0, 256 ) == ESP_ERR_INVALID_ARG, "rajada maior que a memoria" );
+	VERIFICA( captura_benchmark( RMT_CHANNEL_0, 100 ) == ESP_OK, "captura_benchmark" );
+	esp_log_set_vprintf( vprintf );
+	VERIFICA( s_taxa_maxima != UINT32_MAX, "captura_benchmark nao reportou a taxa" );
+	VERIFICA( sim_gpio_nivel( BUTTON ) == 1, "BUTTON nao voltou ao repouso" );
+
+	//2. Quadro gerado por um circuito externo no BUTTON, lido em lotes de 4 pulsos. Cada borda é
+	//registrada entre os instantes lidos antes e depois de gerá-la: a duração medida de cada pulso fica
+	//entre os dois limites, independente do quanto o escalonador atrasou a geração.
+	const size_t n_quadro = sizeof( s_quadro_us ) / sizeof( s_quadro_us[0] );
+	int64_t antes_us[n_quadro + 1], depois_us[n_quadro + 1];
+	for( size_t i = 0; i <= n_quadro; i++ )
+	{
+		antes_us[i] = esp_timer_get_time();
+		sim_gpio_externo( BUTTON, i < n_quadro ? (int)( i & 1 ) : -1 );	//Por fim solto: volta ao pull-up.
+		depois_us[i] = esp_timer_get_time();
+		if( i < n_quadro )
+			espera_us( s_quadro_us[i] );
+	}
+	n = le_quadro( s_capturados, 4 );
+	confere( "quadro", s_capturados, n, n_quadro );
+	for( size_t i = 0; i < n && i < n_quadro; i++ )
+	{
+		int64_t minimo_ns = ( antes_us[i + 1] - depois_us[i] - 1 ) * 1000 - RESOLUCAO_NS;
+		int64_t maximo_ns = ( depois_us[i + 1] - antes_us[i] + 1 ) * 1000;
+		VERIFICA( s_capturados[i].duracao_ns > minimo_ns && s_capturados[i].duracao_ns < maximo_ns,
+				  "quadro: pulso %zu com %u ns, gerado com %lld a %lld ns", i, s_capturados[i].duracao_ns,
+				  (long long) minimo_ns, (long long) maximo_ns );
+	}
+
+	//3. Reprodução do quadro capturado: os mesmos pulsos, lidos em lotes de 3.
+	rmt_item32_t itens[MAX_PULSOS / 2 + 1];
+	size_t n_itens = para_itens( s_capturados, n, itens );
+	VERIFICA( captura_reproduzir( itens, n_itens, 0 ) == ESP_OK, "captura_reproduzir" );
+	size_t m = le_quadro( s_reproduzidos, 3 );
+	VERIFICA( m == n, "%zu pulsos reproduzidos (capturados %zu)", m, n );
+	for( size_t i = 0; i < n && i < m; i++ )
+		VERIFICA( s_reproduzidos[i].duracao_ns == s_capturados[i].duracao_ns && s_reproduzidos[i].nivel == s_capturados[i].nivel
+				  && s_reproduzidos[i].fim_quadro == s_capturados[i].fim_quadro, "pulso reproduzido %zu diferente", i );
+
+	//4. Ringbuffer cheio: o quadro é descartado e contado.
+	captura_stats_t antes, depois;
+	captura_estatisticas( &antes );
+	esp_err_t ret;
+	uint32_t enviados = 0;
+	while( ( ret = captura_reproduzir( itens, n_itens, 0 ) ) == ESP_OK )
+		enviados++;
+	captura_estatisticas( &depois );
+	VERIFICA( ret == ESP_ERR_TIMEOUT && depois.descartados == antes.descartados + 1, "descarte nao contado" );
+	for( uint32_t i = 0; i < enviados; i++ )
+		VERIFICA( le_quadro( s_reproduzidos, n ) == n, "quadro %u perdido", i );
+	captura_estatisticas( &depois );
+	printf( "%u quadros no ringbuffer cheio; total: %u quadros, %u pulsos, %u descartados\n", enviados,
+			depois.quadros, depois.pulsos, depois.descartados );
+	VERIFICA( depois.quadros == antes.quadros + enviados, "quadros lidos" );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
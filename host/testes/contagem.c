@@ -0,0 +1,131 @@
+/*
+	Objetivo: Teste da contagem no build para Linux - benchmark de CPU da ISR por borda contra o PCNT
+			  em 1, 10 e 100 kHz gerados pelo LEDC no próprio pino, e total de 64 bits exato com
+			  estouros e limiar
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "contagem.h"
+#include "placa.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define DURACAO_MS		1000
+#define NUM_FREQUENCIAS	3
+#define BORDAS_MANUAIS	1234
+#define LIMITE			100
+#define LIMIAR			10
+
+typedef struct {
+	uint32_t frequencia;
+	uint32_t bordas;
+	uint32_t esperadas;
+	uint32_t interrupcoes;
+	uint32_t cpu_centesimos;	//Centésimos de % da CPU nos handlers.
+} medida_t;
+
+/* Variáveis Globais */
+static medida_t s_isr[NUM_FREQUENCIAS];
+static medida_t s_pcnt[NUM_FREQUENCIAS];
+static int s_n_isr, s_n_pcnt;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Saída do log: guarda as linhas do contagem_benchmark e repassa tudo ao terminal. */
+static int captura_log( const char *formato, va_list args )
+{
+	va_list copia;
+	va_copy( copia, args );
+	char linha[256];
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	const char *texto = strstr( linha, "contagem: " );
+	medida_t m;
+	char modo[8];
+	uint32_t inteiro, fracao;
+	if( texto && sscanf( texto, "contagem: %u Hz %7[A-Z] : %u bordas (%u esperadas), %u interrupcoes, CPU %u.%u%%",
+						 &m.frequencia, modo, &m.bordas, &m.esperadas, &m.interrupcoes, &inteiro, &fracao ) == 7 )
+	{
+		m.cpu_centesimos = inteiro * 100 + fracao;
+		if( strcmp( modo, "ISR" ) == 0 && s_n_isr < NUM_FREQUENCIAS )
+			s_isr[s_n_isr++] = m;
+		else if( strcmp( modo, "PCNT" ) == 0 && s_n_pcnt < NUM_FREQUENCIAS )
+			s_pcnt[s_n_pcnt++] = m;
+	}
+	return vprintf( formato, args );
+}
+
+void app_main( void )
+{
+	//1. Benchmark: as mesmas ondas contadas por uma ISR por borda e pelo PCNT.
+	esp_log_set_vprintf( captura_log );
+	VERIFICA( contagem_benchmark( BUTTON, PCNT_UNIT_0, DURACAO_MS ) == ESP_OK, "contagem_benchmark" );
+	esp_log_set_vprintf( vprintf );
+	VERIFICA( s_n_isr == NUM_FREQUENCIAS && s_n_pcnt == NUM_FREQUENCIAS, "%d linhas ISR e %d PCNT", s_n_isr, s_n_pcnt );
+	for( int f = 0; f < s_n_isr && f < s_n_pcnt; f++ )
+	{
+		const medida_t *isr = &s_isr[f], *pcnt = &s_pcnt[f];
+		//O gerador do LEDC é uma thread do Linux: em 100 kHz ele perde períodos para o escalonador.
+		uint32_t minimo = isr->esperadas / ( isr->frequencia < 100000 ? 2 : 10 );
+		VERIFICA( isr->bordas >= minimo && pcnt->bordas >= minimo, "%u Hz: %u bordas (ISR) e %u (PCNT), esperadas %u",
+				  isr->frequencia, isr->bordas, pcnt->bordas, isr->esperadas );
+		VERIFICA( isr->interrupcoes == isr->bordas, "%u Hz: %u interrupcoes para %u bordas na ISR", isr->frequencia,
+				  isr->interrupcoes, isr->bordas );
+		//Uma interrupção a cada 10000 bordas.
+		VERIFICA( pcnt->interrupcoes <= pcnt->bordas / 10000, "%u Hz: %u interrupcoes do PCNT para %u bordas",
+				  pcnt->frequencia, pcnt->interrupcoes, pcnt->bordas );
+		VERIFICA( pcnt->cpu_centesimos < isr->cpu_centesimos || isr->cpu_centesimos == 0, "%u Hz: CPU %u.%02u%% no PCNT, %u.%02u%% na ISR",
+				  pcnt->frequencia, pcnt->cpu_centesimos / 100, pcnt->cpu_centesimos % 100,
+				  isr->cpu_centesimos / 100, isr->cpu_centesimos % 100 );
+	}
+	VERIFICA( sim_gpio_nivel( BUTTON ) == 1, "BUTTON nao voltou ao repouso" );
+
+	//2. Bordas de descida geradas fora do chip: o total atravessa vários estouros do contador.
+	gpio_config_t entrada = {
+		.pin_bit_mask = 1ULL << BUTTON,
+		.mode = GPIO_MODE_INPUT,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+	};
+	gpio_config( &entrada );
+	const contagem_config_t config = {
+		.pino = BUTTON,
+		.unidade = PCNT_UNIT_0,
+		.subida = PCNT_COUNT_DIS,
+		.descida = PCNT_COUNT_INC,
+		.limite = LIMITE,
+		.limiar = LIMIAR,
+		.notificar = xTaskGetCurrentTaskHandle(),
+	};
+	VERIFICA( contagem_iniciar( &config ) == ESP_OK, "contagem_iniciar" );
+	VERIFICA( contagem_iniciar( &config ) == ESP_ERR_INVALID_STATE, "segunda contagem_iniciar" );
+	VERIFICA( contagem_benchmark( BUTTON, PCNT_UNIT_0, DURACAO_MS ) == ESP_ERR_INVALID_STATE, "benchmark depois do iniciar" );
+	uint64_t anterior = 0;
+	for( int i = 1; i <= BORDAS_MANUAIS; i++ )
+	{
+		sim_gpio_externo( BUTTON, 0 );
+		sim_gpio_externo( BUTTON, 1 );
+		uint64_t total = contagem_total();
+		VERIFICA( total >= anterior, "total voltou de %llu para %llu", (unsigned long long) anterior, (unsigned long long) total );
+		anterior = total;
+		if( i % 64 == 0 )
+			taskYIELD();
+	}
+	vTaskDelay( 2 );
+	uint32_t notificacoes = ulTaskNotifyTake( pdTRUE, 0 );
+	VERIFICA( contagem_total() == BORDAS_MANUAIS, "total %llu (esperado %u)", (unsigned long long) contagem_total(), BORDAS_MANUAIS );
+	//Um estouro e uma passagem pelo limiar a cada LIMITE bordas; notificações seguidas se somam.
+	VERIFICA( notificacoes >= 1 && notificacoes <= 2 * ( BORDAS_MANUAIS / LIMITE ) + 1, "%u notificacoes", notificacoes );
+	printf( "%u bordas manuais: total %llu, %u notificacoes\n", BORDAS_MANUAIS, (unsigned long long) contagem_total(), notificacoes );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
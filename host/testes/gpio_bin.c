@@ -0,0 +1,204 @@
+/*
+	Objetivo: Teste do gpio_bin no build para Linux - fuzz do round-trip gpio_bin_codificar ->
+			  gpio_bin_decodificar com eventos, cortes e lotes aleatórios, limites do codificador e
+			  bytes aleatórios no decodificador
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "gpio_bin.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define FLUXOS			100000
+#define MAX_BLOCOS		8
+#define MAX_BORDAS		40		//Por bloco.
+#define MAX_EVENTOS		( MAX_BLOCOS * MAX_BORDAS )
+#define MAX_FLUXO		( MAX_BLOCOS * ( GPIO_BIN_MAX_REGISTRO * ( MAX_BORDAS + 1 ) ) )
+
+/* Variáveis Globais */
+static uint64_t s_estado;
+static gpio_bin_evento_t s_esperado[MAX_EVENTOS];
+static gpio_bin_evento_t s_obtido[MAX_EVENTOS];
+static uint8_t s_fluxo[MAX_FLUXO];
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* xorshift64*: a semente impressa reproduz a falha (GPIO_BIN_SEMENTE). */
+static uint64_t aleatorio( void )
+{
+	s_estado ^= s_estado >> 12;
+	s_estado ^= s_estado << 25;
+	s_estado ^= s_estado >> 27;
+	return s_estado * 0x2545F4914F6CDD1DULL;
+}
+
+static uint32_t intervalo( uint32_t min, uint32_t max )
+{
+	return min + (uint32_t)( aleatorio() % ( max - min + 1 ) );
+}
+
+/*
+	Entrega o fluxo em pedaços de 1 a 16 bytes, cortando registros no meio, e lê até 1 a 8 bordas por
+	chamada, repetindo com o restante do pedaço. Retorna as bordas decodificadas.
+*/
+static size_t decodifica_em_pedacos( gpio_bin_decodificador_t *d, const uint8_t *fluxo, size_t n )
+{
+	size_t obtidos = 0;
+	size_t i = 0;
+	while( i < n )
+	{
+		size_t pedaco = intervalo( 1, 16 );
+		if( pedaco > n - i )
+			pedaco = n - i;
+		size_t usados = 0;
+		while( usados < pedaco )
+		{
+			size_t consumidos = 0;
+			size_t max = intervalo( 1, 8 );
+			if( max > MAX_EVENTOS - obtidos )
+				max = MAX_EVENTOS - obtidos;
+			size_t lidos = gpio_bin_decodificar( d, fluxo + i + usados, pedaco - usados, s_obtido + obtidos, max, &consumidos );
+			if( lidos > max || consumidos > pedaco - usados || ( lidos < max && consumidos != pedaco - usados ) || max == 0 )
+				return (size_t) -1;
+			obtidos += lidos;
+			usados += consumidos;
+		}
+		i += pedaco;
+	}
+	return obtidos;
+}
+
+/* Um fluxo com vários blocos, cada um começando com sincronismo, como a telemetria e a UART. */
+static size_t gera_fluxo( size_t *n_eventos )
+{
+	static const uint64_t escalas[] = { 1, 100, 100000, 1ULL << 20, 1ULL << 40 };
+	gpio_bin_codificador_t c;
+	gpio_bin_codificador_init( &c );
+	size_t n = 0;
+	size_t eventos = 0;
+	uint64_t instante;
+	switch( intervalo( 0, 2 ) )
+	{
+		case 0:  instante = 0; break;
+		case 1:  instante = (uint32_t) aleatorio(); break;
+		default: instante = aleatorio() >> 1; break;
+	}
+	for( uint32_t b = intervalo( 1, MAX_BLOCOS ); b > 0; b-- )
+	{
+		n += gpio_bin_sincronismo( &c, s_fluxo + n, MAX_FLUXO - n, instante );
+		for( uint32_t k = intervalo( 0, MAX_BORDAS ); k > 0; k-- )
+		{
+			uint64_t escala = escalas[intervalo( 0, sizeof( escalas ) / sizeof( escalas[0] ) - 1 )];
+			uint64_t borda = instante + aleatorio() % escala;
+			//Uma borda fora de ordem é gravada com delta 0, no instante da anterior.
+			if( intervalo( 0, 31 ) == 0 && instante > 0 )
+				borda = instante - 1;
+			else
+				instante = borda;
+			uint8_t pino = intervalo( 0, GPIO_BIN_MAX_PINO );
+			uint8_t nivel = intervalo( 0, 1 );
+			size_t escritos = gpio_bin_codificar( &c, s_fluxo + n, MAX_FLUXO - n, borda, pino, nivel );
+			if( escritos == 0 || escritos > GPIO_BIN_MAX_REGISTRO )
+				return 0;
+			n += escritos;
+			s_esperado[eventos++] = (gpio_bin_evento_t) { .instante_us = instante, .pino = pino, .nivel = nivel };
+		}
+	}
+	*n_eventos = eventos;
+	return n;
+}
+
+static void fuzz_round_trip( uint64_t semente )
+{
+	uint64_t bordas = 0, bytes = 0;
+	for( uint32_t f = 0; f < FLUXOS; f++ )
+	{
+		size_t esperados = 0;
+		size_t n = gera_fluxo( &esperados );
+		gpio_bin_decodificador_t d;
+		gpio_bin_decodificador_init( &d );
+		size_t obtidos = n ? decodifica_em_pedacos( &d, s_fluxo, n ) : (size_t) -1;
+		bool igual = obtidos == esperados && d.erros == 0 && !d.em_registro;
+		for( size_t i = 0; igual && i < esperados; i++ )
+			igual = s_obtido[i].instante_us == s_esperado[i].instante_us && s_obtido[i].pino == s_esperado[i].pino
+					&& s_obtido[i].nivel == s_esperado[i].nivel;
+		if( !igual )
+		{
+			VERIFICA( false, "divergencia no fluxo %u (semente %llu): %zu de %zu bordas, %u erros", f,
+					  (unsigned long long) semente, obtidos, esperados, d.erros );
+			return;
+		}
+		bordas += esperados;
+		bytes += n;
+	}
+	printf( "fuzz: %u fluxos, %llu bordas, %.2f bytes/borda, round-trip ok (semente %llu)\n", FLUXOS,
+			(unsigned long long) bordas, bordas ? (double) bytes / bordas : 0.0, (unsigned long long) semente );
+}
+
+static void limites_codificador( void )
+{
+	gpio_bin_codificador_t c;
+	uint8_t buf[GPIO_BIN_MAX_REGISTRO];
+	gpio_bin_codificador_init( &c );
+	VERIFICA( gpio_bin_sincronismo( &c, buf, sizeof( buf ), 0 ) == 2, "sincronismo em 0" );
+	VERIFICA( gpio_bin_codificar( &c, buf, sizeof( buf ), UINT64_MAX, 3, 1 ) == GPIO_BIN_MAX_REGISTRO, "delta de 64 bits" );
+	VERIFICA( gpio_bin_codificar( &c, buf, sizeof( buf ), 10, GPIO_BIN_MAX_PINO + 1, 1 ) == 0, "pino acima do maximo" );
+
+	//Sem espaço: nada é escrito e o estado não muda.
+	gpio_bin_codificador_init( &c );
+	VERIFICA( gpio_bin_sincronismo( &c, buf, 2, 1000 ) == 0 && c.anterior == 0, "sincronismo sem espaco" );
+	gpio_bin_sincronismo( &c, buf, sizeof( buf ), 1000 );
+	VERIFICA( gpio_bin_codificar( &c, buf, 2, 1000 + ( 1 << 14 ), 1, 0 ) == 0 && c.anterior == 1000, "borda sem espaco" );
+	VERIFICA( gpio_bin_codificar( &c, buf, 3, 1000 + ( 1 << 14 ) - 1, 1, 0 ) == 3, "borda no limite do buffer" );
+}
+
+/* Bytes aleatórios não podem travar o decodificador nem escrever além de "max". */
+static void bytes_aleatorios( void )
+{
+	gpio_bin_decodificador_t d;
+	gpio_bin_decodificador_init( &d );
+	gpio_bin_evento_t eventos[9];
+	uint64_t bordas = 0;
+	for( uint32_t f = 0; f < FLUXOS; f++ )
+	{
+		size_t n = intervalo( 1, 64 );
+		for( size_t i = 0; i < n; i++ )
+			s_fluxo[i] = (uint8_t) aleatorio();
+		size_t usados = 0;
+		while( usados < n )
+		{
+			size_t consumidos = 0;
+			memset( &eventos[8], 0xA5, sizeof( eventos[8] ) );
+			size_t lidos = gpio_bin_decodificar( &d, s_fluxo + usados, n - usados, eventos, 8, &consumidos );
+			if( lidos > 8 || consumidos == 0 || consumidos > n - usados || eventos[8].pino != 0xA5 )
+			{
+				VERIFICA( false, "bytes aleatorios: %zu bordas, %zu consumidos de %zu", lidos, consumidos, n - usados );
+				return;
+			}
+			usados += consumidos;
+			bordas += lidos;
+		}
+	}
+	printf( "bytes aleatorios: %llu bordas, %u erros\n", (unsigned long long) bordas, d.erros );
+}
+
+void app_main( void )
+{
+	const char *texto = getenv( "GPIO_BIN_SEMENTE" );
+	uint64_t semente = texto ? strtoull( texto, NULL, 10 ) : (uint64_t) time( NULL );
+	s_estado = semente ? semente : 1;
+
+	fuzz_round_trip( semente );
+	limites_codificador();
+	bytes_aleatorios();
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
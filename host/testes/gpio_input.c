@@ -0,0 +1,138 @@
+/*
+	Objetivo: Teste do gpio_input no build para Linux - estresse do ring SPSC (gpio_ring.h) com o
+			  produtor e o consumidor em núcleos diferentes, e a inicialização desfeita após uma falha
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "gpio_input.h"
+#include "gpio_ring.h"
+#include "placa.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define CAPACIDADE		64
+#define EVENTOS			1000000
+#define LOTE			8
+#define PINO_INEXISTENTE	20
+
+typedef struct {
+	bool repete;			//true: o produtor tenta de novo quando o ring está cheio (sem descartes).
+	volatile bool fim;
+} produtor_t;
+
+/* Variáveis Globais */
+static gpio_ring_t s_ring;
+static gpio_ring_evento_t s_buffer[CAPACIDADE];
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* O campo ciclos numera as tentativas; pino e nível são derivados dele para detectar leituras rasgadas. */
+static void task_produtor( void *arg )
+{
+	produtor_t *p = arg;
+	for( uint32_t i = 0; i < EVENTOS; i++ )
+	{
+		//Com o ring cheio cede a CPU: no Linux os dois "núcleos" podem dividir um único processador.
+		while( !gpio_ring_push( &s_ring, (uint8_t) i, ( i >> 8 ) & 1, i ) && p->repete )
+			taskYIELD();
+		//Rajadas de 16 bordas, como uma ISR acionada por um sinal rápido.
+		if( i % 16 == 15 )
+			taskYIELD();
+	}
+	p->fim = true;
+	vTaskDelete( NULL );
+}
+
+static void estresse( bool repete )
+{
+	produtor_t p = { .repete = repete };
+	gpio_ring_init( &s_ring, s_buffer, CAPACIDADE );
+	xTaskCreatePinnedToCore( task_produtor, "produtor", 2048, &p, 5, NULL, 1 );
+
+	gpio_ring_evento_t lote[LOTE];
+	uint32_t recebidos = 0, erros = 0, lacunas = 0, ultima_pausa = 0;
+	uint16_t seq = 0;
+	int64_t anterior = -1;
+	while( !p.fim || gpio_ring_pendentes( &s_ring ) )
+	{
+		size_t n = gpio_ring_drenar( &s_ring, lote, LOTE );
+		for( size_t i = 0; i < n; i++ )
+		{
+			const gpio_ring_evento_t *e = &lote[i];
+			//A sequência pula os descartados: a soma das lacunas é o total descartado.
+			lacunas += (uint16_t)( e->seq - seq );
+			if( (int64_t) e->ciclos <= anterior || e->pino != (uint8_t) e->ciclos || e->nivel != ( ( e->ciclos >> 8 ) & 1 ) )
+				erros++;
+			seq = e->seq + 1;
+			anterior = e->ciclos;
+		}
+		recebidos += n;
+		if( n == 0 )
+			taskYIELD();
+		//Sem repetição, o consumidor fica para trás de vez em quando para encher o ring. A pausa cede a
+		//CPU algumas rajadas além da capacidade, e cada lacuna fica bem abaixo do limite da seq de 16 bits.
+		if( !repete && recebidos - ultima_pausa >= 4096 )
+		{
+			for( int k = 0; k < 2 * CAPACIDADE / 16; k++ )
+				taskYIELD();
+			ultima_pausa = recebidos;
+		}
+	}
+
+	uint32_t descartados = gpio_ring_descartados( &s_ring );
+	printf( "%s: %u recebidos, %u descartados, %u erros\n", repete ? "com repeticao" : "sem repeticao",
+			recebidos, descartados, erros );
+	VERIFICA( erros == 0, "%u eventos fora de ordem ou rasgados", erros );
+	VERIFICA( recebidos + descartados == EVENTOS, "%u + %u != %u", recebidos, descartados, EVENTOS );
+	VERIFICA( lacunas == descartados, "lacunas na sequencia somam %u, descartados %u", lacunas, descartados );
+	VERIFICA( !repete || recebidos == EVENTOS, "descartes com repeticao" );
+}
+
+static uint32_t interrupcoes( void )
+{
+	gpio_input_stats_t stats;
+	gpio_input_estatisticas( &stats );
+	return stats.interrupcoes;
+}
+
+/* Uma falha no meio do registro desfaz tudo: sem ISR no BUTTON e uma nova chamada é aceita. */
+static void inicializacao( void )
+{
+	gpio_config_t config = {
+		.pin_bit_mask = 1ULL << BUTTON,
+		.mode = GPIO_MODE_INPUT,
+		.pull_up_en = GPIO_PULLUP_ENABLE,
+	};
+	gpio_config( &config );
+
+	esp_err_t ret = gpio_input_iniciar( ( 1ULL << BUTTON ) | ( 1ULL << PINO_INEXISTENTE ), 16 );
+	VERIFICA( ret != ESP_OK, "GPIO %d aceito", PINO_INEXISTENTE );
+	sim_gpio_externo( BUTTON, 0 );
+	vTaskDelay( 2 );
+	sim_gpio_externo( BUTTON, 1 );
+	vTaskDelay( 2 );
+	VERIFICA( interrupcoes() == 0, "ISR do BUTTON ativa apos a falha (%u)", interrupcoes() );
+
+	ret = gpio_input_iniciar( 1ULL << BUTTON, 16 );
+	VERIFICA( ret == ESP_OK, "nova inicializacao: %s", esp_err_to_name( ret ) );
+	sim_gpio_externo( BUTTON, 0 );
+	gpio_input_evento_t evento;
+	VERIFICA( gpio_input_ler( &evento, 10 ) && evento.pino == BUTTON && evento.nivel == 0, "borda nao entregue" );
+	VERIFICA( gpio_input_iniciar( 1ULL << BUTTON, 16 ) == ESP_ERR_INVALID_STATE, "inicializacao repetida aceita" );
+}
+
+void app_main( void )
+{
+	estresse( false );
+	estresse( true );
+	inicializacao();
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
@@ -0,0 +1,93 @@
+/*
+	Objetivo: Teste do gpio_mask no build para Linux - gpio_mask_benchmark com 1 a 16 pinos livres,
+			  os ciclos por atualização de gpio_set_level e de gpio_write_mask para cada N e o nível
+			  final dos pinos
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "gpio_mask.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define REPETICOES		10000	//Par: a última repetição liga todos os pinos.
+#define MAX_PINOS		16
+
+/* Variáveis Globais */
+//Saídas sem uso na placa: fora do LED RGB, do BUTTON, da flash (6 a 11), da UART0 e dos pinos só de
+//entrada (34 a 39). O GPIO 0 é de strapping, livre após o boot.
+static const gpio_num_t s_pinos[MAX_PINOS] = {
+	GPIO_NUM_2, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_13, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_21,
+	GPIO_NUM_22, GPIO_NUM_23, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_0,
+};
+static const size_t s_quantidades[] = { 1, 2, 4, 8, 12, 16 };
+static uint32_t s_ciclos_set_level;
+static uint32_t s_ciclos_mascara;
+static size_t s_pinos_relatados;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Lê os ciclos da linha de resultado do gpio_mask_benchmark. */
+static int captura_log( const char *formato, va_list args )
+{
+	char linha[160];
+	va_list copia;
+	va_copy( copia, args );
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	const char *resultado = strstr( linha, "gpio_mask: " );
+	unsigned pinos, set_level, mascara;
+	if( resultado && sscanf( resultado, "gpio_mask: %u pinos: gpio_set_level %u ciclos/atualizacao, gpio_write_mask %u",
+							 &pinos, &set_level, &mascara ) == 3 )
+	{
+		s_pinos_relatados = pinos;
+		s_ciclos_set_level = set_level;
+		s_ciclos_mascara = mascara;
+	}
+	return vprintf( formato, args );
+}
+
+void app_main( void )
+{
+	gpio_config_t saidas = { .mode = GPIO_MODE_OUTPUT };
+	for( size_t i = 0; i < MAX_PINOS; i++ )
+		saidas.pin_bit_mask |= 1ULL << s_pinos[i];
+	VERIFICA( gpio_config( &saidas ) == ESP_OK, "gpio_config" );
+
+	esp_log_set_vprintf( captura_log );
+	uint32_t tabela[sizeof( s_quantidades ) / sizeof( s_quantidades[0] )][2];
+	for( size_t q = 0; q < sizeof( s_quantidades ) / sizeof( s_quantidades[0] ); q++ )
+	{
+		size_t n = s_quantidades[q];
+		for( size_t i = 0; i < MAX_PINOS; i++ )
+			gpio_set_level( s_pinos[i], 0 );
+		s_pinos_relatados = 0;
+		gpio_mask_benchmark( s_pinos, n, REPETICOES );
+		VERIFICA( s_pinos_relatados == n, "sem resultado para %zu pinos", n );
+		tabela[q][0] = s_ciclos_set_level;
+		tabela[q][1] = s_ciclos_mascara;
+
+		//A última escrita (repetição ímpar) liga os N primeiros pinos e não toca nos demais.
+		for( size_t i = 0; i < MAX_PINOS; i++ )
+			VERIFICA( sim_gpio_nivel( s_pinos[i] ) == ( i < n ), "%zu pinos: GPIO %d em %d", n, s_pinos[i],
+					  sim_gpio_nivel( s_pinos[i] ) );
+	}
+	esp_log_set_vprintf( vprintf );
+
+	//Ciclos por atualização dos N pinos em cada método (na simulação a máscara ainda propaga pino a pino).
+	printf( "%6s %22s %22s\n", "pinos", "gpio_set_level", "gpio_write_mask" );
+	for( size_t q = 0; q < sizeof( s_quantidades ) / sizeof( s_quantidades[0] ); q++ )
+		printf( "%6zu %15u ciclos %15u ciclos\n", s_quantidades[q], tabela[q][0], tabela[q][1] );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
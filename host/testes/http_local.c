@@ -0,0 +1,414 @@
+/*
+	Objetivo: Teste do http_local no build para Linux - carga com clientes em paralelo sobre sockets
+			  reais (localhost) e conexões persistentes, latência por pedido, limite de conexões (503),
+			  pedidos em sequência no mesmo envio, resposta em blocos, erros, Connection: close e
+			  fechamento por ociosidade
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "esp_timer.h"
+#include "http_local.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define PORTA_BASE			18080
+#define CLIENTES			4		//Igual a max_conexoes: todas as conexões persistentes em uso.
+#define PEDIDOS				500		//Por cliente.
+#define PEDIDOS_SEM_MANTER	200
+#define OCIOSO_MS			1000
+#define TAMANHO_PEDIDO		512
+#define TAMANHO_RESPOSTA	1024
+#define TAMANHO_GRANDE		5000	//Corpo de /grande: maior que o buffer, segue em blocos.
+#define MAX_CORPO			8192
+
+/* Cliente HTTP/1.1 mínimo, com buffer de recepção próprio. */
+typedef struct {
+	int sock;
+	size_t n;
+	char buf[MAX_CORPO];
+} cliente_t;
+
+typedef struct {
+	int status;
+	bool blocos;				//Transfer-Encoding: chunked.
+	bool manter;				//Connection: keep-alive.
+	size_t tamanho;
+	char corpo[MAX_CORPO + 1];
+} resposta_t;
+
+typedef struct {
+	int id;
+	uint32_t erros;
+	uint32_t latencias[PEDIDOS];	//us entre o envio e o fim da resposta.
+} carga_t;
+
+/* Variáveis Globais */
+static uint16_t s_porta;
+static carga_t s_carga[CLIENTES];
+static SemaphoreHandle_t s_fim_carga;
+static volatile uint32_t s_estado;		//Pedidos atendidos por /estado.
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static void rota_estado( const http_local_req_t *req, void *arg )
+{
+	http_local_printf( "{\"n\":%u}", ++s_estado );
+}
+
+/* Devolve o parâmetro "v" (consulta ou corpo), já decodificado. */
+static void rota_eco( const http_local_req_t *req, void *arg )
+{
+	char valor[64];
+	if( !http_local_parametro( req, "v", valor, sizeof( valor ) ) )
+	{
+		http_local_status( 400, "text/plain" );
+		http_local_printf( "sem v\n" );
+		return;
+	}
+	http_local_status( 200, "text/plain" );
+	http_local_printf( "%s", valor );
+}
+
+static void rota_grande( const http_local_req_t *req, void *arg )
+{
+	http_local_status( 200, "text/plain" );
+	for( int i = 0; i < TAMANHO_GRANDE; i++ )
+		http_local_printf( "%c", 'a' + i % 26 );
+}
+
+static void rota_http( const http_local_req_t *req, void *arg )
+{
+	http_local_json_estatisticas();
+}
+
+static bool conecta( cliente_t *c )
+{
+	struct sockaddr_in endereco = {
+		.sin_family = AF_INET,
+		.sin_port = htons( s_porta ),
+		.sin_addr.s_addr = htonl( INADDR_LOOPBACK ),
+	};
+	struct timeval timeout = { .tv_sec = 5 };
+	int um = 1;
+	c->n = 0;
+	c->sock = socket( AF_INET, SOCK_STREAM, IPPROTO_IP );
+	if( c->sock < 0 )
+		return false;
+	setsockopt( c->sock, IPPROTO_TCP, TCP_NODELAY, &um, sizeof( um ) );
+	setsockopt( c->sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof( timeout ) );
+	if( connect( c->sock, (struct sockaddr*) &endereco, sizeof( endereco ) ) != 0 )
+	{
+		close( c->sock );
+		c->sock = -1;
+		return false;
+	}
+	return true;
+}
+
+static void desconecta( cliente_t *c )
+{
+	if( c->sock >= 0 )
+		close( c->sock );
+	c->sock = -1;
+}
+
+static bool envia( cliente_t *c, const char *texto )
+{
+	size_t tamanho = strlen( texto );
+	while( tamanho )
+	{
+		ssize_t n = send( c->sock, texto, tamanho, 0 );
+		if( n <= 0 )
+			return false;
+		texto += n;
+		tamanho -= n;
+	}
+	return true;
+}
+
+/* Recebe mais bytes no buffer. Retorna false com a conexão fechada, erro ou timeout. */
+static bool recebe( cliente_t *c )
+{
+	if( c->n >= sizeof( c->buf ) )
+		return false;
+	ssize_t n = recv( c->sock, c->buf + c->n, sizeof( c->buf ) - c->n, 0 );
+	if( n <= 0 )
+		return false;
+	c->n += n;
+	return true;
+}
+
+/* Retira "tamanho" bytes do início do buffer (NULL: descarta). */
+static bool retira( cliente_t *c, char *destino, size_t tamanho )
+{
+	while( c->n < tamanho )
+		if( !recebe( c ) )
+			return false;
+	if( destino )
+		memcpy( destino, c->buf, tamanho );
+	c->n -= tamanho;
+	memmove( c->buf, c->buf + tamanho, c->n );
+	return true;
+}
+
+/* Linha até o "\r\n", sem ele. */
+static bool linha( cliente_t *c, char *destino, size_t tamanho )
+{
+	char *fim;
+	while( ( fim = memmem( c->buf, c->n, "\r\n", 2 ) ) == NULL )
+		if( !recebe( c ) )
+			return false;
+	size_t n = fim - c->buf;
+	if( n >= tamanho )
+		return false;
+	retira( c, destino, n + 2 );
+	destino[n] = '\0';
+	return true;
+}
+
+/* Lê uma resposta completa: linha de status, cabeçalhos e corpo (Content-Length ou chunked). */
+static bool le_resposta( cliente_t *c, resposta_t *r )
+{
+	char texto[256];
+	size_t comprimento = 0;
+	memset( r, 0, offsetof( resposta_t, corpo ) );
+	if( !linha( c, texto, sizeof( texto ) ) || sscanf( texto, "HTTP/1.1 %d", &r->status ) != 1 )
+		return false;
+	while( linha( c, texto, sizeof( texto ) ) && texto[0] )
+	{
+		if( strncasecmp( texto, "Content-Length:", 15 ) == 0 )
+			comprimento = strtoul( texto + 15, NULL, 10 );
+		else if( strcasecmp( texto, "Transfer-Encoding: chunked" ) == 0 )
+			r->blocos = true;
+		else if( strcasecmp( texto, "Connection: keep-alive" ) == 0 )
+			r->manter = true;
+	}
+	if( texto[0] )
+		return false;
+	if( !r->blocos )
+	{
+		if( comprimento > MAX_CORPO || !retira( c, r->corpo, comprimento ) )
+			return false;
+		r->tamanho = comprimento;
+	}
+	else
+	{
+		while( 1 )
+		{
+			if( !linha( c, texto, sizeof( texto ) ) )
+				return false;
+			size_t bloco = strtoul( texto, NULL, 16 );
+			if( bloco == 0 )
+				break;
+			if( r->tamanho + bloco > MAX_CORPO || !retira( c, r->corpo + r->tamanho, bloco ) || !retira( c, NULL, 2 ) )
+				return false;
+			r->tamanho += bloco;
+		}
+		if( !retira( c, NULL, 2 ) )
+			return false;
+	}
+	r->corpo[r->tamanho] = '\0';
+	return true;
+}
+
+/* Um pedido em uma conexão nova; "fechada" indica se o servidor fechou após a resposta. */
+static bool pedido_unico( const char *pedido, resposta_t *r, bool *fechada )
+{
+	cliente_t c;
+	if( !conecta( &c ) )
+		return false;
+	bool ok = envia( &c, pedido ) && le_resposta( &c, r );
+	if( fechada )
+		*fechada = ok && c.n == 0 && !recebe( &c );
+	desconecta( &c );
+	return ok;
+}
+
+/* Cliente da carga: PEDIDOS GET /estado em sequência na mesma conexão. */
+static void task_cliente( void *arg )
+{
+	carga_t *carga = arg;
+	static resposta_t respostas[CLIENTES];
+	static cliente_t clientes[CLIENTES];
+	resposta_t *r = &respostas[carga->id];
+	cliente_t *c = &clientes[carga->id];
+
+	if( !conecta( c ) )
+		carga->erros = PEDIDOS;
+	for( int i = 0; i < PEDIDOS && c->sock >= 0; i++ )
+	{
+		int64_t inicio = esp_timer_get_time();
+		if( !envia( c, "GET /estado HTTP/1.1\r\nHost: esp32\r\n\r\n" ) || !le_resposta( c, r ) )
+		{
+			carga->erros += PEDIDOS - i;
+			break;
+		}
+		carga->latencias[i] = (uint32_t)( esp_timer_get_time() - inicio );
+		if( r->status != 200 || !r->manter || strncmp( r->corpo, "{\"n\":", 5 ) != 0 )
+			carga->erros++;
+	}
+	desconecta( c );
+	xSemaphoreGive( s_fim_carga );
+	vTaskDelete( NULL );
+}
+
+static int compara( const void *a, const void *b )
+{
+	uint32_t x = *(const uint32_t*) a, y = *(const uint32_t*) b;
+	return x < y ? -1 : x > y;
+}
+
+static void carga( void )
+{
+	static uint32_t todas[CLIENTES * PEDIDOS];
+	http_local_stats_t antes, depois;
+	http_local_estatisticas( &antes );
+	s_fim_carga = xSemaphoreCreateCounting( CLIENTES, 0 );
+
+	int64_t inicio = esp_timer_get_time();
+	for( int i = 0; i < CLIENTES; i++ )
+	{
+		s_carga[i].id = i;
+		xTaskCreatePinnedToCore( task_cliente, "cliente", 4096, &s_carga[i], 5, NULL, i % 2 );
+	}
+	for( int i = 0; i < CLIENTES; i++ )
+		xSemaphoreTake( s_fim_carga, portMAX_DELAY );
+	int64_t duracao_us = esp_timer_get_time() - inicio;
+	http_local_estatisticas( &depois );
+
+	uint32_t erros = 0;
+	for( int i = 0; i < CLIENTES; i++ )
+	{
+		erros += s_carga[i].erros;
+		memcpy( &todas[i * PEDIDOS], s_carga[i].latencias, sizeof( s_carga[i].latencias ) );
+	}
+	qsort( todas, CLIENTES * PEDIDOS, sizeof( todas[0] ), compara );
+	VERIFICA( erros == 0, "carga: %u pedidos com erro", erros );
+	VERIFICA( depois.pedidos - antes.pedidos == CLIENTES * PEDIDOS && depois.conexoes - antes.conexoes == CLIENTES
+			  && depois.recusadas == antes.recusadas, "carga: %u pedidos em %u conexoes, %u recusadas",
+			  depois.pedidos - antes.pedidos, depois.conexoes - antes.conexoes, depois.recusadas - antes.recusadas );
+	printf( "carga: %d clientes x %d pedidos persistentes, %.0f pedidos/s, latencia p50 %u us, p90 %u us, p99 %u us, max %u us\n",
+			CLIENTES, PEDIDOS, CLIENTES * PEDIDOS * 1e6 / duracao_us, todas[CLIENTES * PEDIDOS / 2],
+			todas[CLIENTES * PEDIDOS * 90 / 100], todas[CLIENTES * PEDIDOS * 99 / 100], todas[CLIENTES * PEDIDOS - 1] );
+}
+
+/* A mesma rota com uma conexão nova por pedido, para comparar com as persistentes. */
+static void sem_manter( void )
+{
+	static uint32_t latencias[PEDIDOS_SEM_MANTER];
+	static resposta_t r;
+	uint32_t erros = 0;
+	for( int i = 0; i < PEDIDOS_SEM_MANTER; i++ )
+	{
+		bool fechada;
+		int64_t inicio = esp_timer_get_time();
+		if( !pedido_unico( "GET /estado HTTP/1.1\r\nConnection: close\r\n\r\n", &r, &fechada ) || r.status != 200
+			|| r.manter || !fechada )
+			erros++;
+		latencias[i] = (uint32_t)( esp_timer_get_time() - inicio );
+	}
+	qsort( latencias, PEDIDOS_SEM_MANTER, sizeof( latencias[0] ), compara );
+	VERIFICA( erros == 0, "Connection: close: %u pedidos com erro", erros );
+	printf( "conexao nova por pedido: latencia p50 %u us, p99 %u us\n", latencias[PEDIDOS_SEM_MANTER / 2],
+			latencias[PEDIDOS_SEM_MANTER * 99 / 100] );
+}
+
+void app_main( void )
+{
+	static resposta_t r;
+	static cliente_t abertas[CLIENTES], extra;
+	s_porta = PORTA_BASE + getpid() % 1000;		//Execuções em paralelo não disputam a porta.
+	http_local_rota( HTTP_LOCAL_GET, "/estado", rota_estado, NULL );
+	http_local_rota( HTTP_LOCAL_POST | HTTP_LOCAL_PUT, "/eco", rota_eco, NULL );
+	http_local_rota( HTTP_LOCAL_GET, "/grande", rota_grande, NULL );
+	http_local_rota( HTTP_LOCAL_GET, "/http", rota_http, NULL );
+	const http_local_config_t config = {
+		.porta = s_porta,
+		.max_conexoes = CLIENTES,
+		.tamanho_pedido = TAMANHO_PEDIDO,
+		.tamanho_resposta = TAMANHO_RESPOSTA,
+		.ocioso_ms = OCIOSO_MS,
+		.prioridade = 4,
+		.nucleo = 0,
+	};
+	VERIFICA( http_local_iniciar( &config ) == ESP_OK, "http_local_iniciar" );
+	vTaskDelay( 100 / portTICK_PERIOD_MS );		//Socket escutando.
+
+	//1. Carga: todas as conexões persistentes em uso ao mesmo tempo.
+	carga();
+	sem_manter();
+
+	//2. Limite: com as conexões ocupadas, a seguinte recebe 503 e é fechada.
+	http_local_stats_t antes, depois;
+	http_local_estatisticas( &antes );
+	bool ok = true;
+	for( int i = 0; i < CLIENTES; i++ )
+		ok = ok && conecta( &abertas[i] ) && envia( &abertas[i], "GET /estado HTTP/1.1\r\n\r\n" )
+			&& le_resposta( &abertas[i], &r ) && r.status == 200;
+	VERIFICA( ok, "conexoes persistentes abertas" );
+	ok = conecta( &extra ) && le_resposta( &extra, &r );
+	VERIFICA( ok && r.status == 503 && !recebe( &extra ), "conexao alem do limite: status %d", r.status );
+	desconecta( &extra );
+	http_local_estatisticas( &depois );
+	VERIFICA( depois.recusadas == antes.recusadas + 1, "%u recusadas", depois.recusadas - antes.recusadas );
+
+	//3. Dois pedidos no mesmo envio, com o corpo do POST codificado.
+	ok = envia( &abertas[0], "POST /eco HTTP/1.1\r\nContent-Length: 11\r\n\r\nv=ola+mundo"
+							 "PUT /eco?v=%7Bx%7D HTTP/1.1\r\n\r\n" );
+	VERIFICA( ok && le_resposta( &abertas[0], &r ) && r.status == 200 && strcmp( r.corpo, "ola mundo" ) == 0,
+			  "primeiro pedido em sequencia: %d \"%s\"", r.status, r.corpo );
+	VERIFICA( le_resposta( &abertas[0], &r ) && r.status == 200 && strcmp( r.corpo, "{x}" ) == 0,
+			  "segundo pedido em sequencia: %d \"%s\"", r.status, r.corpo );
+
+	//4. Resposta maior que o buffer: segue em blocos e chega inteira.
+	ok = envia( &abertas[1], "GET /grande HTTP/1.1\r\n\r\n" ) && le_resposta( &abertas[1], &r );
+	bool igual = ok && r.tamanho == TAMANHO_GRANDE;
+	for( int i = 0; igual && i < TAMANHO_GRANDE; i++ )
+		igual = r.corpo[i] == 'a' + i % 26;
+	VERIFICA( igual && r.blocos && r.manter, "resposta em blocos: %zu bytes, chunked %d", r.tamanho, r.blocos );
+
+	//5. Erros: a conexão continua para 404 e 405; o pedido malformado e o grande demais a fecham.
+	ok = envia( &abertas[2], "GET /nada HTTP/1.1\r\n\r\n" ) && le_resposta( &abertas[2], &r ) && r.status == 404
+		&& envia( &abertas[2], "GET /eco HTTP/1.1\r\n\r\n" ) && le_resposta( &abertas[2], &r ) && r.status == 405
+		&& envia( &abertas[2], "POST /eco HTTP/1.1\r\nContent-Length: 0\r\n\r\n" ) && le_resposta( &abertas[2], &r )
+		&& r.status == 400;
+	VERIFICA( ok, "404, 405 e 400 da rota na mesma conexao (status %d)", r.status );
+	ok = envia( &abertas[3], "LIXO\r\n\r\n" ) && le_resposta( &abertas[3], &r ) && r.status == 400 && !recebe( &abertas[3] );
+	VERIFICA( ok, "pedido malformado: status %d", r.status );
+	char grande[TAMANHO_PEDIDO + 64];
+	snprintf( grande, sizeof( grande ), "GET /estado HTTP/1.1\r\nX: %0*d\r\n\r\n", TAMANHO_PEDIDO, 0 );
+	ok = pedido_unico( grande, &r, NULL ) && r.status == 413;
+	VERIFICA( ok, "pedido maior que o buffer: status %d", r.status );
+	for( int i = 0; i < CLIENTES; i++ )
+		desconecta( &abertas[i] );
+
+	//6. Ociosidade: a conexão sem pedidos é fechada pelo servidor após OCIOSO_MS.
+	http_local_estatisticas( &antes );
+	int64_t inicio = esp_timer_get_time();
+	ok = conecta( &extra ) && !recebe( &extra );
+	int32_t fechada_ms = (int32_t)( ( esp_timer_get_time() - inicio ) / 1000 );
+	desconecta( &extra );
+	http_local_estatisticas( &depois );
+	VERIFICA( ok && fechada_ms >= OCIOSO_MS && depois.ociosas == antes.ociosas + 1,
+			  "conexao ociosa fechada em %d ms (%u)", fechada_ms, depois.ociosas - antes.ociosas );
+
+	//7. A rota de diagnóstico conta os pedidos atendidos.
+	ok = pedido_unico( "GET /http HTTP/1.1\r\n\r\n", &r, NULL ) && r.status == 200 && strstr( r.corpo, "\"pedidos\":" );
+	VERIFICA( ok, "rota de diagnostico: %s", r.corpo );
+
+	http_local_relatorio();
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
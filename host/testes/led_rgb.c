@@ -0,0 +1,143 @@
+/*
+	Objetivo: Teste do led_rgb no build para Linux - linha do tempo do duty de cada canal do LEDC
+			  simulado: troca imediata, fade dos três canais, padrões de status, substituição da
+			  animação em curso e a CPU da task durante os fades
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include "led_rgb.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define MODO			LEDC_HIGH_SPEED_MODE
+#define DUTY_MAX		8191		//13 bits.
+#define TOLERANCIA_US	15000		//Tick de 10 ms mais o escalonamento do Linux.
+#define MAX_PONTOS		256
+
+/* Variáveis Globais */
+static sim_ledc_ponto_t s_pontos[MAX_PONTOS];
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static uint32_t duty_de( uint8_t cor )
+{
+	return (uint32_t) cor * DUTY_MAX / 255;
+}
+
+/* Pontos do canal registrados a partir de "desde" (us); retorna quantos, copiados para s_pontos. */
+static size_t linha_desde( int canal, int64_t desde )
+{
+	static sim_ledc_ponto_t todos[4096];
+	size_t total = sim_ledc_linha( MODO, canal, todos, 4096 );
+	size_t n = 0;
+	for( size_t i = 0; i < total && i < 4096 && n < MAX_PONTOS; i++ )
+		if( todos[i].instante_us >= desde )
+			s_pontos[n++] = todos[i];
+	return n;
+}
+
+static uint32_t cpu_da_task( const char *nome )
+{
+	TaskStatus_t tasks[32];
+	UBaseType_t n = uxTaskGetSystemState( tasks, 32, NULL );
+	for( UBaseType_t i = 0; i < n; i++ )
+		if( strcmp( tasks[i].pcTaskName, nome ) == 0 )
+			return tasks[i].ulRunTimeCounter;
+	return 0;
+}
+
+void app_main( void )
+{
+	VERIFICA( led_rgb_cor( 1, 2, 3, 0 ) == ESP_ERR_INVALID_STATE, "cor antes do iniciar" );
+	VERIFICA( led_rgb_iniciar( LEDC_TIMER_13_BIT, 20000, 5 ) == ESP_ERR_INVALID_ARG, "20 kHz com 13 bits aceito" );
+	VERIFICA( led_rgb_iniciar( LEDC_TIMER_13_BIT, 5000, 5 ) == ESP_OK, "led_rgb_iniciar" );
+
+	//1. Troca imediata: um ponto sem fade no vermelho, nenhum nos canais que já estavam em 0.
+	int64_t t0 = esp_timer_get_time();
+	led_rgb_cor( 255, 0, 0, 0 );
+	vTaskDelay( 50 / portTICK_PERIOD_MS );
+	size_t n = linha_desde( 0, t0 );
+	VERIFICA( n == 1 && s_pontos[0].duty == DUTY_MAX && s_pontos[0].duracao_ms == 0, "troca imediata: %zu pontos", n );
+	VERIFICA( linha_desde( 1, t0 ) == 0 && linha_desde( 2, t0 ) == 0, "canais apagados reescritos" );
+
+	//2. Fade de 500 ms dos três canais, iniciados juntos; no meio, metade do caminho.
+	t0 = esp_timer_get_time();
+	led_rgb_cor( 0, 255, 128, 500 );
+	vTaskDelay( 250 / portTICK_PERIOD_MS );
+	uint8_t meio[3];
+	led_rgb_atual( meio );
+	vTaskDelay( 300 / portTICK_PERIOD_MS );
+	const uint32_t destinos[3] = { 0, DUTY_MAX, duty_de( 128 ) };
+	int64_t inicio[3];
+	for( int c = 0; c < 3; c++ )
+	{
+		n = linha_desde( c, t0 );
+		VERIFICA( n == 1 && s_pontos[0].duty_final == destinos[c] && s_pontos[0].duracao_ms == 500,
+				  "fade do canal %d: %zu pontos, final %u", c, n, n ? s_pontos[0].duty_final : 0 );
+		inicio[c] = n ? s_pontos[0].instante_us : 0;
+		int64_t meio_fade = inicio[c] + 250000;
+		uint32_t esperado = ( s_pontos[0].duty + s_pontos[0].duty_final ) / 2;
+		VERIFICA( abs( (int) sim_ledc_duty_em( MODO, c, meio_fade ) - (int) esperado ) <= 20, "duty no meio do fade" );
+	}
+	VERIFICA( llabs( inicio[0] - inicio[2] ) < 2000 && llabs( inicio[1] - inicio[2] ) < 2000, "fades desencontrados" );
+	printf( "meio do fade: r=%u g=%u b=%u\n", meio[0], meio[1], meio[2] );
+	VERIFICA( abs( meio[0] - 128 ) <= 16 && abs( meio[1] - 128 ) <= 16 && abs( meio[2] - 64 ) <= 12, "cor no meio do fade" );
+
+	//3. Falha: vermelho 200 ms aceso e 800 ms apagado.
+	led_rgb_cor( 0, 0, 0, 0 );
+	vTaskDelay( 50 / portTICK_PERIOD_MS );
+	t0 = esp_timer_get_time();
+	led_rgb_padrao( LED_RGB_FALHA );
+	vTaskDelay( 3100 / portTICK_PERIOD_MS );
+	n = linha_desde( 0, t0 );
+	VERIFICA( n >= 6, "falha: %zu pontos em 3 s", n );
+	for( size_t i = 1; i < n; i++ )
+	{
+		int64_t intervalo = s_pontos[i].instante_us - s_pontos[i - 1].instante_us;
+		int64_t esperado = s_pontos[i - 1].duty ? 200000 : 800000;
+		VERIFICA( s_pontos[i].duty == ( s_pontos[i - 1].duty ? 0 : DUTY_MAX ) && llabs( intervalo - esperado ) < TOLERANCIA_US,
+				  "piscada %zu: %lld us com duty %u", i, (long long) intervalo, s_pontos[i - 1].duty );
+	}
+
+	//4. Conectando: azul respirando (fades de 1 s entre 255 e 16), sem CPU da task durante os fades.
+	t0 = esp_timer_get_time();
+	led_rgb_padrao( LED_RGB_CONECTANDO );
+	vTaskDelay( 100 / portTICK_PERIOD_MS );
+	uint32_t cpu_inicio = cpu_da_task( "task_led_rgb" );
+	int64_t inicio_cpu = esp_timer_get_time();
+	vTaskDelay( 4000 / portTICK_PERIOD_MS );
+	uint32_t cpu = cpu_da_task( "task_led_rgb" ) - cpu_inicio;
+	int64_t janela = esp_timer_get_time() - inicio_cpu;
+	n = linha_desde( 2, t0 );
+	VERIFICA( n >= 4 && n <= 6, "respiracao: %zu fades em 4 s", n );
+	for( size_t i = 0; i < n; i++ )
+		VERIFICA( s_pontos[i].duracao_ms == 1000 && s_pontos[i].duty_final == duty_de( i % 2 ? 16 : 255 ),
+				  "fade %zu da respiracao: final %u", i, s_pontos[i].duty_final );
+	for( size_t i = 1; i < n; i++ )
+		VERIFICA( llabs( s_pontos[i].instante_us - s_pontos[i - 1].instante_us - 1000000 ) < TOLERANCIA_US, "fades fora do ritmo" );
+	printf( "respiracao: %zu fades, CPU da task %u us em %lld ms\n", n, cpu, (long long) janela / 1000 );
+	VERIFICA( cpu * 1000 < janela, "task_led_rgb usou %u us de CPU (mais de 0,1%%)", cpu );
+
+	//5. Duas animações seguidas durante um fade: só a última é aplicada, no fim do fade em curso.
+	int64_t pedido = esp_timer_get_time();
+	led_rgb_cor( 0, 255, 0, 0 );
+	led_rgb_cor( 255, 255, 255, 0 );
+	vTaskDelay( 1200 / portTICK_PERIOD_MS );
+	n = linha_desde( 1, pedido );
+	VERIFICA( n == 1 && s_pontos[0].duty == DUTY_MAX, "verde: %zu pontos", n );
+	VERIFICA( n == 0 || s_pontos[0].instante_us - pedido <= 1000000 + TOLERANCIA_US, "substituicao atrasou" );
+	n = linha_desde( 0, pedido );
+	VERIFICA( n == 1 && s_pontos[0].duty == DUTY_MAX, "cor intermediaria aplicada (vermelho: %zu pontos)", n );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
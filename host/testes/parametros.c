@@ -0,0 +1,260 @@
+/*
+	Objetivo: Teste do parametros no build para Linux - migração do esquema, leituras da cópia em RAM
+			  contra a NVS (latência e acessos ao emulador) e escritas na flash por alteração: rajada
+			  agrupada em uma gravação, alteração revertida, intervalo mínimo e restauração do padrão
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "nvs_flash.h"
+#include "parametros.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define VERSAO				2
+#define ATRASO_MS			200
+#define INTERVALO_MIN_MS	1000
+#define LEITURAS			100000
+#define RAJADA				100
+#define CHAVE_ANTIGA		"tent_antiga"	//Nome de PARAM_TENTATIVAS na versão 1 do esquema.
+
+enum {
+	PARAM_TENTATIVAS = 0,
+	PARAM_SSID,
+	PARAM_IP,
+	NUM_PARAMETROS
+};
+
+/* Variáveis Globais */
+static const parametros_def_t s_tabela[NUM_PARAMETROS] = {
+	[PARAM_TENTATIVAS] = { "tentativas", PARAMETROS_INT,   .padrao = 5, .minimo = 0, .maximo = 1000 },
+	[PARAM_SSID]       = { "ssid",       PARAMETROS_TEXTO, .padrao_texto = "myssid", .maximo = 32 },
+	[PARAM_IP]         = { "ip_fixo",    PARAMETROS_IP4,   .padrao_texto = "10.0.0.145" },
+};
+static uint32_t s_migracoes;
+static uint32_t s_avisos;
+static bool s_rajada_relatada;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Versão 1 -> 2: "tent_antiga" passa a se chamar "tentativas". */
+static esp_err_t migra( uint16_t versao_antiga, nvs_handle_t nvs )
+{
+	int32_t valor;
+	s_migracoes++;
+	if( versao_antiga != 1 || nvs_get_i32( nvs, CHAVE_ANTIGA, &valor ) != ESP_OK )
+		return ESP_OK;
+	esp_err_t ret = nvs_set_i32( nvs, "tentativas", valor );
+	if( ret == ESP_OK )
+		ret = nvs_erase_key( nvs, CHAVE_ANTIGA );
+	return ret;
+}
+
+static void alterado( int id, void *arg )
+{
+	s_avisos++;
+}
+
+static int captura_log( const char *formato, va_list args )
+{
+	char linha[256];
+	va_list copia;
+	va_copy( copia, args );
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	if( strstr( linha, "Rajada de" ) )
+		s_rajada_relatada = true;
+	return vprintf( formato, args );
+}
+
+static int32_t nvs_int( const char *chave, esp_err_t *ret )
+{
+	nvs_handle_t nvs;
+	int32_t valor = 0;
+	*ret = nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READONLY, &nvs );
+	if( *ret == ESP_OK )
+	{
+		*ret = nvs_get_i32( nvs, chave, &valor );
+		nvs_close( nvs );
+	}
+	return valor;
+}
+
+/* Esquema da versão 1 gravado por um firmware anterior, com "ssid" de outro tipo. */
+static void grava_versao_antiga( void )
+{
+	nvs_handle_t nvs;
+	nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READWRITE, &nvs );
+	nvs_set_u16( nvs, "_versao", 1 );
+	nvs_set_i32( nvs, CHAVE_ANTIGA, 7 );
+	nvs_set_i32( nvs, "ssid", 1234 );
+	nvs_commit( nvs );
+	nvs_close( nvs );
+}
+
+/* Latência de uma leitura (ns) pela cópia em RAM e direto da NVS, e leituras que chegam ao emulador. */
+static void leituras( void )
+{
+	nvs_handle_t nvs;
+	nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READONLY, &nvs );
+	sim_nvs_stats_t antes, ram, direto;
+	volatile int32_t valor;
+	int32_t lido;
+
+	sim_nvs_estatisticas( &antes );
+	int64_t inicio = esp_timer_get_time();
+	for( int i = 0; i < LEITURAS; i++ )
+		valor = parametros_int( PARAM_TENTATIVAS );
+	int64_t ram_us = esp_timer_get_time() - inicio;
+	sim_nvs_estatisticas( &ram );
+
+	inicio = esp_timer_get_time();
+	for( int i = 0; i < LEITURAS; i++ )
+	{
+		nvs_get_i32( nvs, "tentativas", &lido );
+		valor = lido;
+	}
+	int64_t nvs_us = esp_timer_get_time() - inicio;
+	sim_nvs_estatisticas( &direto );
+	nvs_close( nvs );
+	(void) valor;
+
+	VERIFICA( ram.leituras == antes.leituras, "%u leituras da NVS pela copia em RAM", ram.leituras - antes.leituras );
+	VERIFICA( direto.leituras - ram.leituras == LEITURAS, "%u leituras diretas contadas", direto.leituras - ram.leituras );
+	VERIFICA( ram_us < nvs_us, "RAM %lld us, NVS %lld us", (long long) ram_us, (long long) nvs_us );
+	printf( "leitura: RAM %.1f ns, NVS %.1f ns (%d leituras)\n", ram_us * 1000.0 / LEITURAS, nvs_us * 1000.0 / LEITURAS,
+			LEITURAS );
+}
+
+void app_main( void )
+{
+	nvs_flash_erase();
+	nvs_flash_init();
+	grava_versao_antiga();
+
+	//1. Migração: a chave renomeada é lida, a de outro tipo volta ao padrão e a versão nova é gravada.
+	const parametros_config_t config = {
+		.tabela = s_tabela,
+		.n = NUM_PARAMETROS,
+		.versao = VERSAO,
+		.migrar = migra,
+		.atraso_ms = ATRASO_MS,
+		.intervalo_min_ms = INTERVALO_MIN_MS,
+	};
+	VERIFICA( parametros_iniciar( &config ) == ESP_OK, "parametros_iniciar" );
+	VERIFICA( parametros_iniciar( &config ) == ESP_ERR_INVALID_STATE, "segunda inicializacao aceita" );
+	char texto[PARAMETROS_MAX_TEXTO + 1];
+	parametros_texto( PARAM_SSID, texto, sizeof( texto ) );
+	VERIFICA( s_migracoes == 1 && parametros_int( PARAM_TENTATIVAS ) == 7, "migracao: %u chamadas, tentativas %d",
+			  s_migracoes, parametros_int( PARAM_TENTATIVAS ) );
+	VERIFICA( strcmp( texto, "myssid" ) == 0, "ssid de outro tipo: \"%s\"", texto );
+	VERIFICA( parametros_ip4( PARAM_IP ) == ESP_IP4TOADDR( 10, 0, 0, 145 ), "IP padrao" );
+	parametros_assinar( PARAMETROS_TODOS, alterado, NULL );
+
+	//2. Validação: tipo errado, fora dos limites e texto longo demais não alteram nada.
+	VERIFICA( parametros_definir_int( PARAM_TENTATIVAS, 1001 ) == ESP_ERR_INVALID_ARG, "INT acima do maximo" );
+	VERIFICA( parametros_definir_int( PARAM_SSID, 1 ) == ESP_ERR_INVALID_ARG, "INT em um TEXTO" );
+	VERIFICA( parametros_definir_texto( PARAM_TENTATIVAS, "12x" ) == ESP_ERR_INVALID_ARG, "INT com lixo" );
+	VERIFICA( parametros_definir_texto( PARAM_IP, "10.0.0" ) == ESP_ERR_INVALID_ARG, "IP incompleto" );
+	VERIFICA( parametros_definir_texto( PARAM_SSID, "123456789012345678901234567890123" ) == ESP_ERR_INVALID_ARG,
+			  "SSID com 33 caracteres" );
+	VERIFICA( s_avisos == 0, "%u avisos sem alteracao", s_avisos );
+
+	//3. Leituras: a cópia em RAM não acessa a NVS.
+	leituras();
+
+	//4. Rajada: 101 alterações dentro da janela viram uma gravação de uma chave; direto na NVS, uma por alteração.
+	parametros_stats_t antes, depois;
+	sim_nvs_stats_t nvs;
+	parametros_estatisticas( &antes );
+	sim_nvs_zera_estatisticas();
+	for( int i = 0; i < RAJADA; i++ )
+		parametros_definir_int( PARAM_TENTATIVAS, i % 2 ? 7 : 100 );
+	parametros_definir_int( PARAM_TENTATIVAS, 100 );
+	sim_nvs_estatisticas( &nvs );
+	VERIFICA( nvs.commits == 0 && nvs.escritas == 0, "gravacao antes do fim da janela" );
+	vTaskDelay( 2 * ATRASO_MS / portTICK_PERIOD_MS );
+	sim_nvs_estatisticas( &nvs );
+	parametros_estatisticas( &depois );
+	esp_err_t ret;
+	VERIFICA( nvs.commits == 1 && nvs.escritas == 1 && nvs.entradas_escritas == 1,
+			  "rajada: %u commits, %u escritas, %u entradas", nvs.commits, nvs.escritas, nvs.entradas_escritas );
+	VERIFICA( depois.alteracoes - antes.alteracoes == RAJADA + 1 && s_avisos == RAJADA + 1,
+			  "%u alteracoes, %u avisos", depois.alteracoes - antes.alteracoes, s_avisos );
+	VERIFICA( nvs_int( "tentativas", &ret ) == 100 && ret == ESP_OK, "valor gravado" );
+	printf( "rajada de %d alteracoes: %u commit, %u entrada escrita (%.3f escritas por alteracao)\n", RAJADA + 1,
+			nvs.commits, nvs.entradas_escritas, (double) nvs.escritas / ( RAJADA + 1 ) );
+
+	nvs_handle_t handle;
+	nvs_open( PARAMETROS_NVS_NAMESPACE, NVS_READWRITE, &handle );
+	sim_nvs_zera_estatisticas();
+	for( int i = 0; i <= RAJADA; i++ )
+	{
+		nvs_set_i32( handle, "_direto", i % 2 ? 7 : 100 );
+		nvs_commit( handle );
+	}
+	nvs_erase_key( handle, "_direto" );
+	nvs_commit( handle );
+	nvs_close( handle );
+	sim_nvs_estatisticas( &nvs );
+	VERIFICA( nvs.entradas_escritas == RAJADA + 1, "direto: %u entradas", nvs.entradas_escritas );
+	printf( "mesma rajada direto na NVS: %u commits, %u entradas escritas\n", nvs.commits - 1, nvs.entradas_escritas );
+
+	//5. Alteração revertida dentro da janela: a gravação agendada não escreve nada.
+	vTaskDelay( INTERVALO_MIN_MS / portTICK_PERIOD_MS );
+	sim_nvs_zera_estatisticas();
+	parametros_definir_int( PARAM_TENTATIVAS, 50 );
+	parametros_definir_int( PARAM_TENTATIVAS, 100 );
+	vTaskDelay( 2 * ATRASO_MS / portTICK_PERIOD_MS );
+	sim_nvs_estatisticas( &nvs );
+	VERIFICA( nvs.commits == 0 && nvs.escritas == 0, "alteracao revertida gravada (%u escritas)", nvs.escritas );
+
+	//6. Intervalo mínimo: logo após uma gravação, a seguinte espera INTERVALO_MIN_MS.
+	parametros_definir_texto( PARAM_IP, "192.168.0.10" );
+	VERIFICA( parametros_ip4( PARAM_IP ) == ESP_IP4TOADDR( 192, 168, 0, 10 ), "IP em texto" );
+	VERIFICA( parametros_gravar() == ESP_OK, "parametros_gravar" );
+	int64_t gravacao = esp_timer_get_time();
+	sim_nvs_zera_estatisticas();
+	parametros_definir_texto( PARAM_SSID, "rede_2" );
+	vTaskDelay( 2 * ATRASO_MS / portTICK_PERIOD_MS );
+	sim_nvs_estatisticas( &nvs );
+	VERIFICA( nvs.commits == 0, "gravacao antes do intervalo minimo" );
+	while( nvs.commits == 0 && esp_timer_get_time() - gravacao < 3 * INTERVALO_MIN_MS * 1000 )
+	{
+		vTaskDelay( 10 / portTICK_PERIOD_MS );
+		sim_nvs_estatisticas( &nvs );
+	}
+	int32_t intervalo_ms = (int32_t)( ( esp_timer_get_time() - gravacao ) / 1000 );
+	VERIFICA( nvs.commits == 1 && intervalo_ms >= INTERVALO_MIN_MS, "segunda gravacao apos %d ms", intervalo_ms );
+
+	//7. Restauração: a RAM volta ao padrão e a chave sai da NVS.
+	sim_nvs_zera_estatisticas();
+	parametros_restaurar( PARAM_TENTATIVAS );
+	VERIFICA( parametros_int( PARAM_TENTATIVAS ) == 5, "padrao restaurado na RAM" );
+	parametros_gravar();
+	sim_nvs_estatisticas( &nvs );
+	nvs_int( "tentativas", &ret );
+	VERIFICA( nvs.apagamentos == 1 && ret == ESP_ERR_NVS_NOT_FOUND, "chave restaurada na NVS (%s)", esp_err_to_name( ret ) );
+
+	//8. O benchmark do ESP32 também roda aqui e devolve o valor original.
+	esp_log_set_vprintf( captura_log );
+	parametros_benchmark( PARAM_TENTATIVAS, PARAM_SSID, RAJADA );
+	parametros_relatorio();
+	esp_log_set_vprintf( vprintf );
+	nvs_int( "_bench", &ret );
+	VERIFICA( s_rajada_relatada && parametros_int( PARAM_TENTATIVAS ) == 5 && ret == ESP_ERR_NVS_NOT_FOUND,
+			  "benchmark: relatorio %d, tentativas %d", s_rajada_relatada, parametros_int( PARAM_TENTATIVAS ) );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
@@ -0,0 +1,144 @@
+/*
+	Objetivo: Teste do perfil no build para Linux - uso de CPU de uma task com carga conhecida, folga
+			  de pilha, prioridade, núcleo e as estatísticas de uma ISR no relatório JSON
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "perfil.h"
+#include "simulacao.h"
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY
+
+/* Definições e Constantes */
+#define PILHA_USADA		8192
+//Pedida pela task_pilha: o buffer mais o que a libc e o simulador usam no x86-64, que passa de 8 KB
+//sem otimização (CMAKE_BUILD_TYPE=Debug).
+#define PILHA_TESTE		( PILHA_USADA + 24576 )
+#define CICLOS_ISR		1600
+#define ENTRADAS_ISR	100
+
+typedef struct {
+	unsigned cpu, pilha, prio;
+	int nucleo;
+} task_t;
+
+/* Variáveis Globais */
+static SemaphoreHandle_t s_relatorio;
+static char s_json[2048];
+static unsigned s_n_relatorios;
+static perfil_isr_t s_isr = { .nome = "isr_teste" };
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Saída do log: guarda a última linha do perfil e repassa tudo ao terminal. */
+static int captura_log( const char *formato, va_list args )
+{
+	va_list copia;
+	va_copy( copia, args );
+	char linha[sizeof( s_json )];
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	const char *json = strstr( linha, "perfil: {" );
+	if( json )
+	{
+		strlcpy( s_json, json + strlen( "perfil: " ), sizeof( s_json ) );
+		s_n_relatorios++;
+		xSemaphoreGive( s_relatorio );
+	}
+	return vprintf( formato, args );
+}
+
+/* 10 ms de CPU a cada 20 ms: metade de um núcleo, 250 décimos de % dos dois. */
+static void task_carga( void *arg )
+{
+	TickType_t ultimo = xTaskGetTickCount();
+	while( 1 )
+	{
+		int64_t fim = esp_timer_get_time() + 10000;
+		while( esp_timer_get_time() < fim )
+			;
+		vTaskDelayUntil( &ultimo, 20 / portTICK_PERIOD_MS );
+	}
+}
+
+static void task_pilha( void *arg )
+{
+	volatile uint8_t buffer[PILHA_USADA];
+	memset( (void*) buffer, 1, sizeof( buffer ) );
+	vTaskDelay( portMAX_DELAY );
+}
+
+static void task_ociosa( void *arg )
+{
+	vTaskDelay( portMAX_DELAY );
+}
+
+static bool procura_task( const char *nome, task_t *t )
+{
+	char chave[48];
+	snprintf( chave, sizeof( chave ), "{\"nome\":\"%s\",", nome );
+	const char *p = strstr( s_json, chave );
+	return p && sscanf( p + strlen( chave ), "\"cpu\":%u,\"pilha\":%u,\"prio\":%u,\"nucleo\":%d",
+						&t->cpu, &t->pilha, &t->prio, &t->nucleo ) == 4;
+}
+
+void app_main( void )
+{
+	s_relatorio = xSemaphoreCreateCounting( 16, 0 );
+	esp_log_set_vprintf( captura_log );
+	xTaskCreatePinnedToCore( task_carga, "carga", 4096, NULL, 3, NULL, 1 );
+	xTaskCreatePinnedToCore( task_pilha, "pilha", PILHA_TESTE, NULL, 2, NULL, 0 );
+	xTaskCreatePinnedToCore( task_ociosa, "ociosa", 2048, NULL, 4, NULL, tskNO_AFFINITY );
+
+	perfil_registrar_isr( &s_isr );
+	for( int i = 0; i < ENTRADAS_ISR; i++ )
+		perfil_isr_saida( &s_isr, xthal_get_ccount() - CICLOS_ISR );
+
+	VERIFICA( perfil_iniciar( 1 ) == ESP_ERR_INVALID_ARG, "periodo menor que um tick aceito" );
+	VERIFICA( perfil_iniciar( 1000 ) == ESP_OK, "perfil_iniciar falhou" );
+	//O primeiro relatório cobre desde o boot; o terceiro mede um período inteiro com a carga estável.
+	while( s_n_relatorios < 3 )
+		VERIFICA( xSemaphoreTake( s_relatorio, 3000 / portTICK_PERIOD_MS ), "sem relatorio" );
+
+	task_t carga, pilha, ociosa, perfil;
+	VERIFICA( procura_task( "carga", &carga ) && procura_task( "pilha", &pilha ) && procura_task( "ociosa", &ociosa )
+			  && procura_task( "task_perfil", &perfil ), "tasks ausentes: %s", s_json );
+	printf( "carga: cpu %u, ociosa: cpu %u, pilha: folga %u de %u\n", carga.cpu, ociosa.cpu, pilha.pilha, PILHA_TESTE );
+	VERIFICA( carga.cpu >= 200 && carga.cpu <= 300, "cpu da carga %u (esperado ~250)", carga.cpu );
+	VERIFICA( ociosa.cpu <= 5, "cpu da task ociosa %u", ociosa.cpu );
+	VERIFICA( pilha.pilha > 0 && pilha.pilha <= PILHA_TESTE - PILHA_USADA, "folga de pilha %u", pilha.pilha );
+	VERIFICA( carga.prio == 3 && carga.nucleo == 1 && pilha.nucleo == 0 && ociosa.nucleo == -1 && perfil.nucleo == -1,
+			  "prioridade ou nucleo errados" );
+
+	unsigned n, med, max;
+	const char *isr = strstr( s_json, "{\"nome\":\"isr_teste\"," );
+	VERIFICA( isr && sscanf( isr, "{\"nome\":\"isr_teste\",\"n\":%u,\"med\":%u,\"max\":%u}", &n, &med, &max ) == 3,
+			  "isr ausente" );
+	VERIFICA( n == ENTRADAS_ISR && med >= CICLOS_ISR && med < CICLOS_ISR + 400 && max >= med,
+			  "isr: n=%u med=%u max=%u", n, med, max );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
+
+#else
+
+/* Build sem o trace facility: o perfil não é suportado. */
+void app_main( void )
+{
+	esp_err_t ret = perfil_iniciar( 1000 );
+	printf( "perfil_iniciar sem CONFIG_FREERTOS_USE_TRACE_FACILITY: %s\n", esp_err_to_name( ret ) );
+	sim_encerrar( ret == ESP_ERR_NOT_SUPPORTED ? 0 : 1 );
+}
+
+#endif
@@ -0,0 +1,124 @@
+/*
+	Objetivo: Teste do rede_ip no build para Linux - modo híbrido: DHCP dentro do timeout sem fallback,
+			  fallback para o IP fixo com o servidor lento e a concessão tardia substituindo o IP fixo
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+#include "rede_ip.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define TIMEOUT_DHCP_MS		500
+#define ESPERA_MS			5000
+
+/* Variáveis Globais */
+static esp_netif_t *s_netif;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+/* Aguarda a origem do IP satisfazer "aceita". Retorna o tempo em ms, ou -1. */
+static int32_t espera_origem( bool ( *aceita )( rede_ip_origem_t ), uint32_t max_ms )
+{
+	int64_t inicio = esp_timer_get_time();
+	while( esp_timer_get_time() - inicio < (int64_t) max_ms * 1000 )
+	{
+		if( aceita( rede_ip_origem() ) )
+			return (int32_t)( ( esp_timer_get_time() - inicio ) / 1000 );
+		vTaskDelay( 10 / portTICK_PERIOD_MS );
+	}
+	return -1;
+}
+
+static bool por_dhcp( rede_ip_origem_t origem )
+{
+	return origem == REDE_IP_ORIGEM_DHCP || origem == REDE_IP_ORIGEM_CONCESSAO;
+}
+
+static bool por_fallback( rede_ip_origem_t origem )
+{
+	return origem == REDE_IP_ORIGEM_FALLBACK;
+}
+
+static uint32_t ip_atual( void )
+{
+	esp_netif_ip_info_t ip = { 0 };
+	esp_netif_get_ip_info( s_netif, &ip );
+	return ip.ip.addr;
+}
+
+/* Nova associação ao AP, com o servidor DHCP respondendo após "atraso_ms" (negativo: nunca). */
+static void reconecta( int32_t atraso_ms )
+{
+	esp_wifi_disconnect();
+	vTaskDelay( 100 / portTICK_PERIOD_MS );
+	sim_wifi_dhcp_atraso_ms( atraso_ms );
+	esp_wifi_connect();
+}
+
+void app_main( void )
+{
+	nvs_flash_erase();
+	nvs_flash_init();
+	esp_netif_init();
+	esp_event_loop_create_default();
+	s_netif = esp_netif_create_default_wifi_sta();
+	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+	esp_wifi_init( &cfg );
+
+	rede_ip_config_t rede = { .modo = REDE_IP_HIBRIDO, .timeout_dhcp_ms = TIMEOUT_DHCP_MS };
+	VERIFICA( rede_ip_endereco( "10.0.0.145", "255.255.255.0", "10.0.0.1", &rede.estatico ) == ESP_OK, "rede_ip_endereco" );
+	VERIFICA( rede_ip_iniciar( s_netif, &rede ) == ESP_OK, "rede_ip_iniciar" );
+	const uint32_t fixo = rede.estatico.ip.addr;
+	const uint32_t concessao = ESP_IP4TOADDR( 10, 0, 0, 100 );		//Servidor DHCP simulado.
+
+	wifi_config_t wifi = { 0 };
+	snprintf( (char*) wifi.sta.ssid, sizeof( wifi.sta.ssid ), "%s", CONFIG_ESP_WIFI_SSID );
+	snprintf( (char*) wifi.sta.password, sizeof( wifi.sta.password ), "%s", CONFIG_ESP_WIFI_PASSWORD );
+	esp_wifi_set_mode( WIFI_MODE_STA );
+	esp_wifi_start();
+	esp_wifi_set_config( ESP_IF_WIFI_STA, &wifi );
+
+	//1. DHCP dentro do timeout: o disparo do fallback é cancelado e o IP fixo nunca é aplicado.
+	sim_wifi_dhcp_atraso_ms( 100 );
+	esp_wifi_connect();
+	int32_t ms = espera_origem( por_dhcp, ESPERA_MS );
+	VERIFICA( ms >= 0, "sem IP pelo DHCP" );
+	vTaskDelay( 2 * TIMEOUT_DHCP_MS / portTICK_PERIOD_MS );
+	VERIFICA( por_dhcp( rede_ip_origem() ) && ip_atual() == concessao, "fallback depois do DHCP (%s)",
+			  rede_ip_nome_origem( rede_ip_origem() ) );
+
+	//2. Servidor lento: o IP fixo entra no timeout e a concessão tardia o substitui.
+	reconecta( 3 * TIMEOUT_DHCP_MS );
+	int64_t inicio = esp_timer_get_time();
+	ms = espera_origem( por_fallback, ESPERA_MS );
+	int32_t fallback_ms = (int32_t)( ( esp_timer_get_time() - inicio ) / 1000 );
+	VERIFICA( ms >= 0 && ip_atual() == fixo, "sem fallback para o IP fixo" );
+	VERIFICA( fallback_ms >= TIMEOUT_DHCP_MS, "fallback em %d ms, antes do timeout", fallback_ms );
+	ms = espera_origem( por_dhcp, ESPERA_MS );
+	VERIFICA( ms >= 0 && ip_atual() == concessao, "concessao tardia nao substituiu o IP fixo (%s)",
+			  rede_ip_nome_origem( rede_ip_origem() ) );
+	printf( "fallback em %d ms, concessao tardia %d ms depois\n", fallback_ms, ms );
+
+	//3. Servidor fora do ar: o IP fixo fica até a queda, e a associação seguinte espera o DHCP de novo.
+	reconecta( -1 );
+	VERIFICA( espera_origem( por_fallback, ESPERA_MS ) >= 0, "sem fallback com o servidor fora do ar" );
+	vTaskDelay( 1000 / portTICK_PERIOD_MS );
+	VERIFICA( por_fallback( rede_ip_origem() ) && ip_atual() == fixo, "IP fixo perdido sem concessao" );
+	reconecta( 100 );
+	VERIFICA( espera_origem( por_dhcp, ESPERA_MS ) >= 0 && ip_atual() == concessao, "sem DHCP apos o fallback" );
+
+	rede_ip_relatorio();
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
@@ -0,0 +1,138 @@
+/*
+	Objetivo: Teste do tarefas no build para Linux - com CONFIG_TAREFAS_ESTATICO nenhuma alocação do
+			  heap após tarefas_selar() (tasks, fila, mutex, grupo de eventos e ISR de GPIO em uso), a
+			  task temporária de tarefas_isr_gpio fora da área estática e a criação após o selo recusada
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "driver/gpio.h"
+#include "esp_log.h"
+#include "tarefas.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define PINO			4
+#define DURACAO_MS		2000
+#define BIT_EVENTO		BIT0
+
+/* Variáveis Globais */
+static QueueHandle_t s_fila;
+static SemaphoreHandle_t s_mutex;
+static EventGroupHandle_t s_grupo;
+static volatile bool s_fim;
+static volatile uint32_t s_bordas;
+static uint32_t s_recebidos;
+static bool s_subsistema_tarefas;		//Linha do subsistema "tarefas" no relatório.
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static void isr_borda( void *arg )
+{
+	uint32_t nivel = gpio_get_level( PINO );
+	xQueueSendFromISR( s_fila, &nivel, NULL );
+}
+
+/* Gera bordas no pino, como um sinal externo. */
+static void task_sinal( void *arg )
+{
+	int nivel = 0;
+	while( !s_fim )
+	{
+		nivel = !nivel;
+		sim_gpio_externo( PINO, nivel );
+		s_bordas++;
+		vTaskDelay( 1 );
+	}
+	vTaskDelete( NULL );
+}
+
+/* Consome as bordas da ISR usando a fila, o mutex e o grupo de eventos criados antes do selo. */
+static void task_consumidor( void *arg )
+{
+	uint32_t nivel;
+	while( 1 )
+	{
+		if( xQueueReceive( s_fila, &nivel, 10 / portTICK_PERIOD_MS ) != pdTRUE )
+			continue;
+		xSemaphoreTake( s_mutex, portMAX_DELAY );
+		s_recebidos++;
+		xSemaphoreGive( s_mutex );
+		xEventGroupSetBits( s_grupo, BIT_EVENTO );
+	}
+}
+
+static int captura_log( const char *formato, va_list args )
+{
+	char linha[160];
+	va_list copia;
+	va_copy( copia, args );
+	vsnprintf( linha, sizeof( linha ), formato, copia );
+	va_end( copia );
+	if( strstr( linha, "  tarefas " ) )
+		s_subsistema_tarefas = true;
+	return vprintf( formato, args );
+}
+
+void app_main( void )
+{
+	//A task temporária da instalação roda e some sem deixar a pilha na área estática. A interrupção do
+	//pino é habilitada no núcleo de quem chama gpio_config: o mesmo da task main.
+	VERIFICA( tarefas_isr_gpio( PRO_CPU_NUM, 0 ) == ESP_OK, "tarefas_isr_gpio" );
+	VERIFICA( tarefas_nucleo_isr_gpio() == PRO_CPU_NUM, "nucleo da ISR %d", tarefas_nucleo_isr_gpio() );
+
+	s_fila = tarefas_fila( "teste", 64, sizeof( uint32_t ) );
+	s_mutex = tarefas_mutex( "teste" );
+	s_grupo = tarefas_grupo( "teste" );
+	VERIFICA( s_fila && s_mutex && s_grupo, "objetos na area estatica" );
+	const gpio_config_t pino = {
+		.pin_bit_mask = 1ULL << PINO,
+		.mode = GPIO_MODE_INPUT,
+		.intr_type = GPIO_INTR_ANYEDGE,
+	};
+	gpio_config( &pino );
+	gpio_isr_handler_add( PINO, isr_borda, NULL );
+	const tarefas_t tabela[] = {
+		{ task_consumidor, "consumidor", 2048, 6, APP_CPU_NUM, NULL, NULL },
+		{ task_sinal, "sinal", 2048, 5, PRO_CPU_NUM, NULL, NULL },
+	};
+	VERIFICA( tarefas_criar( tabela, sizeof( tabela ) / sizeof( tabela[0] ) ) == ESP_OK, "tarefas_criar" );
+
+	//Fim da inicialização: daqui em diante o heap não pode ser tocado.
+	vTaskDelay( 100 / portTICK_PERIOD_MS );
+	tarefas_selar();
+	sim_heap_stats_t antes, depois;
+	sim_heap_estatisticas( &antes );
+	vTaskDelay( DURACAO_MS / portTICK_PERIOD_MS );
+	sim_heap_estatisticas( &depois );
+	s_fim = true;
+
+	EventBits_t bits = xEventGroupWaitBits( s_grupo, BIT_EVENTO, pdTRUE, pdFALSE, 0 );
+	VERIFICA( s_recebidos > 0 && ( bits & BIT_EVENTO ), "nenhuma borda consumida (%u geradas)", s_bordas );
+	VERIFICA( depois.alocacoes == antes.alocacoes && depois.liberacoes == antes.liberacoes,
+			  "%u alocacoes e %u liberacoes apos o selo", depois.alocacoes - antes.alocacoes,
+			  depois.liberacoes - antes.liberacoes );
+	VERIFICA( depois.livre == antes.livre, "heap livre %zu -> %zu", antes.livre, depois.livre );
+	VERIFICA( tarefas_apos_selar() == 0, "%u criacoes apos o selo", tarefas_apos_selar() );
+	printf( "%u bordas geradas, %u consumidas; heap apos o selo: %u alocacoes, %zu bytes livres\n", s_bordas,
+			s_recebidos, depois.alocacoes - antes.alocacoes, depois.livre );
+
+	esp_log_set_vprintf( captura_log );
+	tarefas_relatorio();
+	esp_log_set_vprintf( vprintf );
+	VERIFICA( !s_subsistema_tarefas, "pilha da task temporaria da ISR ficou na area estatica" );
+
+	//Com a área estática, uma criação após o selo falha em vez de ir ao heap.
+	VERIFICA( tarefas_fila( "teste", 4, sizeof( uint32_t ) ) == NULL && tarefas_apos_selar() == 1,
+			  "criacao apos o selo aceita" );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
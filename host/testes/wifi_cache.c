@@ -0,0 +1,166 @@
+/*
+	Objetivo: Teste do wifi_cache no build para Linux - conexão com varredura completa, conexão rápida
+			  pelo AP salvo, regravação evitada, cache mantido em uma queda após o IP e fallback quando o
+			  AP salvo some
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+#include "wifi_cache.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define ESPERA_MAX		( 3000 / portTICK_PERIOD_MS )
+
+typedef struct {
+	int32_t id;
+	uint8_t motivo;			//WIFI_EVENT_STA_DISCONNECTED.
+} evento_t;
+
+/* Variáveis Globais */
+static const uint8_t AP_1[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x01 };
+static const uint8_t AP_2[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x02 };
+static QueueHandle_t s_eventos;
+static wifi_config_t s_config;
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static void trata_evento( void *arg, esp_event_base_t base, int32_t id, void *dados )
+{
+	evento_t evento = { .id = base == IP_EVENT ? -id - 1 : id };	//IDs de IP_EVENT negativos.
+	if( base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED )
+		evento.motivo = ( (wifi_event_sta_disconnected_t*) dados )->reason;
+	xQueueSend( s_eventos, &evento, 0 );
+}
+
+/* Aguarda o GOT_IP ou a falha da conexão. Retorna o tempo até o IP (us) ou -1 com o motivo da falha. */
+static int64_t conecta( uint8_t *motivo )
+{
+	xQueueReset( s_eventos );
+	esp_wifi_set_config( ESP_IF_WIFI_STA, &s_config );
+	int64_t inicio = esp_timer_get_time();
+	esp_wifi_connect();
+	evento_t evento;
+	while( xQueueReceive( s_eventos, &evento, ESPERA_MAX ) )
+	{
+		if( evento.id == -IP_EVENT_STA_GOT_IP - 1 )
+			return esp_timer_get_time() - inicio;
+		if( evento.id == WIFI_EVENT_STA_DISCONNECTED )
+		{
+			*motivo = evento.motivo;
+			return -1;
+		}
+	}
+	*motivo = 0;
+	return -1;
+}
+
+static void desconecta( void )
+{
+	evento_t evento;
+	esp_wifi_disconnect();
+	while( xQueueReceive( s_eventos, &evento, ESPERA_MAX ) && evento.id != WIFI_EVENT_STA_DISCONNECTED )
+		;
+}
+
+/* Configuração inicial de cada boot: SSID e senha, sem AP fixado. */
+static void novo_boot( void )
+{
+	memset( &s_config, 0, sizeof( s_config ) );
+	strlcpy( (char*) s_config.sta.ssid, CONFIG_ESP_WIFI_SSID, sizeof( s_config.sta.ssid ) );
+	strlcpy( (char*) s_config.sta.password, CONFIG_ESP_WIFI_PASSWORD, sizeof( s_config.sta.password ) );
+}
+
+static uint32_t escritas_nvs( void )
+{
+	sim_nvs_stats_t stats;
+	sim_nvs_estatisticas( &stats );
+	return stats.escritas;
+}
+
+void app_main( void )
+{
+	nvs_flash_erase();
+	nvs_flash_init();
+	esp_netif_init();
+	esp_event_loop_create_default();
+	esp_netif_create_default_wifi_sta();
+	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+	esp_wifi_init( &cfg );
+	s_eventos = xQueueCreate( 16, sizeof( evento_t ) );
+	esp_event_handler_register( WIFI_EVENT, ESP_EVENT_ANY_ID, trata_evento, NULL );
+	esp_event_handler_register( IP_EVENT, IP_EVENT_STA_GOT_IP, trata_evento, NULL );
+	esp_wifi_set_mode( WIFI_MODE_STA );
+	esp_wifi_start();
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP_1, 6, -50 );
+	sim_wifi_ap( "outra_rede", "senha", AP_2, 1, -40 );
+
+	//1. Primeiro boot: sem cache, varredura completa.
+	uint8_t motivo;
+	novo_boot();
+	VERIFICA( wifi_cache_aplicar( &s_config ) == ESP_ERR_NOT_FOUND && !wifi_cache_em_uso(), "cache antes de salvar" );
+	int64_t completa = conecta( &motivo );
+	VERIFICA( completa > 0, "sem IP na varredura completa (motivo %u)", motivo );
+	uint32_t escritas = escritas_nvs();
+	VERIFICA( wifi_cache_salvar() == ESP_OK && escritas_nvs() == escritas + 1, "AP nao salvo" );
+	VERIFICA( wifi_cache_salvar() == ESP_OK && escritas_nvs() == escritas + 1, "mesmo AP regravado" );
+	desconecta();
+
+	//2. Boot seguinte: direto no canal e BSSID salvos.
+	novo_boot();
+	VERIFICA( wifi_cache_aplicar( &s_config ) == ESP_OK && wifi_cache_em_uso(), "cache nao aplicado" );
+	VERIFICA( s_config.sta.bssid_set && memcmp( s_config.sta.bssid, AP_1, 6 ) == 0 && s_config.sta.channel == 6,
+			  "BSSID ou canal errados" );
+	sim_wifi_stats_t stats;
+	sim_wifi_estatisticas( &stats );
+	uint32_t rapidas = stats.conexoes_rapidas;
+	int64_t rapida = conecta( &motivo );
+	sim_wifi_estatisticas( &stats );
+	VERIFICA( rapida > 0 && stats.conexoes_rapidas == rapidas + 1, "conexao rapida falhou (motivo %u)", motivo );
+	VERIFICA( rapida < completa, "conexao rapida (%lld us) nao mais curta que a completa (%lld us)",
+			  (long long) rapida, (long long) completa );
+	printf( "boot ate o IP: varredura completa %lld ms, AP salvo %lld ms\n", (long long) completa / 1000,
+			(long long) rapida / 1000 );
+	wifi_cache_salvar();
+	VERIFICA( escritas_nvs() == escritas + 1, "AP inalterado regravado" );
+	VERIFICA( wifi_cache_em_uso(), "conexao pelo cache esquecida apos o IP" );
+	//Uma queda depois do IP não é falha do AP salvo: o cache continua na NVS.
+	desconecta();
+	VERIFICA( wifi_cache_fallback( &s_config ) == ESP_ERR_INVALID_STATE && s_config.sta.bssid_set,
+			  "queda apos o IP apagou o cache" );
+
+	//3. O AP salvo foi trocado por outro, no canal 11: a conexão rápida falha e o fallback varre tudo.
+	sim_wifi_remove_ap( AP_1 );
+	const uint8_t AP_3[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x03 };
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP_3, 11, -60 );
+	novo_boot();
+	VERIFICA( wifi_cache_aplicar( &s_config ) == ESP_OK, "cache perdido na queda" );
+	VERIFICA( conecta( &motivo ) < 0 && motivo == WIFI_REASON_NO_AP_FOUND, "AP salvo ausente: motivo %u", motivo );
+	VERIFICA( wifi_cache_fallback( &s_config ) == ESP_OK && !s_config.sta.bssid_set && s_config.sta.channel == 0
+			  && !wifi_cache_em_uso(), "fallback nao restaurou a varredura completa" );
+	VERIFICA( wifi_cache_fallback( &s_config ) == ESP_ERR_INVALID_STATE, "segundo fallback aceito" );
+	VERIFICA( conecta( &motivo ) > 0, "sem IP apos o fallback (motivo %u)", motivo );
+	wifi_cache_salvar();
+	novo_boot();
+	VERIFICA( wifi_cache_aplicar( &s_config ) == ESP_OK && memcmp( s_config.sta.bssid, AP_3, 6 ) == 0
+			  && s_config.sta.channel == 11, "novo AP nao salvo" );
+
+	//4. Cache de outro SSID não é usado.
+	strlcpy( (char*) s_config.sta.ssid, "outra_rede", sizeof( s_config.sta.ssid ) );
+	s_config.sta.bssid_set = false;
+	VERIFICA( wifi_cache_aplicar( &s_config ) == ESP_ERR_NOT_FOUND && !s_config.sta.bssid_set, "cache de outro SSID" );
+
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
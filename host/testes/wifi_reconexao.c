@@ -0,0 +1,169 @@
+/*
+	Objetivo: Teste do wifi_reconexao no build para Linux - quedas repetidas com o AP ausente: primeira
+			  tentativa imediata, atraso base << (falhas - 2) limitado ao teto, jitter na metade superior
+			  e os bits de conexão e de falha do grupo de eventos
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "soc/soc.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+#include "wifi_reconexao.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define BIT_CONECTADO		BIT0
+#define BIT_FALHA			BIT1
+#define BASE_MS				100
+#define TETO_MS				800
+#define TENTATIVAS_FALHA	4
+#define FALHAS				8		//Quedas registradas antes de o AP aparecer.
+#define VARREDURA_MS		30		//Conexão sem o AP no canal fixado: um canal varrido (host/simulacao/wifi.c).
+#define TOLERANCIA_MS		50		//Atraso do escalonador do Linux além do atraso sorteado.
+#define ESPERA_MS			5000
+
+/* Variáveis Globais */
+static const uint8_t AP[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x08 };
+static EventGroupHandle_t s_grupo;
+static volatile uint32_t s_quedas;			//Eventos STA_DISCONNECTED recebidos.
+//Por queda: as FALHAS iniciais e a primeira após o IP.
+static int64_t s_instante[FALHAS + 1];		//Instante (us) da queda.
+static bool s_imediata[FALHAS + 1];			//esp_wifi_connect() feito dentro do wifi_reconexao_desconectado.
+static EventBits_t s_bits[FALHAS + 1];		//Bits do grupo após a queda.
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static uint32_t conexoes( void )
+{
+	sim_wifi_stats_t stats;
+	sim_wifi_estatisticas( &stats );
+	return stats.conexoes;
+}
+
+/* Handlers como os do EX05/EX06, registrando o instante e o efeito de cada queda. */
+static void trata_evento( void *arg, esp_event_base_t base, int32_t id, void *dados )
+{
+	if( base == WIFI_EVENT && id == WIFI_EVENT_STA_DISCONNECTED )
+	{
+		uint32_t antes = conexoes();
+		wifi_reconexao_desconectado();
+		uint32_t n = s_quedas;
+		if( n <= FALHAS )
+		{
+			s_instante[n] = esp_timer_get_time();
+			s_imediata[n] = conexoes() != antes;
+			s_bits[n] = xEventGroupGetBits( s_grupo );
+		}
+		s_quedas = n + 1;
+	}
+	else if( base == IP_EVENT && id == IP_EVENT_STA_GOT_IP )
+		wifi_reconexao_conectado();
+}
+
+static bool espera_quedas( uint32_t n )
+{
+	int64_t inicio = esp_timer_get_time();
+	while( s_quedas < n )
+	{
+		if( esp_timer_get_time() - inicio > (int64_t) ESPERA_MS * 1000 )
+			return false;
+		vTaskDelay( 10 / portTICK_PERIOD_MS );
+	}
+	return true;
+}
+
+void app_main( void )
+{
+	nvs_flash_erase();
+	nvs_flash_init();
+	esp_netif_init();
+	esp_event_loop_create_default();
+	esp_netif_create_default_wifi_sta();
+	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+	esp_wifi_init( &cfg );
+	esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, trata_evento, NULL );
+	esp_event_handler_register( IP_EVENT, IP_EVENT_STA_GOT_IP, trata_evento, NULL );
+
+	s_grupo = xEventGroupCreate();
+	const wifi_reconexao_config_t reconexao = {
+		.grupo = s_grupo,
+		.bit_conectado = BIT_CONECTADO,
+		.bit_falha = BIT_FALHA,
+		.tentativas_falha = TENTATIVAS_FALHA,
+		.atraso_base_ms = BASE_MS,
+		.atraso_teto_ms = TETO_MS,
+	};
+	VERIFICA( wifi_reconexao_iniciar( &reconexao ) == ESP_OK, "wifi_reconexao_iniciar" );
+
+	//Nenhum AP no ar e o canal e o BSSID fixados: cada tentativa falha (NO_AP_FOUND) em VARREDURA_MS.
+	sim_wifi_remove_todos();
+	wifi_config_t wifi = { 0 };
+	strlcpy( (char*) wifi.sta.ssid, CONFIG_ESP_WIFI_SSID, sizeof( wifi.sta.ssid ) );
+	strlcpy( (char*) wifi.sta.password, CONFIG_ESP_WIFI_PASSWORD, sizeof( wifi.sta.password ) );
+	memcpy( wifi.sta.bssid, AP, sizeof( AP ) );
+	wifi.sta.bssid_set = true;
+	wifi.sta.channel = 6;
+	wifi.sta.scan_method = WIFI_FAST_SCAN;
+	esp_wifi_set_mode( WIFI_MODE_STA );
+	esp_wifi_start();
+	esp_wifi_set_config( ESP_IF_WIFI_STA, &wifi );
+	esp_wifi_connect();
+	VERIFICA( espera_quedas( FALHAS ), "%u quedas de %u", s_quedas, FALHAS );
+
+	//1. Primeira tentativa imediata; as seguintes agendadas pelo timer.
+	VERIFICA( s_imediata[0], "primeira tentativa agendada" );
+	for( uint32_t i = 1; i < FALHAS; i++ )
+		VERIFICA( !s_imediata[i], "tentativa apos a falha %u imediata", i + 1 );
+
+	//2. Falha n (n >= 2): atraso sorteado entre a metade e base << (n - 2), limitado ao teto.
+	printf( "%6s %10s %14s\n", "falha", "atraso", "faixa (ms)" );
+	for( uint32_t i = 1; i + 1 < FALHAS; i++ )
+	{
+		uint32_t falha = i + 1;
+		uint32_t atraso = (uint32_t) BASE_MS << ( falha - 2 );
+		if( atraso > TETO_MS )
+			atraso = TETO_MS;
+		int32_t medido = (int32_t)( ( s_instante[i + 1] - s_instante[i] ) / 1000 ) - VARREDURA_MS;
+		printf( "%6u %7d ms %6u a %4u\n", falha, medido, atraso / 2, atraso );
+		VERIFICA( medido >= (int32_t)( atraso / 2 ) && medido <= (int32_t)( atraso + TOLERANCIA_MS ),
+				  "falha %u: atraso %d ms fora de [%u, %u]", falha, medido, atraso / 2, atraso );
+	}
+
+	//3. Bits: sem conexão desde a primeira queda e falha sinalizada a partir de TENTATIVAS_FALHA.
+	for( uint32_t i = 0; i < FALHAS; i++ )
+		VERIFICA( !( s_bits[i] & BIT_CONECTADO ) && !!( s_bits[i] & BIT_FALHA ) == ( i + 1 >= TENTATIVAS_FALHA ),
+				  "falha %u: bits 0x%x", i + 1, (unsigned) s_bits[i] );
+
+	//4. O AP aparece: a tentativa agendada conecta, o bit de falha é apagado e o de conexão setado.
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP, 6, -50 );
+	EventBits_t bits = xEventGroupWaitBits( s_grupo, BIT_CONECTADO, pdFALSE, pdFALSE, ESPERA_MS / portTICK_PERIOD_MS );
+	VERIFICA( ( bits & BIT_CONECTADO ) && !( bits & BIT_FALHA ), "bits 0x%x apos o IP", (unsigned) bits );
+	wifi_reconexao_stats_t stats;
+	wifi_reconexao_estatisticas( &stats );
+	VERIFICA( stats.quedas == 1 && stats.reconexoes == 1 && stats.tentativas == conexoes() - 1,
+			  "quedas %u, reconexoes %u, tentativas %u (%u conexoes)", stats.quedas, stats.reconexoes,
+			  stats.tentativas, conexoes() );
+
+	//5. Nova queda após o IP: o backoff recomeça com a tentativa imediata.
+	uint32_t quedas = s_quedas;
+	sim_wifi_remove_ap( AP );
+	VERIFICA( espera_quedas( quedas + 1 ) && quedas == FALHAS, "sem queda ao remover o AP" );
+	wifi_reconexao_estatisticas( &stats );
+	VERIFICA( stats.quedas == 2 && s_imediata[FALHAS] && !( s_bits[FALHAS] & ( BIT_CONECTADO | BIT_FALHA ) ),
+			  "quedas %u, tentativa imediata %d, bits 0x%x", stats.quedas, s_imediata[FALHAS], (unsigned) s_bits[FALHAS] );
+
+	wifi_reconexao_relatorio();
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
@@ -0,0 +1,193 @@
+/*
+	Objetivo: Teste do wifi_roaming no build para Linux - vários APs do mesmo SSID: troca pelo RSSI
+			  após a varredura, histerese sem troca, queda do AP com reconexão pelo cache e troca de
+			  perfil quando nenhum AP do SSID responde
+	Disciplina: IoT Aplicada
+	Curso: Engenharia da Computação
+*/
+
+/* Inclusão das Bibliotecas */
+#include <stdio.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_event.h"
+#include "esp_netif.h"
+#include "esp_timer.h"
+#include "esp_wifi.h"
+#include "nvs_flash.h"
+#include "wifi_roaming.h"
+#include "simulacao.h"
+
+/* Definições e Constantes */
+#define LIMIAR			-70
+#define HISTERESE		8
+#define ESPERA_MS		5000
+#define SSID_2			"rede_2"
+
+/* Variáveis Globais */
+static const uint8_t AP_A[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x0a };	//SSID do menuconfig, canal 1.
+static const uint8_t AP_B[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x0b };	//SSID do menuconfig, canal 6.
+static const uint8_t AP_C[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x0c };	//SSID do menuconfig, canal 11.
+static const uint8_t AP_D[6] = { 0x24, 0x0a, 0xc4, 0x00, 0x00, 0x0d };	//SSID_2, canal 3, somente no fim.
+static const wifi_roaming_perfil_t s_perfis[] = {
+	{ .ssid = CONFIG_ESP_WIFI_SSID, .senha = CONFIG_ESP_WIFI_PASSWORD },
+	{ .ssid = SSID_2, .senha = "senha_2" },
+};
+static QueueHandle_t s_eventos;
+static wifi_config_t s_config;
+static volatile uint32_t s_conectados;		//GOT_IP já repassados ao wifi_roaming_conectado.
+static int s_falhas;
+
+#define VERIFICA( cond, ... ) do { if( !( cond ) ) { printf( "FALHA: " __VA_ARGS__ ); printf( "\n" ); s_falhas++; } } while( 0 )
+
+static void trata_evento( void *arg, esp_event_base_t base, int32_t id, void *dados )
+{
+	int32_t evento = base == IP_EVENT ? -id - 1 : id;	//IDs de IP_EVENT negativos.
+	xQueueSend( s_eventos, &evento, 0 );
+}
+
+/* Station da aplicação, como no EX05: reconecta no destino escolhido pelo roaming. */
+static void task_estacao( void *arg )
+{
+	int32_t evento;
+	while( 1 )
+	{
+		xQueueReceive( s_eventos, &evento, portMAX_DELAY );
+		if( evento == WIFI_EVENT_STA_DISCONNECTED )
+		{
+			wifi_roaming_desconectado( &s_config );
+			esp_wifi_set_config( ESP_IF_WIFI_STA, &s_config );
+			vTaskDelay( 100 / portTICK_PERIOD_MS );
+			esp_wifi_connect();
+		}
+		else if( evento == -IP_EVENT_STA_GOT_IP - 1 )
+		{
+			wifi_roaming_conectado();
+			s_conectados++;
+		}
+	}
+}
+
+/* Aguarda a associação ao AP (e o GOT_IP tratado). Retorna o tempo em ms, ou -1. */
+static int32_t espera_ap( const uint8_t bssid[6], uint32_t max_ms )
+{
+	int64_t inicio = esp_timer_get_time();
+	uint32_t conectados = s_conectados;
+	while( esp_timer_get_time() - inicio < (int64_t) max_ms * 1000 )
+	{
+		sim_wifi_stats_t stats;
+		sim_wifi_estatisticas( &stats );
+		wifi_ap_record_t info;
+		//O GOT_IP chega ao roaming pela task da estação, depois da associação.
+		if( memcmp( stats.bssid, bssid, 6 ) == 0 && esp_wifi_sta_get_ap_info( &info ) == ESP_OK && s_conectados != conectados )
+			return (int32_t)( ( esp_timer_get_time() - inicio ) / 1000 );
+		vTaskDelay( 20 / portTICK_PERIOD_MS );
+	}
+	return -1;
+}
+
+static bool no_ap( const uint8_t bssid[6] )
+{
+	sim_wifi_stats_t stats;
+	sim_wifi_estatisticas( &stats );
+	return memcmp( stats.bssid, bssid, 6 ) == 0;
+}
+
+void app_main( void )
+{
+	nvs_flash_erase();
+	nvs_flash_init();
+	esp_netif_init();
+	esp_event_loop_create_default();
+	esp_netif_create_default_wifi_sta();
+	wifi_init_config_t cfg = WIFI_INIT_CONFIG_DEFAULT();
+	esp_wifi_init( &cfg );
+	s_eventos = xQueueCreate( 16, sizeof( int32_t ) );
+	esp_event_handler_register( WIFI_EVENT, WIFI_EVENT_STA_DISCONNECTED, trata_evento, NULL );
+	esp_event_handler_register( IP_EVENT, IP_EVENT_STA_GOT_IP, trata_evento, NULL );
+
+	const wifi_roaming_config_t roaming = {
+		.perfis = s_perfis,
+		.n_perfis = sizeof( s_perfis ) / sizeof( s_perfis[0] ),
+		.rssi_limiar = LIMIAR,
+		.histerese_db = HISTERESE,
+		.varredura_forte_ms = 0,
+		.varredura_fraca_ms = 1000,
+		.validade_cache_ms = 30000,
+		.falhas_por_perfil = 2,
+	};
+	VERIFICA( wifi_roaming_iniciar( &roaming, &s_config ) == ESP_OK, "wifi_roaming_iniciar" );
+	VERIFICA( strcmp( (char*) s_config.sta.ssid, CONFIG_ESP_WIFI_SSID ) == 0, "primeiro perfil" );
+	xTaskCreate( task_estacao, "estacao", 3072, NULL, 5, NULL );
+	esp_wifi_set_mode( WIFI_MODE_STA );
+	esp_wifi_start();
+
+	sim_wifi_remove_todos();
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP_A, 1, -50 );
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP_B, 6, -75 );
+	sim_wifi_ap( CONFIG_ESP_WIFI_SSID, CONFIG_ESP_WIFI_PASSWORD, AP_C, 11, -80 );
+
+	//1. Boot: varredura completa, vence o AP mais forte do SSID.
+	esp_wifi_set_config( ESP_IF_WIFI_STA, &s_config );
+	esp_wifi_connect();
+	VERIFICA( espera_ap( AP_A, ESPERA_MS ) >= 0, "sem conexao ao AP A" );
+
+	//2. A estação se afasta de A e chega perto de B: abaixo do limiar, a varredura acha B e o roaming troca.
+	wifi_roaming_stats_t antes, depois;
+	wifi_roaming_estatisticas( &antes );
+	sim_wifi_rssi( AP_B, -55 );
+	sim_wifi_rssi( AP_A, -85 );
+	int32_t troca = espera_ap( AP_B, ESPERA_MS );
+	wifi_roaming_estatisticas( &depois );
+	VERIFICA( troca >= 0, "sem troca de A para B" );
+	VERIFICA( depois.trocas == antes.trocas + 1 && depois.trocas_externas == antes.trocas_externas
+			  && depois.varreduras > antes.varreduras, "troca A->B: %u trocas, %u externas, %u varreduras", depois.trocas,
+			  depois.trocas_externas, depois.varreduras );
+	printf( "troca A -> B em %d ms, %u varreduras\n", troca, depois.varreduras - antes.varreduras );
+
+	//3. Histerese: B fica fraco, mas C não o supera pela margem. Nenhuma troca; depois B se recupera.
+	sim_wifi_rssi( AP_C, -68 );
+	sim_wifi_rssi( AP_B, -72 );
+	vTaskDelay( 4000 / portTICK_PERIOD_MS );
+	wifi_roaming_estatisticas( &antes );
+	VERIFICA( no_ap( AP_B ) && antes.trocas == depois.trocas, "troca sem superar a histerese (%u trocas)", antes.trocas );
+	VERIFICA( antes.ms_abaixo_limiar > depois.ms_abaixo_limiar, "tempo abaixo do limiar nao contado" );
+	sim_wifi_rssi( AP_B, LIMIAR + HISTERESE );
+	vTaskDelay( 3000 / portTICK_PERIOD_MS );		//Próxima leitura do RSSI (2 s).
+	wifi_roaming_estatisticas( &depois );
+	uint64_t abaixo = depois.ms_abaixo_limiar;
+	vTaskDelay( 1000 / portTICK_PERIOD_MS );
+	wifi_roaming_estatisticas( &depois );
+	VERIFICA( depois.rssi == LIMIAR + HISTERESE && depois.ms_abaixo_limiar == abaixo, "conexao nao voltou a ser forte" );
+
+	//4. B desliga: a reconexão vai direto ao melhor AP do cache (C), sem varrer os canais.
+	sim_wifi_stats_t wifi_antes, wifi_depois;
+	sim_wifi_estatisticas( &wifi_antes );
+	wifi_roaming_estatisticas( &antes );
+	sim_wifi_remove_ap( AP_B );
+	troca = espera_ap( AP_C, ESPERA_MS );
+	sim_wifi_estatisticas( &wifi_depois );
+	wifi_roaming_estatisticas( &depois );
+	VERIFICA( troca >= 0, "sem reconexao ao AP C" );
+	VERIFICA( wifi_depois.conexoes_rapidas > wifi_antes.conexoes_rapidas && depois.trocas_externas == antes.trocas_externas + 1,
+			  "queda de B: %u conexoes rapidas, %u trocas externas", wifi_depois.conexoes_rapidas - wifi_antes.conexoes_rapidas,
+			  depois.trocas_externas );
+	printf( "queda de B -> C em %d ms\n", troca );
+
+	//5. Todos os APs do primeiro SSID somem e surge o do segundo, ainda fora do cache: depois das falhas
+	//nos APs do cache, o roaming passa ao segundo perfil e varre todos os canais.
+	sim_wifi_ap( SSID_2, "senha_2", AP_D, 3, -60 );
+	sim_wifi_remove_ap( AP_A );
+	sim_wifi_remove_ap( AP_C );
+	troca = espera_ap( AP_D, 4 * ESPERA_MS );
+	wifi_roaming_estatisticas( &depois );
+	VERIFICA( troca >= 0 && depois.trocas_perfil == 1, "sem troca de perfil (%u)", depois.trocas_perfil );
+	VERIFICA( strcmp( (char*) s_config.sta.ssid, SSID_2 ) == 0, "SSID %s", (char*) s_config.sta.ssid );
+	printf( "troca de perfil em %d ms\n", troca );
+
+	wifi_roaming_relatorio();
+	printf( "%s\n", s_falhas ? "FALHOU" : "OK" );
+	sim_encerrar( s_falhas ? 1 : 0 );
+}
@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+#
+# Servidor DHCP mínimo para medir o componente rede_ip em bancada, no lugar do roteador. Atende a
+# troca completa (DISCOVER/OFFER/REQUEST/ACK) e o INIT-REBOOT (REQUEST direto com o último IP) e
+# imprime, por cliente, o tipo de troca, o número de mensagens e o tempo entre a primeira mensagem e
+# o ACK. --atraso-ms simula um servidor lento e --silencioso um servidor fora do ar (fallback do
+# modo híbrido). As concessões ficam em memória: reinicie o servidor para forçar a troca completa.
+#
+# uso: sudo dhcp_servidor.py --interface-ip 10.0.0.1 [--rede 10.0.0.0/24] [--atraso-ms 0] [--silencioso]
+#      dhcp_servidor.py --porta 6767 --destino 127.0.0.1 ...     (teste local, sem privilégios)
+#
+
+import argparse
+import ipaddress
+import random
+import socket
+import struct
+import time
+
+MAGIC = b'\x63\x82\x53\x63'
+DISCOVER, OFFER, REQUEST, DECLINE, ACK, NAK, RELEASE = 1, 2, 3, 4, 5, 6, 7
+NOMES = {DISCOVER: 'DISCOVER', REQUEST: 'REQUEST', DECLINE: 'DECLINE', RELEASE: 'RELEASE'}
+BOOTP = struct.Struct('!BBBBIHH4s4s4s4s16s64s128s')
+
+
+def opcoes(dados):
+    resultado = {}
+    i = 0
+    while i < len(dados):
+        codigo = dados[i]
+        if codigo == 255:
+            break
+        if codigo == 0:
+            i += 1
+            continue
+        tamanho = dados[i + 1]
+        resultado[codigo] = dados[i + 2:i + 2 + tamanho]
+        i += 2 + tamanho
+    return resultado
+
+
+def codifica_opcoes(lista):
+    saida = bytearray(MAGIC)
+    for codigo, valor in lista:
+        saida += bytes([codigo, len(valor)]) + valor
+    saida.append(255)
+    return bytes(saida)
+
+
+class Servidor:
+    def __init__(self, args):
+        self.args = args
+        self.rede = ipaddress.ip_network(args.rede)
+        self.servidor = ipaddress.ip_address(args.interface_ip)
+        self.concessoes = {}        # mac -> ip
+        self.transacoes = {}        # mac -> (inicio, mensagens, tipo)
+        self.medidas = {'completa': [], 'INIT-REBOOT': []}
+
+    def livre(self, mac):
+        usados = set(self.concessoes.values())
+        for ip in self.rede.hosts():
+            if ip != self.servidor and int(ip) - int(self.rede.network_address) >= self.args.inicio and ip not in usados:
+                self.concessoes[mac] = ip
+                return ip
+        return None
+
+    def resposta(self, pedido, tipo, ip):
+        op, htype, hlen, hops, xid, secs, flags, ciaddr, yiaddr, siaddr, giaddr, chaddr, sname, arquivo = pedido
+        cabecalho = BOOTP.pack(2, htype, hlen, 0, xid, 0, flags, ciaddr,
+                               ip.packed if ip else b'\0' * 4, self.servidor.packed, giaddr, chaddr, sname, arquivo)
+        lista = [(53, bytes([tipo])), (54, self.servidor.packed)]
+        if tipo != NAK:
+            lista += [(51, struct.pack('!I', self.args.concessao_s)), (1, self.rede.netmask.packed),
+                      (3, self.servidor.packed), (6, self.servidor.packed)]
+        return cabecalho + codifica_opcoes(lista)
+
+    def trata(self, dados):
+        if len(dados) < BOOTP.size + 4 or dados[BOOTP.size:BOOTP.size + 4] != MAGIC:
+            return None
+        pedido = BOOTP.unpack_from(dados)
+        mac = pedido[11][:6].hex(':')
+        op = opcoes(dados[BOOTP.size + 4:])
+        tipo = op.get(53, b'\0')[0]
+        agora = time.monotonic()
+
+        if tipo == DISCOVER:
+            self.transacoes[mac] = (agora, 1, 'completa')
+            ip = self.concessoes.get(mac) or self.livre(mac)
+            return self.resposta(pedido, OFFER, ip) if ip else None
+
+        if tipo == REQUEST:
+            inicio, mensagens, troca = self.transacoes.pop(mac, (agora, 0, None))
+            pedido_ip = op.get(50) or pedido[7]
+            pedido_ip = ipaddress.ip_address(pedido_ip) if pedido_ip != b'\0' * 4 else None
+            if troca is None:
+                # Sem DISCOVER antes: INIT-REBOOT (sem server id) ou renovação.
+                troca = 'INIT-REBOOT' if 54 not in op else 'renovacao'
+            dono = next((m for m, ip in self.concessoes.items() if ip == pedido_ip), None)
+            if pedido_ip is None or pedido_ip not in self.rede or dono not in (None, mac):
+                print('%s: %s pediu %s -> NAK' % (mac, troca, pedido_ip))
+                return self.resposta(pedido, NAK, None)
+            self.concessoes[mac] = pedido_ip
+            ms = (time.monotonic() - inicio) * 1000 + self.args.atraso_ms
+            if troca in self.medidas:
+                self.medidas[troca].append(ms)
+            print('%s: %s -> ACK %s (%u mensagens do cliente, %.0f ms)' % (mac, troca, pedido_ip, mensagens + 1, ms))
+            return self.resposta(pedido, ACK, pedido_ip)
+
+        if tipo in NOMES:
+            print('%s: %s' % (mac, NOMES[tipo]))
+            if tipo == RELEASE:
+                self.concessoes.pop(mac, None)
+        return None
+
+    def relatorio(self):
+        for troca, medidas in self.medidas.items():
+            if medidas:
+                medidas = sorted(medidas)
+                print('== %-11s %3u concessoes, mediana %.0f ms, pior %.0f ms'
+                      % (troca, len(medidas), medidas[len(medidas) // 2], medidas[-1]))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Servidor DHCP minimo para medir o rede_ip.')
+    parser.add_argument('--interface-ip', default='10.0.0.1', help='endereco deste computador (server id e gateway)')
+    parser.add_argument('--rede', default='10.0.0.0/24')
+    parser.add_argument('--inicio', type=int, default=100, help='primeiro host da faixa de concessoes')
+    parser.add_argument('--concessao-s', type=int, default=3600)
+    parser.add_argument('--atraso-ms', type=float, default=0, help='atraso de cada resposta')
+    parser.add_argument('--perda', type=float, default=0, help='fracao das respostas descartadas')
+    parser.add_argument('--silencioso', action='store_true', help='nao responde (teste do fallback)')
+    parser.add_argument('--porta', type=int, default=67, help='porta do servidor; o cliente recebe na seguinte')
+    parser.add_argument('--destino', default='255.255.255.255')
+    args = parser.parse_args()
+
+    servidor = Servidor(args)
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_BROADCAST, 1)
+    sock.bind(('', args.porta))
+    print('Servidor DHCP em %s, faixa %s a partir do host %u%s'
+          % (args.interface_ip, args.rede, args.inicio, ' (silencioso)' if args.silencioso else ''))
+    try:
+        while True:
+            dados, _ = sock.recvfrom(2048)
+            resposta = servidor.trata(dados)
+            if resposta is None or args.silencioso or random.random() < args.perda:
+                continue
+            if args.atraso_ms:
+                time.sleep(args.atraso_ms / 1000)
+            sock.sendto(resposta, (args.destino, args.porta + 1))
+    except KeyboardInterrupt:
+        servidor.relatorio()
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+#
+# Decodifica as linhas "DLOG:<hex>" geradas pelo componente dlog em modo DLOG_SAIDA_BINARIA.
+# O formato, a tag e os argumentos %s são ponteiros para strings do firmware, lidas do ELF.
+#
+# uso: dlog_decode.py build/app.elf [captura.txt]    (sem arquivo, lê da entrada padrão)
+# requer: pyelftools (já instalado no ambiente do ESP-IDF)
+#
+
+import re
+import struct
+import sys
+
+from elftools.elf.elffile import ELFFile
+
+MAX_ARGS = 8
+REGISTRO = struct.Struct('<IIIBBBB%dI' % MAX_ARGS)  # mesmo layout de dlog_registro_t
+NIVEIS = 'NEWID'
+CONVERSAO = re.compile(r'%([-+ #0]*\d*(?:\.\d+)?)(?:hh|h|ll|l|z)?([diuxXcsp%])')
+
+
+class Strings:
+    def __init__(self, caminho):
+        self.secoes = []
+        with open(caminho, 'rb') as f:
+            for secao in ELFFile(f).iter_sections():
+                if secao['sh_addr'] and secao['sh_type'] == 'SHT_PROGBITS':
+                    self.secoes.append((secao['sh_addr'], secao.data()))
+
+    def le(self, endereco):
+        for inicio, dados in self.secoes:
+            if inicio <= endereco < inicio + len(dados):
+                fim = dados.find(b'\0', endereco - inicio)
+                return dados[endereco - inicio:fim].decode('utf-8', 'replace')
+        return '<0x%08x?>' % endereco
+
+
+def formata(strings, fmt, args):
+    args = list(args)
+
+    def substitui(m):
+        flags, tipo = m.group(1), m.group(2)
+        if tipo == '%':
+            return '%'
+        valor = args.pop(0) if args else 0
+        if tipo == 's':
+            return ('%' + flags + 's') % strings.le(valor)
+        if tipo == 'p':
+            return '0x%08x' % valor
+        if tipo in 'di':
+            valor = valor - (1 << 32) if valor & 0x80000000 else valor
+            tipo = 'd'
+        elif tipo == 'u':
+            tipo = 'd'
+        return ('%' + flags + tipo) % valor
+
+    return CONVERSAO.sub(substitui, fmt)
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit('uso: dlog_decode.py app.elf [captura.txt]')
+    strings = Strings(sys.argv[1])
+    entrada = open(sys.argv[2], errors='replace') if len(sys.argv) > 2 else sys.stdin
+    for linha in entrada:
+        i = linha.find('DLOG:')
+        if i < 0:
+            sys.stdout.write(linha)  # demais linhas do console passam sem alteração
+            continue
+        try:
+            dados = bytes.fromhex(linha[i + 5:].strip())
+            fmt, tag, instante, nivel, nargs, nucleo, _, *args = REGISTRO.unpack(dados)
+        except (ValueError, struct.error):
+            sys.stdout.write(linha)
+            continue
+        mensagem = formata(strings, strings.le(fmt), args[:nargs])
+        print('%s (%u) [%u] %s: %s' % (NIVEIS[nivel] if nivel < len(NIVEIS) else '?',
+                                       instante, nucleo, strings.le(tag), mensagem))
+
+
+if __name__ == '__main__':
+    main()
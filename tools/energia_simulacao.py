@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+#
+# Estimativa do consumo da station com o componente energia (light sleep automático e modem sleep).
+#
+# Com um log do console, lê as linhas "energia: {...}" de energia_relatorio() e soma o tempo em cada
+# modo; sem log, simula uma hora da station: o rádio acorda para os beacons escutados, as tarefas
+# periódicas acordam a CPU e o restante do tempo é light sleep. Nos dois casos mostra o tempo em cada
+# estado, a corrente média e a autonomia com a bateria informada.
+#
+# uso: energia_simulacao.py --log captura.txt [--bateria-mah 2000]
+#      energia_simulacao.py [--beacon-ms 102.4] [--dtim 1] [--escuta 3] [--tarefa 60000:5] ...
+#
+
+import argparse
+import json
+import re
+
+# Correntes típicas (uA), as mesmas de energia.h; RX e TX com o rádio ligado.
+CORRENTE_UA = {
+    'SLEEP': 800,
+    'XTAL': 15000,
+    '80': 25000,
+    '160': 40000,
+    '240': 50000,
+    'RX': 95000,
+    'TX': 180000,
+}
+RELATORIO = re.compile(r'energia: (\{.*\})')
+US_POR_HORA = 3600 * 1000000
+
+
+def corrente_cpu(mhz):
+    if mhz >= 240:
+        return CORRENTE_UA['240']
+    if mhz >= 160:
+        return CORRENTE_UA['160']
+    if mhz >= 80:
+        return CORRENTE_UA['80']
+    return CORRENTE_UA['XTAL']
+
+
+def le_log(caminho):
+    """Soma o tempo (us) e a carga (uA*us) de cada modo nos relatórios do log."""
+    estados = {}
+    with open(caminho, errors='replace') as entrada:
+        for linha in entrada:
+            m = RELATORIO.search(linha)
+            if not m:
+                continue
+            try:
+                relatorio = json.loads(m.group(1))
+            except ValueError:
+                continue
+            for modo in relatorio['modos']:
+                nome = '%s (%u MHz)' % (modo['modo'], modo['mhz'])
+                us = modo['ms'] * 1000
+                tempo, carga = estados.get(nome, (0, 0))
+                estados[nome] = (tempo + us, carga + modo['ua'] * us)
+    return estados
+
+
+def simula(args):
+    """Uma hora da station: despertares do rádio e das tarefas; o restante em light sleep."""
+    estados = {}
+
+    def soma(nome, ua, us):
+        tempo, carga = estados.get(nome, (0, 0))
+        estados[nome] = (tempo + us, carga + ua * us)
+
+    # Modem sleep: com escuta 0 acorda em todo DTIM (MIN_MODEM), senão a cada "escuta" beacons (MAX_MODEM).
+    beacons = args.dtim if args.escuta == 0 else args.escuta
+    despertares_radio = US_POR_HORA / (args.beacon_ms * 1000 * beacons)
+    soma('RX (beacons)', CORRENTE_UA['RX'], despertares_radio * args.janela_rx_ms * 1000)
+    soma('TX (envios)', CORRENTE_UA['TX'], args.envios_por_hora * args.janela_tx_ms * 1000)
+
+    despertares_cpu = 0
+    for tarefa in args.tarefa:
+        periodo_ms, duracao_ms = (float(x) for x in tarefa.split(':'))
+        n = US_POR_HORA / (periodo_ms * 1000)
+        despertares_cpu += n
+        soma('CPU_MAX (%u MHz)' % args.mhz, corrente_cpu(args.mhz), n * duracao_ms * 1000)
+
+    ocupado = sum(tempo for tempo, _ in estados.values())
+    if ocupado > US_POR_HORA:
+        raise SystemExit('os despertares somam mais que uma hora: a CPU nunca dormiria')
+    soma('SLEEP', CORRENTE_UA['SLEEP'], US_POR_HORA - ocupado)
+    print('Despertares por hora: %.0f do radio, %.0f das tarefas' % (despertares_radio, despertares_cpu))
+    return estados
+
+
+def imprime(estados, bateria_mah):
+    total = sum(tempo for tempo, _ in estados.values())
+    if total == 0:
+        raise SystemExit('nenhum relatorio "energia:" encontrado')
+    carga = sum(c for _, c in estados.values())
+    print('%-22s %12s %7s' % ('estado', 'tempo (s)', '%'))
+    for nome, (tempo, _) in sorted(estados.items(), key=lambda e: -e[1][0]):
+        print('%-22s %12.1f %6.2f%%' % (nome, tempo / 1e6, tempo * 100.0 / total))
+    media_ma = carga / total / 1000.0
+    print('Corrente media: %.2f mA' % media_ma)
+    print('Autonomia com %u mAh: %.1f h (%.1f dias)' % (bateria_mah, bateria_mah / media_ma,
+                                                       bateria_mah / media_ma / 24))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Estimativa do consumo em light sleep e modem sleep.')
+    parser.add_argument('--log', help='log do console com as linhas "energia:" (sem ele, simula)')
+    parser.add_argument('--bateria-mah', type=int, default=2000)
+    parser.add_argument('--beacon-ms', type=float, default=102.4, help='intervalo de beacon do AP')
+    parser.add_argument('--dtim', type=int, default=1, help='período DTIM do AP (beacons)')
+    parser.add_argument('--escuta', type=int, default=3, help='CONFIG_ESP_INTERVALO_ESCUTA (0 = todo DTIM)')
+    parser.add_argument('--janela-rx-ms', type=float, default=3.0, help='rádio ligado por beacon')
+    parser.add_argument('--envios-por-hora', type=float, default=0)
+    parser.add_argument('--janela-tx-ms', type=float, default=5.0, help='rádio ligado por envio')
+    parser.add_argument('--mhz', type=int, default=240, help='CPU nos despertares das tarefas')
+    parser.add_argument('--tarefa', action='append', default=[], metavar='PERIODO_MS:DURACAO_MS',
+                        help='tarefa periódica que acorda a CPU (pode repetir)')
+    args = parser.parse_args()
+
+    estados = le_log(args.log) if args.log else simula(args)
+    imprime(estados, args.bateria_mah)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+#
+# Decodifica as bordas de GPIO no formato do componente gpio_bin: as linhas "GPIOBIN:<hex>" da UART
+# (EX04 com SAIDA_BINARIA) ou, com --bruto, um fluxo binário contínuo (arquivo, socket gravado).
+# O decodificador é incremental, como o gpio_bin_decodificar: aceita o fluxo em pedaços de qualquer
+# tamanho. O round-trip codificador -> decodificador é conferido pelo teste gpio_bin do build para
+# Linux (host/testes/gpio_bin.c), direto sobre o gpio_bin.c.
+#
+# uso: gpio_bin_decode.py [captura.txt]          (sem arquivo, lê da entrada padrão)
+#      gpio_bin_decode.py --bruto fluxo.bin
+#
+
+import argparse
+import sys
+
+SINCRONISMO = 0xFF
+
+
+class Decodificador:
+    def __init__(self):
+        self.instante = 0
+        self.sincronizado = False
+        self.erros = 0
+        self.cabecalho = None
+        self.valor = self.deslocamento = 0
+
+    def alimenta(self, dados):
+        """Consome um pedaço do fluxo e retorna as bordas completas como (instante_us, pino, nivel)."""
+        eventos = []
+        for byte in dados:
+            if self.cabecalho is None:
+                self.cabecalho, self.valor, self.deslocamento = byte, 0, 0
+                continue
+            if self.deslocamento >= 64:
+                # Varint longo demais: fluxo corrompido, espera o próximo sincronismo.
+                self.erros += 1
+                self.cabecalho = None
+                self.sincronizado = False
+                continue
+            self.valor |= (byte & 0x7F) << self.deslocamento
+            self.deslocamento += 7
+            if byte & 0x80:
+                continue
+            cabecalho, self.cabecalho = self.cabecalho, None
+            valor = self.valor & 0xFFFFFFFFFFFFFFFF  # uint64_t, como no gpio_bin.c
+            if cabecalho == SINCRONISMO:
+                self.instante = valor
+                self.sincronizado = True
+            elif not self.sincronizado:
+                self.erros += 1
+            else:
+                self.instante = (self.instante + valor) & 0xFFFFFFFFFFFFFFFF
+                eventos.append((self.instante, cabecalho >> 1, cabecalho & 1))
+        return eventos
+
+
+def imprime(eventos, anterior):
+    for instante, pino, nivel in eventos:
+        delta = '' if anterior is None else '  (+%u us)' % (instante - anterior)
+        print('%14.6f s  GPIO %u -> %u%s' % (instante / 1e6, pino, nivel, delta))
+        anterior = instante
+    return anterior
+
+
+def decodifica_linhas(entrada):
+    linhas = bordas = bytes_total = erros = 0
+    anterior = None
+    for linha in entrada:
+        linha = linha.strip()
+        if not linha.startswith('GPIOBIN:'):
+            continue
+        try:
+            dados = bytes.fromhex(linha[8:])
+        except ValueError:
+            print('linha corrompida: %s' % linha[:40], file=sys.stderr)
+            erros += 1
+            continue
+        # Cada linha começa com um sincronismo: decodificador novo, sem herdar erros da anterior.
+        decodificador = Decodificador()
+        eventos = decodificador.alimenta(dados)
+        anterior = imprime(eventos, anterior)
+        linhas += 1
+        bordas += len(eventos)
+        bytes_total += len(dados)
+        erros += decodificador.erros
+    resumo(bordas, bytes_total, erros, '%u linhas' % linhas)
+
+
+def decodifica_bruto(entrada):
+    decodificador = Decodificador()
+    bordas = bytes_total = 0
+    anterior = None
+    while True:
+        dados = entrada.read(4096)
+        if not dados:
+            break
+        eventos = decodificador.alimenta(dados)
+        anterior = imprime(eventos, anterior)
+        bordas += len(eventos)
+        bytes_total += len(dados)
+    resumo(bordas, bytes_total, decodificador.erros, 'fluxo continuo')
+
+
+def resumo(bordas, bytes_total, erros, origem):
+    media = bytes_total / bordas if bordas else 0
+    print('== %s: %u bordas, %u bytes (%.2f bytes/borda), %u erros' % (origem, bordas, bytes_total, media, erros),
+          file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Decodificador das bordas de GPIO no formato gpio_bin.')
+    parser.add_argument('captura', nargs='?', help='arquivo capturado (padrao: entrada padrao)')
+    parser.add_argument('--bruto', action='store_true', help='fluxo binario continuo em vez de linhas GPIOBIN:')
+    args = parser.parse_args()
+
+    if args.bruto:
+        with (open(args.captura, 'rb') if args.captura else sys.stdin.buffer) as entrada:
+            decodifica_bruto(entrada)
+    else:
+        with (open(args.captura, errors='replace') if args.captura else sys.stdin) as entrada:
+            decodifica_linhas(entrada)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+#
+# Gerador de carga para o servidor http_local: várias conexões em paralelo enviam pedidos em
+# sequência pelo tempo pedido e medem, para cada um, o tempo entre o envio e o último byte da
+# resposta (Content-Length ou chunked). Mostra pedidos por segundo, p50, p90, p99 e máximo da
+# latência e as conexões abertas. --comparar repete a medida com uma conexão nova por pedido
+# (Connection: close) para mostrar o ganho das conexões persistentes. No fim, o tempo de
+# atendimento medido no ESP32 é lido da rota de diagnóstico (--diagnostico, "" desabilita).
+#
+# uso: http_carga.py 192.168.0.50 [--porta 80] [--conexoes 4] [--duracao 10]
+#                    [--caminho /estado --caminho /tarefas] [--sem-keepalive] [--comparar]
+#
+
+import argparse
+import json
+import socket
+import threading
+import time
+
+
+class Conexao:
+    """Cliente HTTP/1.1 mínimo sobre um socket, com buffer de recepção próprio."""
+
+    def __init__(self, host, porta, timeout):
+        self.sock = socket.create_connection((host, porta), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        self.buf = b''
+
+    def _recebe(self):
+        dados = self.sock.recv(65536)
+        if not dados:
+            raise ConnectionError('conexao fechada pelo servidor')
+        self.buf += dados
+
+    def _linha(self):
+        while b'\r\n' not in self.buf:
+            self._recebe()
+        linha, self.buf = self.buf.split(b'\r\n', 1)
+        return linha
+
+    def _bytes(self, n):
+        while len(self.buf) < n:
+            self._recebe()
+        dados, self.buf = self.buf[:n], self.buf[n:]
+        return dados
+
+    def pedido(self, caminho, manter):
+        self.sock.sendall(('GET %s HTTP/1.1\r\nHost: esp32\r\nConnection: %s\r\n\r\n'
+                           % (caminho, 'keep-alive' if manter else 'close')).encode())
+        status = int(self._linha().split()[1])
+        cabecalhos = {}
+        while True:
+            linha = self._linha()
+            if not linha:
+                break
+            nome, valor = linha.decode().split(':', 1)
+            cabecalhos[nome.strip().lower()] = valor.strip().lower()
+        if cabecalhos.get('transfer-encoding') == 'chunked':
+            corpo = b''
+            while True:
+                tamanho = int(self._linha(), 16)
+                if tamanho == 0:
+                    self._linha()
+                    break
+                corpo += self._bytes(tamanho)
+                self._bytes(2)
+        else:
+            corpo = self._bytes(int(cabecalhos.get('content-length', 0)))
+        return status, corpo, cabecalhos.get('connection') != 'close'
+
+    def fecha(self):
+        self.sock.close()
+
+
+def percentil(ordenadas, p):
+    return ordenadas[min(len(ordenadas) - 1, int(len(ordenadas) * p / 100))]
+
+
+def cliente(args, manter, fim, resultado, trava):
+    latencias = []
+    erros = conexoes = bytes_recebidos = 0
+    conexao = None
+    i = 0
+    while time.monotonic() < fim:
+        caminho = args.caminho[i % len(args.caminho)]
+        i += 1
+        try:
+            inicio = time.perf_counter()    # Inclui o connect quando a conexao e nova.
+            if conexao is None:
+                conexao = Conexao(args.host, args.porta, args.timeout)
+                conexoes += 1
+            status, corpo, aberta = conexao.pedido(caminho, manter)
+            latencias.append(time.perf_counter() - inicio)
+            bytes_recebidos += len(corpo)
+            if status != 200:
+                erros += 1
+            if not aberta:
+                conexao.fecha()
+                conexao = None
+        except (OSError, ValueError, IndexError):
+            erros += 1
+            if conexao is not None:
+                conexao.fecha()
+                conexao = None
+            time.sleep(0.05)
+    if conexao is not None:
+        conexao.fecha()
+    with trava:
+        resultado['latencias'] += latencias
+        resultado['erros'] += erros
+        resultado['conexoes'] += conexoes
+        resultado['bytes'] += bytes_recebidos
+
+
+def mede(args, manter):
+    resultado = {'latencias': [], 'erros': 0, 'conexoes': 0, 'bytes': 0}
+    trava = threading.Lock()
+    inicio = time.monotonic()
+    fim = inicio + args.duracao
+    threads = [threading.Thread(target=cliente, args=(args, manter, fim, resultado, trava))
+               for _ in range(args.conexoes)]
+    for t in threads:
+        t.start()
+    for t in threads:
+        t.join()
+    decorrido = time.monotonic() - inicio
+    latencias = sorted(resultado['latencias'])
+    nome = 'keep-alive' if manter else 'conexao por pedido'
+    if not latencias:
+        print('%-19s nenhuma resposta (%u erros)' % (nome, resultado['erros']))
+        return
+    print('%-19s %7.1f pedidos/s  latencia ms: p50 %6.2f  p90 %6.2f  p99 %6.2f  max %7.2f  '
+          '(%u pedidos, %u conexoes, %u erros, %u bytes)'
+          % (nome, len(latencias) / decorrido, percentil(latencias, 50) * 1000, percentil(latencias, 90) * 1000,
+             percentil(latencias, 99) * 1000, latencias[-1] * 1000, len(latencias), resultado['conexoes'],
+             resultado['erros'], resultado['bytes']))
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Carga para o servidor http_local: pedidos/s e latencia.')
+    parser.add_argument('host', help='IP do ESP32')
+    parser.add_argument('--porta', type=int, default=80)
+    parser.add_argument('--conexoes', type=int, default=4, help='clientes em paralelo (max_conexoes do servidor)')
+    parser.add_argument('--duracao', type=float, default=10, help='segundos de cada medida')
+    parser.add_argument('--caminho', action='append', help='rotas pedidas em rodizio (padrao /estado)')
+    parser.add_argument('--sem-keepalive', action='store_true', help='uma conexao nova por pedido')
+    parser.add_argument('--comparar', action='store_true', help='mede com e sem keep-alive')
+    parser.add_argument('--diagnostico', default='/http', help='rota com o tempo de atendimento no ESP32')
+    parser.add_argument('--timeout', type=float, default=5)
+    args = parser.parse_args()
+    args.caminho = args.caminho or ['/estado']
+
+    print('%u conexoes por %.0f s, rotas %s' % (args.conexoes, args.duracao, ' '.join(args.caminho)))
+    if args.comparar or not args.sem_keepalive:
+        mede(args, True)
+    if args.comparar or args.sem_keepalive:
+        mede(args, False)
+
+    if args.diagnostico:
+        try:
+            conexao = Conexao(args.host, args.porta, args.timeout)
+            status, corpo, _ = conexao.pedido(args.diagnostico, False)
+            conexao.fecha()
+            if status == 200:
+                print('no ESP32: %s' % json.dumps(json.loads(corpo)))
+        except (OSError, ValueError) as e:
+            print('diagnostico indisponivel: %s' % e)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,206 @@
+#!/usr/bin/env python3
+#
+# Emulador da NVS do ESP-IDF para medir, no computador, o desgaste da flash causado pelas alterações
+# de configuração. A partição é dividida em páginas de 4 KB com 126 entradas de 32 bytes; cada escrita
+# ocupa entradas novas na página ativa e a versão anterior da chave é marcada como apagada. Sem
+# páginas livres, a página com mais entradas apagadas é compactada na página reserva e apagada.
+#
+# A mesma sequência de alterações (sessões de ajuste com rajadas e valores revertidos) é aplicada a
+# três estratégias: a configuração inteira em um blob a cada alteração, uma chave por alteração com
+# commit imediato e o componente parametros (chaves alteradas, agrupadas em "atraso_ms" e escritas
+# somente se diferentes do valor gravado). Mostra entradas escritas e apagamentos de página por
+# alteração e a vida estimada da partição. A latência de leitura é medida no ESP32 por
+# parametros_benchmark().
+#
+# uso: nvs_simulacao.py [--paginas 6] [--sessoes-dia 4] [--dias 365] [--atraso-ms 2000]
+#                       [--intervalo-min-ms 10000] [--ciclos 100000] [--semente 1]
+#
+
+import argparse
+import math
+import random
+
+ENTRADAS_PAGINA = 126
+BYTES_ENTRADA = 32
+
+# Tabela do EX05/EX06: chave -> (tipo, tamanho em bytes do valor típico).
+TABELA = {
+    'ssid': ('str', 12),
+    'senha': ('str', 16),
+    'tentativas': ('i32', 4),
+    'ip_fixo': ('u32', 4),
+    'ip_mascara': ('u32', 4),
+    'ip_gateway': ('u32', 4),
+    'ip_dns': ('u32', 4),
+}
+
+
+def entradas(tipo, tamanho):
+    """Entradas ocupadas por um item: cabeçalho mais os dados de strings e blobs (blob v2 tem índice)."""
+    if tipo in ('i32', 'u32', 'u16'):
+        return 1
+    dados = math.ceil(tamanho / BYTES_ENTRADA)
+    return 1 + dados + (1 if tipo == 'blob' else 0)
+
+
+class Nvs:
+    def __init__(self, paginas):
+        if paginas < 2:
+            raise SystemExit('a NVS precisa de pelo menos 2 paginas')
+        self.paginas = [{'usadas': 0, 'apagadas': 0, 'itens': {}} for _ in range(paginas)]
+        self.ativa = 0
+        self.livres = list(range(1, paginas - 1))
+        self.reserva = paginas - 1
+        self.onde = {}              # chave -> página
+        self.escritas = 0           # Entradas escritas (inclui as copiadas na compactação).
+        self.apagamentos = 0
+        self.apagamentos_pagina = [0] * paginas
+
+    def _apaga_anterior(self, chave):
+        pagina = self.onde.pop(chave, None)
+        if pagina is not None:
+            n = self.paginas[pagina]['itens'].pop(chave)
+            self.paginas[pagina]['apagadas'] += n
+
+    def _compacta(self):
+        # Página cheia com mais entradas apagadas: os itens válidos vão para a reserva.
+        candidatas = [i for i in range(len(self.paginas)) if i not in self.livres and i != self.reserva]
+        vitima = max(candidatas, key=lambda i: self.paginas[i]['apagadas'])
+        if self.paginas[vitima]['apagadas'] == 0:
+            raise SystemExit('NVS cheia: aumente --paginas')
+        destino = self.paginas[self.reserva]
+        for chave, n in self.paginas[vitima]['itens'].items():
+            destino['itens'][chave] = n
+            destino['usadas'] += n
+            self.onde[chave] = self.reserva
+            self.escritas += n
+        self.paginas[vitima] = {'usadas': 0, 'apagadas': 0, 'itens': {}}
+        self.apagamentos += 1
+        self.apagamentos_pagina[vitima] += 1
+        novo_ativo = self.reserva
+        self.reserva = vitima
+        return novo_ativo
+
+    def escreve(self, chave, n):
+        if self.paginas[self.ativa]['usadas'] + n > ENTRADAS_PAGINA:
+            self.ativa = self.livres.pop(0) if self.livres else self._compacta()
+            if self.paginas[self.ativa]['usadas'] + n > ENTRADAS_PAGINA:
+                self.ativa = self.livres.pop(0) if self.livres else self._compacta()
+        self._apaga_anterior(chave)
+        pagina = self.paginas[self.ativa]
+        pagina['itens'][chave] = n
+        pagina['usadas'] += n
+        self.onde[chave] = self.ativa
+        self.escritas += n
+
+    def apaga(self, chave):
+        self._apaga_anterior(chave)
+
+
+def sessoes(args, aleatorio):
+    """Alterações (instante em s, chave, valor) de sessões de ajuste: rajadas, reversões e repetições."""
+    eventos = []
+    chaves = list(TABELA)
+    valores = {chave: 0 for chave in chaves}
+    for dia in range(args.dias):
+        for _ in range(args.sessoes_dia):
+            t = dia * 86400 + aleatorio.uniform(0, 86400)
+            for chave in aleatorio.sample(chaves, aleatorio.randint(1, 3)):
+                original = valores[chave]
+                # Um controle deslizante ou um formulário reenviado: vários valores em poucos segundos.
+                for i in range(aleatorio.randint(1, 6)):
+                    t += aleatorio.uniform(0.1, 1.5)
+                    valores[chave] = aleatorio.randint(1, 1000)
+                    eventos.append((t, chave, valores[chave]))
+                if aleatorio.random() < 0.25:
+                    t += aleatorio.uniform(0.5, 3)
+                    valores[chave] = original
+                    eventos.append((t, chave, original))     # Desistiu: volta ao valor anterior.
+            # Formulário completo salvo de novo sem mudanças.
+            if aleatorio.random() < 0.3:
+                t += aleatorio.uniform(1, 5)
+                eventos.extend((t, chave, None) for chave in chaves)
+    eventos.sort()
+    return eventos
+
+
+def simula_blob(eventos, args):
+    nvs = Nvs(args.paginas)
+    tamanho = sum(t for _, t in TABELA.values())
+    for _ in eventos:
+        nvs.escreve('config', entradas('blob', tamanho))
+    return nvs
+
+
+def simula_chave(eventos, args):
+    nvs = Nvs(args.paginas)
+    for _, chave, _ in eventos:
+        tipo, tamanho = TABELA[chave]
+        nvs.escreve(chave, entradas(tipo, tamanho))
+    return nvs
+
+
+def simula_parametros(eventos, args):
+    """Mesma lógica do parametros.c: janela de agrupamento, intervalo mínimo e comparação com o gravado."""
+    nvs = Nvs(args.paginas)
+    atual = {chave: 0 for chave in TABELA}
+    gravado = dict(atual)
+    pendentes = set()
+    gravacao = None
+    ultima = -math.inf
+
+    def grava(instante):
+        nonlocal ultima
+        escreveu = False
+        for chave in pendentes:
+            if atual[chave] != gravado[chave]:
+                tipo, tamanho = TABELA[chave]
+                nvs.escreve(chave, entradas(tipo, tamanho))
+                gravado[chave] = atual[chave]
+                escreveu = True
+        pendentes.clear()
+        if escreveu:
+            ultima = instante
+
+    for t, chave, valor in eventos:
+        if gravacao is not None and t >= gravacao:
+            grava(gravacao)
+            gravacao = None
+        if valor is None or valor == atual[chave]:
+            continue                    # Sem mudança: nem aviso nem gravação.
+        atual[chave] = valor
+        pendentes.add(chave)
+        if gravacao is None:
+            gravacao = max(t + args.atraso_ms / 1000, ultima + args.intervalo_min_ms / 1000)
+    if gravacao is not None:
+        grava(gravacao)
+    return nvs
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Emulador da NVS: desgaste da flash por alteracao de configuracao.')
+    parser.add_argument('--paginas', type=int, default=6, help='paginas de 4 KB da particao nvs (0x6000 = 6)')
+    parser.add_argument('--sessoes-dia', type=int, default=4, help='sessoes de ajuste por dia')
+    parser.add_argument('--dias', type=int, default=365)
+    parser.add_argument('--atraso-ms', type=float, default=2000, help='atraso_ms do parametros')
+    parser.add_argument('--intervalo-min-ms', type=float, default=10000, help='intervalo_min_ms do parametros')
+    parser.add_argument('--ciclos', type=int, default=100000, help='apagamentos suportados por setor da flash')
+    parser.add_argument('--semente', type=int, default=1)
+    args = parser.parse_args()
+
+    eventos = sessoes(args, random.Random(args.semente))
+    print('%u alteracoes em %u dias (%u sessoes por dia), particao de %u paginas'
+          % (len(eventos), args.dias, args.sessoes_dia, args.paginas))
+    for nome, simula in (('blob por alteracao', simula_blob), ('chave por alteracao', simula_chave),
+                         ('parametros', simula_parametros)):
+        nvs = simula(eventos, args)
+        pior = max(nvs.apagamentos_pagina)
+        anos = args.ciclos / (pior / (args.dias / 365)) if pior else math.inf
+        print('%-20s %8u entradas escritas (%5.2f por alteracao, %7u bytes)  %5u apagamentos de pagina  '
+              'vida da particao %s'
+              % (nome, nvs.escritas, nvs.escritas / len(eventos), nvs.escritas * BYTES_ENTRADA, nvs.apagamentos,
+                 '%.0f anos' % anos if anos != math.inf else 'sem apagamentos'))
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,215 @@
+#!/usr/bin/env python3
+#
+# Simulação do componente wifi_roaming em um galpão com vários APs. A station percorre o galpão de
+# uma ponta à outra enquanto o RSSI de cada AP segue a perda log-distância com sombreamento
+# correlacionado. A mesma lógica do componente (limiar com histerese, varreduras em segundo plano com
+# cache, dicas de canal do 802.11k) é comparada com o comportamento padrão do driver, que só troca de
+# AP quando a conexão cai. Mostra trocas, tempo de troca, tempo abaixo do limiar, tempo sem conexão e
+# a fração do tempo de rádio gasta em varreduras.
+#
+# uso: roaming_simulacao.py [--ap x,y,canal ...] [--limiar -70] [--histerese 8] [--duracao 3600]
+#                           [--velocidade 1.0] [--11k] [--semente 1]
+#
+
+import argparse
+import math
+import random
+
+PASSO_S = 0.1
+TEMPO_CANAL_S = 0.060       # TEMPO_CANAL_MS do componente.
+CANAIS = 13
+PERIODO_RSSI_S = 2.0        # PERIODO_RSSI_MS do componente.
+RSSI_QUEDA = -90            # Abaixo disso a station perde os beacons e desconecta.
+ASSOCIACAO_S = 0.15         # Autenticação, associação e 4-way handshake (PMK em cache).
+MAX_FALHAS_AP = 2
+
+
+class Galpao:
+    def __init__(self, aps, sombreamento, expoente, aleatorio):
+        self.aps = aps
+        self.sombreamento = sombreamento
+        self.expoente = expoente
+        self.aleatorio = aleatorio
+        self.ruido = random.Random(aleatorio.random())
+        self.desvio = [0.0] * len(aps)
+
+    def avanca(self):
+        # Sombreamento AR(1): muda devagar, como pessoas e empilhadeiras passando.
+        for i in range(len(self.aps)):
+            self.desvio[i] = 0.98 * self.desvio[i] + self.aleatorio.gauss(0, self.sombreamento * 0.2)
+
+    def rssi(self, i, posicao):
+        x, y, _ = self.aps[i]
+        distancia = max(math.hypot(posicao[0] - x, posicao[1] - y), 1.0)
+        return -40 - 10 * self.expoente * math.log10(distancia) + self.desvio[i] + self.ruido.gauss(0, 1)
+
+
+class Station:
+    """Estado e métricas de uma estratégia (roaming ou padrão do driver)."""
+
+    def __init__(self, nome, args, roaming):
+        self.nome = nome
+        self.args = args
+        self.roaming = roaming
+        self.ap = None
+        self.fraca = False
+        self.ocupado_ate = 0.0          # Associação/DHCP ou varredura em andamento.
+        self.destino = None
+        self.inicio_troca = None
+        self.proxima_varredura = 0.0
+        self.proximo_rssi = 0.0
+        self.cache = {}                 # ap -> (rssi, instante, falhas)
+        self.trocas = []
+        self.quedas = 0
+        self.varreduras_s = 0.0
+        self.conectado_s = self.abaixo_s = self.sem_conexao_s = 0.0
+        self.soma_rssi = 0.0
+
+    def varre(self, agora, galpao, posicao, canais):
+        canais = set(canais)
+        for i, (_, _, canal) in enumerate(galpao.aps):
+            if canal in canais:
+                rssi = galpao.rssi(i, posicao)
+                if rssi > RSSI_QUEDA:
+                    self.cache[i] = (rssi, agora, 0)
+        duracao = len(canais) * TEMPO_CANAL_S
+        self.varreduras_s += duracao
+        return duracao
+
+    def candidato(self, agora, excluir=None):
+        melhor = None
+        for ap, (rssi, instante, falhas) in self.cache.items():
+            if ap == excluir or falhas >= MAX_FALHAS_AP or agora - instante > self.args.validade:
+                continue
+            if melhor is None or rssi > self.cache[melhor][0]:
+                melhor = ap
+        return melhor
+
+    def conecta(self, agora, ap, varredura_s):
+        self.destino = ap
+        self.ocupado_ate = agora + varredura_s + ASSOCIACAO_S + self.args.ip_ms / 1000
+
+    def passo(self, agora, galpao, posicao):
+        args = self.args
+        if self.ap is None:
+            self.sem_conexao_s += PASSO_S
+            if agora < self.ocupado_ate:
+                return
+            if self.destino is not None:
+                # Fim da associação: confere se o destino ainda é alcançável.
+                if galpao.rssi(self.destino, posicao) > RSSI_QUEDA:
+                    self.ap = self.destino
+                    if self.inicio_troca is not None:
+                        self.trocas.append(agora - self.inicio_troca)
+                    self.inicio_troca = None
+                    self.fraca = False
+                    self.proxima_varredura = agora + args.varredura_forte
+                    self.destino = None
+                    return
+                rssi, instante, falhas = self.cache.get(self.destino, (0, 0, 0))
+                self.cache[self.destino] = (rssi, instante, falhas + 1)
+                self.destino = None
+            # Reconexão: AP do cache (canal conhecido) ou varredura completa, como o driver.
+            ap = self.candidato(agora) if self.roaming else None
+            if ap is not None:
+                self.conecta(agora, ap, TEMPO_CANAL_S)
+            else:
+                varredura = self.varre(agora, galpao, posicao, range(1, CANAIS + 1))
+                ap = self.candidato(agora)
+                if ap is None:
+                    self.ocupado_ate = agora + varredura
+                    return
+                self.conecta(agora, ap, varredura)
+            return
+
+        rssi = galpao.rssi(self.ap, posicao)
+        self.conectado_s += PASSO_S
+        self.soma_rssi += rssi * PASSO_S
+        if rssi < args.limiar:
+            self.abaixo_s += PASSO_S
+        if rssi < RSSI_QUEDA:
+            self.quedas += 1
+            self.ap = None
+            self.inicio_troca = agora
+            return
+        if not self.roaming:
+            return
+
+        if not self.fraca and rssi < args.limiar:
+            # WIFI_EVENT_STA_BSS_RSSI_LOW: troca imediata com o cache, senão varredura.
+            self.fraca = True
+            self.proximo_rssi = agora
+            self.proxima_varredura = agora
+        if self.fraca and agora >= self.proximo_rssi:
+            self.proximo_rssi = agora + PERIODO_RSSI_S
+            if rssi >= args.limiar + args.histerese:
+                self.fraca = False
+                self.proxima_varredura = agora + args.varredura_forte
+        if agora >= self.proxima_varredura and agora >= self.ocupado_ate:
+            canais = sorted({c for _, _, c in galpao.aps}) if args.k11 else range(1, CANAIS + 1)
+            self.ocupado_ate = agora + self.varre(agora, galpao, posicao, canais)
+            self.cache[self.ap] = (rssi, agora, 0)
+            self.proxima_varredura = agora + (args.varredura_fraca if self.fraca else args.varredura_forte)
+        if self.fraca and agora >= self.ocupado_ate:
+            ap = self.candidato(agora, excluir=self.ap)
+            if ap is not None and self.cache[ap][0] >= rssi + args.histerese:
+                self.ap = None
+                self.inicio_troca = agora
+                self.conecta(agora, ap, 0)
+
+    def relatorio(self, duracao):
+        trocas = len(self.trocas)
+        media = sum(self.trocas) / trocas * 1000 if trocas else 0
+        pior = max(self.trocas) * 1000 if trocas else 0
+        print('%-18s trocas %4u (media %5.0f ms, pior %5.0f ms)  quedas %3u  abaixo do limiar %5.1f%%  '
+              'sem conexao %5.2f%%  RSSI medio %5.1f dBm  varreduras %4.2f%% do tempo'
+              % (self.nome, trocas, media, pior, self.quedas,
+                 100 * self.abaixo_s / max(self.conectado_s, PASSO_S), 100 * self.sem_conexao_s / duracao,
+                 self.soma_rssi / max(self.conectado_s, PASSO_S), 100 * self.varreduras_s / duracao))
+
+
+def ap(texto):
+    x, y, canal = texto.split(',')
+    return float(x), float(y), int(canal)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Simulacao do roaming entre APs em um galpao.')
+    parser.add_argument('--ap', type=ap, action='append', help='x,y,canal em metros (repetir para cada AP)')
+    parser.add_argument('--comprimento', type=float, default=120, help='metros percorridos de ponta a ponta')
+    parser.add_argument('--velocidade', type=float, default=1.0, help='m/s')
+    parser.add_argument('--duracao', type=float, default=3600, help='segundos simulados')
+    parser.add_argument('--limiar', type=int, default=-70, help='Roaming RSSI threshold (dBm)')
+    parser.add_argument('--histerese', type=int, default=8, help='Roaming hysteresis (dB)')
+    parser.add_argument('--varredura-forte', type=float, default=300, help='s entre varreduras com a conexao forte')
+    parser.add_argument('--varredura-fraca', type=float, default=10, help='s entre varreduras com a conexao fraca')
+    parser.add_argument('--validade', type=float, default=30, help='s de validade do cache')
+    parser.add_argument('--ip-ms', type=float, default=300, help='DHCP apos a associacao (ms)')
+    parser.add_argument('--11k', dest='k11', action='store_true', help='varre somente os canais dos vizinhos')
+    parser.add_argument('--expoente', type=float, default=3.0, help='expoente da perda log-distancia')
+    parser.add_argument('--sombreamento', type=float, default=4, help='desvio do sombreamento (dB)')
+    parser.add_argument('--semente', type=int, default=1)
+    args = parser.parse_args()
+
+    aps = args.ap or [(10, 5, 1), (35, 25, 6), (60, 5, 11), (85, 25, 1), (110, 5, 6)]
+    estacoes = [Station('padrao do driver', args, False), Station('wifi_roaming', args, True)]
+    # Mesma sequência de sombreamento para as duas estratégias; o ruído de medição é separado.
+    galpoes = [Galpao(aps, args.sombreamento, args.expoente, random.Random(args.semente)) for _ in estacoes]
+
+    agora = 0.0
+    while agora < args.duracao:
+        volta = (agora * args.velocidade) % (2 * args.comprimento)
+        posicao = (volta if volta < args.comprimento else 2 * args.comprimento - volta, 15.0)
+        for station, galpao in zip(estacoes, galpoes):
+            galpao.avanca()
+            station.passo(agora, galpao, posicao)
+        agora += PASSO_S
+
+    print('%u APs, %.0f s a %.1f m/s, limiar %d dBm, histerese %d dB%s'
+          % (len(aps), args.duracao, args.velocidade, args.limiar, args.histerese, ', 802.11k' if args.k11 else ''))
+    for station in estacoes:
+        station.relatorio(args.duracao)
+
+
+if __name__ == '__main__':
+    main()
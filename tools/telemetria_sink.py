@@ -0,0 +1,125 @@
+#!/usr/bin/env python3
+#
+# Coletor local da telemetria (componente telemetria): recebe os lotes por UDP ou TCP, confere a
+# sequência e imprime as amostras e, a cada intervalo, a vazão e os lotes por hora (despertares do
+# rádio). Substitui o servidor de produção nos testes com a placa.
+#
+# uso: telemetria_sink.py [--porta 5005] [--tcp] [--quieto] [--intervalo 10]
+#
+
+import argparse
+import socket
+import struct
+import time
+
+CABECALHO = struct.Struct('<HHI')  # versao, n, sequencia (telemetria_cabecalho_t)
+AMOSTRA = struct.Struct('<IiH2x')  # tempo_ms, valor, canal (telemetria_amostra_t)
+VERSAO = 1
+
+
+class Coletor:
+    def __init__(self, quieto, intervalo):
+        self.quieto = quieto
+        self.intervalo = intervalo
+        self.inicio = self.ultimo_relatorio = time.monotonic()
+        self.proxima = None
+        self.lotes = self.amostras = self.perdidos = self.bytes = 0
+
+    def lote(self, origem, cabecalho, corpo):
+        versao, n, sequencia = cabecalho
+        if versao != VERSAO:
+            print('%s: versao %u desconhecida, lote ignorado' % (origem, versao))
+            return
+        if self.proxima is not None and sequencia != self.proxima:
+            if sequencia > self.proxima:
+                self.perdidos += sequencia - self.proxima
+                print('%s: %u lotes perdidos antes do %u' % (origem, sequencia - self.proxima, sequencia))
+            else:
+                print('%s: sequencia reiniciada em %u (reboot ou lotes da NVS)' % (origem, sequencia))
+        self.proxima = sequencia + 1
+        self.lotes += 1
+        self.amostras += n
+        self.bytes += CABECALHO.size + len(corpo)
+        if not self.quieto:
+            amostras = [AMOSTRA.unpack_from(corpo, i * AMOSTRA.size) for i in range(n)]
+            print('%s: lote %u com %u amostras' % (origem, sequencia, n))
+            for tempo_ms, valor, canal in amostras:
+                print('  %10u ms  canal %u  valor %d' % (tempo_ms, canal, valor))
+        self.relatorio()
+
+    def relatorio(self, forcar=False):
+        agora = time.monotonic()
+        if not forcar and agora - self.ultimo_relatorio < self.intervalo:
+            return
+        self.ultimo_relatorio = agora
+        decorrido = max(agora - self.inicio, 1e-3)
+        print('== %u lotes, %u amostras (%.1f/s), %u bytes, %u lotes perdidos, %.0f lotes por hora'
+              % (self.lotes, self.amostras, self.amostras / decorrido, self.bytes, self.perdidos,
+                 self.lotes * 3600 / decorrido))
+
+
+def recebe_udp(args, coletor):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.bind(('', args.porta))
+    print('Aguardando lotes UDP na porta %u' % args.porta)
+    while True:
+        dados, origem = sock.recvfrom(65535)
+        if len(dados) < CABECALHO.size:
+            continue
+        cabecalho = CABECALHO.unpack_from(dados)
+        corpo = dados[CABECALHO.size:]
+        if len(corpo) != cabecalho[1] * AMOSTRA.size:
+            print('%s: datagrama de %u bytes nao corresponde a %u amostras' % (origem[0], len(dados), cabecalho[1]))
+            continue
+        coletor.lote(origem[0], cabecalho, corpo)
+
+
+def le_exato(conexao, tamanho):
+    dados = b''
+    while len(dados) < tamanho:
+        parte = conexao.recv(tamanho - len(dados))
+        if not parte:
+            return None
+        dados += parte
+    return dados
+
+
+def recebe_tcp(args, coletor):
+    servidor = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    servidor.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    servidor.bind(('', args.porta))
+    servidor.listen(1)
+    print('Aguardando conexoes TCP na porta %u' % args.porta)
+    while True:
+        conexao, origem = servidor.accept()
+        print('%s: conectado' % origem[0])
+        with conexao:
+            while True:
+                dados = le_exato(conexao, CABECALHO.size)
+                if dados is None:
+                    break
+                cabecalho = CABECALHO.unpack(dados)
+                corpo = le_exato(conexao, cabecalho[1] * AMOSTRA.size)
+                if corpo is None:
+                    break
+                coletor.lote(origem[0], cabecalho, corpo)
+        print('%s: conexao encerrada' % origem[0])
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Coletor local dos lotes da telemetria.')
+    parser.add_argument('--porta', type=int, default=5005)
+    parser.add_argument('--tcp', action='store_true', help='aceita conexoes TCP em vez de datagramas UDP')
+    parser.add_argument('--quieto', action='store_true', help='nao imprime cada amostra')
+    parser.add_argument('--intervalo', type=float, default=10, help='segundos entre os resumos')
+    args = parser.parse_args()
+
+    coletor = Coletor(args.quieto, args.intervalo)
+    try:
+        (recebe_tcp if args.tcp else recebe_udp)(args, coletor)
+    except KeyboardInterrupt:
+        coletor.relatorio(forcar=True)
+
+
+if __name__ == '__main__':
+    main()